@@ -0,0 +1,24 @@
+#include <benchmark/benchmark.h>
+#include "streamit/common/crc32.h"
+#include <cstddef>
+#include <vector>
+
+namespace streamit::common {
+namespace {
+
+// Checksum over every appended and fetched batch; the argument is the buffer size in bytes
+void BM_Crc32Compute(benchmark::State& state) {
+  std::vector<std::byte> data(static_cast<size_t>(state.range(0)));
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<std::byte>(i * 31);
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Crc32::Compute(data));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Crc32Compute)->RangeMultiplier(16)->Range(64, 1 << 20);
+
+} // namespace
+} // namespace streamit::common
@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+#include "streamit/coordinator/consumer_group_manager.h"
+#include <string>
+#include <vector>
+
+namespace streamit::coordinator {
+namespace {
+
+// A member joining a large group, which reassigns every partition of every subscribed topic.
+// Arguments are the number of members already in the group and the number of topics they subscribe to.
+void BM_ConsumerGroupRebalance(benchmark::State& state) {
+  auto members = state.range(0);
+  std::vector<std::string> topics;
+  for (int64_t i = 0; i < state.range(1); ++i) {
+    topics.push_back("topic-" + std::to_string(i));
+  }
+
+  ConsumerGroupManager manager(3000, 60000);
+  for (int64_t i = 0; i < members; ++i) {
+    if (!manager.JoinGroup("bench", "member-" + std::to_string(i), topics).ok()) {
+      state.SkipWithError("Failed to build the group");
+      return;
+    }
+  }
+
+  // Fresh member ids so every join misses an assignment and rebalances; the leave keeps the group size fixed
+  int64_t next = members;
+  for (auto _ : state) {
+    auto member_id = "member-" + std::to_string(next++);
+    benchmark::DoNotOptimize(manager.JoinGroup("bench", member_id, topics));
+    benchmark::DoNotOptimize(manager.LeaveGroup("bench", member_id));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ConsumerGroupRebalance)->ArgsProduct({{10, 100, 1000}, {1, 10, 100}})->Unit(benchmark::kMicrosecond);
+
+// Heartbeats from every member of a group, the steady-state load on the coordinator
+void BM_ConsumerGroupHeartbeat(benchmark::State& state) {
+  auto members = state.range(0);
+  ConsumerGroupManager manager(3000, 60000);
+  for (int64_t i = 0; i < members; ++i) {
+    benchmark::DoNotOptimize(manager.JoinGroup("bench", "member-" + std::to_string(i), {"orders"}));
+  }
+
+  std::vector<std::string> ids;
+  for (int64_t i = 0; i < members; ++i) {
+    ids.push_back("member-" + std::to_string(i));
+  }
+  size_t next = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(manager.Heartbeat("bench", ids[next]));
+    next = (next + 1) % ids.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ConsumerGroupHeartbeat)->Arg(10)->Arg(1000);
+
+} // namespace
+} // namespace streamit::coordinator
@@ -0,0 +1,104 @@
+#include <benchmark/benchmark.h>
+#include "streamit/broker/bounded_idempotency_table.h"
+#include "streamit/broker/idempotency_table.h"
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace streamit::broker {
+namespace {
+
+std::vector<ProducerKey> MakeKeys(size_t count) {
+  std::vector<ProducerKey> keys;
+  keys.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    keys.push_back({static_cast<int64_t>(i + 1), 0, static_cast<int32_t>(i % 16)});
+  }
+  return keys;
+}
+
+// Produce path: check then record a sequence for a random active producer
+void BM_BoundedIdempotencyProduce(benchmark::State& state) {
+  auto producers = static_cast<size_t>(state.range(0));
+  auto keys = MakeKeys(producers);
+  BoundedIdempotencyTable table(producers, std::chrono::minutes(10));
+  for (const auto& key : keys) {
+    table.UpdateSequence(key, 0, 0);
+  }
+
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<size_t> pick(0, producers - 1);
+  int64_t sequence = 1;
+  for (auto _ : state) {
+    const auto& key = keys[pick(rng)];
+    benchmark::DoNotOptimize(table.IsValidSequence(key, sequence));
+    table.UpdateSequence(key, sequence, sequence);
+    ++sequence;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BoundedIdempotencyProduce)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// New producers arriving at capacity, so every insert evicts the LRU entry
+void BM_BoundedIdempotencyEvict(benchmark::State& state) {
+  auto capacity = static_cast<size_t>(state.range(0));
+  auto keys = MakeKeys(capacity * 2);
+  BoundedIdempotencyTable table(capacity, std::chrono::minutes(10));
+
+  size_t next = 0;
+  for (auto _ : state) {
+    table.UpdateSequence(keys[next], 0, 0);
+    next = (next + 1) % keys.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BoundedIdempotencyEvict)->Arg(1000)->Arg(100000);
+
+// Concurrent produces to distinct partitions; the argument is the shard count
+void BM_IdempotencyContended(benchmark::State& state) {
+  static IdempotencyTable* table = nullptr;
+  if (state.thread_index() == 0) {
+    table = new IdempotencyTable(static_cast<size_t>(state.range(0)));
+  }
+
+  ProducerKey key{state.thread_index() + 1, 0, state.thread_index()};
+  int64_t sequence = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table->IsValidSequence(key, sequence));
+    table->UpdateSequence(key, sequence, sequence);
+    ++sequence;
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    delete table;
+    table = nullptr;
+  }
+}
+BENCHMARK(BM_IdempotencyContended)->Arg(1)->Arg(16)->Threads(1)->Threads(4)->Threads(8)->UseRealTime();
+
+// The bounded table under the same load; the argument is the shard count
+void BM_BoundedIdempotencyContended(benchmark::State& state) {
+  static BoundedIdempotencyTable* table = nullptr;
+  if (state.thread_index() == 0) {
+    table = new BoundedIdempotencyTable(100000, std::chrono::minutes(10), static_cast<size_t>(state.range(0)));
+  }
+
+  ProducerKey key{state.thread_index() + 1, 0, state.thread_index()};
+  int64_t sequence = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table->IsValidSequence(key, sequence));
+    table->UpdateSequence(key, sequence, sequence);
+    ++sequence;
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    delete table;
+    table = nullptr;
+  }
+}
+BENCHMARK(BM_BoundedIdempotencyContended)->Arg(1)->Arg(16)->Threads(1)->Threads(4)->Threads(8)->UseRealTime();
+
+} // namespace
+} // namespace streamit::broker
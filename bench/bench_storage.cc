@@ -0,0 +1,214 @@
+#include <benchmark/benchmark.h>
+#include "streamit/storage/flush_policy.h"
+#include "streamit/storage/log_dir.h"
+#include "streamit/storage/record.h"
+#include "streamit/storage/segment.h"
+#include "streamit/storage/serializer.h"
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace streamit::storage {
+namespace {
+
+constexpr size_t kValueSize = 100;
+constexpr size_t kSegmentBytes = 1024 * 1024 * 1024;
+
+// Empty scratch directory for one benchmark
+std::filesystem::path BenchDir(const std::string& name) {
+  auto path = std::filesystem::temp_directory_path() / ("streamit_bench_" + name);
+  std::filesystem::remove_all(path);
+  std::filesystem::create_directories(path);
+  return path;
+}
+
+std::vector<Record> MakeRecords(size_t count) {
+  std::vector<Record> records;
+  records.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    records.emplace_back("key-" + std::to_string(i), std::string(kValueSize, 'v'), 1700000000000);
+  }
+  return records;
+}
+
+size_t RecordBytes(const std::vector<Record>& records) {
+  size_t bytes = 0;
+  for (const auto& record : records) {
+    bytes += record.SerializedSize();
+  }
+  return bytes;
+}
+
+std::unique_ptr<Segment> MakeSegment(const std::filesystem::path& dir, FlushPolicy policy) {
+  std::filesystem::remove(dir / "0.log");
+  std::filesystem::remove(dir / "0.index");
+  return std::make_unique<Segment>(dir / "0.log", dir / "0.index", 0, kSegmentBytes, policy);
+}
+
+// Append path; arguments are records per batch and flush policy (Never, OnRoll, EachBatch)
+void BM_SegmentAppend(benchmark::State& state) {
+  auto records = MakeRecords(static_cast<size_t>(state.range(0)));
+  auto policy = static_cast<FlushPolicy>(state.range(1));
+  auto dir = BenchDir("segment_append");
+  auto segment = MakeSegment(dir, policy);
+
+  for (auto _ : state) {
+    auto offset = segment->Append(records);
+    if (!offset.ok()) {
+      // Full: carry on in a fresh segment outside the timed region
+      state.PauseTiming();
+      segment = MakeSegment(dir, policy);
+      state.ResumeTiming();
+      offset = segment->Append(records);
+    }
+    benchmark::DoNotOptimize(offset);
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(RecordBytes(records)));
+  state.SetLabel(ToString(policy));
+  segment.reset();
+  std::filesystem::remove_all(dir);
+}
+BENCHMARK(BM_SegmentAppend)
+    ->ArgsProduct({{1, 16, 256}, {static_cast<int64_t>(FlushPolicy::Never), static_cast<int64_t>(FlushPolicy::OnRoll)}})
+    ->Args({1, static_cast<int64_t>(FlushPolicy::EachBatch)})
+    ->Args({256, static_cast<int64_t>(FlushPolicy::EachBatch)});
+
+// Fetch path: read up to 1MB from a random offset of a segment holding 4096 batches of `range(0)` records
+void BM_SegmentRead(benchmark::State& state) {
+  auto per_batch = static_cast<size_t>(state.range(0));
+  auto records = MakeRecords(per_batch);
+  auto dir = BenchDir("segment_read");
+  auto segment = MakeSegment(dir, FlushPolicy::Never);
+  for (int i = 0; i < 4096; ++i) {
+    if (!segment->Append(records).ok()) {
+      state.SkipWithError("Failed to fill the segment");
+      return;
+    }
+  }
+
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int64_t> pick(0, segment->EndOffset() - 1);
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    auto batches = segment->Read(pick(rng), 1024 * 1024);
+    if (batches.ok()) {
+      for (const auto& batch : *batches) {
+        bytes += static_cast<int64_t>(RecordBytes(batch.records));
+      }
+    }
+    benchmark::DoNotOptimize(batches);
+  }
+
+  state.SetBytesProcessed(bytes);
+  segment.reset();
+  std::filesystem::remove_all(dir);
+}
+BENCHMARK(BM_SegmentRead)->Arg(1)->Arg(16)->Arg(256);
+
+// Batch encoding as done on every append; the argument is records per batch
+void BM_SerializeBatch(benchmark::State& state) {
+  RecordBatch batch(0, MakeRecords(static_cast<size_t>(state.range(0))), 1700000000000);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Serializer::SerializeBatch(batch));
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(Serializer::GetBatchSize(batch)));
+}
+BENCHMARK(BM_SerializeBatch)->Arg(1)->Arg(16)->Arg(256);
+
+// Batch decoding as done on every read
+void BM_DeserializeBatch(benchmark::State& state) {
+  auto bytes = Serializer::SerializeBatch(RecordBatch(0, MakeRecords(static_cast<size_t>(state.range(0))),
+                                                      1700000000000));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Serializer::DeserializeBatch(bytes));
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+}
+BENCHMARK(BM_DeserializeBatch)->Arg(1)->Arg(16)->Arg(256);
+
+// RecordBatch's own encoding, including the CRC over the body
+void BM_RecordBatchEncode(benchmark::State& state) {
+  RecordBatch batch(0, MakeRecords(static_cast<size_t>(state.range(0))), 1700000000000);
+  for (auto _ : state) {
+    batch.ComputeCrc32();
+    benchmark::DoNotOptimize(batch.Serialize());
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(batch.SerializedSize()));
+}
+BENCHMARK(BM_RecordBatchEncode)->Arg(1)->Arg(16)->Arg(256);
+
+void BM_RecordBatchDecode(benchmark::State& state) {
+  auto bytes = RecordBatch(0, MakeRecords(static_cast<size_t>(state.range(0))), 1700000000000).Serialize();
+  for (auto _ : state) {
+    auto batch = RecordBatch::Deserialize(bytes);
+    benchmark::DoNotOptimize(batch.VerifyCrc32());
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+}
+BENCHMARK(BM_RecordBatchDecode)->Arg(1)->Arg(16)->Arg(256);
+
+// Partition lookups from request threads racing on a shared LogDir; the argument is the partition count
+void BM_LogDirGetPartition(benchmark::State& state) {
+  static LogDir* log_dir = nullptr;
+  static std::vector<common::TopicPartition>* partitions = nullptr;
+  if (state.thread_index() == 0) {
+    log_dir = new LogDir(BenchDir("log_dir_lookup"), kSegmentBytes);
+    partitions = new std::vector<common::TopicPartition>();
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      common::TopicPartition tp{log_dir->Topics()->Intern("topic-" + std::to_string(i % 16)),
+                                static_cast<int32_t>(i / 16)};
+      benchmark::DoNotOptimize(log_dir->GetOrCreatePartition(tp));
+      partitions->push_back(tp);
+    }
+  }
+
+  std::mt19937_64 rng(state.thread_index());
+  std::uniform_int_distribution<size_t> pick(0, static_cast<size_t>(state.range(0)) - 1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(log_dir->GetPartition((*partitions)[pick(rng)]));
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    auto root = log_dir->RootPath();
+    delete log_dir;
+    delete partitions;
+    log_dir = nullptr;
+    partitions = nullptr;
+    std::filesystem::remove_all(root);
+  }
+}
+BENCHMARK(BM_LogDirGetPartition)->Arg(16)->Arg(1024)->Threads(1)->Threads(4)->Threads(8)->UseRealTime();
+
+// Name-keyed lookup as used by admin paths: intern the topic, then find the partition
+void BM_LogDirEndOffsetByName(benchmark::State& state) {
+  static LogDir* log_dir = nullptr;
+  if (state.thread_index() == 0) {
+    log_dir = new LogDir(BenchDir("log_dir_by_name"), kSegmentBytes);
+    for (int32_t i = 0; i < 16; ++i) {
+      benchmark::DoNotOptimize(log_dir->GetOrCreatePartition({log_dir->Topics()->Intern("orders"), i}));
+    }
+  }
+
+  const std::string topic = "orders";
+  int32_t partition = state.thread_index() % 16;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(log_dir->GetEndOffset(topic, partition));
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    auto root = log_dir->RootPath();
+    delete log_dir;
+    log_dir = nullptr;
+    std::filesystem::remove_all(root);
+  }
+}
+BENCHMARK(BM_LogDirEndOffsetByName)->Threads(1)->Threads(4)->Threads(8)->UseRealTime();
+
+} // namespace
+} // namespace streamit::storage
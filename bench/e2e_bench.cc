@@ -0,0 +1,560 @@
+// In-process end-to-end benchmark: a broker, controller and coordinator on loopback, driven by open-loop
+// producers and long-polling consumers. Produce latency is measured from each request's scheduled send time, not
+// from when it was actually sent, so a stalled broker shows up as the queueing it causes (coordinated omission
+// correction). Records carry their scheduled send time, which gives append-to-consume latency on the consumer side.
+
+#include "streamit/broker/broker_service.h"
+#include "streamit/common/metrics.h"
+#include "streamit/common/tracing.h"
+#include "streamit/controller/controller_service.h"
+#include "streamit/coordinator/coordinator_service.h"
+#include "streamit/proto/streamit.grpc.pb.h"
+#include "streamit/storage/log_dir.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <functional>
+#include <grpcpp/grpcpp.h>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace streamit::bench {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  int producers = 4;
+  int consumers = 4;
+  int partitions = 12;
+  double rate = 20000;     // Records per second across all producers
+  int batch = 1;           // Records per produce request
+  size_t record_size = 256; // Value bytes per record (at least 8: the scheduled send time)
+  int keys = 10000;
+  std::string key_distribution = "uniform"; // uniform or zipf
+  double zipf_exponent = 0.99;
+  std::chrono::seconds warmup{5};
+  std::chrono::seconds duration{30};
+  std::chrono::milliseconds fetch_wait{500};
+  int32_t fetch_max_bytes = 1024 * 1024;
+  uint16_t port = 19092; // Broker; the controller and coordinator take the next two ports
+  std::string log_dir;
+  std::string json_path;
+};
+
+void PrintHelp() {
+  std::cout << "Usage: streamit_e2e_bench [options]\n"
+            << "\n"
+            << "Options:\n"
+            << "  --producers NUM         Producer threads (default: 4)\n"
+            << "  --consumers NUM         Consumer threads; partitions are split between them (default: 4)\n"
+            << "  --partitions NUM        Partitions of the benchmark topic (default: 12)\n"
+            << "  --rate NUM              Records per second across all producers, open loop (default: 20000)\n"
+            << "  --batch NUM             Records per produce request (default: 1)\n"
+            << "  --record-size BYTES     Value size, at least 8 (default: 256)\n"
+            << "  --keys NUM              Distinct keys; a key always maps to the same partition (default: 10000)\n"
+            << "  --key-distribution D    uniform or zipf (default: uniform)\n"
+            << "  --zipf-exponent S       Skew of the zipf distribution (default: 0.99)\n"
+            << "  --warmup SECONDS        Load before measuring starts (default: 5)\n"
+            << "  --duration SECONDS      Measured load (default: 30)\n"
+            << "  --fetch-wait-ms MS      Long-poll wait of fetches at the log end (default: 500)\n"
+            << "  --port PORT             Broker port; controller and coordinator use the next two (default: 19092)\n"
+            << "  --log-dir PATH          Broker log directory, emptied first (default: a temporary directory)\n"
+            << "  --json PATH             Also write the results as JSON\n"
+            << "  --help, -h              Show this help message\n";
+}
+
+// nullopt after printing the problem (or the help)
+std::optional<Options> ParseOptions(int argc, char* argv[]) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--help" || arg == "-h") {
+      PrintHelp();
+      return std::nullopt;
+    } else if (arg == "--producers" && has_value) {
+      options.producers = std::stoi(argv[++i]);
+    } else if (arg == "--consumers" && has_value) {
+      options.consumers = std::stoi(argv[++i]);
+    } else if (arg == "--partitions" && has_value) {
+      options.partitions = std::stoi(argv[++i]);
+    } else if (arg == "--rate" && has_value) {
+      options.rate = std::stod(argv[++i]);
+    } else if (arg == "--batch" && has_value) {
+      options.batch = std::stoi(argv[++i]);
+    } else if (arg == "--record-size" && has_value) {
+      options.record_size = std::stoul(argv[++i]);
+    } else if (arg == "--keys" && has_value) {
+      options.keys = std::stoi(argv[++i]);
+    } else if (arg == "--key-distribution" && has_value) {
+      options.key_distribution = argv[++i];
+    } else if (arg == "--zipf-exponent" && has_value) {
+      options.zipf_exponent = std::stod(argv[++i]);
+    } else if (arg == "--warmup" && has_value) {
+      options.warmup = std::chrono::seconds(std::stoi(argv[++i]));
+    } else if (arg == "--duration" && has_value) {
+      options.duration = std::chrono::seconds(std::stoi(argv[++i]));
+    } else if (arg == "--fetch-wait-ms" && has_value) {
+      options.fetch_wait = std::chrono::milliseconds(std::stoi(argv[++i]));
+    } else if (arg == "--port" && has_value) {
+      options.port = static_cast<uint16_t>(std::stoi(argv[++i]));
+    } else if (arg == "--log-dir" && has_value) {
+      options.log_dir = argv[++i];
+    } else if (arg == "--json" && has_value) {
+      options.json_path = argv[++i];
+    } else {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      PrintHelp();
+      return std::nullopt;
+    }
+  }
+
+  if (options.producers < 1 || options.consumers < 1 || options.partitions < 1 || options.batch < 1 ||
+      options.keys < 1 || options.rate <= 0 || options.duration.count() < 1) {
+    std::cerr << "producers, consumers, partitions, batch, keys, rate and duration must be positive" << std::endl;
+    return std::nullopt;
+  }
+  if (options.record_size < sizeof(int64_t)) {
+    std::cerr << "record-size must be at least 8" << std::endl;
+    return std::nullopt;
+  }
+  if (options.key_distribution != "uniform" && options.key_distribution != "zipf") {
+    std::cerr << "key-distribution must be uniform or zipf" << std::endl;
+    return std::nullopt;
+  }
+  if (options.log_dir.empty()) {
+    options.log_dir = (std::filesystem::temp_directory_path() / "streamit_e2e_bench").string();
+  }
+  return options;
+}
+
+// Picks keys by index; zipf keys are drawn by inverting a precomputed CDF
+class KeyChooser {
+public:
+  explicit KeyChooser(const Options& options) : keys_(options.keys) {
+    if (options.key_distribution == "zipf") {
+      cdf_.reserve(static_cast<size_t>(keys_));
+      double total = 0;
+      for (int k = 1; k <= keys_; ++k) {
+        total += 1.0 / std::pow(k, options.zipf_exponent);
+        cdf_.push_back(total);
+      }
+      for (auto& p : cdf_) {
+        p /= total;
+      }
+    }
+  }
+
+  [[nodiscard]] int Next(std::mt19937_64& rng) const {
+    if (cdf_.empty()) {
+      return std::uniform_int_distribution<int>(0, keys_ - 1)(rng);
+    }
+    auto u = std::uniform_real_distribution<double>(0, 1)(rng);
+    auto it = std::lower_bound(cdf_.begin(), cdf_.end(), u);
+    return static_cast<int>(std::min<ptrdiff_t>(it - cdf_.begin(), keys_ - 1));
+  }
+
+private:
+  int keys_;
+  std::vector<double> cdf_;
+};
+
+// What producers and consumers record during the measured window
+struct Results {
+  common::Histogram produce_ns;         // Scheduled send to ack (corrected)
+  common::Histogram produce_service_ns; // Actual send to ack
+  common::Histogram fetch_ns;           // Fetches of data already in the log (long polls excluded)
+  common::Histogram end_to_end_ns;      // Scheduled send to consume, per record
+  std::atomic<int64_t> produced_records{0};
+  std::atomic<int64_t> produced_bytes{0};
+  std::atomic<int64_t> produce_errors{0};
+  std::atomic<int64_t> consumed_records{0};
+  std::atomic<int64_t> consumed_bytes{0};
+  std::atomic<int64_t> fetch_errors{0};
+
+  // Records produced and consumed over the whole run, warmup included, to know when consumers have caught up
+  std::atomic<int64_t> total_produced{0};
+  std::atomic<int64_t> total_consumed{0};
+};
+
+int64_t Nanos(Clock::duration d) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+int64_t Nanos(Clock::time_point t) {
+  return Nanos(t.time_since_epoch());
+}
+
+// A channel of its own, so clients do not share one HTTP/2 connection
+std::shared_ptr<grpc::Channel> MakeChannel(const std::string& address) {
+  grpc::ChannelArguments args;
+  args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+  return grpc::CreateCustomChannel(address, grpc::InsecureChannelCredentials(), args);
+}
+
+// Sends batches on a fixed schedule from `start` until `end`. A late send does not push the schedule back, so
+// latency measured from the scheduled time includes the time the request spent waiting for its turn.
+void RunProducer(int index, const Options& options, const std::string& topic, const std::string& address,
+                 const KeyChooser& keys, Clock::time_point start, Clock::time_point measure_from,
+                 Clock::time_point end, Results& results) {
+  auto stub = streamit::v1::Broker::NewStub(MakeChannel(address));
+  std::mt19937_64 rng(static_cast<uint64_t>(index) * 7919 + 1);
+
+  auto requests_per_second = options.rate / options.batch / options.producers;
+  auto interval = std::chrono::nanoseconds(static_cast<int64_t>(1e9 / requests_per_second));
+
+  // Stagger producers across one interval
+  auto scheduled = start + interval * index / options.producers;
+  std::string value(options.record_size, 'x');
+  std::hash<std::string> hash;
+
+  for (; scheduled < end; scheduled += interval) {
+    std::this_thread::sleep_until(scheduled);
+
+    auto key = "key-" + std::to_string(keys.Next(rng));
+    auto scheduled_ns = Nanos(scheduled);
+    std::memcpy(value.data(), &scheduled_ns, sizeof(scheduled_ns));
+
+    streamit::v1::ProduceRequest request;
+    request.set_topic(topic);
+    request.set_partition(static_cast<int32_t>(hash(key) % static_cast<size_t>(options.partitions)));
+    auto now_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch());
+    for (int i = 0; i < options.batch; ++i) {
+      auto* record = request.add_records();
+      record->set_key(key);
+      record->set_value(value);
+      record->set_timestamp_ms(now_ms.count());
+    }
+
+    streamit::v1::ProduceResponse response;
+    grpc::ClientContext context;
+    auto sent = Clock::now();
+    auto status = stub->Produce(&context, request, &response);
+    auto acked = Clock::now();
+
+    bool ok = status.ok() && response.error_code() == streamit::v1::OK;
+    if (ok) {
+      results.total_produced.fetch_add(options.batch, std::memory_order_relaxed);
+    }
+    if (scheduled < measure_from) {
+      continue;
+    }
+    if (!ok) {
+      results.produce_errors.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+    results.produce_ns.Record(Nanos(acked - scheduled));
+    results.produce_service_ns.Record(Nanos(acked - sent));
+    results.produced_records.fetch_add(options.batch, std::memory_order_relaxed);
+    results.produced_bytes.fetch_add(static_cast<int64_t>(request.ByteSizeLong()), std::memory_order_relaxed);
+  }
+}
+
+// One outstanding fetch per assigned partition on a completion queue, so an idle partition's long poll never
+// delays a busy one
+struct PartitionFetch {
+  int32_t partition;
+  int64_t offset = 0;
+  bool behind = false; // The last response showed data past `offset`, so the next fetch will not long-poll
+  Clock::time_point sent;
+  std::unique_ptr<grpc::ClientContext> context;
+  streamit::v1::FetchResponse response;
+  grpc::Status status;
+  std::unique_ptr<grpc::ClientAsyncResponseReader<streamit::v1::FetchResponse>> reader;
+};
+
+void RunConsumer(int index, const Options& options, const std::string& topic, const std::string& broker_address,
+                 const std::string& coordinator_address, Clock::time_point measure_from,
+                 const std::atomic<bool>& stop, Results& results) {
+  auto stub = streamit::v1::Broker::NewStub(MakeChannel(broker_address));
+  auto coordinator = streamit::v1::Coordinator::NewStub(MakeChannel(coordinator_address));
+  grpc::CompletionQueue queue;
+
+  // Partitions are split statically: the coordinator's assignor does not know partition counts
+  std::vector<std::unique_ptr<PartitionFetch>> fetches;
+  for (int32_t p = index; p < options.partitions; p += options.consumers) {
+    fetches.push_back(std::make_unique<PartitionFetch>());
+    fetches.back()->partition = p;
+  }
+
+  auto issue = [&](PartitionFetch& fetch) {
+    streamit::v1::FetchRequest request;
+    request.set_topic(topic);
+    request.set_partition(fetch.partition);
+    request.set_offset(fetch.offset);
+    request.set_max_bytes(options.fetch_max_bytes);
+
+    fetch.context = std::make_unique<grpc::ClientContext>();
+    fetch.context->AddMetadata("x-max-wait-ms", std::to_string(options.fetch_wait.count()));
+    fetch.response.Clear();
+    fetch.sent = Clock::now();
+    fetch.reader = stub->AsyncFetch(fetch.context.get(), request, &queue);
+    fetch.reader->Finish(&fetch.response, &fetch.status, &fetch);
+  };
+
+  for (auto& fetch : fetches) {
+    issue(*fetch);
+  }
+
+  auto last_commit = Clock::now();
+  size_t outstanding = fetches.size();
+  bool cancelled = false;
+  while (outstanding > 0) {
+    void* tag = nullptr;
+    bool ok = false;
+    auto next = queue.AsyncNext(&tag, &ok, Clock::now() + std::chrono::milliseconds(100));
+    if (next == grpc::CompletionQueue::SHUTDOWN) {
+      break;
+    }
+
+    if (stop.load() && !cancelled) {
+      cancelled = true;
+      for (auto& fetch : fetches) {
+        fetch->context->TryCancel();
+      }
+    }
+    if (next == grpc::CompletionQueue::TIMEOUT) {
+      continue;
+    }
+
+    auto& fetch = *static_cast<PartitionFetch*>(tag);
+    auto done = Clock::now();
+    if (cancelled) {
+      --outstanding;
+      continue;
+    }
+
+    if (!ok || !fetch.status.ok() || fetch.response.error_code() != streamit::v1::OK) {
+      if (done >= measure_from) {
+        results.fetch_errors.fetch_add(1, std::memory_order_relaxed);
+      }
+      issue(fetch);
+      continue;
+    }
+
+    int64_t records = 0;
+    for (const auto& batch : fetch.response.batches()) {
+      for (const auto& record : batch.records()) {
+        ++records;
+        int64_t scheduled_ns = 0;
+        if (record.value().size() >= sizeof(scheduled_ns)) {
+          std::memcpy(&scheduled_ns, record.value().data(), sizeof(scheduled_ns));
+        }
+        if (scheduled_ns >= Nanos(measure_from)) {
+          results.end_to_end_ns.Record(Nanos(done) - scheduled_ns);
+          results.consumed_records.fetch_add(1, std::memory_order_relaxed);
+          results.consumed_bytes.fetch_add(static_cast<int64_t>(record.ByteSizeLong()), std::memory_order_relaxed);
+        }
+      }
+      fetch.offset = batch.base_offset() + batch.records_size();
+    }
+    results.total_consumed.fetch_add(records, std::memory_order_relaxed);
+
+    if (fetch.behind && records > 0 && done >= measure_from) {
+      results.fetch_ns.Record(Nanos(done - fetch.sent));
+    }
+    fetch.behind = fetch.response.high_watermark() > fetch.offset;
+
+    // Commit progress about once a second, as a real consumer would
+    if (done - last_commit >= std::chrono::seconds(1)) {
+      last_commit = done;
+      for (const auto& partition : fetches) {
+        streamit::v1::CommitOffsetRequest commit;
+        commit.set_group("e2e-bench");
+        commit.set_topic(topic);
+        commit.set_partition(partition->partition);
+        commit.set_offset(partition->offset);
+        streamit::v1::CommitOffsetResponse commit_response;
+        grpc::ClientContext context;
+        (void)coordinator->CommitOffset(&context, commit, &commit_response);
+      }
+    }
+
+    issue(fetch);
+  }
+
+  queue.Shutdown();
+  void* tag = nullptr;
+  bool ok = false;
+  while (queue.Next(&tag, &ok)) {
+  }
+}
+
+void PrintLatency(std::string_view name, const common::HistogramSnapshot& snapshot) {
+  auto us = [](int64_t ns) { return static_cast<double>(ns) / 1000.0; };
+  std::cout << fmt::format("{:<26}{:>10}{:>10.1f}{:>10.1f}{:>10.1f}{:>10.1f}{:>11.1f}{:>10.1f}\n", name,
+                           snapshot.Count(), us(snapshot.Quantile(0.5)), us(snapshot.Quantile(0.9)),
+                           us(snapshot.Quantile(0.99)), us(snapshot.Quantile(0.999)), us(snapshot.Quantile(0.9999)),
+                           us(snapshot.Max()));
+}
+
+std::string LatencyJson(const common::HistogramSnapshot& snapshot) {
+  return fmt::format("{{\"count\":{},\"mean_ns\":{:.0f},\"p50_ns\":{},\"p90_ns\":{},\"p99_ns\":{},\"p999_ns\":{},"
+                     "\"p9999_ns\":{},\"max_ns\":{}}}",
+                     snapshot.Count(), snapshot.Mean(), snapshot.Quantile(0.5), snapshot.Quantile(0.9),
+                     snapshot.Quantile(0.99), snapshot.Quantile(0.999), snapshot.Quantile(0.9999), snapshot.Max());
+}
+
+void Report(const Options& options, const Results& results) {
+  auto seconds = static_cast<double>(options.duration.count());
+  auto produced = results.produced_records.load();
+  auto consumed = results.consumed_records.load();
+  auto produce = results.produce_ns.Snapshot();
+  auto produce_service = results.produce_service_ns.Snapshot();
+  auto fetch = results.fetch_ns.Snapshot();
+  auto end_to_end = results.end_to_end_ns.Snapshot();
+
+  std::cout << fmt::format("\n{} producers, {} consumers, {} partitions, {:.0f} records/s offered ({} per request, "
+                           "{}B values, {} {} keys), {}s measured after {}s warmup\n\n",
+                           options.producers, options.consumers, options.partitions, options.rate, options.batch,
+                           options.record_size, options.keys, options.key_distribution, options.duration.count(),
+                           options.warmup.count());
+  std::cout << fmt::format("produced  {:>12.0f} records/s {:>9.2f} MB/s   {} failed requests\n", produced / seconds,
+                           static_cast<double>(results.produced_bytes.load()) / seconds / 1e6,
+                           results.produce_errors.load());
+  std::cout << fmt::format("consumed  {:>12.0f} records/s {:>9.2f} MB/s   {} failed fetches\n\n", consumed / seconds,
+                           static_cast<double>(results.consumed_bytes.load()) / seconds / 1e6,
+                           results.fetch_errors.load());
+  std::cout << fmt::format("{:<26}{:>10}{:>10}{:>10}{:>10}{:>10}{:>11}{:>10}\n", "latency (us)", "count", "p50", "p90",
+                           "p99", "p99.9", "p99.99", "max");
+  PrintLatency("produce ack (corrected)", produce);
+  PrintLatency("produce ack (service)", produce_service);
+  PrintLatency("fetch (catch-up)", fetch);
+  PrintLatency("end to end (corrected)", end_to_end);
+
+  if (options.json_path.empty()) {
+    return;
+  }
+  std::ofstream out(options.json_path);
+  out << fmt::format("{{\"options\":{{\"producers\":{},\"consumers\":{},\"partitions\":{},\"rate\":{},\"batch\":{},"
+                     "\"record_size\":{},\"keys\":{},\"key_distribution\":\"{}\",\"warmup_s\":{},\"duration_s\":{}}},"
+                     "\"produced_records_per_sec\":{:.1f},\"produced_bytes_per_sec\":{:.1f},\"produce_errors\":{},"
+                     "\"consumed_records_per_sec\":{:.1f},\"consumed_bytes_per_sec\":{:.1f},\"fetch_errors\":{},"
+                     "\"latency\":{{\"produce\":{},\"produce_service\":{},\"fetch\":{},\"end_to_end\":{}}}}}\n",
+                     options.producers, options.consumers, options.partitions, options.rate, options.batch,
+                     options.record_size, options.keys, options.key_distribution, options.warmup.count(),
+                     options.duration.count(), produced / seconds,
+                     static_cast<double>(results.produced_bytes.load()) / seconds, results.produce_errors.load(),
+                     consumed / seconds, static_cast<double>(results.consumed_bytes.load()) / seconds,
+                     results.fetch_errors.load(), LatencyJson(produce), LatencyJson(produce_service),
+                     LatencyJson(fetch), LatencyJson(end_to_end));
+  std::cout << "\nResults written to " << options.json_path << std::endl;
+}
+
+int Run(const Options& options) {
+  const std::string host = "127.0.0.1";
+  const std::string topic = "e2e-bench";
+  auto broker_address = fmt::format("{}:{}", host, options.port);
+  auto controller_address = fmt::format("{}:{}", host, options.port + 1);
+  auto coordinator_address = fmt::format("{}:{}", host, options.port + 2);
+
+  std::filesystem::remove_all(options.log_dir);
+  std::filesystem::create_directories(options.log_dir);
+
+  auto controller = std::make_unique<controller::ControllerServer>(host, static_cast<uint16_t>(options.port + 1),
+                                                                   std::make_shared<controller::TopicManager>());
+  auto coordinator = std::make_unique<coordinator::CoordinatorServer>(
+      host, static_cast<uint16_t>(options.port + 2), std::make_shared<coordinator::ConsumerGroupManager>(3000, 30000));
+  auto log_dir = std::make_shared<storage::LogDir>(options.log_dir, 128 * 1024 * 1024);
+  auto broker = std::make_unique<broker::BrokerServer>(host, options.port, log_dir,
+                                                       std::make_shared<broker::IdempotencyTable>());
+  if (!controller->Start() || !coordinator->Start() || !broker->Start()) {
+    std::cerr << "Failed to start the servers on ports " << options.port << "-" << options.port + 2 << std::endl;
+    return 1;
+  }
+
+  // Create the topic through the controller, as an operator would
+  {
+    auto stub = streamit::v1::Controller::NewStub(MakeChannel(controller_address));
+    streamit::v1::CreateTopicRequest request;
+    request.set_topic(topic);
+    request.set_partitions(options.partitions);
+    request.set_replication_factor(1);
+    streamit::v1::CreateTopicResponse response;
+    grpc::ClientContext context;
+    auto status = stub->CreateTopic(&context, request, &response);
+    if (!status.ok() || !response.success()) {
+      std::cerr << "Failed to create topic: " << status.error_message() << response.error_message() << std::endl;
+      return 1;
+    }
+  }
+
+  KeyChooser keys(options);
+  Results results;
+  std::atomic<bool> stop_consumers{false};
+
+  auto start = Clock::now() + std::chrono::milliseconds(100);
+  auto measure_from = start + options.warmup;
+  auto end = measure_from + options.duration;
+
+  std::vector<std::thread> consumers;
+  for (int i = 0; i < options.consumers; ++i) {
+    consumers.emplace_back(RunConsumer, i, std::cref(options), std::cref(topic), std::cref(broker_address),
+                           std::cref(coordinator_address), measure_from, std::cref(stop_consumers),
+                           std::ref(results));
+  }
+  std::vector<std::thread> producers;
+  for (int i = 0; i < options.producers; ++i) {
+    producers.emplace_back(RunProducer, i, std::cref(options), std::cref(topic), std::cref(broker_address),
+                           std::cref(keys), start, measure_from, end, std::ref(results));
+  }
+
+  std::cout << fmt::format("Running for {}s ({}s warmup) against {}...", (options.warmup + options.duration).count(),
+                           options.warmup.count(), broker_address)
+            << std::endl;
+  for (auto& producer : producers) {
+    producer.join();
+  }
+
+  // Let consumers catch up with everything produced, then stop them
+  auto drain_deadline = Clock::now() + std::chrono::seconds(10);
+  while (results.total_consumed.load() < results.total_produced.load() && Clock::now() < drain_deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  stop_consumers.store(true);
+  for (auto& consumer : consumers) {
+    consumer.join();
+  }
+
+  (void)broker->Stop();
+  (void)coordinator->Stop();
+  (void)controller->Stop();
+
+  Report(options, results);
+  std::filesystem::remove_all(options.log_dir);
+  return 0;
+}
+
+} // namespace
+} // namespace streamit::bench
+
+int main(int argc, char* argv[]) {
+  auto options = streamit::bench::ParseOptions(argc, argv);
+  if (!options) {
+    return 1;
+  }
+
+  // Keep broker logging off the measured path
+  streamit::common::StructuredLogger::Initialize("warn");
+  int code = 1;
+  try {
+    code = streamit::bench::Run(*options);
+  } catch (const std::exception& e) {
+    std::cerr << "Benchmark failed: " << e.what() << std::endl;
+  }
+  streamit::common::StructuredLogger::Shutdown();
+  return code;
+}
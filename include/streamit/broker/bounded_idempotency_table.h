@@ -1,61 +1,52 @@
 #pragma once
 
+#include "streamit/broker/producer_key.h"
+#include "streamit/broker/sequence_window.h"
+#include "streamit/common/instrumented_mutex.h"
 #include "streamit/common/result.h"
+#include <array>
 #include <chrono>
 #include <cstdint>
-#include <deque>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace streamit::broker {
 
-// Key for idempotency table
-struct ProducerKey {
-  std::string producer_id;
-  std::string topic;
-  int32_t partition;
-
-  bool operator==(const ProducerKey& other) const noexcept {
-    return producer_id == other.producer_id && topic == other.topic && partition == other.partition;
-  }
-};
-
-// Hash function for ProducerKey
-struct ProducerKeyHash {
-  size_t operator()(const ProducerKey& key) const noexcept {
-    return std::hash<std::string>{}(key.producer_id) ^ (std::hash<std::string>{}(key.topic) << 1) ^
-           (std::hash<int32_t>{}(key.partition) << 2);
-  }
-};
-
 // Value for idempotency table with TTL
 struct ProducerState {
-  int64_t last_sequence;
-  int64_t last_offset;
+  SequenceWindow batches;
   std::chrono::steady_clock::time_point timestamp;
 
-  ProducerState() = default;
-  ProducerState(int64_t seq, int64_t offset)
-      : last_sequence(seq), last_offset(offset), timestamp(std::chrono::steady_clock::now()) {
-  }
-
   bool IsExpired(std::chrono::milliseconds ttl) const noexcept {
     return std::chrono::steady_clock::now() - timestamp > ttl;
   }
 };
 
-// Bounded TTL+LRU idempotency table
-class BoundedIdempotencyTable {
+// One lock stripe of a bounded TTL+LRU idempotency table.
+// Entries sit on an intrusive LRU list for capacity eviction and in a hashed timer wheel for TTL expiry,
+// so every operation is O(1) amortized regardless of the number of producers.
+class BoundedIdempotencyShard {
 public:
+  using Clock = std::chrono::steady_clock;
+
   // Constructor
-  BoundedIdempotencyTable(size_t max_entries, std::chrono::milliseconds ttl);
+  BoundedIdempotencyShard(size_t max_entries, std::chrono::milliseconds ttl);
+
+  // Non-copyable (entries link to each other)
+  BoundedIdempotencyShard(const BoundedIdempotencyShard&) = delete;
+  BoundedIdempotencyShard& operator=(const BoundedIdempotencyShard&) = delete;
+
+  // Classify a sequence against the producer's recent batches
+  [[nodiscard]] SequenceCheck CheckSequence(const ProducerKey& key, int64_t sequence) noexcept;
 
-  // Check if a sequence number is valid (not a duplicate)
+  // Check if a sequence number is valid (next in order, not a duplicate)
   [[nodiscard]] bool IsValidSequence(const ProducerKey& key, int64_t sequence) noexcept;
 
-  // Update the sequence number and offset for a producer
-  [[nodiscard]] void UpdateSequence(const ProducerKey& key, int64_t sequence, int64_t offset) noexcept;
+  // Record an appended batch's sequence number and base offset for a producer
+  void UpdateSequence(const ProducerKey& key, int64_t sequence, int64_t offset) noexcept;
 
   // Get the last sequence number for a producer
   [[nodiscard]] int64_t GetLastSequence(const ProducerKey& key) const noexcept;
@@ -64,35 +55,128 @@ public:
   [[nodiscard]] int64_t GetLastOffset(const ProducerKey& key) const noexcept;
 
   // Remove entries for a producer (cleanup)
-  [[nodiscard]] void RemoveProducer(const std::string& producer_id) noexcept;
+  void RemoveProducer(int64_t producer_id) noexcept;
 
   // Get the number of entries
   [[nodiscard]] size_t Size() const noexcept;
 
   // Clear all entries
-  [[nodiscard]] void Clear() noexcept;
+  void Clear() noexcept;
 
   // Clean up expired entries
-  [[nodiscard]] void CleanupExpired() noexcept;
+  void CleanupExpired() noexcept;
 
 private:
+  // Wheel slots; the tick is sized so one revolution covers the TTL
+  static constexpr size_t kWheelSlots = 256;
+
+  // Table entry, linked into the LRU list and one timer wheel slot
+  struct Entry {
+    const ProducerKey* key = nullptr;
+    ProducerState state;
+    Clock::time_point deadline;
+    size_t wheel_slot = 0;
+    Entry* lru_prev = nullptr;
+    Entry* lru_next = nullptr;
+    Entry* wheel_prev = nullptr;
+    Entry* wheel_next = nullptr;
+  };
+
+  // Intrusive doubly-linked list threaded through Entry
+  struct EntryList {
+    Entry* head = nullptr;
+    Entry* tail = nullptr;
+  };
+
   size_t max_entries_;
   std::chrono::milliseconds ttl_;
+  Clock::duration tick_;
+  Clock::time_point epoch_;
+  int64_t current_tick_;
+
+  // Map for O(1) lookup; node-based, so Entry addresses stay stable across rehashes
+  std::unordered_map<ProducerKey, Entry, ProducerKeyHash> table_;
 
-  // Map for O(1) lookup
-  std::unordered_map<ProducerKey, ProducerState, ProducerKeyHash> table_;
+  // Least recently used at the head
+  EntryList lru_;
 
-  // LRU queue for eviction
-  std::deque<ProducerKey> lru_queue_;
+  // Entries bucketed by deadline tick
+  std::array<EntryList, kWheelSlots> wheel_;
 
   // Mutex for thread safety
-  mutable std::mutex mutex_;
+  mutable common::InstrumentedMutex mutex_{"bounded_idempotency_table"};
+
+  // Expire entries whose wheel slots have come due
+  void AdvanceWheel(Clock::time_point now) noexcept;
+
+  // Find a live entry (nullptr if absent or expired)
+  [[nodiscard]] const Entry* FindLive(const ProducerKey& key, Clock::time_point now) const noexcept;
+
+  // Place an entry in the slot for its deadline
+  void Schedule(Entry* entry) noexcept;
+
+  // Unlink an entry from both lists and erase it
+  void Erase(Entry* entry) noexcept;
 
   // Helper to evict oldest entry
-  [[nodiscard]] void EvictOldest() noexcept;
+  void EvictOldest() noexcept;
 
   // Helper to update LRU position
-  [[nodiscard]] void UpdateLRU(const ProducerKey& key) noexcept;
+  void UpdateLRU(Entry* entry) noexcept;
+
+  // Wheel tick a time point falls in
+  [[nodiscard]] int64_t TickOf(Clock::time_point time) const noexcept;
+
+  // Intrusive list operations
+  template <Entry* Entry::*Prev, Entry* Entry::*Next>
+  static void PushBack(EntryList& list, Entry* entry) noexcept;
+
+  template <Entry* Entry::*Prev, Entry* Entry::*Next>
+  static void Unlink(EntryList& list, Entry* entry) noexcept;
+};
+
+// Bounded TTL+LRU idempotency table.
+// Keys are spread over independently locked shards; capacity is split evenly, so LRU order is per shard.
+class BoundedIdempotencyTable {
+public:
+  // Constructor
+  BoundedIdempotencyTable(size_t max_entries, std::chrono::milliseconds ttl, size_t num_shards = 1);
+
+  // Classify a sequence against the producer's recent batches
+  [[nodiscard]] SequenceCheck CheckSequence(const ProducerKey& key, int64_t sequence) noexcept;
+
+  // Check if a sequence number is valid (next in order, not a duplicate)
+  [[nodiscard]] bool IsValidSequence(const ProducerKey& key, int64_t sequence) noexcept;
+
+  // Record an appended batch's sequence number and base offset for a producer
+  void UpdateSequence(const ProducerKey& key, int64_t sequence, int64_t offset) noexcept;
+
+  // Get the last sequence number for a producer
+  [[nodiscard]] int64_t GetLastSequence(const ProducerKey& key) const noexcept;
+
+  // Get the last offset for a producer
+  [[nodiscard]] int64_t GetLastOffset(const ProducerKey& key) const noexcept;
+
+  // Remove entries for a producer (cleanup)
+  void RemoveProducer(int64_t producer_id) noexcept;
+
+  // Get the number of entries
+  [[nodiscard]] size_t Size() const noexcept;
+
+  // Clear all entries
+  void Clear() noexcept;
+
+  // Clean up expired entries
+  void CleanupExpired() noexcept;
+
+  // Number of shards
+  [[nodiscard]] size_t NumShards() const noexcept;
+
+private:
+  std::vector<std::unique_ptr<BoundedIdempotencyShard>> shards_;
+
+  // Shard owning a key
+  [[nodiscard]] BoundedIdempotencyShard& ShardFor(const ProducerKey& key) const noexcept;
 };
 
 } // namespace streamit::broker
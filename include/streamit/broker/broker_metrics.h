@@ -1,61 +1,169 @@
 #pragma once
 
 #include "streamit/common/metrics.h"
+#include "streamit/common/stage_timer.h"
+#include "streamit/common/topic_registry.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <map>
 #include <memory>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 namespace streamit::broker {
 
-// Broker-specific metrics
+// Stages of a produce request, in the order they run
+enum class ProduceStage {
+  kValidate,
+  kAdmission, // Quota and memory budget
+  kIdempotencyCheck,
+  kConvert, // Protobuf records to storage records
+  kSegmentLookup,
+  kPipelineWait, // Waiting for an earlier batch of the producer's pipeline (idempotent produces only)
+  kAppendLock,   // Waiting for the producer's append lock (idempotent produces only)
+  kWrite,        // Serialize and write the batch (including a roll)
+  kFsyncQueue,   // Waiting for a flush thread (durable acks only)
+  kFsync,
+  kHighWaterMark,
+  kResponse,
+  kCount,
+};
+
+// Stages of a fetch request, in the order they run
+enum class FetchStage {
+  kValidate,
+  kAdmission, // Quota and memory budget
+  kSegmentLookup,
+  kLongPoll,
+  kRead,
+  kSerialize, // Storage batches to protobuf
+  kResponse,
+  kCount,
+};
+
+// Broker-specific metrics.
+// Per-partition series are resolved once per partition and cached by topic id, and single-label series by their
+// label value, so the request path neither builds label maps nor goes through the metrics registry.
 class BrokerMetrics {
 public:
-  // Constructor
-  BrokerMetrics();
+  // Constructor; topic names for labels come from the broker's registry
+  explicit BrokerMetrics(std::shared_ptr<const common::TopicRegistry> topics);
+
+  // Per-stage latency histograms for StageTimer
+  [[nodiscard]] const common::StageHistograms<ProduceStage>& ProduceStages() const noexcept;
+  [[nodiscard]] const common::StageHistograms<FetchStage>& FetchStages() const noexcept;
 
   // Produce metrics
-  void RecordProduceLatency(const std::string& ack, const std::string& topic, int32_t partition,
-                            double latency_ms) noexcept;
-  void RecordProduceBytes(const std::string& topic, int32_t partition, int64_t bytes) noexcept;
-  void RecordProduceRecords(const std::string& topic, int32_t partition, int64_t records) noexcept;
+  void RecordProduceLatency(std::string_view ack, common::TopicPartition tp,
+                            std::chrono::nanoseconds latency) noexcept;
+  void RecordProduceBytes(common::TopicPartition tp, int64_t bytes) noexcept;
+  void RecordProduceRecords(common::TopicPartition tp, int64_t records) noexcept;
 
   // Fetch metrics
-  void RecordFetchLatency(const std::string& topic, int32_t partition, double latency_ms) noexcept;
-  void RecordFetchBytes(const std::string& topic, int32_t partition, int64_t bytes) noexcept;
+  void RecordFetchLatency(common::TopicPartition tp, std::chrono::nanoseconds latency) noexcept;
+  void RecordFetchBytes(common::TopicPartition tp, int64_t bytes) noexcept;
 
   // Storage metrics
-  void RecordSegmentRoll(const std::string& topic, int32_t partition) noexcept;
-  void RecordCrcMismatch(const std::string& topic, int32_t partition) noexcept;
+  void RecordSegmentRoll(common::TopicPartition tp) noexcept;
+  void RecordCrcMismatch(common::TopicPartition tp) noexcept;
 
   // High water mark metrics
-  void SetHighWaterMark(const std::string& topic, int32_t partition, int64_t offset) noexcept;
+  void SetHighWaterMark(common::TopicPartition tp, int64_t offset) noexcept;
+
+  // Quota metrics
+  void RecordThrottle(const std::string& type, std::string_view entity, int64_t throttle_ms) noexcept;
+
+  // Memory budget metrics
+  void SetInflightBytes(size_t bytes, size_t waiting) noexcept;
+  void RecordMemoryRejected(std::string_view type) noexcept;
+
+  // Executor metrics
+  void SetExecutorQueueDepth(std::string_view executor, size_t depth) noexcept;
+  void RecordQueueWait(std::string_view type, std::chrono::nanoseconds wait) noexcept;
+
+  // Requests dropped because the client's deadline passed
+  void RecordShed(std::string_view type, std::string_view stage) noexcept;
 
   // Replication lag metrics (for future use)
-  void SetReplicationLag(const std::string& topic, int32_t partition, int64_t lag) noexcept;
+  void SetReplicationLag(common::TopicPartition tp, int64_t lag) noexcept;
 
 private:
-  // Produce metrics
-  std::shared_ptr<streamit::common::SimpleHistogram> produce_latency_hist_;
-  std::shared_ptr<streamit::common::SimpleCounter> produce_bytes_counter_;
-  std::shared_ptr<streamit::common::SimpleCounter> produce_records_counter_;
+  // Series of one partition
+  struct PartitionMetrics {
+    common::MetricLabels labels;
 
-  // Fetch metrics
-  std::shared_ptr<streamit::common::SimpleHistogram> fetch_latency_hist_;
-  std::shared_ptr<streamit::common::SimpleCounter> fetch_bytes_counter_;
+    // Produce latency per ack type, resolved on the first produce with that ack (the family keeps them alive)
+    std::atomic<common::Histogram*> produce_latency_leader{nullptr};
+    std::atomic<common::Histogram*> produce_latency_quorum{nullptr};
+    std::shared_ptr<common::Counter> produce_bytes;
+    std::shared_ptr<common::Counter> produce_records;
+    std::shared_ptr<common::Histogram> fetch_latency;
+    std::shared_ptr<common::Counter> fetch_bytes;
+    std::shared_ptr<common::Counter> segment_rolls;
+    std::shared_ptr<common::Counter> crc_mismatches;
+    std::shared_ptr<common::Gauge> high_watermark;
+    std::shared_ptr<common::Gauge> replication_lag;
+  };
 
-  // Storage metrics
-  std::shared_ptr<streamit::common::SimpleCounter> segment_rolls_counter_;
-  std::shared_ptr<streamit::common::SimpleCounter> crc_mismatches_counter_;
+  // Series of a family that has a single label, cached by label value
+  template <typename Metric>
+  class SingleLabelSeries {
+  public:
+    SingleLabelSeries(std::shared_ptr<common::MetricFamily<Metric>> family, std::string label);
 
-  // High water mark metrics
-  std::shared_ptr<streamit::common::SimpleGauge> high_watermark_gauge_;
+    // Series for `value`, created on first use
+    [[nodiscard]] Metric& Get(std::string_view value) noexcept;
+
+  private:
+    std::shared_ptr<common::MetricFamily<Metric>> family_;
+    std::string label_;
+    std::map<std::string, std::shared_ptr<Metric>, std::less<>> series_;
+    std::shared_mutex mutex_;
+  };
+
+  std::shared_ptr<const common::TopicRegistry> topics_;
+
+  // Cached per-partition metrics (entries are never removed, so references stay valid)
+  std::unordered_map<common::TopicPartition, std::unique_ptr<PartitionMetrics>, common::TopicPartitionHash>
+      partitions_;
+  mutable std::shared_mutex partitions_mutex_;
+
+  // Per-partition families
+  std::shared_ptr<common::MetricFamily<common::Histogram>> produce_latency_;
+  std::shared_ptr<common::MetricFamily<common::Counter>> bytes_in_;
+  std::shared_ptr<common::MetricFamily<common::Counter>> records_in_;
+  std::shared_ptr<common::MetricFamily<common::Histogram>> fetch_latency_;
+  std::shared_ptr<common::MetricFamily<common::Counter>> bytes_out_;
+  std::shared_ptr<common::MetricFamily<common::Counter>> segment_rolls_;
+  std::shared_ptr<common::MetricFamily<common::Counter>> crc_mismatches_;
+  std::shared_ptr<common::MetricFamily<common::Gauge>> high_watermark_;
+  std::shared_ptr<common::MetricFamily<common::Gauge>> replication_lag_;
+
+  // Quota families (labelled by type and entity)
+  std::shared_ptr<common::MetricFamily<common::Counter>> throttled_requests_;
+  std::shared_ptr<common::MetricFamily<common::Histogram>> throttle_time_;
+
+  // Memory budget metrics
+  std::shared_ptr<common::Gauge> inflight_bytes_gauge_;
+  std::shared_ptr<common::Gauge> inflight_waiters_gauge_;
+  SingleLabelSeries<common::Counter> memory_rejected_;
+
+  // Executor metrics
+  SingleLabelSeries<common::Gauge> executor_queue_depth_;
+  SingleLabelSeries<common::Histogram> queue_wait_;
+
+  // Shed requests (labelled by type and stage)
+  std::shared_ptr<common::MetricFamily<common::Counter>> requests_shed_;
 
-  // Replication lag metrics
-  std::shared_ptr<streamit::common::SimpleGauge> replication_lag_gauge_;
+  // Request stage latencies
+  common::StageHistograms<ProduceStage> produce_stages_;
+  common::StageHistograms<FetchStage> fetch_stages_;
 
-  // Helper to create labels
-  [[nodiscard]] std::map<std::string, std::string> CreateLabels(const std::string& topic,
-                                                                int32_t partition) const noexcept;
+  // Metrics of a partition, created on first use
+  [[nodiscard]] PartitionMetrics& ForPartition(common::TopicPartition tp) noexcept;
 };
 
 } // namespace streamit::broker
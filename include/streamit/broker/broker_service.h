@@ -1,36 +1,217 @@
 #pragma once
 
 #include "streamit/broker/broker_metrics.h"
+#include "streamit/broker/fetch_waiters.h"
 #include "streamit/broker/idempotency_table.h"
+#include "streamit/broker/memory_budget.h"
+#include "streamit/broker/producer_id_manager.h"
+#include "streamit/broker/producer_snapshot.h"
+#include "streamit/broker/quota_manager.h"
+#include "streamit/broker/request_lanes.h"
+#include "streamit/broker/sequence_waiters.h"
+#include "streamit/common/executor.h"
+#include "streamit/common/instrumented_mutex.h"
+#include "streamit/common/slow_request_log.h"
+#include "streamit/common/span.h"
+#include "streamit/common/task.h"
+#include "streamit/common/timer_service.h"
+#include "streamit/common/topic_registry.h"
 #include "streamit/proto/streamit.grpc.pb.h"
 #include "streamit/storage/log_dir.h"
+#include <array>
+#include <chrono>
 #include <grpcpp/grpcpp.h>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 
 namespace streamit::broker {
 
-// Broker service implementation
-class BrokerServiceImpl final : public streamit::v1::Broker::Service {
+// Tunables for the broker service
+struct BrokerServiceOptions {
+  // Quotas applied separately to produce and fetch traffic
+  QuotaConfig quotas;
+
+  // Budget for produce requests and fetch responses held in memory (0 = unlimited)
+  size_t max_inflight_bytes = 0;
+
+  // How long a request may queue for memory before it is throttled
+  std::chrono::milliseconds max_inflight_wait{1000};
+
+  // Executors per request class
+  RequestLaneConfig lanes;
+
+  // How often idempotency state is snapshotted to each partition directory (0 = only on shutdown)
+  std::chrono::milliseconds producer_snapshot_interval{60000};
+
+  // How often partition offsets are written to the log directory checkpoint (0 = only on shutdown)
+  std::chrono::milliseconds checkpoint_interval{5000};
+
+  // Where requests over the slow-request threshold are recorded (none if null)
+  std::shared_ptr<common::SlowRequestLog> slow_requests;
+
+  // Where finished request spans are sent (spans are still propagated, but not exported, if null)
+  std::shared_ptr<common::SpanExporter> span_exporter;
+};
+
+// Broker service implementation.
+// RPCs arrive on the gRPC callback API and run as coroutines on the executor for their request
+// class, so durable acks and long polls suspend instead of holding a thread. Segment reads and
+// appends run inline on their request executor; fsyncs hop to the lanes' flush executor.
+class BrokerServiceImpl final : public streamit::v1::Broker::CallbackService {
 public:
   // Constructor
-  BrokerServiceImpl(std::shared_ptr<storage::LogDir> log_dir, std::shared_ptr<IdempotencyTable> idempotency_table);
+  BrokerServiceImpl(std::shared_ptr<storage::LogDir> log_dir, std::shared_ptr<IdempotencyTable> idempotency_table,
+                    BrokerServiceOptions options = {});
+
+  // Destructor
+  ~BrokerServiceImpl() override;
+
+  // InitProducerId RPC implementation
+  grpc::ServerUnaryReactor* InitProducerId(grpc::CallbackServerContext* context,
+                                           const streamit::v1::InitProducerIdRequest* request,
+                                           streamit::v1::InitProducerIdResponse* response) override;
 
   // Produce RPC implementation
-  grpc::Status Produce(grpc::ServerContext* context, const streamit::v1::ProduceRequest* request,
-                       streamit::v1::ProduceResponse* response) override;
+  grpc::ServerUnaryReactor* Produce(grpc::CallbackServerContext* context, const streamit::v1::ProduceRequest* request,
+                                    streamit::v1::ProduceResponse* response) override;
 
   // Fetch RPC implementation
-  grpc::Status Fetch(grpc::ServerContext* context, const streamit::v1::FetchRequest* request,
-                     streamit::v1::FetchResponse* response) override;
+  grpc::ServerUnaryReactor* Fetch(grpc::CallbackServerContext* context, const streamit::v1::FetchRequest* request,
+                                  streamit::v1::FetchResponse* response) override;
+
+  // Executor for admin and health traffic
+  [[nodiscard]] common::Executor& AdminExecutor() noexcept;
+
+  // Executor serving a request class
+  [[nodiscard]] common::Executor& LaneExecutor(RequestClass request_class) noexcept;
+
+  // Answer parked long polls now and stop parking new ones, so in-flight RPCs can drain
+  void BeginShutdown() noexcept;
 
 private:
+  // Upper bound on how long a fetch may wait for new data
+  static constexpr std::chrono::milliseconds kMaxFetchWait{30000};
+
+  // Back-off suggested to clients throttled by the memory budget
+  static constexpr std::chrono::milliseconds kMemoryRetryAfter{100};
+
+  // A single fetch reserves at most this fraction of the memory budget...
+  static constexpr size_t kFetchBudgetShare = 4;
+
+  // ...but never less than gRPC's default message limit, so any batch a produce could deliver can be fetched
+  static constexpr size_t kMinFetchReservation = 4 * 1024 * 1024;
+
+  // Upper bound on how long a pipelined batch waits for the batches ahead of it
+  static constexpr std::chrono::milliseconds kMaxPipelineWait{5000};
+
+  // Lock stripes serialising idempotent appends per producer-partition
+  static constexpr size_t kAppendStripes = 64;
+
   std::shared_ptr<storage::LogDir> log_dir_;
+  std::shared_ptr<common::TopicRegistry> topics_;
   std::shared_ptr<IdempotencyTable> idempotency_table_;
   std::unique_ptr<BrokerMetrics> metrics_;
+  std::shared_ptr<common::SlowRequestLog> slow_requests_;
+  std::shared_ptr<common::SpanExporter> span_exporter_;
+  QuotaManager produce_quotas_;
+  QuotaManager fetch_quotas_;
   mutable std::mutex mutex_;
 
+  // Held across check, append and record of an idempotent batch so a retry racing its original, or
+  // pipelined batches racing each other, are ordered by sequence
+  struct AppendStripe {
+    common::InstrumentedMutex mutex{"broker_append"};
+  };
+  std::array<AppendStripe, kAppendStripes> append_mutexes_;
+
+  // Idempotency state persistence and producer id allocation
+  ProducerSnapshotter producer_snapshots_;
+  ProducerIdManager producer_ids_;
+  std::chrono::milliseconds producer_snapshot_interval_;
+  std::chrono::milliseconds checkpoint_interval_;
+
+  // Coroutine runtime (destroyed first so no request resumes into freed members)
+  common::TimerService timers_;
+  FetchWaiters fetch_waiters_;
+  SequenceWaiters sequence_waiters_;
+  MemoryBudget memory_budget_;
+  std::chrono::milliseconds max_inflight_wait_;
+  RequestLanes lanes_;
+
+  // InitProducerId pipeline
+  [[nodiscard]] common::Task<grpc::Status> HandleInitProducerId(streamit::v1::InitProducerIdResponse* response);
+
+  // Produce pipeline
+  [[nodiscard]] common::Task<grpc::Status> HandleProduce(grpc::CallbackServerContext* context,
+                                                         const streamit::v1::ProduceRequest* request,
+                                                         streamit::v1::ProduceResponse* response,
+                                                         common::TraceId trace_id);
+
+  // Fetch pipeline
+  [[nodiscard]] common::Task<grpc::Status> HandleFetch(grpc::CallbackServerContext* context,
+                                                       const streamit::v1::FetchRequest* request,
+                                                       streamit::v1::FetchResponse* response,
+                                                       common::TraceId trace_id);
+
+  // Run a handler on its request class's executor, finish the reactor with its status and end the request's span
+  [[nodiscard]] common::Task<void> RunUnary(RequestClass request_class, grpc::CallbackServerContext* context,
+                                            grpc::ServerUnaryReactor* reactor,
+                                            std::chrono::steady_clock::time_point arrival, common::Span span,
+                                            common::Task<grpc::Status> handler);
+
+  // Server span for an RPC, continuing the caller's trace and returned to it as `traceparent`
+  [[nodiscard]] common::Span StartSpan(std::string_view name, grpc::CallbackServerContext* context);
+
+  // Time left before the client's deadline (zero once it has passed)
+  [[nodiscard]] static std::chrono::milliseconds TimeRemaining(const grpc::CallbackServerContext* context) noexcept;
+
+  // Check whether the client has timed out or cancelled before an expensive stage; records the shed
+  [[nodiscard]] bool ShouldShed(grpc::CallbackServerContext* context, std::string_view type,
+                                std::string_view stage) noexcept;
+
+  // Snapshot idempotency state for every partition
+  void SnapshotProducerState() noexcept;
+
+  // Arm the timer for the next periodic snapshot
+  void ScheduleProducerSnapshot() noexcept;
+
+  // Write partition offsets to the log directory checkpoint
+  void CheckpointOffsets() noexcept;
+
+  // Arm the timer for the next periodic checkpoint
+  void ScheduleCheckpoint() noexcept;
+
+  // Publish queue depths of all request executors
+  void RecordQueueDepths() noexcept;
+
+  // Append an idempotent batch unless its sequence is no longer next; `check` receives the verdict and `timer`
+  // the wait for the producer's append lock
+  [[nodiscard]] common::Result<storage::Partition::AppendResult>
+  AppendIdempotent(storage::Partition& partition, const std::vector<storage::Record>& records, const ProducerKey& key,
+                   int64_t sequence, SequenceCheck& check, common::StageTimer<ProduceStage>& timer);
+
+  // Record a finished request in the slow-request log if it went over the threshold
+  template <typename Stage>
+  void MaybeLogSlowRequest(std::string_view type, const common::StageTimer<Stage>& timer,
+                           const common::TraceId& trace_id, const std::string& topic, int32_t partition, int64_t bytes,
+                           int64_t records) noexcept;
+
+  // Answer a produce whose sequence was not accepted (duplicates succeed with their original offset)
+  static void SetSequenceResponse(const SequenceCheck& check, int64_t sequence,
+                                  streamit::v1::ProduceResponse* response);
+
+  // Fill the quota subject for a request from its context
+  [[nodiscard]] static QuotaSubject MakeQuotaSubject(const grpc::CallbackServerContext* context, int64_t producer_id,
+                                                     const std::string& topic);
+
+  // Read the client's long-poll wait from request metadata
+  [[nodiscard]] std::chrono::milliseconds GetFetchMaxWait(const grpc::CallbackServerContext* context) const noexcept;
+
+  // Most bytes one fetch may reserve from the memory budget
+  [[nodiscard]] size_t MaxFetchReservation() const noexcept;
+
   // Helper to validate produce request
   [[nodiscard]] grpc::Status ValidateProduceRequest(const streamit::v1::ProduceRequest* request) const;
 
@@ -51,7 +232,7 @@ class BrokerServer {
 public:
   // Constructor
   BrokerServer(const std::string& host, uint16_t port, std::shared_ptr<storage::LogDir> log_dir,
-               std::shared_ptr<IdempotencyTable> idempotency_table);
+               std::shared_ptr<IdempotencyTable> idempotency_table, BrokerServiceOptions options = {});
 
   // Start the server
   [[nodiscard]] bool Start() noexcept;
@@ -65,11 +246,18 @@ public:
   // Check if server is running
   [[nodiscard]] bool IsRunning() const noexcept;
 
+  // Executor reserved for admin and health traffic (nullptr before Start)
+  [[nodiscard]] common::Executor* AdminExecutor() noexcept;
+
 private:
+  // How long Stop waits for in-flight RPCs before cancelling them
+  static constexpr std::chrono::seconds kShutdownGracePeriod{5};
+
   std::string host_;
   uint16_t port_;
   std::shared_ptr<storage::LogDir> log_dir_;
   std::shared_ptr<IdempotencyTable> idempotency_table_;
+  BrokerServiceOptions options_;
   std::unique_ptr<grpc::Server> server_;
   std::unique_ptr<BrokerServiceImpl> service_;
   std::atomic<bool> running_;
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "streamit/common/executor.h"
+#include "streamit/common/instrumented_mutex.h"
+#include "streamit/common/timer_service.h"
+#include "streamit/common/topic_registry.h"
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace streamit::broker {
+
+// Registry of long-poll fetches waiting for new data on a partition
+class FetchWaiters {
+public:
+  // State for a single suspended fetch
+  struct Waiter {
+    std::atomic<bool> fired{false};
+    bool notified = false;
+    std::coroutine_handle<> handle;
+    common::Executor* executor = nullptr;
+    common::TimerService::TimerId timer_id = 0;
+    common::TopicPartition partition{};
+    std::string topic; // Set instead of `partition` while waiting for a topic to be created
+  };
+
+  // Constructor
+  explicit FetchWaiters(common::TimerService& timers);
+
+  // Awaitable that completes once the partition end offset moves past `offset`
+  // or the timeout expires. Resolves to true if new data arrived.
+  [[nodiscard]] auto WaitForData(common::TopicPartition partition, int64_t offset,
+                                 std::chrono::milliseconds timeout) noexcept {
+    struct WaitAwaiter {
+      FetchWaiters* waiters;
+      std::shared_ptr<Waiter> waiter;
+      int64_t offset;
+      std::chrono::milliseconds timeout;
+
+      bool await_ready() const noexcept {
+        return timeout.count() <= 0;
+      }
+
+      bool await_suspend(std::coroutine_handle<> handle) noexcept {
+        waiter->handle = handle;
+        waiter->executor = common::Executor::Current();
+        return waiters->Register(waiter, offset, timeout);
+      }
+
+      bool await_resume() const noexcept {
+        return waiter->notified;
+      }
+    };
+    auto waiter = std::make_shared<Waiter>();
+    waiter->partition = partition;
+    return WaitAwaiter{this, std::move(waiter), offset, timeout};
+  }
+
+  // Awaitable that completes once `topic` is interned in `topics` or the timeout expires. Waiting by name lets a
+  // long poll on a topic nobody has produced to yet avoid assigning it an id. Resolves to true if the topic appeared.
+  [[nodiscard]] auto WaitForTopic(const common::TopicRegistry& topics, std::string topic,
+                                  std::chrono::milliseconds timeout) noexcept {
+    struct TopicAwaiter {
+      FetchWaiters* waiters;
+      const common::TopicRegistry& topics;
+      std::shared_ptr<Waiter> waiter;
+      std::chrono::milliseconds timeout;
+
+      bool await_ready() const noexcept {
+        return timeout.count() <= 0;
+      }
+
+      bool await_suspend(std::coroutine_handle<> handle) noexcept {
+        waiter->handle = handle;
+        waiter->executor = common::Executor::Current();
+        return waiters->RegisterTopic(waiter, topics, timeout);
+      }
+
+      bool await_resume() const noexcept {
+        return waiter->notified;
+      }
+    };
+    auto waiter = std::make_shared<Waiter>();
+    waiter->topic = std::move(topic);
+    return TopicAwaiter{this, topics, std::move(waiter), timeout};
+  }
+
+  // Wake all fetches waiting on a partition after its end offset advanced
+  void Notify(common::TopicPartition partition, int64_t end_offset) noexcept;
+
+  // Wake all fetches waiting for `topic` after it was interned
+  void NotifyTopic(std::string_view topic) noexcept;
+
+  // Wake every suspended fetch as timed out and stop suspending new ones
+  void Shutdown() noexcept;
+
+  // Number of suspended fetches
+  [[nodiscard]] size_t Size() const noexcept;
+
+private:
+  struct PartitionWaiters {
+    int64_t end_offset = -1;
+    std::vector<std::shared_ptr<Waiter>> waiters;
+  };
+
+  common::TimerService& timers_;
+  std::unordered_map<common::TopicPartition, PartitionWaiters, common::TopicPartitionHash> partitions_;
+  std::unordered_map<std::string, std::vector<std::shared_ptr<Waiter>>> topic_waiters_;
+  bool stopped_ = false;
+  mutable common::InstrumentedMutex mutex_{"fetch_waiters"};
+
+  // Register a waiter; returns false if data is already available and the caller should not suspend
+  [[nodiscard]] bool Register(const std::shared_ptr<Waiter>& waiter, int64_t offset,
+                              std::chrono::milliseconds timeout) noexcept;
+
+  // Register a waiter for a topic; returns false if it already exists and the caller should not suspend
+  [[nodiscard]] bool RegisterTopic(const std::shared_ptr<Waiter>& waiter, const common::TopicRegistry& topics,
+                                   std::chrono::milliseconds timeout) noexcept;
+
+  // Called by the timer when a waiter times out
+  void Expire(const std::shared_ptr<Waiter>& waiter) noexcept;
+
+  // Resume a waiter exactly once
+  static void Resume(const std::shared_ptr<Waiter>& waiter, bool notified) noexcept;
+};
+
+} // namespace streamit::broker
@@ -1,50 +1,35 @@
 #pragma once
 
+#include "streamit/broker/producer_key.h"
+#include "streamit/broker/sequence_window.h"
+#include "streamit/common/instrumented_mutex.h"
 #include <cstdint>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace streamit::broker {
 
-// Key for idempotency table
-struct ProducerKey {
-  std::string producer_id;
-  std::string topic;
-  int32_t partition;
+// Idempotency table for deduplicating producer requests.
+// Keys are spread over independently locked shards so produces to different partitions do not contend.
+class IdempotencyTable {
+public:
+  // Default number of shards
+  static constexpr size_t kDefaultShards = 16;
 
-  bool operator==(const ProducerKey& other) const noexcept {
-    return producer_id == other.producer_id && topic == other.topic && partition == other.partition;
-  }
-};
+  // Constructor
+  explicit IdempotencyTable(size_t num_shards = kDefaultShards);
 
-// Hash function for ProducerKey
-struct ProducerKeyHash {
-  size_t operator()(const ProducerKey& key) const noexcept {
-    return std::hash<std::string>{}(key.producer_id) ^ (std::hash<std::string>{}(key.topic) << 1) ^
-           (std::hash<int32_t>{}(key.partition) << 2);
-  }
-};
+  // Classify a sequence against the producer's recent batches
+  [[nodiscard]] SequenceCheck CheckSequence(const ProducerKey& key, int64_t sequence) const noexcept;
 
-// Value for idempotency table
-struct ProducerSequence {
-  int64_t last_sequence;
-  int64_t last_offset;
+  // Check if a sequence number is valid (next in order, not a duplicate)
+  [[nodiscard]] bool IsValidSequence(const ProducerKey& key, int64_t sequence) const noexcept;
 
-  ProducerSequence() : last_sequence(-1), last_offset(-1) {
-  }
-  ProducerSequence(int64_t seq, int64_t offset) : last_sequence(seq), last_offset(offset) {
-  }
-};
-
-// Idempotency table for deduplicating producer requests
-class IdempotencyTable {
-public:
-  // Check if a sequence number is valid (not a duplicate)
-  [[nodiscard]] bool IsValidSequence(const ProducerKey& key, int64_t sequence) noexcept;
-
-  // Update the sequence number and offset for a producer
-  [[nodiscard]] void UpdateSequence(const ProducerKey& key, int64_t sequence, int64_t offset) noexcept;
+  // Record an appended batch's sequence number and base offset for a producer
+  void UpdateSequence(const ProducerKey& key, int64_t sequence, int64_t offset) noexcept;
 
   // Get the last sequence number for a producer
   [[nodiscard]] int64_t GetLastSequence(const ProducerKey& key) const noexcept;
@@ -52,18 +37,33 @@ public:
   // Get the last offset for a producer
   [[nodiscard]] int64_t GetLastOffset(const ProducerKey& key) const noexcept;
 
+  // Copy of every producer-partition's retained batches (for snapshots)
+  [[nodiscard]] std::vector<std::pair<ProducerKey, SequenceWindow>> Entries() const;
+
   // Remove entries for a producer (cleanup)
-  [[nodiscard]] void RemoveProducer(const std::string& producer_id) noexcept;
+  void RemoveProducer(int64_t producer_id) noexcept;
 
   // Get the number of entries
   [[nodiscard]] size_t Size() const noexcept;
 
   // Clear all entries
-  [[nodiscard]] void Clear() noexcept;
+  void Clear() noexcept;
+
+  // Number of shards
+  [[nodiscard]] size_t NumShards() const noexcept;
 
 private:
-  std::unordered_map<ProducerKey, ProducerSequence, ProducerKeyHash> table_;
-  mutable std::mutex mutex_;
+  // One lock stripe, padded to its own cache line
+  struct alignas(64) Shard {
+    std::unordered_map<ProducerKey, SequenceWindow, ProducerKeyHash> table;
+    mutable common::InstrumentedMutex mutex{"idempotency_shard"};
+  };
+
+  std::vector<Shard> shards_;
+
+  // Shard owning a key
+  [[nodiscard]] Shard& ShardFor(const ProducerKey& key) noexcept;
+  [[nodiscard]] const Shard& ShardFor(const ProducerKey& key) const noexcept;
 };
 
 } // namespace streamit::broker
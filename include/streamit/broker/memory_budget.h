@@ -0,0 +1,129 @@
+#pragma once
+
+#include "streamit/common/executor.h"
+#include "streamit/common/instrumented_mutex.h"
+#include "streamit/common/timer_service.h"
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace streamit::broker {
+
+// Broker-wide accountant for bytes held by in-flight requests and responses.
+// Reservations that do not fit wait in FIFO order so large requests are not starved by small ones.
+class MemoryBudget {
+public:
+  // Bytes held against the budget; released on destruction
+  class Reservation {
+  public:
+    Reservation() = default;
+    Reservation(MemoryBudget* budget, size_t bytes) noexcept;
+    ~Reservation();
+
+    Reservation(Reservation&& other) noexcept;
+    Reservation& operator=(Reservation&& other) noexcept;
+    Reservation(const Reservation&) = delete;
+    Reservation& operator=(const Reservation&) = delete;
+
+    // Give back part of the reservation once the real size is known
+    void Shrink(size_t bytes) noexcept;
+
+    // Return the bytes to the budget early
+    void Release() noexcept;
+
+    // Bytes currently held
+    [[nodiscard]] size_t Bytes() const noexcept;
+
+  private:
+    MemoryBudget* budget_ = nullptr;
+    size_t bytes_ = 0;
+  };
+
+  // State for a single suspended reservation
+  struct Waiter {
+    std::atomic<bool> fired{false};
+    bool granted = false;
+    size_t bytes = 0;
+    std::coroutine_handle<> handle;
+    common::Executor* executor = nullptr;
+    common::TimerService::TimerId timer_id = 0;
+  };
+
+  // Constructor (a zero capacity disables the budget)
+  MemoryBudget(size_t capacity_bytes, common::TimerService& timers);
+
+  // Reserve bytes if they fit right now
+  [[nodiscard]] std::optional<Reservation> TryReserve(size_t bytes) noexcept;
+
+  // Awaitable that reserves bytes, queueing behind earlier waiters for up to `timeout`.
+  // Resolves to std::nullopt if the budget stayed exhausted.
+  [[nodiscard]] auto Reserve(size_t bytes, std::chrono::milliseconds timeout) noexcept {
+    struct ReserveAwaiter {
+      MemoryBudget* budget;
+      std::shared_ptr<Waiter> waiter;
+      std::chrono::milliseconds timeout;
+
+      bool await_ready() noexcept {
+        waiter->granted = budget->TryAcquire(waiter->bytes);
+        return waiter->granted || timeout.count() <= 0;
+      }
+
+      bool await_suspend(std::coroutine_handle<> handle) noexcept {
+        waiter->handle = handle;
+        waiter->executor = common::Executor::Current();
+        return budget->Enqueue(waiter, timeout);
+      }
+
+      std::optional<Reservation> await_resume() const noexcept {
+        if (!waiter->granted) {
+          return std::nullopt;
+        }
+        return Reservation(budget, waiter->bytes);
+      }
+    };
+    auto waiter = std::make_shared<Waiter>();
+    waiter->bytes = Clamp(bytes);
+    return ReserveAwaiter{this, std::move(waiter), timeout};
+  }
+
+  // Bytes currently reserved
+  [[nodiscard]] size_t Used() const noexcept;
+
+  // Configured capacity (0 = unlimited)
+  [[nodiscard]] size_t Capacity() const noexcept;
+
+  // Number of queued reservations
+  [[nodiscard]] size_t Waiting() const noexcept;
+
+private:
+  size_t capacity_;
+  size_t used_;
+  common::TimerService& timers_;
+  std::deque<std::shared_ptr<Waiter>> waiters_;
+  mutable common::InstrumentedMutex mutex_{"memory_budget"};
+
+  // A single request larger than the whole budget is charged as the whole budget so it can still run alone
+  [[nodiscard]] size_t Clamp(size_t bytes) const noexcept;
+
+  // Take bytes if nobody is queued ahead and they fit
+  [[nodiscard]] bool TryAcquire(size_t bytes) noexcept;
+
+  // Queue a waiter; returns false if it was granted meanwhile and the caller should not suspend
+  [[nodiscard]] bool Enqueue(const std::shared_ptr<Waiter>& waiter, std::chrono::milliseconds timeout) noexcept;
+
+  // Return bytes and grant queued waiters that now fit
+  void Release(size_t bytes) noexcept;
+
+  // Called by the timer when a waiter times out
+  void Expire(const std::shared_ptr<Waiter>& waiter) noexcept;
+
+  // Resume a waiter exactly once
+  static void Resume(const std::shared_ptr<Waiter>& waiter, bool granted) noexcept;
+};
+
+} // namespace streamit::broker
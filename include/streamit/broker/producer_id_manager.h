@@ -0,0 +1,47 @@
+#pragma once
+
+#include "streamit/common/instrumented_mutex.h"
+#include "streamit/common/result.h"
+#include <absl/status/status.h>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string_view>
+
+namespace streamit::broker {
+
+// Hands out broker-unique 64-bit producer ids for InitProducerId.
+// Ids are reserved on disk a block at a time, so a restart skips the rest of the current block instead of
+// reissuing an id that a live producer may still be writing with.
+class ProducerIdManager {
+public:
+  // Ids reserved per file write
+  static constexpr int64_t kBlockSize = 1000;
+
+  // Reservation file kept in the log directory root
+  static constexpr std::string_view kFileName = "producer_id_block";
+
+  // Constructor
+  explicit ProducerIdManager(std::filesystem::path path);
+
+  // Read the reservation file; ids start at 1 if it does not exist. Allocation fails until this succeeds.
+  [[nodiscard]] absl::Status Load() noexcept;
+
+  // Next unused producer id (ids are positive; 0 means a non-idempotent producer)
+  [[nodiscard]] common::Result<int64_t> Allocate() noexcept;
+
+  // Never hand out `producer_id` or anything below it (ids found in the log during recovery)
+  void Observe(int64_t producer_id) noexcept;
+
+private:
+  std::filesystem::path path_;
+  bool loaded_ = false;
+  int64_t next_id_ = 1;
+  int64_t block_end_ = 1; // Ids below this are covered by the reservation on disk
+  common::InstrumentedMutex mutex_{"producer_id_manager"};
+
+  // Persist a new reservation end (via a temporary file and rename)
+  [[nodiscard]] absl::Status Reserve(int64_t block_end) noexcept;
+};
+
+} // namespace streamit::broker
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "streamit/common/topic_registry.h"
+#include <cstdint>
+#include <functional>
+
+namespace streamit::broker {
+
+// Key for idempotency table; all-integer so building and hashing one on each produce is free
+struct ProducerKey {
+  int64_t producer_id;
+  common::TopicId topic;
+  int32_t partition;
+
+  bool operator==(const ProducerKey& other) const noexcept = default;
+};
+
+// Hash function for ProducerKey
+struct ProducerKeyHash {
+  size_t operator()(const ProducerKey& key) const noexcept {
+    uint64_t partition = (static_cast<uint64_t>(key.topic) << 32) | static_cast<uint32_t>(key.partition);
+    return std::hash<uint64_t>{}(static_cast<uint64_t>(key.producer_id) * 0x9e3779b97f4a7c15ULL ^ partition);
+  }
+};
+
+// Shard index for a key; the hash is remixed so shard choice does not depend on its low bits alone
+inline size_t ProducerKeyShard(const ProducerKey& key, size_t num_shards) noexcept {
+  uint64_t hash = ProducerKeyHash{}(key);
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return static_cast<size_t>(hash % num_shards);
+}
+
+} // namespace streamit::broker
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "streamit/broker/idempotency_table.h"
+#include "streamit/broker/sequence_window.h"
+#include "streamit/common/result.h"
+#include "streamit/common/topic_registry.h"
+#include "streamit/storage/log_dir.h"
+#include <absl/status/status.h>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace streamit::broker {
+
+// Idempotency state of one partition as of a log offset
+struct ProducerSnapshot {
+  // Every batch below this offset is reflected in `producers`
+  int64_t end_offset = 0;
+
+  // Producer id and its retained batches, oldest first
+  std::vector<std::pair<int64_t, std::vector<SequenceWindow::Batch>>> producers;
+};
+
+// Snapshot of one partition, tagged with where it belongs
+struct PartitionProducerSnapshot {
+  common::TopicPartition partition;
+  ProducerSnapshot snapshot;
+};
+
+// Persists the idempotency table per partition so a restarted broker rebuilds it from the latest
+// snapshot plus the log written after it, instead of scanning whole logs
+class ProducerSnapshotter {
+public:
+  // Snapshot file kept in each partition directory
+  static constexpr std::string_view kFileName = "producer_snapshot";
+
+  // Constructor
+  ProducerSnapshotter(std::shared_ptr<storage::LogDir> log_dir, std::shared_ptr<IdempotencyTable> table);
+
+  // Load every partition's snapshot into the table and replay the log after it; returns batches replayed
+  [[nodiscard]] common::Result<size_t> Recover() noexcept;
+
+  // Highest producer id seen by the last Recover (0 if none)
+  [[nodiscard]] int64_t MaxProducerId() const noexcept;
+
+  // Capture every partition's state. The caller must hold off idempotent appends while this runs so
+  // that no batch is in the log without also being in the table.
+  [[nodiscard]] std::vector<PartitionProducerSnapshot> Capture() const;
+
+  // Write captured snapshots, atomically replacing each partition's previous file
+  [[nodiscard]] absl::Status Write(const std::vector<PartitionProducerSnapshot>& snapshots) const noexcept;
+
+  // Write one snapshot file (via a temporary file and rename)
+  [[nodiscard]] static absl::Status WriteFile(const std::filesystem::path& path,
+                                              const ProducerSnapshot& snapshot) noexcept;
+
+  // Read one snapshot file
+  [[nodiscard]] static common::Result<ProducerSnapshot> ReadFile(const std::filesystem::path& path) noexcept;
+
+private:
+  // Read size per replay step
+  static constexpr size_t kReplayChunkBytes = 4 * 1024 * 1024;
+
+  std::shared_ptr<storage::LogDir> log_dir_;
+  std::shared_ptr<IdempotencyTable> table_;
+  int64_t max_producer_id_ = 0;
+
+  // Record a recovered batch in the table
+  void Restore(const ProducerKey& key, int64_t sequence, int64_t offset) noexcept;
+
+  // Feed batches at or after `from_offset` into the table; returns batches replayed
+  [[nodiscard]] common::Result<size_t> ReplayLog(common::TopicPartition tp, int64_t from_offset) noexcept;
+};
+
+} // namespace streamit::broker
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "streamit/common/instrumented_mutex.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace streamit::broker {
+
+// Token bucket refilled continuously at a fixed rate.
+// A request is admitted whenever the bucket is not in debt, and is charged in full even if that
+// drives the balance negative, so a batch larger than the burst is not rejected forever.
+class TokenBucket {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Constructor (rate in units per second; the bucket starts full)
+  TokenBucket(double rate_per_sec, double burst, Clock::time_point now = Clock::now()) noexcept;
+
+  // Time until the bucket is out of debt; zero if a request may be admitted now
+  [[nodiscard]] std::chrono::milliseconds Delay(Clock::time_point now) noexcept;
+
+  // Charge an amount against the bucket
+  void Consume(double amount, Clock::time_point now) noexcept;
+
+  // Last time the bucket was touched
+  [[nodiscard]] Clock::time_point LastUpdate() const noexcept;
+
+private:
+  double rate_per_sec_;
+  double burst_;
+  double tokens_;
+  Clock::time_point last_update_;
+
+  // Add tokens accrued since the last update
+  void Refill(Clock::time_point now) noexcept;
+};
+
+// Byte and request rate limits for one kind of quota entity (0 = unlimited)
+struct QuotaLimit {
+  double bytes_per_sec = 0;
+  double requests_per_sec = 0;
+
+  [[nodiscard]] bool Enabled() const noexcept {
+    return bytes_per_sec > 0 || requests_per_sec > 0;
+  }
+};
+
+// Quota limits applied to every producer id, client address and topic
+struct QuotaConfig {
+  QuotaLimit producer;
+  QuotaLimit client;
+  QuotaLimit topic;
+};
+
+// Entities a request is charged against; empty fields are skipped
+struct QuotaSubject {
+  std::string producer_id;
+  std::string client;
+  std::string topic;
+};
+
+// Outcome of a quota check
+struct QuotaDecision {
+  std::chrono::milliseconds throttle{0};
+  std::string_view entity; // "producer", "client" or "topic" when throttled
+
+  [[nodiscard]] bool Throttled() const noexcept {
+    return throttle.count() > 0;
+  }
+};
+
+// Per-producer, per-client and per-topic token-bucket quotas for one request direction
+class QuotaManager {
+public:
+  using Clock = TokenBucket::Clock;
+
+  // Constructor
+  explicit QuotaManager(QuotaConfig config);
+
+  // Check all buckets for a request and, if none is in debt, charge one request and `bytes`.
+  // Nothing is charged when the request is throttled.
+  [[nodiscard]] QuotaDecision Acquire(const QuotaSubject& subject, int64_t bytes,
+                                      Clock::time_point now = Clock::now()) noexcept;
+
+  // Charge bytes that were only known after serving the request (fetch responses)
+  void RecordBytes(const QuotaSubject& subject, int64_t bytes, Clock::time_point now = Clock::now()) noexcept;
+
+  // Whether any quota is configured
+  [[nodiscard]] bool Enabled() const noexcept;
+
+  // Number of tracked entities
+  [[nodiscard]] size_t Size() const noexcept;
+
+  // Strip the transport prefix and port from a gRPC peer string ("ipv4:10.0.0.1:5000" -> "10.0.0.1")
+  [[nodiscard]] static std::string ClientAddress(std::string_view peer) noexcept;
+
+private:
+  // Buckets idle for this long are dropped
+  static constexpr std::chrono::seconds kIdleTimeout{300};
+
+  // Requests between idle sweeps
+  static constexpr uint64_t kSweepInterval = 4096;
+
+  // Buckets held for one entity
+  struct EntityBuckets {
+    TokenBucket bytes;
+    TokenBucket requests;
+  };
+
+  using BucketMap = std::unordered_map<std::string, EntityBuckets>;
+
+  QuotaConfig config_;
+  BucketMap producers_;
+  BucketMap clients_;
+  BucketMap topics_;
+  uint64_t requests_since_sweep_;
+  mutable common::InstrumentedMutex mutex_{"quota_manager"};
+
+  // Find or create the buckets for an entity (nullptr if the limit is disabled or the name is empty)
+  [[nodiscard]] EntityBuckets* GetBuckets(BucketMap& map, const QuotaLimit& limit, const std::string& name,
+                                          Clock::time_point now) noexcept;
+
+  // Longest delay across an entity's buckets
+  [[nodiscard]] static std::chrono::milliseconds Delay(EntityBuckets* buckets, Clock::time_point now) noexcept;
+
+  // Drop buckets that have been idle for kIdleTimeout
+  void SweepIdle(Clock::time_point now) noexcept;
+};
+
+} // namespace streamit::broker
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "streamit/common/executor.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace streamit::broker {
+
+// Classes of broker traffic, each served by its own executor
+enum class RequestClass {
+  kProduce,
+  kTailFetch,
+  kCatchUpFetch,
+  kAdmin,
+};
+
+// Number of request classes
+inline constexpr size_t kNumRequestClasses = 4;
+
+// Thread counts per class and the tail/catch-up boundary
+struct RequestLaneConfig {
+  size_t produce_threads = 4;
+  size_t tail_fetch_threads = 2;
+  size_t catch_up_fetch_threads = 2;
+  size_t admin_threads = 1;
+
+  // Threads for fsyncs behind durable acks
+  size_t flush_threads = 2;
+
+  // Fetches at most this many offsets behind the high water mark count as tail reads
+  int64_t tail_fetch_max_lag = 1000;
+};
+
+// Dedicated executors per request class so backfills cannot starve produces or health checks.
+// Each executor's thread count is that class's concurrency limit, including for the storage calls
+// it makes inline. Fsyncs get an executor of their own so a slow flush never queues an append.
+class RequestLanes {
+public:
+  // Constructor (starts all executors)
+  explicit RequestLanes(const RequestLaneConfig& config);
+
+  // Executor serving a request class
+  [[nodiscard]] common::Executor& For(RequestClass request_class) noexcept;
+
+  // Executor for fsyncs behind durable acks
+  [[nodiscard]] common::Executor& Flush() noexcept;
+
+  // Tail fetches read recently produced, usually cached data; everything further back is catch-up
+  [[nodiscard]] RequestClass ClassifyFetch(int64_t offset, int64_t high_watermark) const noexcept;
+
+  // Stop all executors after draining their queues
+  void Shutdown() noexcept;
+
+  // Metric label for a request class
+  [[nodiscard]] static std::string_view Name(RequestClass request_class) noexcept;
+
+private:
+  int64_t tail_fetch_max_lag_;
+  std::array<std::unique_ptr<common::Executor>, kNumRequestClasses> executors_;
+  common::Executor flush_executor_;
+};
+
+} // namespace streamit::broker
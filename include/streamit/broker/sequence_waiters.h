@@ -0,0 +1,92 @@
+#pragma once
+
+#include "streamit/broker/idempotency_table.h"
+#include "streamit/broker/producer_key.h"
+#include "streamit/common/executor.h"
+#include "streamit/common/instrumented_mutex.h"
+#include "streamit/common/timer_service.h"
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace streamit::broker {
+
+// Registry of pipelined produces that reached the broker ahead of an earlier batch from the same producer.
+// Each waits for the batch before it to be appended instead of failing as out of order.
+class SequenceWaiters {
+public:
+  // State for a single suspended produce
+  struct Waiter {
+    std::atomic<bool> fired{false};
+    bool ready = false;
+    std::coroutine_handle<> handle;
+    common::Executor* executor = nullptr;
+    common::TimerService::TimerId timer_id = 0;
+    ProducerKey key{};
+    int64_t sequence = -1;
+  };
+
+  // Constructor; `table` decides whether a sequence is still waiting for its predecessor
+  SequenceWaiters(const IdempotencyTable& table, common::TimerService& timers);
+
+  // Awaitable that completes once `sequence` is no longer pending for `key` or the timeout expires.
+  // Resolves to true if the caller should check the sequence again.
+  [[nodiscard]] auto WaitForTurn(const ProducerKey& key, int64_t sequence,
+                                 std::chrono::milliseconds timeout) noexcept {
+    struct TurnAwaiter {
+      SequenceWaiters* waiters;
+      std::shared_ptr<Waiter> waiter;
+      std::chrono::milliseconds timeout;
+
+      bool await_ready() const noexcept {
+        return timeout.count() <= 0;
+      }
+
+      bool await_suspend(std::coroutine_handle<> handle) noexcept {
+        waiter->handle = handle;
+        waiter->executor = common::Executor::Current();
+        return waiters->Register(waiter, timeout);
+      }
+
+      bool await_resume() const noexcept {
+        return waiter->ready;
+      }
+    };
+    auto waiter = std::make_shared<Waiter>();
+    waiter->key = key;
+    waiter->sequence = sequence;
+    return TurnAwaiter{this, std::move(waiter), timeout};
+  }
+
+  // Wake the batch queued behind `sequence` after it was appended
+  void Notify(const ProducerKey& key, int64_t sequence) noexcept;
+
+  // Wake every suspended produce as timed out and stop suspending new ones
+  void Shutdown() noexcept;
+
+  // Number of suspended produces
+  [[nodiscard]] size_t Size() const noexcept;
+
+private:
+  const IdempotencyTable& table_;
+  common::TimerService& timers_;
+  std::unordered_map<ProducerKey, std::vector<std::shared_ptr<Waiter>>, ProducerKeyHash> waiters_;
+  bool stopped_ = false;
+  mutable common::InstrumentedMutex mutex_{"sequence_waiters"};
+
+  // Register a waiter; returns false if the caller should not suspend
+  [[nodiscard]] bool Register(const std::shared_ptr<Waiter>& waiter, std::chrono::milliseconds timeout) noexcept;
+
+  // Called by the timer when a waiter times out
+  void Expire(const std::shared_ptr<Waiter>& waiter) noexcept;
+
+  // Resume a waiter exactly once
+  static void Resume(const std::shared_ptr<Waiter>& waiter, bool ready) noexcept;
+};
+
+} // namespace streamit::broker
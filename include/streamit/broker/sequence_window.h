@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace streamit::broker {
+
+// Outcome of checking a produce sequence against a producer's recent batches
+enum class SequenceStatus {
+  kAccept,     // Next in order (or the first batch seen for the producer): append it
+  kDuplicate,  // Retry of a retained batch: answer with its original base offset
+  kPending,    // Less than a window ahead of the next expected sequence: an earlier pipelined batch is in flight
+  kOutOfOrder, // A window or more ahead of the next expected sequence: an earlier batch was lost
+  kStale,      // Older than the retained window: cannot tell whether it was written
+};
+
+// Result of a sequence check
+struct SequenceCheck {
+  SequenceStatus status = SequenceStatus::kAccept;
+  int64_t offset = -1;   // Original base offset (kDuplicate only)
+  int64_t expected = -1; // Next sequence the producer should send (-1 if unknown)
+};
+
+// Sequences and base offsets of a producer's last kSize batches on one partition.
+// Keeping more than the latest batch lets a producer pipeline up to kSize requests and still have any
+// retried one answered with the offset it was first written at.
+class SequenceWindow {
+public:
+  // Batches retained per producer-partition (and so the useful pipelining depth)
+  static constexpr size_t kSize = 5;
+
+  // A retained batch
+  struct Batch {
+    int64_t sequence;
+    int64_t offset;
+  };
+
+  // Classify a sequence against the retained batches
+  [[nodiscard]] SequenceCheck Check(int64_t sequence) const noexcept;
+
+  // Record an appended batch; a non-contiguous sequence restarts the window
+  void Record(int64_t sequence, int64_t offset) noexcept;
+
+  // Sequence of the most recent batch (-1 if empty)
+  [[nodiscard]] int64_t LastSequence() const noexcept;
+
+  // Base offset of the most recent batch (-1 if empty)
+  [[nodiscard]] int64_t LastOffset() const noexcept;
+
+  // Number of retained batches
+  [[nodiscard]] size_t Size() const noexcept;
+
+  // Retained batches, oldest first
+  [[nodiscard]] std::vector<Batch> Batches() const;
+
+private:
+  // Ring of base offsets indexed by sequence; entries for sequences
+  // (last_sequence_ - size_, last_sequence_] are valid
+  std::array<int64_t, kSize> offsets_{};
+  int64_t last_sequence_ = -1;
+  size_t size_ = 0;
+
+  [[nodiscard]] static size_t SlotOf(int64_t sequence) noexcept;
+};
+
+} // namespace streamit::broker
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "streamit/common/mpmc_queue.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
+
+namespace streamit::common {
+
+// Moves log I/O off the calling thread. Callers format their message and push it onto a lock-free queue; one
+// writer thread hands queued messages to the spdlog logger's sinks and flushes after each batch. A full queue
+// drops the message instead of blocking, and the writer reports how many were dropped.
+class AsyncLogger {
+public:
+  static constexpr size_t kDefaultCapacity = 8192;
+
+  // Constructor; starts the writer thread
+  AsyncLogger(std::shared_ptr<spdlog::logger> logger, size_t capacity = kDefaultCapacity);
+
+  // Stops the writer
+  ~AsyncLogger();
+
+  // Non-copyable, non-movable
+  AsyncLogger(const AsyncLogger&) = delete;
+  AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+  // Queue a formatted message (never blocks; after Stop the message is written synchronously)
+  void Log(spdlog::level::level_enum level, std::string message) noexcept;
+
+  // Block until every message queued before the call has been written and the sinks flushed
+  void Flush();
+
+  // Write out everything queued and stop the writer thread (idempotent)
+  void Stop();
+
+  // Messages dropped because the queue was full
+  [[nodiscard]] int64_t Dropped() const noexcept;
+
+private:
+  struct Record {
+    spdlog::level::level_enum level = spdlog::level::info;
+    spdlog::log_clock::time_point time;
+    std::string message;
+  };
+
+  // Writer thread body
+  void Run();
+
+  // Write every queued record; returns the number written
+  size_t Drain();
+
+  // Wake the writer if it is waiting for work
+  void Wake() noexcept;
+
+  std::shared_ptr<spdlog::logger> logger_;
+  MpmcQueue<Record> queue_;
+  std::atomic<int64_t> queued_{0};
+  std::atomic<int64_t> written_{0};
+  std::atomic<int64_t> dropped_{0};
+  std::atomic<bool> sleeping_{false};
+  std::atomic<bool> stopping_{false};
+  std::thread writer_;
+};
+
+// Lets at most `per_second` messages from one call site through per one-second window and counts the rest, so a
+// failure repeating on every request cannot flood the log.
+class LogRateLimiter {
+public:
+  // Constructor
+  explicit LogRateLimiter(int64_t per_second) noexcept;
+
+  // Whether a message may go out now. When it may, `suppressed` is set to the number of messages held back since
+  // the previous one that went out.
+  [[nodiscard]] bool Allow(int64_t& suppressed) noexcept;
+  [[nodiscard]] bool Allow(int64_t& suppressed, std::chrono::steady_clock::time_point now) noexcept;
+
+private:
+  int64_t per_second_;
+  std::atomic<int64_t> window_start_ns_;
+  std::atomic<int64_t> window_count_{0};
+  std::atomic<int64_t> suppressed_{0};
+};
+
+} // namespace streamit::common
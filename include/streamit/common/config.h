@@ -16,6 +16,13 @@ struct BrokerConfig {
   size_t max_segment_size_bytes = 128 * 1024 * 1024; // 128MB
   int64_t segment_roll_interval_ms = 3600000;        // 1 hour
   size_t max_inflight_bytes = 100 * 1024 * 1024;     // 100MB
+  int32_t max_inflight_wait_ms = 1000;
+  size_t idempotency_shards = 16;
+  int64_t producer_snapshot_interval_ms = 60000; // 0 = snapshot only on shutdown
+  int64_t checkpoint_interval_ms = 5000;         // 0 = checkpoint offsets only on shutdown
+  int64_t slow_request_threshold_ms = 100;       // 0 = no slow-request log
+  size_t slow_request_log_size = 256;
+  uint32_t slow_request_sample_one_in = 1;
   int32_t replication_factor = 1;
   int32_t min_insync_replicas = 1;
   int32_t request_timeout_ms = 30000;
@@ -23,6 +30,32 @@ struct BrokerConfig {
   bool enable_metrics = true;
   uint16_t metrics_port = 8080;
   std::string log_level = "info";
+  uint32_t log_sample_one_in = 100; // per-request info logs written (all of them at debug level)
+  size_t log_queue_capacity = 8192; // messages buffered for the log writer thread before dropping
+  std::string lock_profiling = "sampled"; // off, sampled or full; per-lock wait and hold times at /admin/locks
+
+  // Request spans are exported to an OTLP/HTTP collector (host:port) if set, else to a local file if set
+  std::string trace_otlp_endpoint;
+  std::string trace_export_path;
+  int64_t trace_export_interval_ms = 1000;
+  size_t trace_export_batch_size = 512;
+  size_t trace_queue_capacity = 65536;
+
+  // Executor threads per request class
+  size_t produce_threads = 4;
+  size_t tail_fetch_threads = 2;
+  size_t catch_up_fetch_threads = 2;
+  size_t admin_threads = 1;
+  size_t flush_threads = 2; // fsyncs behind durable acks
+  int64_t tail_fetch_max_lag = 1000; // offsets behind the high water mark still served as tail reads
+
+  // Quotas per producer id, client address and topic (0 = unlimited)
+  double quota_producer_bytes_per_sec = 0;
+  double quota_producer_requests_per_sec = 0;
+  double quota_client_bytes_per_sec = 0;
+  double quota_client_requests_per_sec = 0;
+  double quota_topic_bytes_per_sec = 0;
+  double quota_topic_requests_per_sec = 0;
 };
 
 // Controller configuration
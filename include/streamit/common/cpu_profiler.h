@@ -0,0 +1,34 @@
+#pragma once
+
+#include "streamit/common/http_health_server.h"
+#include "streamit/common/result.h"
+#include <chrono>
+#include <string>
+
+namespace streamit::common {
+
+// Parameters of one CPU profile
+struct CpuProfileOptions {
+  std::chrono::seconds duration{10};
+  int frequency_hz = 99; // Off the usual 100 Hz so sampling does not lock step with periodic work
+};
+
+// On-demand sampling CPU profiler for a running server. While a profile runs, ITIMER_PROF delivers SIGPROF to
+// threads as they consume CPU and the handler copies the interrupted stack into a preallocated buffer; stacks
+// are symbolized and aggregated once sampling stops. Between profiles the timer is disarmed, so the SIGPROF
+// handler stays installed but never runs and nothing is paid for.
+class CpuProfiler {
+public:
+  static constexpr std::chrono::seconds kMaxDuration{60};
+  static constexpr int kMaxFrequencyHz = 1000;
+
+  // Sample for `options.duration` (blocking the caller) and return the profile as folded stacks, one
+  // `thread;outermost;...;innermost <samples>` line per distinct stack, ready for flamegraph.pl or speedscope.
+  // Fails with kUnavailable while another profile is running and kInvalidArgument for out-of-range options.
+  [[nodiscard]] static Result<std::string> Collect(const CpuProfileOptions& options);
+};
+
+// Handler for `/debug/pprof/profile?seconds=N&hz=H`; register with HttpHealthServer::AddBlockingHandler
+[[nodiscard]] HttpResponse ServeCpuProfile(const HttpRequest& request);
+
+} // namespace streamit::common
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "streamit/common/task.h"
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace streamit::common {
+
+// Fixed-size thread pool that runs posted work and resumes coroutines
+class Executor {
+public:
+  // Constructor
+  Executor(std::string name, size_t num_threads);
+
+  // Destructor (stops and joins workers)
+  ~Executor();
+
+  // Non-copyable, non-movable
+  Executor(const Executor&) = delete;
+  Executor& operator=(const Executor&) = delete;
+
+  // Queue a function to run on one of the workers; returns false if the executor is shut down
+  bool Post(std::function<void()> fn) noexcept;
+
+  // Awaitable that resumes the calling coroutine on one of the workers
+  [[nodiscard]] auto Schedule() noexcept {
+    struct ScheduleAwaiter {
+      Executor* executor;
+
+      bool await_ready() const noexcept {
+        return false;
+      }
+
+      void await_suspend(std::coroutine_handle<> handle) noexcept {
+        executor->Post([handle] { handle.resume(); });
+      }
+
+      void await_resume() const noexcept {
+      }
+    };
+    return ScheduleAwaiter{this};
+  }
+
+  // Stop accepting work and join the workers
+  void Shutdown() noexcept;
+
+  // Number of queued items not yet picked up by a worker
+  [[nodiscard]] size_t QueueDepth() const noexcept;
+
+  // Number of worker threads
+  [[nodiscard]] size_t NumThreads() const noexcept;
+
+  // Executor name (used for thread names and metrics)
+  [[nodiscard]] const std::string& Name() const noexcept;
+
+  // Executor owning the calling thread, or nullptr if not a worker
+  [[nodiscard]] static Executor* Current() noexcept;
+
+private:
+  std::string name_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> queue_;
+  std::vector<std::thread> workers_;
+  bool stopped_;
+
+  // Worker loop
+  void WorkerLoop() noexcept;
+};
+
+// Run a blocking function on `executor` and resume the caller on the executor it came from.
+// Used to keep slow storage calls (fsync, file creation) off the request threads.
+template <typename F>
+Task<std::invoke_result_t<F>> RunOn(Executor& executor, F fn) {
+  using R = std::invoke_result_t<F>;
+  Executor* origin = Executor::Current();
+
+  co_await executor.Schedule();
+  if constexpr (std::is_void_v<R>) {
+    fn();
+    if (origin && origin != &executor) {
+      co_await origin->Schedule();
+    }
+  } else {
+    R result = fn();
+    if (origin && origin != &executor) {
+      co_await origin->Schedule();
+    }
+    co_return result;
+  }
+}
+
+} // namespace streamit::common
@@ -1,22 +1,60 @@
 #pragma once
 
+#include "streamit/common/executor.h"
 #include "streamit/common/health_check.h"
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
 #include <string>
 #include <thread>
 
 namespace streamit::common {
 
-// Simple HTTP health check server
+// Parsed request line of an HTTP request
+struct HttpRequest {
+  std::string method;
+  std::string path;
+  std::map<std::string, std::string> query;
+};
+
+// Response produced by a handler
+struct HttpResponse {
+  int status_code = 200;
+  std::string body;
+  std::string content_type = "text/plain";
+};
+
+// Handler for one path
+using HttpHandler = std::function<HttpResponse(const HttpRequest&)>;
+
+// Simple HTTP server for health checks and operational endpoints.
+// `/live` and `/ready` are built in; other paths are served by handlers registered before Start().
 class HttpHealthServer {
 public:
-  // Constructor
-  HttpHealthServer(const std::string& host, uint16_t port, std::shared_ptr<HealthCheckManager> manager);
+  // Constructor. Requests are read and parsed on the accept thread under kClientTimeout, then answered on
+  // `executor` when given so slow checks do not block accepts; the executor must outlive Stop().
+  HttpHealthServer(const std::string& host, uint16_t port, std::shared_ptr<HealthCheckManager> manager,
+                   Executor* executor = nullptr);
 
   // Destructor
   ~HttpHealthServer();
 
+  // Serve `path` (exact match, query string excluded) with `handler`; must be called before Start()
+  void AddHandler(std::string path, HttpHandler handler);
+
+  // Like AddHandler, for handlers that take seconds (profiles): each request gets its own thread instead of
+  // holding an executor thread or the accept loop
+  void AddBlockingHandler(std::string path, HttpHandler handler);
+
+  // Split a request line (`GET /path?a=1 HTTP/1.1`) into method, path and query parameters
+  [[nodiscard]] static HttpRequest ParseRequestLine(const std::string& request) noexcept;
+
   // Start the server
   [[nodiscard]] bool Start() noexcept;
 
@@ -27,20 +65,54 @@ public:
   [[nodiscard]] bool IsRunning() const noexcept;
 
 private:
+  // Longest a client may take to send its request or accept the response
+  static constexpr std::chrono::seconds kClientTimeout{5};
+
   std::string host_;
   uint16_t port_;
   std::shared_ptr<HealthCheckManager> manager_;
   std::atomic<bool> running_;
   std::unique_ptr<std::thread> server_thread_;
+  Executor* executor_;
+  std::map<std::string, HttpHandler> handlers_;
+  std::set<std::string> blocking_paths_;
+
+  // Listening socket while the server loop runs, so Stop can wake a blocked accept
+  std::atomic<int> listen_socket_;
+
+  // Requests posted to the executor but not yet finished
+  size_t pending_requests_;
+  std::mutex pending_mutex_;
+  std::condition_variable pending_cv_;
+
+  // Answer a request and close the connection
+  void ServeClient(int client_socket, const HttpRequest& request);
 
   // Server loop
   void ServerLoop();
 
-  // Handle HTTP request
-  void HandleRequest(int client_socket);
+  // Bound reads and writes on a client connection by kClientTimeout
+  static void SetClientTimeouts(int client_socket) noexcept;
+
+  // Read and parse the request line; nullopt if the client closed, failed or timed out
+  [[nodiscard]] static std::optional<HttpRequest> ReadRequest(int client_socket) noexcept;
+
+  // Hand a parsed request to the executor, a thread of its own (blocking paths) or serve it inline;
+  // takes ownership of `client_socket`
+  void Dispatch(int client_socket, HttpRequest request);
+
+  // Route a request to the built-in checks or a handler and send the response
+  void HandleRequest(int client_socket, const HttpRequest& parsed);
+
+  // Run a blocking handler on its own thread, which answers on `socket` and closes it
+  void ServeOnOwnThread(int socket, const HttpHandler& handler, HttpRequest request);
+
+  // Invoke a handler, turning exceptions into 500 responses
+  [[nodiscard]] static HttpResponse RunHandler(const HttpHandler& handler, const HttpRequest& request) noexcept;
 
   // Send HTTP response
-  void SendResponse(int client_socket, int status_code, const std::string& body);
+  void SendResponse(int client_socket, int status_code, const std::string& body,
+                    const std::string& content_type = "text/plain");
 };
 
 } // namespace streamit::common
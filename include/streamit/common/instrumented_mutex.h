@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace streamit::common {
+
+// How much InstrumentedMutex measures
+enum class LockProfiling : uint8_t {
+  kOff,     // Plain mutex
+  kSampled, // Count acquisitions, time every contended wait, time the hold of one acquisition in kHoldSampleEvery
+  kFull,    // Also time every hold
+};
+
+// Current mode (one relaxed load)
+[[nodiscard]] LockProfiling LockProfilingMode() noexcept;
+
+// Change the mode; locks acquired under the previous mode are released under it
+void SetLockProfilingMode(LockProfiling mode) noexcept;
+
+// Parse "off", "sampled" or "full" (anything else is kSampled)
+[[nodiscard]] LockProfiling ParseLockProfiling(std::string_view mode) noexcept;
+
+// Statistics shared by every mutex with the same name (defined in instrumented_mutex.cc)
+class LockSite;
+
+// Drop-in std::mutex (Lockable, so it works with lock_guard, unique_lock and scoped_lock) that reports acquisition
+// wait and hold times per named lock site. An uncontended acquisition costs one try_lock and a sharded counter
+// increment; the clock is only read when the lock is contended or the hold is sampled.
+class InstrumentedMutex {
+public:
+  // One acquisition in this many (per thread) has its hold time measured in kSampled mode
+  static constexpr uint32_t kHoldSampleEvery = 64;
+
+  // Constructor; `name` identifies the lock site in metrics and /admin/locks
+  explicit InstrumentedMutex(std::string_view name);
+
+  // Non-copyable, non-movable
+  InstrumentedMutex(const InstrumentedMutex&) = delete;
+  InstrumentedMutex& operator=(const InstrumentedMutex&) = delete;
+
+  void lock() {
+    if (LockProfilingMode() == LockProfiling::kOff) {
+      mutex_.lock();
+      return;
+    }
+    LockProfiled();
+  }
+
+  [[nodiscard]] bool try_lock() {
+    if (!mutex_.try_lock()) {
+      return false;
+    }
+    if (LockProfilingMode() != LockProfiling::kOff) {
+      Acquired(false, 0);
+    }
+    return true;
+  }
+
+  void unlock() {
+    if (held_since_ns_ == 0) {
+      mutex_.unlock();
+      return;
+    }
+    UnlockProfiled();
+  }
+
+private:
+  void LockProfiled();
+  void UnlockProfiled();
+
+  // Record an acquisition and decide whether to time its hold
+  void Acquired(bool contended, int64_t wait_ns) noexcept;
+
+  std::mutex mutex_;
+  LockSite* site_;
+  int64_t held_since_ns_ = 0; // Guarded by mutex_; 0 unless this hold is being timed
+};
+
+// Lock sites by name. Each site's series are in the metrics registry labelled lock=<name>
+// (streamit_lock_acquisitions_total, streamit_lock_contended_total, streamit_lock_wait_ns, streamit_lock_hold_ns).
+class LockProfiler {
+public:
+  // Site for `name`, created on first use; sites live for the rest of the process
+  [[nodiscard]] static LockSite* Site(std::string_view name);
+
+  // Every site as a JSON array, most total wait first
+  [[nodiscard]] static std::string RenderJson();
+};
+
+} // namespace streamit::common
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace streamit::common {
+
+// `value` as a quoted JSON string
+[[nodiscard]] std::string JsonString(std::string_view value);
+
+} // namespace streamit::common
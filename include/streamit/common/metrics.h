@@ -1,65 +1,310 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <bit>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 namespace streamit::common {
 
-// Forward declarations for simple metrics classes
-class SimpleHistogram;
-class SimpleCounter;
-class SimpleGauge;
+// Number of shards each counter and histogram spreads its updates over
+inline constexpr size_t kMetricShards = 8;
+
+// Shard of the calling thread (threads are assigned round-robin on first use)
+[[nodiscard]] size_t MetricShard() noexcept;
+
+// Monotonic counter. Each thread adds to its own cache line, so concurrent increments never contend;
+// reads sum the shards.
+class Counter {
+public:
+  // Add `value` (lock-free)
+  void Increment(int64_t value = 1) noexcept {
+    shards_[MetricShard()].value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  // Sum over all shards
+  [[nodiscard]] int64_t Value() const noexcept;
+
+private:
+  struct alignas(64) Shard {
+    std::atomic<int64_t> value{0};
+  };
+  std::array<Shard, kMetricShards> shards_;
+};
+
+// Point-in-time value
+class Gauge {
+public:
+  // Replace the value (lock-free)
+  void Set(double value) noexcept {
+    value_.store(value, std::memory_order_relaxed);
+  }
+
+  // Add `delta` (lock-free)
+  void Increment(double delta = 1.0) noexcept {
+    double current = value_.load(std::memory_order_relaxed);
+    while (!value_.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Current value
+  [[nodiscard]] double Value() const noexcept {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<double> value_{0.0};
+};
+
+// Merged state of a histogram at one point in time
+class HistogramSnapshot {
+public:
+  // Empty snapshot
+  HistogramSnapshot();
+
+  // Fold in another snapshot (e.g. the same histogram on another broker, or another label)
+  void Merge(const HistogramSnapshot& other) noexcept;
+
+  // Value at quantile `q` in [0, 1], accurate to the bucket width (about 3%); 0 if empty
+  [[nodiscard]] int64_t Quantile(double q) const noexcept;
+
+  // Number of observations
+  [[nodiscard]] int64_t Count() const noexcept;
+
+  // Sum of all observations
+  [[nodiscard]] int64_t Sum() const noexcept;
+
+  // Smallest and largest observation (0 if empty)
+  [[nodiscard]] int64_t Min() const noexcept;
+  [[nodiscard]] int64_t Max() const noexcept;
+
+  // Mean observation (0 if empty)
+  [[nodiscard]] double Mean() const noexcept;
+
+  // Observations per bucket (see Histogram::BucketIndex)
+  [[nodiscard]] const std::vector<int64_t>& Buckets() const noexcept;
+
+private:
+  friend class Histogram;
+
+  std::vector<int64_t> buckets_;
+  int64_t count_ = 0;
+  int64_t sum_ = 0;
+  int64_t min_ = 0;
+  int64_t max_ = 0;
+};
+
+// HDR-style histogram of non-negative integer values (latencies in any unit, sizes).
+// Buckets are log-linear: exact below 32, then 16 buckets per power of two, so any recorded value is known to
+// within about 3% up to 2^44. Observations go to the calling thread's shard with relaxed atomics only; a shard is
+// allocated the first time a thread records into it, so series that are never (or rarely) used stay small.
+class Histogram {
+public:
+  // Values below this get a bucket each
+  static constexpr int kSubBucketBits = 5;
+  static constexpr int64_t kSubBucketCount = int64_t{1} << kSubBucketBits;
+  static constexpr int64_t kHalfSubBucketCount = kSubBucketCount / 2;
+
+  // Largest value kept apart; anything above lands in the last bucket
+  static constexpr int kMaxValueBits = 44;
+  static constexpr int64_t kMaxValue = (int64_t{1} << kMaxValueBits) - 1;
+
+  static constexpr size_t kBucketCount = kSubBucketCount + (kMaxValueBits - kSubBucketBits) * kHalfSubBucketCount;
+
+  Histogram() = default;
+  ~Histogram();
+
+  Histogram(const Histogram&) = delete;
+  Histogram& operator=(const Histogram&) = delete;
+
+  // Record one value (negative values count as 0, values above kMaxValue as kMaxValue)
+  void Record(int64_t value) noexcept {
+    value = value < 0 ? 0 : (value > kMaxValue ? kMaxValue : value);
+
+    size_t index = MetricShard();
+    Shard* shard = shards_[index].load(std::memory_order_acquire);
+    if (shard == nullptr) [[unlikely]] {
+      shard = AllocateShard(index);
+    }
+    shard->buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    shard->sum.fetch_add(value, std::memory_order_relaxed);
+
+    // Extremes settle quickly, so these loops rarely run
+    int64_t min = min_.load(std::memory_order_relaxed);
+    while (value < min && !min_.compare_exchange_weak(min, value, std::memory_order_relaxed)) {
+    }
+    int64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Record a fractional value, rounded to the nearest integer
+  void Observe(double value) noexcept {
+    Record(static_cast<int64_t>(value + 0.5));
+  }
+
+  // Merge the shards
+  [[nodiscard]] HistogramSnapshot Snapshot() const noexcept;
+
+  // Bucket holding `value` (0 <= value <= kMaxValue)
+  [[nodiscard]] static constexpr size_t BucketIndex(int64_t value) noexcept {
+    if (value < kSubBucketCount) {
+      return static_cast<size_t>(value);
+    }
+    int exponent = std::bit_width(static_cast<uint64_t>(value)) - 1;
+    int shift = exponent - kSubBucketBits + 1;
+    return static_cast<size_t>(kSubBucketCount + (exponent - kSubBucketBits) * kHalfSubBucketCount +
+                               ((value >> shift) - kHalfSubBucketCount));
+  }
+
+  // Smallest value that lands in bucket `index`
+  [[nodiscard]] static constexpr int64_t BucketLowerBound(size_t index) noexcept {
+    auto i = static_cast<int64_t>(index);
+    if (i < kSubBucketCount) {
+      return i;
+    }
+    int64_t octave = (i - kSubBucketCount) / kHalfSubBucketCount;
+    int64_t sub_bucket = (i - kSubBucketCount) % kHalfSubBucketCount + kHalfSubBucketCount;
+    return sub_bucket << (octave + 1);
+  }
+
+  // Largest value that lands in bucket `index`
+  [[nodiscard]] static constexpr int64_t BucketUpperBound(size_t index) noexcept {
+    return index + 1 < kBucketCount ? BucketLowerBound(index + 1) - 1 : kMaxValue;
+  }
+
+private:
+  struct alignas(64) Shard {
+    std::array<std::atomic<int64_t>, kBucketCount> buckets{};
+    std::atomic<int64_t> sum{0};
+  };
+
+  // Installs shard `index` if no other thread has yet; returns the installed shard
+  Shard* AllocateShard(size_t index) noexcept;
+
+  std::array<std::atomic<Shard*>, kMetricShards> shards_{};
+  std::atomic<int64_t> min_{kMaxValue};
+  std::atomic<int64_t> max_{0};
+};
+
+// Label names to values identifying one series of a metric family
+using MetricLabels = std::map<std::string, std::string>;
+
+// All series of one metric name, keyed by their labels. Resolving a series takes the family's mutex, so hot paths
+// resolve once and keep the returned handle.
+template <typename Metric>
+class MetricFamily {
+public:
+  // Constructor
+  MetricFamily(std::string name, std::string help) : name_(std::move(name)), help_(std::move(help)) {
+  }
+
+  // Series for `labels`, created on first use; the handle stays valid for the life of the family
+  [[nodiscard]] std::shared_ptr<Metric> WithLabels(const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& series = series_[labels];
+    if (!series) {
+      series = std::make_shared<Metric>();
+    }
+    return series;
+  }
+
+  // Call `fn(labels, metric)` for every series in label order
+  template <typename Fn>
+  void ForEach(Fn&& fn) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [labels, metric] : series_) {
+      fn(labels, *metric);
+    }
+  }
+
+  // Metric name
+  [[nodiscard]] const std::string& Name() const noexcept {
+    return name_;
+  }
+
+  // Help text
+  [[nodiscard]] const std::string& Help() const noexcept {
+    return help_;
+  }
+
+private:
+  std::string name_;
+  std::string help_;
+  mutable std::mutex mutex_;
+  std::map<MetricLabels, std::shared_ptr<Metric>> series_;
+};
 
 // Simple metrics registry without external dependencies
 class MetricsRegistry {
 public:
+  // Quantiles exported for every histogram
+  static constexpr std::array<double, 4> kExportedQuantiles = {0.5, 0.9, 0.99, 0.999};
+
   // Get singleton instance
   static MetricsRegistry& Instance();
 
+  // Family of histograms named `name`, created on first use (later calls ignore `help`)
+  [[nodiscard]] std::shared_ptr<MetricFamily<Histogram>> HistogramFamily(const std::string& name,
+                                                                         const std::string& help);
+
+  // Family of counters named `name`, created on first use
+  [[nodiscard]] std::shared_ptr<MetricFamily<Counter>> CounterFamily(const std::string& name, const std::string& help);
+
+  // Family of gauges named `name`, created on first use
+  [[nodiscard]] std::shared_ptr<MetricFamily<Gauge>> GaugeFamily(const std::string& name, const std::string& help);
+
   // Create a histogram with standard latency buckets
-  [[nodiscard]] std::shared_ptr<SimpleHistogram> CreateLatencyHistogram(
-      const std::string& name, const std::string& help, const std::map<std::string, std::string>& labels = {});
+  [[nodiscard]] std::shared_ptr<Histogram> CreateLatencyHistogram(const std::string& name, const std::string& help,
+                                                                  const MetricLabels& labels = {});
 
   // Create a counter
-  [[nodiscard]] std::shared_ptr<SimpleCounter> CreateCounter(const std::string& name, const std::string& help,
-                                                             const std::map<std::string, std::string>& labels = {});
+  [[nodiscard]] std::shared_ptr<Counter> CreateCounter(const std::string& name, const std::string& help,
+                                                       const MetricLabels& labels = {});
 
   // Create a gauge
-  [[nodiscard]] std::shared_ptr<SimpleGauge> CreateGauge(const std::string& name, const std::string& help,
-                                                         const std::map<std::string, std::string>& labels = {});
+  [[nodiscard]] std::shared_ptr<Gauge> CreateGauge(const std::string& name, const std::string& help,
+                                                   const MetricLabels& labels = {});
+
+  // Every series in the Prometheus text exposition format. Histograms are exported as summaries with
+  // kExportedQuantiles, since their log-linear buckets do not map onto fixed Prometheus buckets.
+  [[nodiscard]] std::string RenderPrometheus() const;
 
 private:
   MetricsRegistry() = default;
   mutable std::mutex mutex_;
-  std::unordered_map<std::string, std::shared_ptr<SimpleHistogram>> histograms_;
-  std::unordered_map<std::string, std::shared_ptr<SimpleCounter>> counters_;
-  std::unordered_map<std::string, std::shared_ptr<SimpleGauge>> gauges_;
+  std::map<std::string, std::shared_ptr<MetricFamily<Histogram>>> histograms_;
+  std::map<std::string, std::shared_ptr<MetricFamily<Counter>>> counters_;
+  std::map<std::string, std::shared_ptr<MetricFamily<Gauge>>> gauges_;
 };
 
 // RAII timer for measuring latency
 class ScopedTimer {
 public:
-  ScopedTimer(std::shared_ptr<SimpleHistogram> histogram);
+  ScopedTimer(std::shared_ptr<Histogram> histogram);
   ~ScopedTimer();
 
 private:
-  std::shared_ptr<SimpleHistogram> histogram_;
+  std::shared_ptr<Histogram> histogram_;
   std::chrono::steady_clock::time_point start_time_;
 };
 
-// Convenience macros for metrics
-#define STREAMIT_METRICS_LATENCY_HISTOGRAM(name, help, labels)                                                         \
-  streamit::common::MetricsRegistry::Instance().CreateLatencyHistogram(name, help, labels)
+// Convenience macros for metrics (variadic so braced label lists with commas pass through)
+#define STREAMIT_METRICS_LATENCY_HISTOGRAM(name, help, ...)                                                            \
+  streamit::common::MetricsRegistry::Instance().CreateLatencyHistogram(name, help, __VA_ARGS__)
 
-#define STREAMIT_METRICS_COUNTER(name, help, labels)                                                                   \
-  streamit::common::MetricsRegistry::Instance().CreateCounter(name, help, labels)
+#define STREAMIT_METRICS_COUNTER(name, help, ...)                                                                      \
+  streamit::common::MetricsRegistry::Instance().CreateCounter(name, help, __VA_ARGS__)
 
-#define STREAMIT_METRICS_GAUGE(name, help, labels)                                                                     \
-  streamit::common::MetricsRegistry::Instance().CreateGauge(name, help, labels)
+#define STREAMIT_METRICS_GAUGE(name, help, ...)                                                                        \
+  streamit::common::MetricsRegistry::Instance().CreateGauge(name, help, __VA_ARGS__)
 
 #define STREAMIT_METRICS_TIMER(histogram) streamit::common::ScopedTimer timer(histogram)
 
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace streamit::common {
+
+// Bounded multi-producer multi-consumer queue (Dmitry Vyukov's design). Each cell carries a sequence number that
+// tells producers and consumers whether it is free or full for their lap, so a push or pop is one CAS on the
+// position plus one store to the cell, and never takes a lock. `T` must be default-constructible and movable.
+template <typename T>
+class MpmcQueue {
+public:
+  // Constructor (capacity is rounded up to a power of two, at least 2)
+  explicit MpmcQueue(size_t capacity)
+      : capacity_(std::bit_ceil(capacity < 2 ? size_t{2} : capacity)), mask_(capacity_ - 1),
+        cells_(std::make_unique<Cell[]>(capacity_)) {
+    for (size_t i = 0; i < capacity_; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Non-copyable, non-movable
+  MpmcQueue(const MpmcQueue&) = delete;
+  MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+  // Append `value`; false (and `value` left untouched) if the queue is full
+  [[nodiscard]] bool TryPush(T&& value) noexcept(std::is_nothrow_move_assignable_v<T>) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false; // The consumer has not freed this cell since the previous lap
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->value = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Remove the oldest value into `value`; false if the queue is empty
+  [[nodiscard]] bool TryPop(T& value) noexcept(std::is_nothrow_move_assignable_v<T>) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false; // No producer has filled this cell yet
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    value = std::move(cell->value);
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Whether the next pop would find nothing (a hint only while producers are running)
+  [[nodiscard]] bool Empty() const noexcept {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    return cells_[pos & mask_].sequence.load(std::memory_order_acquire) != pos + 1;
+  }
+
+  // Maximum number of queued values
+  [[nodiscard]] size_t Capacity() const noexcept {
+    return capacity_;
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence{0};
+    T value{};
+  };
+
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+
+  // Producers and consumers each get their own cache line
+  alignas(64) std::atomic<size_t> enqueue_pos_{0};
+  alignas(64) std::atomic<size_t> dequeue_pos_{0};
+};
+
+} // namespace streamit::common
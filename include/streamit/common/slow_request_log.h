@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace streamit::common {
+
+// One request that took longer than the slow-request threshold
+struct SlowRequest {
+  std::string type; // "produce" or "fetch"
+  std::string trace_id;
+  std::string topic;
+  int32_t partition = 0;
+  int64_t bytes = 0;
+  int64_t records = 0;
+  std::chrono::system_clock::time_point finished_at;
+  std::chrono::nanoseconds total{0};
+
+  // Time per stage, in the order the stages ran (see StageTimer::MarkedStages); lock waits are stages too
+  std::vector<std::pair<std::string_view, std::chrono::nanoseconds>> stages;
+};
+
+// Bounded log of the slowest recent requests, for chasing tail latency that aggregate histograms hide.
+// Requests over the threshold are sampled (one in `sample_one_in`) into a ring buffer that keeps the latest
+// `capacity` entries. Checking the threshold is lock-free; only recording a slow request takes the lock.
+class SlowRequestLog {
+public:
+  // Constructor (a zero threshold or capacity disables the log)
+  SlowRequestLog(std::chrono::nanoseconds threshold, size_t capacity, uint32_t sample_one_in = 1);
+
+  // Whether a request that took `total` should be recorded (call before building the entry)
+  [[nodiscard]] bool ShouldRecord(std::chrono::nanoseconds total) noexcept;
+
+  // Add an entry, overwriting the oldest once the buffer is full
+  void Record(SlowRequest request);
+
+  // Entries currently held, oldest first
+  [[nodiscard]] std::vector<SlowRequest> Entries() const;
+
+  // Entries as a JSON array, one object per line
+  [[nodiscard]] std::string RenderJson() const;
+
+  // Requests over the threshold, sampled or not
+  [[nodiscard]] int64_t SlowCount() const noexcept;
+
+private:
+  std::chrono::nanoseconds threshold_;
+  size_t capacity_;
+  uint32_t sample_one_in_;
+  std::atomic<int64_t> slow_count_{0};
+
+  mutable std::mutex mutex_;
+  std::vector<SlowRequest> entries_; // Guarded by mutex_
+  size_t next_ = 0;                  // Guarded by mutex_; slot the next entry goes to
+};
+
+} // namespace streamit::common
@@ -0,0 +1,237 @@
+#pragma once
+
+#include "streamit/common/mpmc_queue.h"
+#include <absl/status/status.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fmt/format.h>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace streamit::common {
+
+// Next value of the calling thread's generator (splitmix64, seeded once per thread; never locks)
+[[nodiscard]] uint64_t ThreadLocalRandom() noexcept;
+
+// 128-bit W3C trace id, stored inline so it can be copied into every log call and span for free
+struct TraceId {
+  uint64_t high = 0;
+  uint64_t low = 0;
+
+  // Random non-zero id
+  [[nodiscard]] static TraceId Generate() noexcept;
+
+  // Parse 1 to 32 hex digits (shorter ids fill the low bits); nullopt if malformed or all zero
+  [[nodiscard]] static std::optional<TraceId> FromHex(std::string_view hex) noexcept;
+
+  // All-zero ids are invalid
+  [[nodiscard]] bool IsValid() const noexcept {
+    return high != 0 || low != 0;
+  }
+
+  // 32 lowercase hex digits
+  [[nodiscard]] std::array<char, 32> Hex() const noexcept;
+  [[nodiscard]] std::string ToString() const;
+
+  friend bool operator==(const TraceId&, const TraceId&) = default;
+};
+
+// Position of one span in a trace
+struct SpanContext {
+  TraceId trace_id;
+  uint64_t span_id = 0;
+  bool sampled = true; // W3C trace-flags bit 0; unsampled spans are not exported
+
+  [[nodiscard]] bool IsValid() const noexcept {
+    return trace_id.IsValid() && span_id != 0;
+  }
+};
+
+// Parse a W3C `traceparent` header ("00-<trace id>-<span id>-<flags>"); nullopt if malformed
+[[nodiscard]] std::optional<SpanContext> ParseTraceparent(std::string_view header) noexcept;
+
+// `context` as a version 00 `traceparent` header
+[[nodiscard]] std::string FormatTraceparent(const SpanContext& context);
+
+// One attribute of a span; keys are string literals
+struct SpanAttribute {
+  std::string_view key;
+  std::variant<int64_t, std::string> value;
+};
+
+// A finished span as handed to the exporter
+struct SpanRecord {
+  static constexpr size_t kMaxAttributes = 6;
+
+  TraceId trace_id;
+  uint64_t span_id = 0;
+  uint64_t parent_span_id = 0; // 0 for the root of a trace
+  std::string_view name;       // String literal
+  int64_t start_unix_nanos = 0;
+  int64_t end_unix_nanos = 0;
+  std::array<SpanAttribute, kMaxAttributes> attributes;
+  size_t attribute_count = 0;
+  bool error = false;
+  std::string status_message;
+};
+
+// Spans of one or more batches in the OTLP/JSON ExportTraceServiceRequest format
+[[nodiscard]] std::string RenderOtlpJson(const std::vector<SpanRecord>& spans, std::string_view service_name);
+
+// Destination for batches of finished spans; called from the exporter thread only
+class SpanSink {
+public:
+  virtual ~SpanSink() = default;
+
+  // Write one batch
+  [[nodiscard]] virtual absl::Status Export(const std::vector<SpanRecord>& spans) = 0;
+};
+
+// Appends each batch to a local file as one line of OTLP/JSON
+class FileSpanSink final : public SpanSink {
+public:
+  // Constructor
+  FileSpanSink(std::string path, std::string service_name);
+
+  [[nodiscard]] absl::Status Export(const std::vector<SpanRecord>& spans) override;
+
+private:
+  std::string path_;
+  std::string service_name_;
+  std::ofstream out_;
+};
+
+// POSTs each batch as OTLP/JSON to a collector's HTTP receiver (`<host>:<port>/v1/traces`, usually port 4318)
+class OtlpHttpSpanSink final : public SpanSink {
+public:
+  // Constructor
+  OtlpHttpSpanSink(std::string host, uint16_t port, std::string service_name);
+
+  [[nodiscard]] absl::Status Export(const std::vector<SpanRecord>& spans) override;
+
+private:
+  std::string host_;
+  uint16_t port_;
+  std::string service_name_;
+};
+
+// Tunables for span export
+struct SpanExporterOptions {
+  // Finished spans buffered before new ones are dropped
+  size_t queue_capacity = 65536;
+
+  // Spans per sink call; a full batch wakes the exporter early
+  size_t max_batch = 512;
+
+  // Longest a finished span waits before it is exported
+  std::chrono::milliseconds interval{1000};
+};
+
+// Collects finished spans on a lock-free queue and exports them in batches from one background thread, so ending a
+// span costs the caller one queue push. Spans are dropped (and counted) rather than blocking when the queue is full.
+class SpanExporter {
+public:
+  // Constructor; starts the export thread
+  SpanExporter(std::unique_ptr<SpanSink> sink, SpanExporterOptions options = {});
+
+  // Exports what is queued and stops the thread
+  ~SpanExporter();
+
+  // Non-copyable, non-movable
+  SpanExporter(const SpanExporter&) = delete;
+  SpanExporter& operator=(const SpanExporter&) = delete;
+
+  // Queue a finished span
+  void Export(SpanRecord span) noexcept;
+
+  // Export everything queued and stop the thread (idempotent; later spans are dropped)
+  void Stop();
+
+  // Spans handed to the sink, and spans lost to a full queue or a failing sink
+  [[nodiscard]] int64_t Exported() const noexcept;
+  [[nodiscard]] int64_t Dropped() const noexcept;
+
+private:
+  // Export thread body
+  void Run();
+
+  // Pop and export up to max_batch spans; returns how many were popped
+  size_t ExportBatch(std::vector<SpanRecord>& batch);
+
+  std::unique_ptr<SpanSink> sink_;
+  SpanExporterOptions options_;
+  MpmcQueue<SpanRecord> queue_;
+  std::atomic<int64_t> pending_{0};
+  std::atomic<int64_t> exported_{0};
+  std::atomic<int64_t> dropped_{0};
+  std::atomic<bool> stopping_{false};
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::thread thread_;
+};
+
+// Timed operation within a trace. Starts on construction and ends (and is exported) on End or destruction.
+// Not thread-safe, but may move between threads with the request it times.
+class Span {
+public:
+  // Start a span named `name` (a string literal), child of `parent` if valid, in `parent`'s trace without a parent
+  // span if only its trace id is set, and otherwise the root of a new trace. With a null exporter the span still has
+  // ids for propagation and logs but is never exported.
+  Span(std::string_view name, const SpanContext& parent, SpanExporter* exporter) noexcept;
+
+  // Ends the span
+  ~Span();
+
+  // Movable so a coroutine can take ownership
+  Span(Span&& other) noexcept;
+  Span& operator=(Span&&) = delete;
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+
+  // Attach an attribute (ignored past SpanRecord::kMaxAttributes)
+  void SetAttribute(std::string_view key, int64_t value);
+  void SetAttribute(std::string_view key, std::string value);
+
+  // Mark the span failed
+  void SetError(std::string message);
+
+  // This span's ids, for child spans and propagation
+  [[nodiscard]] const SpanContext& Context() const noexcept {
+    return context_;
+  }
+
+  // Stamp the end time and export (only the first call has an effect)
+  void End() noexcept;
+
+private:
+  SpanContext context_;
+  SpanRecord record_;
+  SpanExporter* exporter_;
+  bool ended_ = false;
+};
+
+} // namespace streamit::common
+
+// Trace ids format as 32 hex digits without allocating (nothing for an invalid id)
+template <>
+struct fmt::formatter<streamit::common::TraceId> : fmt::formatter<fmt::string_view> {
+  template <typename FormatContext>
+  auto format(const streamit::common::TraceId& id, FormatContext& ctx) const {
+    if (!id.IsValid()) {
+      return fmt::formatter<fmt::string_view>::format(fmt::string_view(), ctx);
+    }
+    auto hex = id.Hex();
+    return fmt::formatter<fmt::string_view>::format(fmt::string_view(hex.data(), hex.size()), ctx);
+  }
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "streamit/common/metrics.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace streamit::common {
+
+// Histograms of one request type, one per stage. `Stage` is an enum whose last enumerator is kCount.
+template <typename Stage>
+struct StageHistograms {
+  static constexpr size_t kStages = static_cast<size_t>(Stage::kCount);
+
+  std::array<std::shared_ptr<Histogram>, kStages> stages;
+  std::array<std::string_view, kStages> names;
+
+  // Series of `family` labelled stage=`names[i]` (the names must be string literals or otherwise outlive this)
+  StageHistograms(MetricFamily<Histogram>& family, const std::array<std::string_view, kStages>& stage_names)
+      : names(stage_names) {
+    for (size_t i = 0; i < kStages; ++i) {
+      stages[i] = family.WithLabels({{"stage", std::string(names[i])}});
+    }
+  }
+};
+
+// Splits one request's latency into stages. Each Mark attributes the time since the previous mark (or since
+// construction) to a stage; a stage may be marked more than once and its time adds up. On destruction every
+// marked stage is recorded in nanoseconds. Timing uses steady_clock, which is a vDSO read of the TSC on Linux.
+// Not thread-safe, but a coroutine may mark from whichever thread it resumes on.
+template <typename Stage>
+class StageTimer {
+public:
+  using Clock = std::chrono::steady_clock;
+  static constexpr size_t kStages = StageHistograms<Stage>::kStages;
+
+  // Constructor; `histograms` must outlive the timer
+  explicit StageTimer(const StageHistograms<Stage>& histograms) noexcept
+      : histograms_(histograms), start_(Clock::now()), last_(start_) {
+  }
+
+  // Records the marked stages
+  ~StageTimer() {
+    for (size_t i = 0; i < kStages; ++i) {
+      if (marked_[i]) {
+        histograms_.stages[i]->Record(elapsed_[i].count());
+      }
+    }
+  }
+
+  // Non-copyable, non-movable
+  StageTimer(const StageTimer&) = delete;
+  StageTimer& operator=(const StageTimer&) = delete;
+
+  // Attribute the time since the previous mark to `stage`
+  void Mark(Stage stage) noexcept {
+    auto now = Clock::now();
+    auto index = static_cast<size_t>(stage);
+    elapsed_[index] += now - last_;
+    marked_[index] = true;
+    last_ = now;
+  }
+
+  // Time attributed to `stage` so far
+  [[nodiscard]] std::chrono::nanoseconds Elapsed(Stage stage) const noexcept {
+    return elapsed_[static_cast<size_t>(stage)];
+  }
+
+  // Name and time of every marked stage, in enum order
+  [[nodiscard]] std::vector<std::pair<std::string_view, std::chrono::nanoseconds>> MarkedStages() const {
+    std::vector<std::pair<std::string_view, std::chrono::nanoseconds>> stages;
+    for (size_t i = 0; i < kStages; ++i) {
+      if (marked_[i]) {
+        stages.emplace_back(histograms_.names[i], elapsed_[i]);
+      }
+    }
+    return stages;
+  }
+
+  // Time since construction
+  [[nodiscard]] std::chrono::nanoseconds Total() const noexcept {
+    return Clock::now() - start_;
+  }
+
+private:
+  const StageHistograms<Stage>& histograms_;
+  Clock::time_point start_;
+  Clock::time_point last_;
+  std::array<std::chrono::nanoseconds, kStages> elapsed_{};
+  std::array<bool, kStages> marked_{};
+};
+
+} // namespace streamit::common
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace streamit::common {
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+// Transfers control back to the awaiting coroutine when a task completes
+struct FinalAwaiter {
+  bool await_ready() const noexcept {
+    return false;
+  }
+
+  template <typename Promise>
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+    auto continuation = handle.promise().continuation;
+    return continuation ? continuation : std::noop_coroutine();
+  }
+
+  void await_resume() const noexcept {
+  }
+};
+
+// State shared by all task promises
+struct TaskPromiseBase {
+  std::coroutine_handle<> continuation;
+  std::exception_ptr exception;
+
+  std::suspend_always initial_suspend() const noexcept {
+    return {};
+  }
+
+  FinalAwaiter final_suspend() const noexcept {
+    return {};
+  }
+
+  void unhandled_exception() noexcept {
+    exception = std::current_exception();
+  }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+  std::optional<T> value;
+
+  Task<T> get_return_object() noexcept;
+
+  template <typename U>
+  void return_value(U&& result) {
+    value.emplace(std::forward<U>(result));
+  }
+
+  T Take() {
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+    return std::move(*value);
+  }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+  Task<void> get_return_object() noexcept;
+
+  void return_void() noexcept {
+  }
+
+  void Take() {
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+};
+
+// Eagerly started coroutine that owns its own frame
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() noexcept {
+      return {};
+    }
+
+    std::suspend_never initial_suspend() const noexcept {
+      return {};
+    }
+
+    std::suspend_never final_suspend() const noexcept {
+      return {};
+    }
+
+    void return_void() noexcept {
+    }
+
+    void unhandled_exception() noexcept {
+      std::terminate();
+    }
+  };
+};
+
+} // namespace detail
+
+// Lazily started coroutine producing a value of type T.
+// The body runs when the task is first awaited and resumes the awaiter on completion.
+template <typename T>
+class Task {
+public:
+  using promise_type = detail::TaskPromise<T>;
+  using Handle = std::coroutine_handle<promise_type>;
+
+  Task() noexcept = default;
+  explicit Task(Handle handle) noexcept : handle_(handle) {
+  }
+
+  ~Task() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  // Non-copyable, movable
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+  Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {
+  }
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      if (handle_) {
+        handle_.destroy();
+      }
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+
+  // Check if the task has finished running
+  [[nodiscard]] bool Done() const noexcept {
+    return !handle_ || handle_.done();
+  }
+
+  auto operator co_await() && noexcept {
+    struct Awaiter {
+      Handle handle;
+
+      bool await_ready() const noexcept {
+        return !handle || handle.done();
+      }
+
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+
+      T await_resume() {
+        return handle.promise().Take();
+      }
+    };
+    return Awaiter{handle_};
+  }
+
+private:
+  Handle handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+  return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+  return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+} // namespace detail
+
+// Start a task without waiting for it; the coroutine frame frees itself when done
+inline detail::DetachedTask Spawn(Task<void> task) {
+  co_await std::move(task);
+}
+
+// Block the calling thread until the task completes (for tests and tools)
+template <typename T>
+T SyncWait(Task<T> task) {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+  std::exception_ptr exception;
+  std::conditional_t<std::is_void_v<T>, bool, std::optional<T>> result{};
+
+  auto runner = [&]() -> detail::DetachedTask {
+    try {
+      if constexpr (std::is_void_v<T>) {
+        co_await std::move(task);
+      } else {
+        result.emplace(co_await std::move(task));
+      }
+    } catch (...) {
+      exception = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+    cv.notify_one();
+  };
+  runner();
+
+  std::unique_lock<std::mutex> lock(mutex);
+  cv.wait(lock, [&done] { return done; });
+
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+  if constexpr (!std::is_void_v<T>) {
+    return std::move(*result);
+  }
+}
+
+} // namespace streamit::common
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "streamit/common/executor.h"
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace streamit::common {
+
+// Single-threaded timer queue for delayed callbacks and coroutine sleeps
+class TimerService {
+public:
+  using Clock = std::chrono::steady_clock;
+  using TimerId = uint64_t;
+
+  // Constructor (starts the timer thread)
+  TimerService();
+
+  // Destructor (drops pending timers and joins the timer thread)
+  ~TimerService();
+
+  // Non-copyable, non-movable
+  TimerService(const TimerService&) = delete;
+  TimerService& operator=(const TimerService&) = delete;
+
+  // Run a callback on the timer thread after a delay. Callbacks must be cheap;
+  // anything substantial should be posted to an executor.
+  TimerId ScheduleAfter(std::chrono::milliseconds delay, std::function<void()> callback) noexcept;
+
+  // Cancel a pending timer; returns false if it already fired or was cancelled
+  bool Cancel(TimerId id) noexcept;
+
+  // Awaitable that resumes the caller after a delay on the executor it was running on
+  [[nodiscard]] auto SleepFor(std::chrono::milliseconds delay) noexcept {
+    struct SleepAwaiter {
+      TimerService* timers;
+      std::chrono::milliseconds delay;
+
+      bool await_ready() const noexcept {
+        return delay.count() <= 0;
+      }
+
+      void await_suspend(std::coroutine_handle<> handle) noexcept {
+        Executor* executor = Executor::Current();
+        timers->ScheduleAfter(delay, [handle, executor] {
+          if (executor) {
+            executor->Post([handle] { handle.resume(); });
+          } else {
+            handle.resume();
+          }
+        });
+      }
+
+      void await_resume() const noexcept {
+      }
+    };
+    return SleepAwaiter{this, delay};
+  }
+
+  // Stop the timer thread; pending timers never fire
+  void Shutdown() noexcept;
+
+  // Number of pending timers
+  [[nodiscard]] size_t Size() const noexcept;
+
+private:
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::map<std::pair<Clock::time_point, TimerId>, std::function<void()>> timers_;
+  std::unordered_map<TimerId, Clock::time_point> deadlines_;
+  TimerId next_id_;
+  bool stopped_;
+  std::thread thread_;
+
+  // Timer thread loop
+  void Run() noexcept;
+};
+
+} // namespace streamit::common
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace streamit::common {
+
+// Dense broker-wide id for a topic name
+using TopicId = uint32_t;
+
+// A partition addressed by topic id, cheap to copy and hash
+struct TopicPartition {
+  TopicId topic;
+  int32_t partition;
+
+  bool operator==(const TopicPartition& other) const noexcept = default;
+};
+
+// Hash function for TopicPartition
+struct TopicPartitionHash {
+  size_t operator()(const TopicPartition& tp) const noexcept {
+    return std::hash<uint64_t>{}((static_cast<uint64_t>(tp.topic) << 32) | static_cast<uint32_t>(tp.partition));
+  }
+};
+
+// Interns topic names so storage, metrics and idempotency lookups key on a small integer instead of
+// hashing and copying the name on every request. Ids are never reused or released.
+class TopicRegistry {
+public:
+  // Id for a topic name, assigning the next one if the name is new
+  [[nodiscard]] TopicId Intern(std::string_view name);
+
+  // Id for a topic name if it has been interned
+  [[nodiscard]] std::optional<TopicId> Find(std::string_view name) const noexcept;
+
+  // Name of an interned topic (the reference stays valid for the registry's lifetime)
+  [[nodiscard]] const std::string& Name(TopicId id) const noexcept;
+
+  // Number of interned topics
+  [[nodiscard]] size_t Size() const noexcept;
+
+private:
+  // Transparent hash so lookups by string_view do not allocate
+  struct NameHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view name) const noexcept {
+      return std::hash<std::string_view>{}(name);
+    }
+  };
+
+  std::unordered_map<std::string, TopicId, NameHash, std::equal_to<>> ids_;
+  std::deque<std::string> names_; // Indexed by id; a deque keeps references stable as it grows
+  mutable std::shared_mutex mutex_;
+};
+
+} // namespace streamit::common
@@ -1,69 +1,147 @@
 #pragma once
 
-#include <iomanip>
-#include <random>
-#include <sstream>
+#include "streamit/common/async_logger.h"
+#include "streamit/common/span.h"
+#include <atomic>
+#include <cstdint>
+#include <fmt/format.h>
+#include <grpcpp/grpcpp.h>
+#include <iterator>
+#include <spdlog/spdlog.h>
 #include <string>
 
 namespace streamit::common {
 
-// Trace context for request tracing
+// Trace context propagation over gRPC metadata
 class TraceContext {
 public:
-  // Generate a new trace ID
-  [[nodiscard]] static std::string GenerateTraceId() noexcept;
+  // Generate a new trace ID (thread-local generator, safe under concurrent RPCs)
+  [[nodiscard]] static TraceId GenerateTraceId() noexcept;
 
-  // Extract trace ID from gRPC metadata
-  [[nodiscard]] static std::string ExtractTraceId(const grpc::ServerContext* context) noexcept;
+  // Caller's span from the W3C `traceparent` metadata, or a bare trace id from the legacy `x-trace-id`;
+  // invalid (so the server span starts a new trace) if neither is present and well-formed
+  [[nodiscard]] static SpanContext Extract(const grpc::ServerContextBase* context) noexcept;
 
-  // Set trace ID in gRPC metadata
-  static void SetTraceId(grpc::ServerContext* context, const std::string& trace_id) noexcept;
-
-private:
-  static std::random_device rd_;
-  static std::mt19937_64 gen_;
-  static std::uniform_int_distribution<uint64_t> dis_;
+  // Return `span` to the caller as `traceparent` initial metadata, and its trace id as `x-trace-id`
+  static void Inject(grpc::ServerContextBase* context, const SpanContext& span) noexcept;
 };
 
-// Structured logger with trace context
+// Structured logger with trace context. Messages are formatted on the calling thread and written by an
+// AsyncLogger, so a log call never waits on console or file I/O. The level check is one atomic load.
 class StructuredLogger {
 public:
-  // Initialize structured logging
-  static void Initialize(const std::string& level = "info");
+  // Initialize structured logging. Per-request logs (STREAMIT_LOG_SAMPLED) are written one in
+  // `request_sample_one_in` at info level, and all of them at debug level.
+  static void Initialize(const std::string& level = "info", uint32_t request_sample_one_in = 1,
+                         size_t queue_capacity = AsyncLogger::kDefaultCapacity);
+
+  // Write out queued messages and stop the writer thread; later messages are written synchronously
+  static void Shutdown();
+
+  // Whether messages at `level` are written
+  [[nodiscard]] static bool ShouldLog(spdlog::level::level_enum level) noexcept {
+    return level >= level_.load(std::memory_order_relaxed);
+  }
 
   // Log with trace context
   template <typename... Args>
-  static void LogWithTrace(const std::string& trace_id, spdlog::level::level_enum level, const std::string& message,
+  static void LogWithTrace(const TraceId& trace_id, spdlog::level::level_enum level, const std::string& message,
                            Args&&... args) {
-    auto logger = spdlog::get("streamit");
-    if (logger) {
-      logger->log(level, "[trace_id={}] {}", trace_id, message, std::forward<Args>(args)...);
+    if (ShouldLog(level)) {
+      Write(level, Format(trace_id, message, args...));
     }
   }
 
   // Log info with trace
   template <typename... Args>
-  static void Info(const std::string& trace_id, const std::string& message, Args&&... args) {
+  static void Info(const TraceId& trace_id, const std::string& message, Args&&... args) {
     LogWithTrace(trace_id, spdlog::level::info, message, std::forward<Args>(args)...);
   }
 
   // Log error with trace
   template <typename... Args>
-  static void Error(const std::string& trace_id, const std::string& message, Args&&... args) {
+  static void Error(const TraceId& trace_id, const std::string& message, Args&&... args) {
     LogWithTrace(trace_id, spdlog::level::err, message, std::forward<Args>(args)...);
   }
 
   // Log warning with trace
   template <typename... Args>
-  static void Warn(const std::string& trace_id, const std::string& message, Args&&... args) {
+  static void Warn(const TraceId& trace_id, const std::string& message, Args&&... args) {
     LogWithTrace(trace_id, spdlog::level::warn, message, std::forward<Args>(args)...);
   }
 
   // Log debug with trace
   template <typename... Args>
-  static void Debug(const std::string& trace_id, const std::string& message, Args&&... args) {
+  static void Debug(const TraceId& trace_id, const std::string& message, Args&&... args) {
     LogWithTrace(trace_id, spdlog::level::debug, message, std::forward<Args>(args)...);
   }
+
+  // Per-request log: every call at debug level, otherwise one in `request_sample_one_in` calls from the same thread
+  // and call site at info level (see STREAMIT_LOG_SAMPLED)
+  template <typename... Args>
+  static void LogSampled(uint64_t& call_count, const TraceId& trace_id, const std::string& message,
+                         Args&&... args) {
+    if (ShouldLog(spdlog::level::debug)) {
+      Write(spdlog::level::debug, Format(trace_id, message, args...));
+    } else if (ShouldLog(spdlog::level::info) &&
+               call_count++ % request_sample_one_in_.load(std::memory_order_relaxed) == 0) {
+      Write(spdlog::level::info, Format(trace_id, message, args...));
+    }
+  }
+
+  // Rate-limited log (see STREAMIT_LOG_RATE_LIMITED); notes how many messages were held back before this one
+  template <typename... Args>
+  static void LogRateLimited(LogRateLimiter& limiter, spdlog::level::level_enum level, const TraceId& trace_id,
+                             const std::string& message, Args&&... args) {
+    int64_t suppressed = 0;
+    if (!ShouldLog(level) || !limiter.Allow(suppressed)) {
+      return;
+    }
+    auto text = Format(trace_id, message, args...);
+    if (suppressed > 0) {
+      text += fmt::format(" ({} similar messages suppressed)", suppressed);
+    }
+    Write(level, std::move(text));
+  }
+
+private:
+  // "[trace_id=...] " followed by `message` formatted with `args`
+  template <typename... Args>
+  static std::string Format(const TraceId& trace_id, const std::string& message, Args&... args) {
+    fmt::memory_buffer buffer;
+    fmt::format_to(std::back_inserter(buffer), "[trace_id={}] ", trace_id);
+    auto prefix = buffer.size();
+    try {
+      fmt::vformat_to(std::back_inserter(buffer), fmt::string_view(message), fmt::make_format_args(args...));
+    } catch (const fmt::format_error&) {
+      // A malformed format string still gets its text logged
+      buffer.resize(prefix);
+      buffer.append(message.data(), message.data() + message.size());
+    }
+    return fmt::to_string(buffer);
+  }
+
+  // Hand a formatted message to the async writer
+  static void Write(spdlog::level::level_enum level, std::string message) noexcept;
+
+  static std::atomic<spdlog::level::level_enum> level_;
+  static std::atomic<uint32_t> request_sample_one_in_;
 };
 
+// Per-request info log, sampled (see StructuredLogger::LogSampled). Usage:
+//   STREAMIT_LOG_SAMPLED(trace_id, "Produce request: topic={}", topic);
+#define STREAMIT_LOG_SAMPLED(trace_id, ...)                                                                            \
+  do {                                                                                                                 \
+    static thread_local uint64_t streamit_log_sample_count = 0;                                                        \
+    streamit::common::StructuredLogger::LogSampled(streamit_log_sample_count, trace_id, __VA_ARGS__);                  \
+  } while (0)
+
+// Log at most `per_second` messages per second from this call site. Usage:
+//   STREAMIT_LOG_RATE_LIMITED(spdlog::level::err, 10, trace_id, "Validation failed: {}", error);
+#define STREAMIT_LOG_RATE_LIMITED(level, per_second, trace_id, ...)                                                    \
+  do {                                                                                                                 \
+    static streamit::common::LogRateLimiter streamit_log_rate_limiter(per_second);                                     \
+    streamit::common::StructuredLogger::LogRateLimited(streamit_log_rate_limiter, level, trace_id, __VA_ARGS__);       \
+  } while (0)
+
 } // namespace streamit::common
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "streamit/common/instrumented_mutex.h"
 #include "streamit/common/result.h"
 #include <cstdint>
 #include <mutex>
@@ -71,7 +72,7 @@ public:
 private:
   // Topic name -> TopicInfo
   std::unordered_map<std::string, TopicInfo> topics_;
-  mutable std::mutex mutex_;
+  mutable common::InstrumentedMutex mutex_{"topic_manager"};
 
   // Helper to generate partition assignments
   [[nodiscard]] std::vector<PartitionInfo> GeneratePartitionAssignments(const std::string& topic, int32_t partitions,
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "streamit/common/instrumented_mutex.h"
 #include "streamit/common/result.h"
 #include <chrono>
 #include <cstdint>
@@ -98,7 +99,7 @@ private:
 
   // Group ID -> ConsumerGroup
   std::unordered_map<std::string, ConsumerGroup> groups_;
-  mutable std::mutex mutex_;
+  mutable common::InstrumentedMutex mutex_{"consumer_group_manager"};
 
   // Helper to assign partitions to members
   [[nodiscard]] std::unordered_map<std::string, std::vector<PartitionAssignment>> AssignPartitions(
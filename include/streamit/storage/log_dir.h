@@ -1,17 +1,28 @@
 #pragma once
 
+#include "streamit/common/executor.h"
+#include "streamit/common/instrumented_mutex.h"
 #include "streamit/common/result.h"
+#include "streamit/common/topic_registry.h"
+#include "streamit/storage/offset_checkpoint.h"
+#include "streamit/storage/partition.h"
 #include "streamit/storage/segment.h"
+#include <absl/status/status.h>
+#include <atomic>
 #include <cstdint>
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 namespace streamit::storage {
 
-// Log directory management for topics and partitions
+// Log directory management for topics and partitions.
+// Partitions are keyed by interned topic id; the name overloads intern (or look up) the name and forward.
+// The partition map is copy-on-write: lookups load a snapshot without locking, and only creating a partition
+// takes a lock. Hot paths should resolve a Partition once per request and work on it directly.
 class LogDir {
 public:
   // Create a new log directory
@@ -20,28 +31,49 @@ public:
   // Open an existing log directory
   static Result<std::unique_ptr<LogDir>> Open(std::filesystem::path root_path, size_t max_segment_size_bytes);
 
+  // Root directory of the log
+  [[nodiscard]] const std::filesystem::path& RootPath() const noexcept;
+
+  // Registry the broker interns topic names in
+  [[nodiscard]] const std::shared_ptr<common::TopicRegistry>& Topics() const noexcept;
+
+  // Partition state, or nullptr if the partition has no log yet
+  [[nodiscard]] std::shared_ptr<Partition> GetPartition(common::TopicPartition tp) const noexcept;
+
+  // Partition state, creating it (with no segments) if needed
+  [[nodiscard]] std::shared_ptr<Partition> GetOrCreatePartition(common::TopicPartition tp) noexcept;
+
   // Get or create a segment for the given topic and partition
+  [[nodiscard]] Result<std::shared_ptr<Segment>> GetSegment(common::TopicPartition tp) noexcept;
   [[nodiscard]] Result<std::shared_ptr<Segment>> GetSegment(const std::string& topic, int32_t partition) noexcept;
 
-  // Get all segments for a topic and partition
+  // Get all segments for a topic and partition (a copy; prefer Partition::Segments on hot paths)
+  [[nodiscard]] Result<std::vector<std::shared_ptr<Segment>>> GetSegments(common::TopicPartition tp) const noexcept;
   [[nodiscard]] Result<std::vector<std::shared_ptr<Segment>>> GetSegments(const std::string& topic,
                                                                           int32_t partition) const noexcept;
 
   // Get the current active segment for a topic and partition
-  [[nodiscard]] Result<std::shared_ptr<Segment>> GetActiveSegment(const std::string& topic,
-                                                                  int32_t partition) const noexcept;
+  [[nodiscard]] Result<std::shared_ptr<Segment>> GetActiveSegment(common::TopicPartition tp) const noexcept;
 
   // Roll the current segment for a topic and partition
+  [[nodiscard]] Result<std::shared_ptr<Segment>> RollSegment(common::TopicPartition tp) noexcept;
   [[nodiscard]] Result<std::shared_ptr<Segment>> RollSegment(const std::string& topic, int32_t partition) noexcept;
 
   // Get the end offset for a topic and partition
+  [[nodiscard]] Result<int64_t> GetEndOffset(common::TopicPartition tp) const noexcept;
   [[nodiscard]] Result<int64_t> GetEndOffset(const std::string& topic, int32_t partition) const noexcept;
 
   // Get the high water mark for a topic and partition
+  [[nodiscard]] Result<int64_t> GetHighWaterMark(common::TopicPartition tp) const noexcept;
   [[nodiscard]] Result<int64_t> GetHighWaterMark(const std::string& topic, int32_t partition) const noexcept;
 
-  // Set the high water mark for a topic and partition
-  [[nodiscard]] Result<void> SetHighWaterMark(const std::string& topic, int32_t partition, int64_t offset) noexcept;
+  // Set the high water mark for a topic and partition (in memory until the next checkpoint)
+  void SetHighWaterMark(common::TopicPartition tp, int64_t offset) noexcept;
+  void SetHighWaterMark(const std::string& topic, int32_t partition, int64_t offset) noexcept;
+
+  // Write every partition's end offset and high water mark to the checkpoint file in one go. Nothing is written
+  // if no partition changed since the last checkpoint.
+  [[nodiscard]] absl::Status Checkpoint() noexcept;
 
   // List all topics
   [[nodiscard]] std::vector<std::string> ListTopics() const noexcept;
@@ -49,35 +81,42 @@ public:
   // List all partitions for a topic
   [[nodiscard]] Result<std::vector<int32_t>> ListPartitions(const std::string& topic) const noexcept;
 
+  // List every partition of every topic
+  [[nodiscard]] std::vector<common::TopicPartition> ListTopicPartitions() const noexcept;
+
+  // Get the directory path for a topic and partition
+  [[nodiscard]] std::filesystem::path GetPartitionPath(common::TopicPartition tp) const noexcept;
+  [[nodiscard]] std::filesystem::path GetPartitionPath(const std::string& topic, int32_t partition) const noexcept;
+
   // Clean up old segments (retention policy)
-  [[nodiscard]] Result<void> CleanupOldSegments(const std::string& topic, int32_t partition,
+  [[nodiscard]] absl::Status CleanupOldSegments(const std::string& topic, int32_t partition,
                                                 int64_t retention_bytes) noexcept;
 
 private:
+  using PartitionMap =
+      std::unordered_map<common::TopicPartition, std::shared_ptr<Partition>, common::TopicPartitionHash>;
+
   std::filesystem::path root_path_;
   size_t max_segment_size_bytes_;
+  std::shared_ptr<common::TopicRegistry> topics_;
 
-  // Topic -> Partition -> Segments
-  std::unordered_map<std::string, std::unordered_map<int32_t, std::vector<std::shared_ptr<Segment>>>> segments_;
+  // Published partition map; only replaced while create_mutex_ is held
+  std::atomic<std::shared_ptr<const PartitionMap>> partitions_;
+  common::InstrumentedMutex create_mutex_{"log_dir_create"};
 
-  // Topic -> Partition -> High Water Mark
-  std::unordered_map<std::string, std::unordered_map<int32_t, int64_t>> high_water_marks_;
+  // Offsets persisted by the last checkpoint
+  OffsetCheckpoint checkpoint_;
+  std::vector<PartitionOffsets> last_checkpoint_;
+  common::InstrumentedMutex checkpoint_mutex_{"log_dir_checkpoint"};
 
-  // Mutex for thread safety
-  mutable std::mutex mutex_;
-
-  // Get the directory path for a topic and partition
-  [[nodiscard]] std::filesystem::path GetPartitionPath(const std::string& topic, int32_t partition) const noexcept;
+  // Creates spare segments ahead of rolls; declared last so it drains before the partitions go away
+  common::Executor roll_executor_;
 
   // Load existing segments for a topic and partition
-  [[nodiscard]] Result<void> LoadSegments(const std::string& topic, int32_t partition) noexcept;
-
-  // Create a new segment for a topic and partition
-  [[nodiscard]] Result<std::shared_ptr<Segment>> CreateSegment(const std::string& topic, int32_t partition,
-                                                               int64_t base_offset) noexcept;
+  [[nodiscard]] absl::Status LoadPartition(common::TopicPartition tp) noexcept;
 
-  // Get the next segment number for a topic and partition
-  [[nodiscard]] int64_t GetNextSegmentNumber(const std::string& topic, int32_t partition) const noexcept;
+  // Restore high water marks from the checkpoint after the partitions are loaded
+  void RestoreCheckpoint() noexcept;
 };
 
 } // namespace streamit::storage
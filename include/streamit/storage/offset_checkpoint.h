@@ -0,0 +1,43 @@
+#pragma once
+
+#include "streamit/common/result.h"
+#include <absl/status/status.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace streamit::storage {
+
+// Offsets of one partition as of a checkpoint
+struct PartitionOffsets {
+  std::string topic;
+  int32_t partition = 0;
+  int64_t next_offset = 0;
+  int64_t high_watermark = 0;
+
+  bool operator==(const PartitionOffsets& other) const noexcept = default;
+};
+
+// One file holding the offsets of every partition in a log directory. It is written in the background at an
+// interval, replacing the per-partition manifest and high water mark files that were rewritten on every produce.
+class OffsetCheckpoint {
+public:
+  // Checkpoint file kept in the log directory root
+  static constexpr std::string_view kFileName = "offset_checkpoint";
+
+  // Constructor
+  explicit OffsetCheckpoint(std::filesystem::path path);
+
+  // Replace the checkpoint (via a temporary file, fsync and rename, so a crash leaves the old or the new one)
+  [[nodiscard]] absl::Status Write(const std::vector<PartitionOffsets>& offsets) const noexcept;
+
+  // Read the checkpoint; NotFound if there is none, DataLoss if it is damaged
+  [[nodiscard]] common::Result<std::vector<PartitionOffsets>> Read() const noexcept;
+
+private:
+  std::filesystem::path path_;
+};
+
+} // namespace streamit::storage
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "streamit/common/executor.h"
+#include "streamit/common/instrumented_mutex.h"
+#include "streamit/common/result.h"
+#include "streamit/common/topic_registry.h"
+#include "streamit/storage/segment.h"
+#include <absl/status/status.h>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace streamit::storage {
+
+// The log of one topic partition: its segments and high water mark.
+// Readers load an immutable snapshot of the segment list without locking; roll and retention build a new list
+// and publish it under the partition's own mutex, so one busy partition never blocks another.
+// With a background executor, the segment a roll will need is created ahead of time, so appends never wait on
+// file creation and preallocation.
+class Partition : public std::enable_shared_from_this<Partition> {
+public:
+  using SegmentList = std::vector<std::shared_ptr<Segment>>;
+
+  // Where an append landed
+  struct AppendResult {
+    int64_t base_offset;
+    std::shared_ptr<Segment> segment;
+  };
+
+  // Constructor (segments must be in base-offset order; the next roll creates file `next_segment_number`).
+  // Spare segments are created on `background` if given, otherwise a roll creates its segment itself.
+  Partition(common::TopicPartition id, std::filesystem::path path, size_t max_segment_size_bytes,
+            SegmentList segments = {}, int64_t next_segment_number = 0, common::Executor* background = nullptr);
+
+  // Non-copyable, non-movable (shared by pointer)
+  Partition(const Partition&) = delete;
+  Partition& operator=(const Partition&) = delete;
+
+  // Topic id and partition number
+  [[nodiscard]] common::TopicPartition Id() const noexcept;
+
+  // Directory holding this partition's segment files
+  [[nodiscard]] const std::filesystem::path& Path() const noexcept;
+
+  // Segments in base-offset order. The snapshot is never modified; a roll or cleanup publishes a new one.
+  [[nodiscard]] std::shared_ptr<const SegmentList> Segments() const noexcept;
+
+  // Segment holding `offset` (binary search over base offsets), or end() if no segment holds it
+  [[nodiscard]] static SegmentList::const_iterator FindSegment(const SegmentList& segments, int64_t offset) noexcept;
+
+  // Segment to append to, rolling first if there is none or the last one is full or closed
+  [[nodiscard]] common::Result<std::shared_ptr<Segment>> ActiveSegment() noexcept;
+
+  // Append a batch to the active segment. A batch that would overflow it rolls the partition and is retried in the
+  // new segment; only a batch larger than a whole segment fails.
+  [[nodiscard]] common::Result<AppendResult> Append(std::span<const Record> records, int64_t producer_id = 0,
+                                                    int64_t sequence = -1) noexcept;
+
+  // Start a new segment at the current end offset
+  [[nodiscard]] common::Result<std::shared_ptr<Segment>> Roll() noexcept;
+
+  // Offset the next appended record will get
+  [[nodiscard]] int64_t EndOffset() const noexcept;
+
+  // Get the high water mark (lock-free)
+  [[nodiscard]] int64_t HighWaterMark() const noexcept;
+
+  // Advance the high water mark; it never moves backwards, so concurrent produces may finish in any order.
+  // Only memory is updated; LogDir::Checkpoint persists it.
+  void SetHighWaterMark(int64_t offset) noexcept;
+
+  // Drop the oldest segments beyond `retention_bytes` (the active segment is always kept)
+  [[nodiscard]] absl::Status Cleanup(int64_t retention_bytes) noexcept;
+
+private:
+  // Rolls an append may trigger before giving up
+  static constexpr int kMaxAppendAttempts = 3;
+
+  common::TopicPartition id_;
+  std::filesystem::path path_;
+  size_t max_segment_size_bytes_;
+  common::Executor* background_;
+
+  // Published segment list; only replaced while mutex_ is held
+  std::atomic<std::shared_ptr<const SegmentList>> segments_;
+
+  // Serialises roll and retention
+  common::InstrumentedMutex mutex_{"partition"};
+  int64_t next_segment_number_; // Guarded by mutex_
+
+  // Segment created ahead of the next roll, and whether one is still being created (both guarded by mutex_)
+  std::shared_ptr<Segment> spare_;
+  bool spare_pending_ = false;
+
+  // Set once a spare is on its way, so appends check the fill level without taking mutex_
+  std::atomic<bool> spare_requested_{false};
+
+  std::atomic<int64_t> high_water_mark_{0};
+
+  // Whether appends should move on from this segment
+  [[nodiscard]] static bool NeedsRoll(const Segment& segment) noexcept;
+
+  // Create the files of segment `number` starting at `base_offset`
+  [[nodiscard]] common::Result<std::shared_ptr<Segment>> CreateSegment(int64_t number, int64_t base_offset) noexcept;
+
+  // Roll unless another appender already rolled past `full`
+  [[nodiscard]] absl::Status RollPast(const Segment& full) noexcept;
+
+  // Start creating a spare on the background executor once `active` is mostly full
+  void MaybePrepareSpare(const Segment& active) noexcept;
+
+  // Background half of MaybePrepareSpare
+  void CreateSpare(int64_t number) noexcept;
+
+  // Publish the next segment, taking over the spare if there is one (mutex_ must be held)
+  [[nodiscard]] common::Result<std::shared_ptr<Segment>> RollLocked() noexcept;
+};
+
+} // namespace streamit::storage
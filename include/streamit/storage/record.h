@@ -35,9 +35,16 @@ struct RecordBatch {
   int64_t timestamp_ms;
   uint32_t crc32;
 
+  // Idempotent producer that wrote the batch (0 and -1 for plain produces), kept in the batch
+  // header so producer state can be rebuilt from the log
+  int64_t producer_id = 0;
+  int64_t sequence = -1;
+
   RecordBatch() = default;
-  RecordBatch(int64_t base_offset, std::vector<Record> records, int64_t timestamp_ms)
-      : base_offset(base_offset), records(std::move(records)), timestamp_ms(timestamp_ms) {
+  RecordBatch(int64_t base_offset, std::vector<Record> records, int64_t timestamp_ms, int64_t producer_id = 0,
+              int64_t sequence = -1)
+      : base_offset(base_offset), records(std::move(records)), timestamp_ms(timestamp_ms), producer_id(producer_id),
+        sequence(sequence) {
     ComputeCrc32();
   }
 
@@ -55,6 +62,10 @@ struct RecordBatch {
 
   // Deserialize from bytes
   [[nodiscard]] static RecordBatch Deserialize(std::span<const std::byte> data);
+
+private:
+  // Serialize everything the CRC covers (all fields but the CRC itself)
+  void SerializeBody(std::vector<std::byte>& data) const;
 };
 
 } // namespace streamit::storage
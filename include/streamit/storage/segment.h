@@ -1,9 +1,11 @@
 #pragma once
 
+#include "streamit/common/instrumented_mutex.h"
 #include "streamit/common/result.h"
 #include "streamit/storage/flush_policy.h"
-#include "streamit/storage/manifest.h"
 #include "streamit/storage/record.h"
+#include <absl/status/status.h>
+#include <atomic>
 #include <cstdint>
 #include <filesystem>
 #include <memory>
@@ -20,7 +22,7 @@ struct SegmentHeader {
   uint32_t version;
 
   static constexpr uint32_t kMagic = 0xDEADBEEF;
-  static constexpr uint32_t kVersion = 1;
+  static constexpr uint32_t kVersion = 2; // 2: batch headers carry producer id and sequence
 };
 
 // Sparse index entry
@@ -38,6 +40,9 @@ struct IndexEntry {
 // Append-only segment for storing record batches
 class Segment {
 public:
+  // Base offset of a segment created ahead of a roll, before its place in the log is known (see Rebase)
+  static constexpr int64_t kUnassignedBaseOffset = -1;
+
   // Create a new segment
   Segment(std::filesystem::path log_path, std::filesystem::path index_path, int64_t base_offset, size_t max_size_bytes,
           FlushPolicy flush_policy = FlushPolicy::OnRoll);
@@ -55,8 +60,13 @@ public:
   Segment(Segment&&) noexcept;
   Segment& operator=(Segment&&) noexcept;
 
-  // Append records to the segment
-  [[nodiscard]] Result<int64_t> Append(std::span<const Record> records) noexcept;
+  // Append records to the segment, tagging the batch with the idempotent producer that wrote it (if any)
+  [[nodiscard]] Result<int64_t> Append(std::span<const Record> records, int64_t producer_id = 0,
+                                       int64_t sequence = -1) noexcept;
+
+  // Move an empty segment to `base_offset`, rewriting its header. Lets a roll take over a segment whose files
+  // were created and preallocated in the background.
+  [[nodiscard]] absl::Status Rebase(int64_t base_offset) noexcept;
 
   // Recover segment from crash (scan tail and truncate if corrupted)
   [[nodiscard]] Result<void> RecoverTail() noexcept;
@@ -76,7 +86,7 @@ public:
   // Set file access patterns for performance
   [[nodiscard]] Result<void> SetAccessPattern(bool sequential_write, bool will_need_read) noexcept;
 
-  // Get the end offset of this segment
+  // Get the end offset of this segment (lock-free; records below it are fully written)
   [[nodiscard]] int64_t EndOffset() const noexcept;
 
   // Get the base offset of this segment
@@ -99,24 +109,23 @@ private:
   std::filesystem::path index_path_;
   int64_t base_offset_;
   size_t max_size_bytes_;
-  int64_t end_offset_;
-  bool closed_;
+  std::atomic<int64_t> end_offset_; // Written under mutex_, read without it
+  std::atomic<bool> closed_;        // Written under mutex_, read without it
   FlushPolicy flush_policy_;
-  std::unique_ptr<ManifestManager> manifest_manager_;
 
   // File handles
   int log_fd_;
   int index_fd_;
 
-  // Current file positions
-  int64_t log_position_;
+  // Current file positions (log_position_ is written under mutex_ and read without it)
+  std::atomic<int64_t> log_position_;
   int64_t index_position_;
 
   // Index entries (in memory for fast access)
   std::vector<IndexEntry> index_entries_;
 
   // Mutex for thread safety
-  mutable std::mutex mutex_;
+  mutable common::InstrumentedMutex mutex_{"segment"};
 
   // Private constructor for opening existing segments
   Segment(std::filesystem::path log_path, std::filesystem::path index_path, int64_t base_offset, size_t max_size_bytes,
@@ -3,132 +3,263 @@
 
 namespace streamit::broker {
 
-BoundedIdempotencyTable::BoundedIdempotencyTable(size_t max_entries, std::chrono::milliseconds ttl)
-    : max_entries_(max_entries), ttl_(ttl) {
+BoundedIdempotencyShard::BoundedIdempotencyShard(size_t max_entries, std::chrono::milliseconds ttl)
+    : max_entries_(max_entries), ttl_(ttl), epoch_(Clock::now()), current_tick_(0) {
+  // Keep the TTL within half a revolution so an entry is normally visited once, when it is due
+  tick_ = std::max<Clock::duration>(std::chrono::milliseconds(1), ttl_ / (kWheelSlots / 2));
 }
 
-bool BoundedIdempotencyTable::IsValidSequence(const ProducerKey& key, int64_t sequence) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+SequenceCheck BoundedIdempotencyShard::CheckSequence(const ProducerKey& key, int64_t sequence) noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
-  // Clean up expired entries first
-  CleanupExpired();
+  auto now = Clock::now();
+  AdvanceWheel(now);
 
   auto it = table_.find(key);
-  if (it == table_.end()) {
-    // New producer, sequence must be 0
-    return sequence == 0;
+  if (it == table_.end() || it->second.deadline <= now) {
+    return SequenceWindow{}.Check(sequence);
   }
 
-  // Check if sequence is strictly increasing
-  return sequence > it->second.last_sequence;
+  // An active producer stays hot even between writes
+  UpdateLRU(&it->second);
+
+  return it->second.state.batches.Check(sequence);
 }
 
-void BoundedIdempotencyTable::UpdateSequence(const ProducerKey& key, int64_t sequence, int64_t offset) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+bool BoundedIdempotencyShard::IsValidSequence(const ProducerKey& key, int64_t sequence) noexcept {
+  return CheckSequence(key, sequence).status == SequenceStatus::kAccept;
+}
 
-  // Clean up expired entries first
-  CleanupExpired();
+void BoundedIdempotencyShard::UpdateSequence(const ProducerKey& key, int64_t sequence, int64_t offset) noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
-  // Check if we need to evict entries
-  while (table_.size() >= max_entries_) {
-    EvictOldest();
-  }
+  auto now = Clock::now();
+  AdvanceWheel(now);
 
-  // Update or create entry
   auto it = table_.find(key);
-  if (it != table_.end()) {
-    it->second.last_sequence = sequence;
-    it->second.last_offset = offset;
-    it->second.timestamp = std::chrono::steady_clock::now();
-    UpdateLRU(key);
+  if (it == table_.end()) {
+    // Check if we need to evict entries
+    while (!table_.empty() && table_.size() >= max_entries_) {
+      EvictOldest();
+    }
+
+    it = table_.try_emplace(key).first;
+    it->second.key = &it->first;
+    PushBack<&Entry::lru_prev, &Entry::lru_next>(lru_, &it->second);
   } else {
-    table_[key] = ProducerState(sequence, offset);
-    lru_queue_.push_back(key);
+    // An expired entry the wheel has not reached yet starts over like a new one
+    if (it->second.deadline <= now) {
+      it->second.state.batches = {};
+    }
+    Unlink<&Entry::wheel_prev, &Entry::wheel_next>(wheel_[it->second.wheel_slot], &it->second);
+    UpdateLRU(&it->second);
   }
+
+  Entry& entry = it->second;
+  entry.state.batches.Record(sequence, offset);
+  entry.state.timestamp = now;
+  entry.deadline = now + ttl_;
+  Schedule(&entry);
 }
 
-int64_t BoundedIdempotencyTable::GetLastSequence(const ProducerKey& key) const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+int64_t BoundedIdempotencyShard::GetLastSequence(const ProducerKey& key) const noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
-  auto it = table_.find(key);
-  if (it == table_.end()) {
-    return -1;
+  const Entry* entry = FindLive(key, Clock::now());
+  return entry ? entry->state.batches.LastSequence() : -1;
+}
+
+int64_t BoundedIdempotencyShard::GetLastOffset(const ProducerKey& key) const noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  const Entry* entry = FindLive(key, Clock::now());
+  return entry ? entry->state.batches.LastOffset() : -1;
+}
+
+void BoundedIdempotencyShard::RemoveProducer(int64_t producer_id) noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  // Remove all entries for this producer (rare admin path, so a scan is acceptable)
+  for (Entry* entry = lru_.head; entry != nullptr;) {
+    Entry* next = entry->lru_next;
+    if (entry->key->producer_id == producer_id) {
+      Erase(entry);
+    }
+    entry = next;
   }
+}
 
-  return it->second.last_sequence;
+size_t BoundedIdempotencyShard::Size() const noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+  return table_.size();
 }
 
-int64_t BoundedIdempotencyTable::GetLastOffset(const ProducerKey& key) const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+void BoundedIdempotencyShard::Clear() noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+  table_.clear();
+  lru_ = {};
+  wheel_.fill({});
+}
+
+void BoundedIdempotencyShard::CleanupExpired() noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+  AdvanceWheel(Clock::now());
+}
+
+void BoundedIdempotencyShard::AdvanceWheel(Clock::time_point now) noexcept {
+  int64_t target_tick = TickOf(now);
+  if (target_tick <= current_tick_) {
+    return;
+  }
 
+  // After a long idle gap one full revolution visits every slot
+  int64_t first_tick = std::max(current_tick_ + 1, target_tick - static_cast<int64_t>(kWheelSlots) + 1);
+  for (int64_t tick = first_tick; tick <= target_tick; ++tick) {
+    EntryList& slot = wheel_[static_cast<size_t>(tick) % kWheelSlots];
+    for (Entry* entry = slot.head; entry != nullptr;) {
+      Entry* next = entry->wheel_next;
+      if (entry->deadline <= now) {
+        Erase(entry);
+      }
+      entry = next;
+    }
+  }
+  current_tick_ = target_tick;
+}
+
+const BoundedIdempotencyShard::Entry* BoundedIdempotencyShard::FindLive(const ProducerKey& key,
+                                                                       Clock::time_point now) const noexcept {
   auto it = table_.find(key);
-  if (it == table_.end()) {
-    return -1;
+  if (it == table_.end() || it->second.deadline <= now) {
+    return nullptr;
   }
+  return &it->second;
+}
 
-  return it->second.last_offset;
+void BoundedIdempotencyShard::Schedule(Entry* entry) noexcept {
+  // Round up so the slot is never visited before the entry is due
+  int64_t tick = std::max(TickOf(entry->deadline) + 1, current_tick_ + 1);
+  entry->wheel_slot = static_cast<size_t>(tick) % kWheelSlots;
+  PushBack<&Entry::wheel_prev, &Entry::wheel_next>(wheel_[entry->wheel_slot], entry);
 }
 
-void BoundedIdempotencyTable::RemoveProducer(const std::string& producer_id) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+void BoundedIdempotencyShard::Erase(Entry* entry) noexcept {
+  Unlink<&Entry::lru_prev, &Entry::lru_next>(lru_, entry);
+  Unlink<&Entry::wheel_prev, &Entry::wheel_next>(wheel_[entry->wheel_slot], entry);
+  table_.erase(*entry->key);
+}
 
-  // Remove all entries for this producer
-  auto it = table_.begin();
-  while (it != table_.end()) {
-    if (it->first.producer_id == producer_id) {
-      // Remove from LRU queue
-      lru_queue_.erase(std::remove(lru_queue_.begin(), lru_queue_.end(), it->first), lru_queue_.end());
+void BoundedIdempotencyShard::EvictOldest() noexcept {
+  if (lru_.head == nullptr) {
+    return;
+  }
 
-      it = table_.erase(it);
-    } else {
-      ++it;
-    }
+  Erase(lru_.head);
+}
+
+void BoundedIdempotencyShard::UpdateLRU(Entry* entry) noexcept {
+  // Move to the tail (most recently used)
+  Unlink<&Entry::lru_prev, &Entry::lru_next>(lru_, entry);
+  PushBack<&Entry::lru_prev, &Entry::lru_next>(lru_, entry);
+}
+
+int64_t BoundedIdempotencyShard::TickOf(Clock::time_point time) const noexcept {
+  return (time - epoch_) / tick_;
+}
+
+template <BoundedIdempotencyShard::Entry* BoundedIdempotencyShard::Entry::*Prev,
+          BoundedIdempotencyShard::Entry* BoundedIdempotencyShard::Entry::*Next>
+void BoundedIdempotencyShard::PushBack(EntryList& list, Entry* entry) noexcept {
+  entry->*Prev = list.tail;
+  entry->*Next = nullptr;
+  if (list.tail) {
+    list.tail->*Next = entry;
+  } else {
+    list.head = entry;
   }
+  list.tail = entry;
 }
 
-size_t BoundedIdempotencyTable::Size() const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return table_.size();
+template <BoundedIdempotencyShard::Entry* BoundedIdempotencyShard::Entry::*Prev,
+          BoundedIdempotencyShard::Entry* BoundedIdempotencyShard::Entry::*Next>
+void BoundedIdempotencyShard::Unlink(EntryList& list, Entry* entry) noexcept {
+  if (entry->*Prev) {
+    (entry->*Prev)->*Next = entry->*Next;
+  } else {
+    list.head = entry->*Next;
+  }
+  if (entry->*Next) {
+    (entry->*Next)->*Prev = entry->*Prev;
+  } else {
+    list.tail = entry->*Prev;
+  }
+  entry->*Prev = nullptr;
+  entry->*Next = nullptr;
 }
 
-void BoundedIdempotencyTable::Clear() noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
-  table_.clear();
-  lru_queue_.clear();
+BoundedIdempotencyTable::BoundedIdempotencyTable(size_t max_entries, std::chrono::milliseconds ttl,
+                                                 size_t num_shards) {
+  num_shards = std::max<size_t>(num_shards, 1);
+  size_t shard_entries = (max_entries + num_shards - 1) / num_shards;
+
+  shards_.reserve(num_shards);
+  for (size_t i = 0; i < num_shards; ++i) {
+    shards_.push_back(std::make_unique<BoundedIdempotencyShard>(shard_entries, ttl));
+  }
 }
 
-void BoundedIdempotencyTable::CleanupExpired() noexcept {
-  auto now = std::chrono::steady_clock::now();
+SequenceCheck BoundedIdempotencyTable::CheckSequence(const ProducerKey& key, int64_t sequence) noexcept {
+  return ShardFor(key).CheckSequence(key, sequence);
+}
 
-  auto it = table_.begin();
-  while (it != table_.end()) {
-    if (it->second.IsExpired(ttl_)) {
-      // Remove from LRU queue
-      lru_queue_.erase(std::remove(lru_queue_.begin(), lru_queue_.end(), it->first), lru_queue_.end());
+bool BoundedIdempotencyTable::IsValidSequence(const ProducerKey& key, int64_t sequence) noexcept {
+  return ShardFor(key).IsValidSequence(key, sequence);
+}
 
-      it = table_.erase(it);
-    } else {
-      ++it;
-    }
+void BoundedIdempotencyTable::UpdateSequence(const ProducerKey& key, int64_t sequence, int64_t offset) noexcept {
+  ShardFor(key).UpdateSequence(key, sequence, offset);
+}
+
+int64_t BoundedIdempotencyTable::GetLastSequence(const ProducerKey& key) const noexcept {
+  return ShardFor(key).GetLastSequence(key);
+}
+
+int64_t BoundedIdempotencyTable::GetLastOffset(const ProducerKey& key) const noexcept {
+  return ShardFor(key).GetLastOffset(key);
+}
+
+void BoundedIdempotencyTable::RemoveProducer(int64_t producer_id) noexcept {
+  for (auto& shard : shards_) {
+    shard->RemoveProducer(producer_id);
   }
 }
 
-void BoundedIdempotencyTable::EvictOldest() noexcept {
-  if (lru_queue_.empty()) {
-    return;
+size_t BoundedIdempotencyTable::Size() const noexcept {
+  size_t total = 0;
+  for (const auto& shard : shards_) {
+    total += shard->Size();
+  }
+  return total;
+}
+
+void BoundedIdempotencyTable::Clear() noexcept {
+  for (auto& shard : shards_) {
+    shard->Clear();
   }
+}
 
-  const auto& oldest_key = lru_queue_.front();
-  table_.erase(oldest_key);
-  lru_queue_.pop_front();
+void BoundedIdempotencyTable::CleanupExpired() noexcept {
+  for (auto& shard : shards_) {
+    shard->CleanupExpired();
+  }
 }
 
-void BoundedIdempotencyTable::UpdateLRU(const ProducerKey& key) noexcept {
-  // Remove from current position
-  lru_queue_.erase(std::remove(lru_queue_.begin(), lru_queue_.end(), key), lru_queue_.end());
+size_t BoundedIdempotencyTable::NumShards() const noexcept {
+  return shards_.size();
+}
 
-  // Add to end (most recently used)
-  lru_queue_.push_back(key);
+BoundedIdempotencyShard& BoundedIdempotencyTable::ShardFor(const ProducerKey& key) const noexcept {
+  return *shards_[ProducerKeyShard(key, shards_.size())];
 }
 
 } // namespace streamit::broker
@@ -1,10 +1,16 @@
 #include "streamit/broker/broker_service.h"
 #include "streamit/common/config.h"
+#include "streamit/common/cpu_profiler.h"
 #include "streamit/common/health_check.h"
 #include "streamit/common/http_health_server.h"
+#include "streamit/common/instrumented_mutex.h"
+#include "streamit/common/metrics.h"
 #include "streamit/common/signal_shutdown.h"
+#include "streamit/common/slow_request_log.h"
+#include "streamit/common/span.h"
 #include "streamit/common/tracing.h"
 #include "streamit/storage/log_dir.h"
+#include <filesystem>
 #include <iostream>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
@@ -56,18 +62,72 @@ int main(int argc, char* argv[]) {
     auto config = streamit::common::ConfigLoader::LoadBrokerConfig(argv[1]);
 
     // Setup structured logging
-    streamit::common::StructuredLogger::Initialize(config.log_level);
+    streamit::common::StructuredLogger::Initialize(config.log_level, config.log_sample_one_in,
+                                                   config.log_queue_capacity);
+    streamit::common::SetLockProfilingMode(streamit::common::ParseLockProfiling(config.lock_profiling));
 
     spdlog::info("Starting StreamIt broker {} on {}:{}", config.id, config.host, config.port);
 
-    // Create log directory
-    auto log_dir = std::make_shared<streamit::storage::LogDir>(config.log_dir, config.max_segment_size_bytes);
+    // Open the log directory, reloading existing partitions so their data survives restarts
+    std::shared_ptr<streamit::storage::LogDir> log_dir;
+    if (std::filesystem::exists(config.log_dir)) {
+      auto open_result = streamit::storage::LogDir::Open(config.log_dir, config.max_segment_size_bytes);
+      if (!open_result.ok()) {
+        spdlog::error("Failed to open log directory {}: {}", config.log_dir, open_result.status().message());
+        return 1;
+      }
+      log_dir = std::move(open_result.value());
+    } else {
+      log_dir = std::make_shared<streamit::storage::LogDir>(config.log_dir, config.max_segment_size_bytes);
+    }
 
     // Create idempotency table
-    auto idempotency_table = std::make_shared<streamit::broker::IdempotencyTable>();
+    auto idempotency_table = std::make_shared<streamit::broker::IdempotencyTable>(config.idempotency_shards);
+
+    // Service options
+    streamit::broker::BrokerServiceOptions options;
+    options.quotas.producer = {config.quota_producer_bytes_per_sec, config.quota_producer_requests_per_sec};
+    options.quotas.client = {config.quota_client_bytes_per_sec, config.quota_client_requests_per_sec};
+    options.quotas.topic = {config.quota_topic_bytes_per_sec, config.quota_topic_requests_per_sec};
+    options.max_inflight_bytes = config.max_inflight_bytes;
+    options.max_inflight_wait = std::chrono::milliseconds(config.max_inflight_wait_ms);
+    options.lanes.produce_threads = config.produce_threads;
+    options.lanes.tail_fetch_threads = config.tail_fetch_threads;
+    options.lanes.catch_up_fetch_threads = config.catch_up_fetch_threads;
+    options.lanes.admin_threads = config.admin_threads;
+    options.lanes.flush_threads = config.flush_threads;
+    options.lanes.tail_fetch_max_lag = config.tail_fetch_max_lag;
+    options.producer_snapshot_interval = std::chrono::milliseconds(config.producer_snapshot_interval_ms);
+    options.checkpoint_interval = std::chrono::milliseconds(config.checkpoint_interval_ms);
+    auto slow_requests = std::make_shared<streamit::common::SlowRequestLog>(
+        std::chrono::milliseconds(config.slow_request_threshold_ms), config.slow_request_log_size,
+        config.slow_request_sample_one_in);
+    options.slow_requests = slow_requests;
+
+    // Request spans, exported in batches to a collector or a local file
+    std::unique_ptr<streamit::common::SpanSink> span_sink;
+    if (!config.trace_otlp_endpoint.empty()) {
+      auto colon = config.trace_otlp_endpoint.rfind(':');
+      auto host = config.trace_otlp_endpoint.substr(0, colon);
+      auto port = colon == std::string::npos ? 4318 : std::stoi(config.trace_otlp_endpoint.substr(colon + 1));
+      span_sink = std::make_unique<streamit::common::OtlpHttpSpanSink>(host, static_cast<uint16_t>(port),
+                                                                      "streamit-broker");
+    } else if (!config.trace_export_path.empty()) {
+      span_sink = std::make_unique<streamit::common::FileSpanSink>(config.trace_export_path, "streamit-broker");
+    }
+    std::shared_ptr<streamit::common::SpanExporter> span_exporter;
+    if (span_sink) {
+      streamit::common::SpanExporterOptions exporter_options;
+      exporter_options.queue_capacity = config.trace_queue_capacity;
+      exporter_options.max_batch = config.trace_export_batch_size;
+      exporter_options.interval = std::chrono::milliseconds(config.trace_export_interval_ms);
+      span_exporter = std::make_shared<streamit::common::SpanExporter>(std::move(span_sink), exporter_options);
+    }
+    options.span_exporter = span_exporter;
 
     // Create and start server
-    g_server = std::make_unique<streamit::broker::BrokerServer>(config.host, config.port, log_dir, idempotency_table);
+    g_server = std::make_unique<streamit::broker::BrokerServer>(config.host, config.port, log_dir, idempotency_table,
+                                                                std::move(options));
 
     if (!g_server->Start()) {
       spdlog::error("Failed to start broker server");
@@ -92,12 +152,35 @@ int main(int argc, char* argv[]) {
     });
 
     // Start health check server
-    g_health_server = std::make_unique<streamit::common::HttpHealthServer>("0.0.0.0", 8081, health_manager);
+    // Health checks run on the broker's admin executor so they answer even while data lanes are saturated
+    g_health_server = std::make_unique<streamit::common::HttpHealthServer>("0.0.0.0", config.metrics_port,
+                                                                           health_manager, g_server->AdminExecutor());
+
+    // Prometheus scrape endpoint on the same port
+    if (config.enable_metrics) {
+      g_health_server->AddHandler("/metrics", [](const streamit::common::HttpRequest&) {
+        return streamit::common::HttpResponse{200, streamit::common::MetricsRegistry::Instance().RenderPrometheus(),
+                                              "text/plain; version=0.0.4"};
+      });
+    }
+
+    // Recent slow requests with their stage timings
+    g_health_server->AddHandler("/admin/slow_requests", [slow_requests](const streamit::common::HttpRequest&) {
+      return streamit::common::HttpResponse{200, slow_requests->RenderJson(), "application/json"};
+    });
+
+    // Wait and hold times per lock site, most contended first
+    g_health_server->AddHandler("/admin/locks", [](const streamit::common::HttpRequest&) {
+      return streamit::common::HttpResponse{200, streamit::common::LockProfiler::RenderJson(), "application/json"};
+    });
+
+    // On-demand CPU profile as folded stacks
+    g_health_server->AddBlockingHandler("/debug/pprof/profile", streamit::common::ServeCpuProfile);
 
     if (!g_health_server->Start()) {
       spdlog::warn("Failed to start health check server");
     } else {
-      spdlog::info("Health check server started on port 8081");
+      spdlog::info("Health check server started on port {}", config.metrics_port);
     }
 
     // Setup signal handlers
@@ -123,7 +206,17 @@ int main(int argc, char* argv[]) {
     server_thread.request_stop();
     server_thread.join();
 
+    // Destroy the servers while spans and logs still have somewhere to go; the health server runs its handlers on
+    // the broker's admin executor, so it goes first
+    g_health_server.reset();
+    g_server.reset();
+
     spdlog::info("Broker server stopped");
+    if (span_exporter) {
+      span_exporter->Stop();
+      spdlog::info("Exported {} spans ({} dropped)", span_exporter->Exported(), span_exporter->Dropped());
+    }
+    streamit::common::StructuredLogger::Shutdown();
     return 0;
 
   } catch (const std::exception& e) {
@@ -1,97 +1,199 @@
 #include "streamit/broker/broker_metrics.h"
+#include <array>
+#include <mutex>
 
 namespace streamit::broker {
 
-BrokerMetrics::BrokerMetrics() {
-  // Initialize produce metrics
-  produce_latency_hist_ =
-      STREAMIT_METRICS_LATENCY_HISTOGRAM("streamit_produce_latency_ms", "Produce request latency in milliseconds", {});
+namespace {
 
-  produce_bytes_counter_ = STREAMIT_METRICS_COUNTER("streamit_bytes_in_total", "Total bytes produced", {});
+auto& Registry() {
+  return common::MetricsRegistry::Instance();
+}
+
+// Label values of the stages, in enum order
+constexpr std::array<std::string_view, static_cast<size_t>(ProduceStage::kCount)> kProduceStageNames = {
+    "validate", "admission", "idempotency_check", "convert", "segment_lookup", "pipeline_wait",
+    "append_lock", "write", "fsync_queue", "fsync", "hwm", "response",
+};
+constexpr std::array<std::string_view, static_cast<size_t>(FetchStage::kCount)> kFetchStageNames = {
+    "validate", "admission", "segment_lookup", "long_poll", "read", "serialize", "response",
+};
+
+} // namespace
+
+template <typename Metric>
+BrokerMetrics::SingleLabelSeries<Metric>::SingleLabelSeries(std::shared_ptr<common::MetricFamily<Metric>> family,
+                                                            std::string label)
+    : family_(std::move(family)), label_(std::move(label)) {
+}
+
+template <typename Metric>
+Metric& BrokerMetrics::SingleLabelSeries<Metric>::Get(std::string_view value) noexcept {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = series_.find(value);
+    if (it != series_.end()) {
+      return *it->second;
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto it = series_.find(value);
+  if (it == series_.end()) {
+    it = series_.emplace(std::string(value), family_->WithLabels({{label_, std::string(value)}})).first;
+  }
+  return *it->second;
+}
+
+BrokerMetrics::BrokerMetrics(std::shared_ptr<const common::TopicRegistry> topics)
+    : topics_(std::move(topics)),
+      produce_latency_(Registry().HistogramFamily("streamit_produce_latency_ns",
+                                                  "Produce request latency in nanoseconds")),
+      bytes_in_(Registry().CounterFamily("streamit_bytes_in_total", "Total bytes produced")),
+      records_in_(Registry().CounterFamily("streamit_records_in_total", "Total records produced")),
+      fetch_latency_(
+          Registry().HistogramFamily("streamit_fetch_latency_ns", "Fetch request latency in nanoseconds")),
+      bytes_out_(Registry().CounterFamily("streamit_bytes_out_total", "Total bytes fetched")),
+      segment_rolls_(Registry().CounterFamily("streamit_segment_rolls_total", "Total segment rolls")),
+      crc_mismatches_(Registry().CounterFamily("streamit_crc_mismatches_total", "Total CRC mismatches")),
+      high_watermark_(Registry().GaugeFamily("streamit_high_watermark", "High water mark offset")),
+      replication_lag_(Registry().GaugeFamily("streamit_replication_lag", "Replication lag in offsets")),
+      throttled_requests_(
+          Registry().CounterFamily("streamit_quota_throttled_total", "Requests rejected by a quota")),
+      throttle_time_(Registry().HistogramFamily("streamit_quota_throttle_time_ms",
+                                                "Back-off returned to throttled clients")),
+      inflight_bytes_gauge_(
+          STREAMIT_METRICS_GAUGE("streamit_inflight_bytes", "Bytes reserved by in-flight requests", {})),
+      inflight_waiters_gauge_(
+          STREAMIT_METRICS_GAUGE("streamit_inflight_waiters", "Requests queued for in-flight memory", {})),
+      memory_rejected_(Registry().CounterFamily("streamit_inflight_rejected_total",
+                                                "Requests rejected by the memory budget"),
+                       "type"),
+      executor_queue_depth_(
+          Registry().GaugeFamily("streamit_executor_queue_depth", "Tasks waiting for an executor thread"),
+          "executor"),
+      queue_wait_(Registry().HistogramFamily("streamit_queue_wait_ns",
+                                             "Time from RPC arrival to executor pickup in nanoseconds"),
+                  "type"),
+      requests_shed_(
+          Registry().CounterFamily("streamit_requests_shed_total", "Requests dropped after their deadline")),
+      produce_stages_(
+          *Registry().HistogramFamily("streamit_produce_stage_ns", "Produce time per stage in nanoseconds"),
+          kProduceStageNames),
+      fetch_stages_(*Registry().HistogramFamily("streamit_fetch_stage_ns", "Fetch time per stage in nanoseconds"),
+                    kFetchStageNames) {
+}
 
-  produce_records_counter_ = STREAMIT_METRICS_COUNTER("streamit_records_in_total", "Total records produced", {});
+const common::StageHistograms<ProduceStage>& BrokerMetrics::ProduceStages() const noexcept {
+  return produce_stages_;
+}
 
-  // Initialize fetch metrics
-  fetch_latency_hist_ =
-      STREAMIT_METRICS_LATENCY_HISTOGRAM("streamit_fetch_latency_ms", "Fetch request latency in milliseconds", {});
+const common::StageHistograms<FetchStage>& BrokerMetrics::FetchStages() const noexcept {
+  return fetch_stages_;
+}
 
-  fetch_bytes_counter_ = STREAMIT_METRICS_COUNTER("streamit_bytes_out_total", "Total bytes fetched", {});
+void BrokerMetrics::RecordProduceLatency(std::string_view ack, common::TopicPartition tp,
+                                         std::chrono::nanoseconds latency) noexcept {
+  auto& metrics = ForPartition(tp);
+  bool quorum = ack == "quorum";
+  auto& slot = quorum ? metrics.produce_latency_quorum : metrics.produce_latency_leader;
+  common::Histogram* histogram = slot.load(std::memory_order_acquire);
+  if (histogram == nullptr) [[unlikely]] {
+    // Racing threads resolve the same series from the family, so either store is fine
+    auto labels = metrics.labels;
+    labels["ack"] = quorum ? "quorum" : "leader";
+    histogram = produce_latency_->WithLabels(labels).get();
+    slot.store(histogram, std::memory_order_release);
+  }
+  histogram->Record(latency.count());
+}
 
-  // Initialize storage metrics
-  segment_rolls_counter_ = STREAMIT_METRICS_COUNTER("streamit_segment_rolls_total", "Total segment rolls", {});
+void BrokerMetrics::RecordProduceBytes(common::TopicPartition tp, int64_t bytes) noexcept {
+  ForPartition(tp).produce_bytes->Increment(bytes);
+}
 
-  crc_mismatches_counter_ = STREAMIT_METRICS_COUNTER("streamit_crc_mismatches_total", "Total CRC mismatches", {});
+void BrokerMetrics::RecordProduceRecords(common::TopicPartition tp, int64_t records) noexcept {
+  ForPartition(tp).produce_records->Increment(records);
+}
 
-  // Initialize high water mark metrics
-  high_watermark_gauge_ = STREAMIT_METRICS_GAUGE("streamit_high_watermark", "High water mark offset", {});
+void BrokerMetrics::RecordFetchLatency(common::TopicPartition tp, std::chrono::nanoseconds latency) noexcept {
+  ForPartition(tp).fetch_latency->Record(latency.count());
+}
 
-  // Initialize replication lag metrics
-  replication_lag_gauge_ = STREAMIT_METRICS_GAUGE("streamit_replication_lag", "Replication lag in offsets", {});
+void BrokerMetrics::RecordFetchBytes(common::TopicPartition tp, int64_t bytes) noexcept {
+  ForPartition(tp).fetch_bytes->Increment(bytes);
 }
 
-void BrokerMetrics::RecordProduceLatency(const std::string& ack, const std::string& topic, int32_t partition,
-                                         double latency_ms) noexcept {
-  auto labels = CreateLabels(topic, partition);
-  labels["ack"] = ack;
+void BrokerMetrics::RecordSegmentRoll(common::TopicPartition tp) noexcept {
+  ForPartition(tp).segment_rolls->Increment();
+}
 
-  // Create a new histogram instance for this specific combination
-  auto hist = STREAMIT_METRICS_LATENCY_HISTOGRAM("streamit_produce_latency_ms",
-                                                 "Produce request latency in milliseconds", labels);
-  hist->Observe(latency_ms);
+void BrokerMetrics::RecordCrcMismatch(common::TopicPartition tp) noexcept {
+  ForPartition(tp).crc_mismatches->Increment();
 }
 
-void BrokerMetrics::RecordProduceBytes(const std::string& topic, int32_t partition, int64_t bytes) noexcept {
-  auto labels = CreateLabels(topic, partition);
-  auto counter = STREAMIT_METRICS_COUNTER("streamit_bytes_in_total", "Total bytes produced", labels);
-  counter->Increment(bytes);
+void BrokerMetrics::SetHighWaterMark(common::TopicPartition tp, int64_t offset) noexcept {
+  ForPartition(tp).high_watermark->Set(static_cast<double>(offset));
 }
 
-void BrokerMetrics::RecordProduceRecords(const std::string& topic, int32_t partition, int64_t records) noexcept {
-  auto labels = CreateLabels(topic, partition);
-  auto counter = STREAMIT_METRICS_COUNTER("streamit_records_in_total", "Total records produced", labels);
-  counter->Increment(records);
+void BrokerMetrics::RecordThrottle(const std::string& type, std::string_view entity, int64_t throttle_ms) noexcept {
+  // Throttling is already the slow path, so the series are looked up each time
+  common::MetricLabels labels{{"type", type}, {"entity", std::string(entity)}};
+  throttled_requests_->WithLabels(labels)->Increment();
+  throttle_time_->WithLabels(labels)->Record(throttle_ms);
 }
 
-void BrokerMetrics::RecordFetchLatency(const std::string& topic, int32_t partition, double latency_ms) noexcept {
-  auto labels = CreateLabels(topic, partition);
-  auto hist =
-      STREAMIT_METRICS_LATENCY_HISTOGRAM("streamit_fetch_latency_ms", "Fetch request latency in milliseconds", labels);
-  hist->Observe(latency_ms);
+void BrokerMetrics::SetInflightBytes(size_t bytes, size_t waiting) noexcept {
+  inflight_bytes_gauge_->Set(static_cast<double>(bytes));
+  inflight_waiters_gauge_->Set(static_cast<double>(waiting));
 }
 
-void BrokerMetrics::RecordFetchBytes(const std::string& topic, int32_t partition, int64_t bytes) noexcept {
-  auto labels = CreateLabels(topic, partition);
-  auto counter = STREAMIT_METRICS_COUNTER("streamit_bytes_out_total", "Total bytes fetched", labels);
-  counter->Increment(bytes);
+void BrokerMetrics::RecordMemoryRejected(std::string_view type) noexcept {
+  memory_rejected_.Get(type).Increment();
 }
 
-void BrokerMetrics::RecordSegmentRoll(const std::string& topic, int32_t partition) noexcept {
-  auto labels = CreateLabels(topic, partition);
-  auto counter = STREAMIT_METRICS_COUNTER("streamit_segment_rolls_total", "Total segment rolls", labels);
-  counter->Increment();
+void BrokerMetrics::SetExecutorQueueDepth(std::string_view executor, size_t depth) noexcept {
+  executor_queue_depth_.Get(executor).Set(static_cast<double>(depth));
 }
 
-void BrokerMetrics::RecordCrcMismatch(const std::string& topic, int32_t partition) noexcept {
-  auto labels = CreateLabels(topic, partition);
-  auto counter = STREAMIT_METRICS_COUNTER("streamit_crc_mismatches_total", "Total CRC mismatches", labels);
-  counter->Increment();
+void BrokerMetrics::RecordQueueWait(std::string_view type, std::chrono::nanoseconds wait) noexcept {
+  queue_wait_.Get(type).Record(wait.count());
 }
 
-void BrokerMetrics::SetHighWaterMark(const std::string& topic, int32_t partition, int64_t offset) noexcept {
-  auto labels = CreateLabels(topic, partition);
-  auto gauge = STREAMIT_METRICS_GAUGE("streamit_high_watermark", "High water mark offset", labels);
-  gauge->Set(offset);
+void BrokerMetrics::RecordShed(std::string_view type, std::string_view stage) noexcept {
+  requests_shed_->WithLabels({{"type", std::string(type)}, {"stage", std::string(stage)}})->Increment();
 }
 
-void BrokerMetrics::SetReplicationLag(const std::string& topic, int32_t partition, int64_t lag) noexcept {
-  auto labels = CreateLabels(topic, partition);
-  auto gauge = STREAMIT_METRICS_GAUGE("streamit_replication_lag", "Replication lag in offsets", labels);
-  gauge->Set(lag);
+void BrokerMetrics::SetReplicationLag(common::TopicPartition tp, int64_t lag) noexcept {
+  ForPartition(tp).replication_lag->Set(static_cast<double>(lag));
 }
 
-std::map<std::string, std::string> BrokerMetrics::CreateLabels(const std::string& topic,
-                                                               int32_t partition) const noexcept {
-  return {{"topic", topic}, {"partition", std::to_string(partition)}};
+BrokerMetrics::PartitionMetrics& BrokerMetrics::ForPartition(common::TopicPartition tp) noexcept {
+  {
+    std::shared_lock<std::shared_mutex> lock(partitions_mutex_);
+    auto it = partitions_.find(tp);
+    if (it != partitions_.end()) {
+      return *it->second;
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(partitions_mutex_);
+  auto& metrics = partitions_[tp];
+  if (!metrics) {
+    common::MetricLabels labels{{"topic", topics_->Name(tp.topic)}, {"partition", std::to_string(tp.partition)}};
+
+    metrics = std::make_unique<PartitionMetrics>();
+    metrics->produce_bytes = bytes_in_->WithLabels(labels);
+    metrics->produce_records = records_in_->WithLabels(labels);
+    metrics->fetch_latency = fetch_latency_->WithLabels(labels);
+    metrics->fetch_bytes = bytes_out_->WithLabels(labels);
+    metrics->segment_rolls = segment_rolls_->WithLabels(labels);
+    metrics->crc_mismatches = crc_mismatches_->WithLabels(labels);
+    metrics->high_watermark = high_watermark_->WithLabels(labels);
+    metrics->replication_lag = replication_lag_->WithLabels(labels);
+    metrics->labels = std::move(labels);
+  }
+  return *metrics;
 }
 
 } // namespace streamit::broker
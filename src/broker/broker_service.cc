@@ -3,228 +3,724 @@
 #include "streamit/broker/broker_metrics.h"
 #include "streamit/common/status.h"
 #include "streamit/common/tracing.h"
+#include <algorithm>
 #include <chrono>
 #include <ctime>
+#include <limits>
+#include <optional>
 #include <grpcpp/grpcpp.h>
 
 namespace streamit::broker {
 
 BrokerServiceImpl::BrokerServiceImpl(std::shared_ptr<storage::LogDir> log_dir,
-                                     std::shared_ptr<IdempotencyTable> idempotency_table)
-    : log_dir_(std::move(log_dir)), idempotency_table_(std::move(idempotency_table)),
-      metrics_(std::make_unique<BrokerMetrics>()) {
+                                     std::shared_ptr<IdempotencyTable> idempotency_table,
+                                     BrokerServiceOptions options)
+    : log_dir_(std::move(log_dir)), topics_(log_dir_->Topics()), idempotency_table_(std::move(idempotency_table)),
+      metrics_(std::make_unique<BrokerMetrics>(topics_)), slow_requests_(std::move(options.slow_requests)),
+      span_exporter_(std::move(options.span_exporter)),
+      produce_quotas_(options.quotas),
+      fetch_quotas_(options.quotas), producer_snapshots_(log_dir_, idempotency_table_),
+      producer_ids_(log_dir_->RootPath() / ProducerIdManager::kFileName),
+      producer_snapshot_interval_(options.producer_snapshot_interval),
+      checkpoint_interval_(options.checkpoint_interval), fetch_waiters_(timers_),
+      sequence_waiters_(*idempotency_table_, timers_), memory_budget_(options.max_inflight_bytes, timers_), max_inflight_wait_(options.max_inflight_wait),
+      lanes_(options.lanes) {
+  // Rebuild idempotency state before serving so retries across a restart are still deduplicated
+  auto recover_result = producer_snapshots_.Recover();
+  if (recover_result.ok()) {
+    streamit::common::StructuredLogger::Info({}, "Recovered producer state: replayed {} batches",
+                                             recover_result.value());
+  } else {
+    streamit::common::StructuredLogger::Error({}, "Failed to recover producer state: {}",
+                                              std::string(recover_result.status().message()));
+  }
+
+  // Ids already in the log must not be handed out again, even if the reservation file was lost
+  auto load_status = producer_ids_.Load();
+  if (!load_status.ok()) {
+    streamit::common::StructuredLogger::Error({}, "Failed to load producer id reservation: {}",
+                                              std::string(load_status.message()));
+  }
+  producer_ids_.Observe(producer_snapshots_.MaxProducerId());
+
+  ScheduleProducerSnapshot();
+  ScheduleCheckpoint();
+}
+
+BrokerServiceImpl::~BrokerServiceImpl() {
+  // Release parked fetches while their executors still run, then stop timers so no expiry fires into a draining
+  // executor
+  BeginShutdown();
+  timers_.Shutdown();
+  lanes_.Shutdown();
+
+  // Nothing is appending any more, so this snapshot lets a clean restart skip replay entirely
+  SnapshotProducerState();
+  CheckpointOffsets();
+}
+
+grpc::ServerUnaryReactor* BrokerServiceImpl::InitProducerId(grpc::CallbackServerContext* context,
+                                                            const streamit::v1::InitProducerIdRequest* /*request*/,
+                                                            streamit::v1::InitProducerIdResponse* response) {
+  auto arrival = std::chrono::steady_clock::now();
+  auto* reactor = context->DefaultReactor();
+  auto span = StartSpan("init_producer_id", context);
+  common::Spawn(
+      RunUnary(RequestClass::kAdmin, context, reactor, arrival, std::move(span), HandleInitProducerId(response)));
+  return reactor;
+}
+
+grpc::ServerUnaryReactor* BrokerServiceImpl::Produce(grpc::CallbackServerContext* context,
+                                                     const streamit::v1::ProduceRequest* request,
+                                                     streamit::v1::ProduceResponse* response) {
+  auto arrival = std::chrono::steady_clock::now();
+  auto* reactor = context->DefaultReactor();
+  auto span = StartSpan("produce", context);
+  span.SetAttribute("topic", request->topic());
+  span.SetAttribute("partition", request->partition());
+  span.SetAttribute("records", request->records_size());
+
+  // Taken before the span moves into the coroutine, since argument evaluation order is unspecified
+  auto trace_id = span.Context().trace_id;
+  common::Spawn(RunUnary(RequestClass::kProduce, context, reactor, arrival, std::move(span),
+                         HandleProduce(context, request, response, trace_id)));
+  return reactor;
+}
+
+grpc::ServerUnaryReactor* BrokerServiceImpl::Fetch(grpc::CallbackServerContext* context,
+                                                   const streamit::v1::FetchRequest* request,
+                                                   streamit::v1::FetchResponse* response) {
+  auto arrival = std::chrono::steady_clock::now();
+  auto* reactor = context->DefaultReactor();
+
+  // Route reads far behind the high water mark to the catch-up lane so backfills cannot delay tail consumers
+  auto hwm_result = log_dir_->GetHighWaterMark(request->topic(), request->partition());
+  auto request_class = lanes_.ClassifyFetch(request->offset(), hwm_result.ok() ? hwm_result.value() : 0);
+
+  auto span = StartSpan("fetch", context);
+  span.SetAttribute("topic", request->topic());
+  span.SetAttribute("partition", request->partition());
+  span.SetAttribute("offset", request->offset());
+
+  auto trace_id = span.Context().trace_id;
+  common::Spawn(RunUnary(request_class, context, reactor, arrival, std::move(span),
+                         HandleFetch(context, request, response, trace_id)));
+  return reactor;
+}
+
+common::Executor& BrokerServiceImpl::AdminExecutor() noexcept {
+  return lanes_.For(RequestClass::kAdmin);
 }
 
-grpc::Status BrokerServiceImpl::Produce(grpc::ServerContext* context, const streamit::v1::ProduceRequest* request,
-                                        streamit::v1::ProduceResponse* response) {
-  auto start_time = std::chrono::steady_clock::now();
+common::Executor& BrokerServiceImpl::LaneExecutor(RequestClass request_class) noexcept {
+  return lanes_.For(request_class);
+}
+
+void BrokerServiceImpl::BeginShutdown() noexcept {
+  fetch_waiters_.Shutdown();
+  sequence_waiters_.Shutdown();
+}
+
+common::Task<void> BrokerServiceImpl::RunUnary(RequestClass request_class, grpc::CallbackServerContext* context,
+                                               grpc::ServerUnaryReactor* reactor,
+                                               std::chrono::steady_clock::time_point arrival, common::Span span,
+                                               common::Task<grpc::Status> handler) {
+  // Leave the gRPC callback thread before doing any storage work
+  co_await lanes_.For(request_class).Schedule();
+  RecordQueueDepths();
+
+  auto type = RequestLanes::Name(request_class);
+  metrics_->RecordQueueWait(type, std::chrono::steady_clock::now() - arrival);
+
+  // The client gave up while the request sat in the queue; the handler is never started
+  if (ShouldShed(context, type, "queue")) {
+    span.SetError("Request deadline expired while queued");
+    span.End();
+    reactor->Finish(grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "Request deadline expired while queued"));
+    co_return;
+  }
+
+  grpc::Status status;
+  try {
+    status = co_await std::move(handler);
+  } catch (const std::exception& e) {
+    status = grpc::Status(grpc::StatusCode::INTERNAL, e.what());
+  }
+
+  // The handler's reservation has been released by now
+  metrics_->SetInflightBytes(memory_budget_.Used(), memory_budget_.Waiting());
+
+  if (!status.ok()) {
+    span.SetError(status.error_message());
+  }
+  span.End();
+  reactor->Finish(status);
+}
+
+common::Task<grpc::Status> BrokerServiceImpl::HandleInitProducerId(streamit::v1::InitProducerIdResponse* response) {
+  // Allocation may write the reservation file, so it stays on the admin lane with other rare calls
+  auto id_result = producer_ids_.Allocate();
+  if (!id_result.ok()) {
+    response->set_error_code(streamit::v1::INTERNAL);
+    response->set_error_message("Failed to allocate producer id: " + std::string(id_result.status().message()));
+    co_return grpc::Status::OK;
+  }
 
-  // Extract trace ID
-  std::string trace_id = streamit::common::TraceContext::ExtractTraceId(context);
+  response->set_producer_id(id_result.value());
+  response->set_error_code(streamit::v1::OK);
+  streamit::common::StructuredLogger::Info({}, "Allocated producer id {}", id_result.value());
+  co_return grpc::Status::OK;
+}
+
+common::Task<grpc::Status> BrokerServiceImpl::HandleProduce(grpc::CallbackServerContext* context,
+                                                            const streamit::v1::ProduceRequest* request,
+                                                            streamit::v1::ProduceResponse* response,
+                                                            common::TraceId trace_id) {
+  common::StageTimer<ProduceStage> timer(metrics_->ProduceStages());
 
-  // Log request
-  streamit::common::StructuredLogger::Info(trace_id, "Produce request: topic={}, partition={}, records={}, ack={}",
-                                           request->topic(), request->partition(), request->records().size(),
-                                           (request->ack() == streamit::v1::ACK_LEADER) ? "leader" : "quorum");
+  // Log request (sampled; every request at debug level)
+  STREAMIT_LOG_SAMPLED(trace_id, "Produce request: topic={}, partition={}, records={}, ack={}", request->topic(),
+                       request->partition(), request->records().size(),
+                       (request->ack() == streamit::v1::ACK_LEADER) ? "leader" : "quorum");
 
   // Validate request
   auto validation_status = ValidateProduceRequest(request);
   if (!validation_status.ok()) {
-    streamit::common::StructuredLogger::Error(trace_id, "Produce validation failed: {}",
-                                              validation_status.error_message());
-    return validation_status;
+    STREAMIT_LOG_RATE_LIMITED(spdlog::level::err, 10, trace_id, "Produce validation failed: {}",
+                              validation_status.error_message());
+    co_return validation_status;
+  }
+  timer.Mark(ProduceStage::kValidate);
+
+  // Everything past this point keys the partition by topic id. A new name is announced to fetches long-polling for
+  // it, which wait by name so that fetching does not assign ids.
+  auto known_topic = topics_->Find(request->topic());
+  common::TopicPartition tp{known_topic ? *known_topic : topics_->Intern(request->topic()), request->partition()};
+  if (!known_topic) {
+    fetch_waiters_.NotifyTopic(request->topic());
+  }
+
+  // Calculate bytes and records
+  int64_t total_bytes = 0;
+  for (const auto& record : request->records()) {
+    total_bytes += record.key().size() + record.value().size();
   }
 
-  // Check idempotency if producer_id is provided
-  if (!request->producer_id().empty()) {
-    ProducerKey key{request->producer_id(), request->topic(), request->partition()};
+  // Enforce quotas before doing any storage work
+  auto quota =
+      produce_quotas_.Acquire(MakeQuotaSubject(context, request->producer_id(), request->topic()), total_bytes);
+  if (quota.Throttled()) {
+    metrics_->RecordThrottle("produce", quota.entity, quota.throttle.count());
+    response->set_error_code(streamit::v1::THROTTLED);
+    response->set_error_message("Produce quota exceeded for " + std::string(quota.entity));
+    response->set_retry_after_ms(static_cast<int32_t>(quota.throttle.count()));
+    co_return grpc::Status::OK;
+  }
 
-    if (!idempotency_table_->IsValidSequence(key, request->sequence())) {
-      response->set_error_code(streamit::v1::IDEMPOTENT_REPLAY);
-      response->set_error_message("Invalid sequence number for producer");
-      return grpc::Status::OK;
+  // Hold the request's size against the broker memory budget until the produce completes
+  auto reservation = co_await memory_budget_.Reserve(request->ByteSizeLong(),
+                                                     std::min(max_inflight_wait_, TimeRemaining(context)));
+  metrics_->SetInflightBytes(memory_budget_.Used(), memory_budget_.Waiting());
+  if (!reservation) {
+    metrics_->RecordMemoryRejected("produce");
+    response->set_error_code(streamit::v1::THROTTLED);
+    response->set_error_message("Broker in-flight memory budget exhausted");
+    response->set_retry_after_ms(static_cast<int32_t>(kMemoryRetryAfter.count()));
+    co_return grpc::Status::OK;
+  }
+  timer.Mark(ProduceStage::kAdmission);
+
+  // Check idempotency if producer_id is provided; a retried batch is answered without touching storage
+  bool idempotent = request->producer_id() > 0;
+  ProducerKey key{request->producer_id(), tp.topic, tp.partition};
+  if (idempotent) {
+    // A batch that overtook an earlier one of its pipeline carries on, and waits for it at the append
+    auto check = idempotency_table_->CheckSequence(key, request->sequence());
+    if (check.status != SequenceStatus::kAccept && check.status != SequenceStatus::kPending) {
+      SetSequenceResponse(check, request->sequence(), response);
+      STREAMIT_LOG_RATE_LIMITED(spdlog::level::info, 10, trace_id, "Produce sequence {} not appended: error_code={}",
+                                request->sequence(), static_cast<int>(response->error_code()));
+      co_return grpc::Status::OK;
     }
   }
+  timer.Mark(ProduceStage::kIdempotencyCheck);
 
   // Convert protobuf records to storage records
   auto records = ConvertRecords(request->records());
   if (records.empty()) {
     response->set_error_code(streamit::v1::INVALID_ARGUMENT);
     response->set_error_message("No records to produce");
-    return grpc::Status::OK;
+    co_return grpc::Status::OK;
   }
+  timer.Mark(ProduceStage::kConvert);
 
-  // Get or create segment for the topic and partition
-  auto segment_result = log_dir_->GetSegment(request->topic(), request->partition());
-  if (!segment_result.ok()) {
-    response->set_error_code(streamit::v1::INTERNAL);
-    response->set_error_message("Failed to get segment: " + segment_result.status().message());
-    return grpc::Status::OK;
+  // Do not append for a client that has already timed out and will retry
+  if (ShouldShed(context, "produce", "append")) {
+    co_return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "Request deadline expired before append");
   }
 
-  auto segment = segment_result.value();
-
-  // Append records to segment
-  auto append_result = segment->Append(records);
+  // Resolve the partition once; every later step of this produce works on it directly
+  auto partition = log_dir_->GetOrCreatePartition(tp);
+  timer.Mark(ProduceStage::kSegmentLookup);
+
+  // Append records, rolling past a full segment (re-checking the sequence under the producer's append lock). The
+  // write runs on this produce thread, so produce_threads also bounds concurrent appends.
+  SequenceCheck check;
+  auto append_result = idempotent ? AppendIdempotent(*partition, records, key, request->sequence(), check, timer)
+                                  : partition->Append(records);
+
+  // A pipelined batch that arrived ahead of an earlier one waits for it outside the append lock, then tries again
+  while (check.status == SequenceStatus::kPending) {
+    auto wait = std::min(kMaxPipelineWait, TimeRemaining(context));
+    bool turn = co_await sequence_waiters_.WaitForTurn(key, request->sequence(), wait);
+    timer.Mark(ProduceStage::kPipelineWait);
+    if (!turn) {
+      break;
+    }
+    append_result = AppendIdempotent(*partition, records, key, request->sequence(), check, timer);
+  }
+  timer.Mark(ProduceStage::kWrite);
+  if (check.status != SequenceStatus::kAccept) {
+    SetSequenceResponse(check, request->sequence(), response);
+    co_return grpc::Status::OK;
+  }
   if (!append_result.ok()) {
     response->set_error_code(streamit::v1::INTERNAL);
     response->set_error_message("Failed to append records: " + append_result.status().message());
-    return grpc::Status::OK;
+    co_return grpc::Status::OK;
   }
 
-  int64_t base_offset = append_result.value();
+  // The next batch of this producer's pipeline may be waiting for this one
+  if (idempotent) {
+    sequence_waiters_.Notify(key, request->sequence());
+  }
 
-  // Update idempotency table if producer_id is provided
-  if (!request->producer_id().empty()) {
-    ProducerKey key{request->producer_id(), request->topic(), request->partition()};
-    idempotency_table_->UpdateSequence(key, request->sequence(), base_offset);
+  int64_t base_offset = append_result.value().base_offset;
+  auto segment = append_result.value().segment;
+
+  // Quorum acks are durable acks: with a single replica that means the batch is fsynced before replying
+  if (request->ack() == streamit::v1::ACK_QUORUM) {
+    auto flush_result = co_await common::RunOn(lanes_.Flush(), [&] {
+      timer.Mark(ProduceStage::kFsyncQueue);
+      return segment->Flush();
+    });
+    if (!flush_result.ok()) {
+      response->set_error_code(streamit::v1::INTERNAL);
+      response->set_error_message("Failed to flush records: " + flush_result.status().message());
+      co_return grpc::Status::OK;
+    }
+    timer.Mark(ProduceStage::kFsync);
   }
 
   // Update high water mark
-  auto hwm_result = log_dir_->SetHighWaterMark(request->topic(), request->partition(), base_offset + records.size());
-  if (!hwm_result.ok()) {
-    // Log warning but don't fail the request
-    // In a real implementation, this would be logged
-  }
+  int64_t end_offset = base_offset + static_cast<int64_t>(records.size());
+  partition->SetHighWaterMark(end_offset);
+  metrics_->SetHighWaterMark(tp, partition->HighWaterMark());
+
+  // Wake any long-polling fetches on this partition
+  fetch_waiters_.Notify(tp, end_offset);
+  timer.Mark(ProduceStage::kHighWaterMark);
 
   // Set response
   response->set_base_offset(base_offset);
   response->set_error_code(streamit::v1::OK);
 
   // Record metrics
-  auto end_time = std::chrono::steady_clock::now();
-  auto latency_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-
-  std::string ack_str = (request->ack() == streamit::v1::ACK_LEADER) ? "leader" : "quorum";
-  metrics_->RecordProduceLatency(ack_str, request->topic(), request->partition(), latency_ms);
-
-  // Calculate bytes and records
-  int64_t total_bytes = 0;
-  for (const auto& record : request->records()) {
-    total_bytes += record.key().size() + record.value().size();
-  }
+  std::string_view ack_str = (request->ack() == streamit::v1::ACK_LEADER) ? "leader" : "quorum";
+  metrics_->RecordProduceBytes(tp, total_bytes);
+  metrics_->RecordProduceRecords(tp, request->records().size());
+  timer.Mark(ProduceStage::kResponse);
 
-  metrics_->RecordProduceBytes(request->topic(), request->partition(), total_bytes);
-  metrics_->RecordProduceRecords(request->topic(), request->partition(), request->records().size());
+  auto latency = timer.Total();
+  metrics_->RecordProduceLatency(ack_str, tp, latency);
+  double latency_ms = std::chrono::duration<double, std::milli>(latency).count();
+  MaybeLogSlowRequest("produce", timer, trace_id, request->topic(), request->partition(), total_bytes,
+                      static_cast<int64_t>(records.size()));
 
   // Log success
-  streamit::common::StructuredLogger::Info(trace_id, "Produce completed: base_offset={}, latency_ms={}", base_offset,
-                                           latency_ms);
+  STREAMIT_LOG_SAMPLED(trace_id, "Produce completed: base_offset={}, latency_ms={}", base_offset, latency_ms);
 
-  return grpc::Status::OK;
+  co_return grpc::Status::OK;
 }
 
-grpc::Status BrokerServiceImpl::Fetch(grpc::ServerContext* context, const streamit::v1::FetchRequest* request,
-                                      streamit::v1::FetchResponse* response) {
-  auto start_time = std::chrono::steady_clock::now();
+common::Task<grpc::Status> BrokerServiceImpl::HandleFetch(grpc::CallbackServerContext* context,
+                                                          const streamit::v1::FetchRequest* request,
+                                                          streamit::v1::FetchResponse* response,
+                                                          common::TraceId trace_id) {
+  common::StageTimer<FetchStage> timer(metrics_->FetchStages());
 
-  // Extract trace ID
-  std::string trace_id = streamit::common::TraceContext::ExtractTraceId(context);
-
-  // Log request
-  streamit::common::StructuredLogger::Info(trace_id, "Fetch request: topic={}, partition={}, offset={}, max_bytes={}",
-                                           request->topic(), request->partition(), request->offset(),
-                                           request->max_bytes());
+  // Log request (sampled; every request at debug level)
+  STREAMIT_LOG_SAMPLED(trace_id, "Fetch request: topic={}, partition={}, offset={}, max_bytes={}", request->topic(),
+                       request->partition(), request->offset(), request->max_bytes());
 
   // Validate request
   auto validation_status = ValidateFetchRequest(request);
   if (!validation_status.ok()) {
-    streamit::common::StructuredLogger::Error(trace_id, "Fetch validation failed: {}",
-                                              validation_status.error_message());
-    return validation_status;
+    STREAMIT_LOG_RATE_LIMITED(spdlog::level::err, 10, trace_id, "Fetch validation failed: {}",
+                              validation_status.error_message());
+    co_return validation_status;
   }
-
-  // Get segments for the topic and partition
-  auto segments_result = log_dir_->GetSegments(request->topic(), request->partition());
-  if (!segments_result.ok()) {
-    response->set_error_code(streamit::v1::INTERNAL);
-    response->set_error_message("Failed to get segments: " + segments_result.status().message());
-    return grpc::Status::OK;
+  timer.Mark(FetchStage::kValidate);
+
+  // Fetched bytes are only known after the read, so they are charged afterwards and throttle the next fetch
+  auto quota_subject = MakeQuotaSubject(context, 0, request->topic());
+  auto quota = fetch_quotas_.Acquire(quota_subject, 0);
+  if (quota.Throttled()) {
+    metrics_->RecordThrottle("fetch", quota.entity, quota.throttle.count());
+    response->set_error_code(streamit::v1::THROTTLED);
+    response->set_error_message("Fetch quota exceeded for " + std::string(quota.entity));
+    response->set_retry_after_ms(static_cast<int32_t>(quota.throttle.count()));
+    co_return grpc::Status::OK;
   }
-
-  const auto& segments = segments_result.value();
-  if (segments.empty()) {
+  timer.Mark(FetchStage::kAdmission);
+
+  auto max_wait = std::min(GetFetchMaxWait(context), TimeRemaining(context));
+  bool waited = false;
+
+  // Only produces intern topic names, so fetches for made-up topics cannot grow the registry. A long poll at the
+  // start of a topic nobody has produced to yet waits by name for the first produce, then for data as usual.
+  auto topic = topics_->Find(request->topic());
+  if (!topic && request->offset() == 0 && max_wait.count() > 0) {
+    auto wait_start = std::chrono::steady_clock::now();
+    co_await fetch_waiters_.WaitForTopic(*topics_, request->topic(), max_wait);
+    timer.Mark(FetchStage::kLongPoll);
+    max_wait -= std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - wait_start);
+    topic = topics_->Find(request->topic());
+  }
+  if (!topic) {
     response->set_high_watermark(0);
-    response->set_error_code(streamit::v1::OK);
-    return grpc::Status::OK;
+    if (request->offset() == 0) {
+      // Caught up with an empty log: nothing to return yet
+      response->set_error_code(streamit::v1::OK);
+    } else {
+      response->set_error_code(streamit::v1::OFFSET_OUT_OF_RANGE);
+      response->set_error_message("Requested offset is beyond the end of all segments");
+    }
+    co_return grpc::Status::OK;
   }
+  common::TopicPartition tp{*topic, request->partition()};
+  std::optional<MemoryBudget::Reservation> reservation;
+  int64_t fetched_records = 0;
 
-  // Find the segment containing the requested offset
-  std::shared_ptr<storage::Segment> target_segment = nullptr;
-  for (const auto& segment : segments) {
-    if (request->offset() >= segment->BaseOffset() && request->offset() < segment->EndOffset()) {
-      target_segment = segment;
-      break;
+  // Resolved once (and again after a long poll, in case the first produce created it meanwhile)
+  auto partition = log_dir_->GetPartition(tp);
+
+  while (true) {
+    if (!partition) {
+      partition = log_dir_->GetPartition(tp);
     }
-  }
 
-  if (!target_segment) {
-    // Offset is beyond the end of all segments
-    auto end_offset_result = log_dir_->GetEndOffset(request->topic(), request->partition());
-    if (end_offset_result.ok()) {
-      response->set_high_watermark(end_offset_result.value());
-    } else {
-      response->set_high_watermark(0);
+    // Find the segment containing the requested offset (the snapshot is shared, not copied)
+    std::shared_ptr<const storage::Partition::SegmentList> segments;
+    storage::Partition::SegmentList::const_iterator segment_it;
+    if (partition) {
+      segments = partition->Segments();
+      segment_it = storage::Partition::FindSegment(*segments, request->offset());
+    }
+    timer.Mark(FetchStage::kSegmentLookup);
+
+    if (!segments || segment_it == segments->end()) {
+      int64_t end_offset = partition ? partition->EndOffset() : 0;
+
+      // Fetching at the log end is a long poll: suspend until a produce appends or the wait expires
+      if (request->offset() == end_offset && max_wait.count() > 0 && !waited) {
+        waited = true;
+        co_await fetch_waiters_.WaitForData(tp, request->offset(), max_wait);
+        timer.Mark(FetchStage::kLongPoll);
+        continue;
+      }
+
+      response->set_high_watermark(end_offset);
+      if (request->offset() == end_offset) {
+        // Caught up: nothing to return yet
+        response->set_error_code(streamit::v1::OK);
+        co_return grpc::Status::OK;
+      }
+
+      // Offset is beyond the end of all segments
+      response->set_error_code(streamit::v1::OFFSET_OUT_OF_RANGE);
+      response->set_error_message("Requested offset is beyond the end of all segments");
+      co_return grpc::Status::OK;
     }
-    response->set_error_code(streamit::v1::OFFSET_OUT_OF_RANGE);
-    response->set_error_message("Requested offset is beyond the end of all segments");
-    return grpc::Status::OK;
-  }
 
-  // Read batches from the segment
-  auto batches_result = target_segment->Read(request->offset(), request->max_bytes());
-  if (!batches_result.ok()) {
-    response->set_error_code(streamit::v1::INTERNAL);
-    response->set_error_message("Failed to read from segment: " + batches_result.status().message());
-    return grpc::Status::OK;
-  }
+    // Reserve room for the largest response this fetch can build before reading anything: no more than the client
+    // asked for, the partition holds from this segment on, or a fetch's share of the budget, so one catch-up fetch
+    // cannot hold every in-flight byte while produces queue behind it
+    size_t max_bytes = std::min(static_cast<size_t>(request->max_bytes()), MaxFetchReservation());
+    size_t available = 0;
+    for (auto it = segment_it; it != segments->end() && available < max_bytes; ++it) {
+      available += (*it)->Size();
+    }
+    max_bytes = std::min(max_bytes, available);
+    reservation = co_await memory_budget_.Reserve(max_bytes, std::min(max_inflight_wait_, TimeRemaining(context)));
+    metrics_->SetInflightBytes(memory_budget_.Used(), memory_budget_.Waiting());
+    if (!reservation) {
+      metrics_->RecordMemoryRejected("fetch");
+      response->set_error_code(streamit::v1::THROTTLED);
+      response->set_error_message("Broker in-flight memory budget exhausted");
+      response->set_retry_after_ms(static_cast<int32_t>(kMemoryRetryAfter.count()));
+      co_return grpc::Status::OK;
+    }
+    timer.Mark(FetchStage::kAdmission);
+
+    if (ShouldShed(context, "fetch", "read")) {
+      co_return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "Request deadline expired before read");
+    }
 
-  const auto& batches = batches_result.value();
+    // Read from the segment holding the offset and carry on into the following ones until the reservation is used,
+    // so a fetch near a roll boundary is not cut short
+    std::vector<storage::RecordBatch> batches;
+    size_t bytes_read = 0;
+    int64_t next_offset = request->offset();
+    for (; segment_it != segments->end() && bytes_read < max_bytes; ++segment_it) {
+      auto batches_result = (*segment_it)->Read(next_offset, max_bytes - bytes_read);
+      if (!batches_result.ok()) {
+        response->set_error_code(streamit::v1::INTERNAL);
+        response->set_error_message("Failed to read from segment: " + batches_result.status().message());
+        co_return grpc::Status::OK;
+      }
+
+      // Nothing read means the next batch did not fit (or this segment ended early); either way stop here
+      if (batches_result.value().empty()) {
+        break;
+      }
+
+      for (auto& batch : batches_result.value()) {
+        bytes_read += batch.SerializedSize();
+        next_offset = batch.base_offset + static_cast<int64_t>(batch.records.size());
+        batches.push_back(std::move(batch));
+      }
+    }
+    timer.Mark(FetchStage::kRead);
 
-  // Convert batches to protobuf format
-  for (const auto& batch : batches) {
-    auto* proto_batch = response->add_batches();
-    proto_batch->set_base_offset(batch.base_offset);
-    proto_batch->set_crc32(batch.crc32);
+    if (ShouldShed(context, "fetch", "serialize")) {
+      co_return grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "Request deadline expired before serialize");
+    }
 
-    // Convert records
-    for (const auto& record : batch.records) {
-      auto* proto_record = proto_batch->add_records();
-      proto_record->set_key(record.key);
-      proto_record->set_value(record.value);
-      proto_record->set_timestamp_ms(record.timestamp_ms);
+    // Convert batches to protobuf format
+    for (const auto& batch : batches) {
+      fetched_records += static_cast<int64_t>(batch.records.size());
+      auto* proto_batch = response->add_batches();
+      proto_batch->set_base_offset(batch.base_offset);
+      proto_batch->set_crc32(batch.crc32);
+
+      // Convert records
+      for (const auto& record : batch.records) {
+        auto* proto_record = proto_batch->add_records();
+        proto_record->set_key(record.key);
+        proto_record->set_value(record.value);
+        proto_record->set_timestamp_ms(record.timestamp_ms);
+      }
     }
+
+    // Keep only what the response actually holds
+    reservation->Shrink(response->ByteSizeLong());
+    timer.Mark(FetchStage::kSerialize);
+    break;
   }
 
   // Set high water mark
-  auto hwm_result = log_dir_->GetHighWaterMark(request->topic(), request->partition());
-  if (hwm_result.ok()) {
-    response->set_high_watermark(hwm_result.value());
-  } else {
-    response->set_high_watermark(0);
-  }
+  response->set_high_watermark(partition->HighWaterMark());
 
   response->set_error_code(streamit::v1::OK);
 
-  // Record metrics
-  auto end_time = std::chrono::steady_clock::now();
-  auto latency_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-
-  metrics_->RecordFetchLatency(request->topic(), request->partition(), latency_ms);
-
   // Calculate bytes fetched
   int64_t total_bytes = 0;
   for (const auto& batch : response->batches()) {
     total_bytes += batch.payload().size();
   }
 
-  metrics_->RecordFetchBytes(request->topic(), request->partition(), total_bytes);
+  // Record metrics
+  metrics_->RecordFetchBytes(tp, total_bytes);
+  fetch_quotas_.RecordBytes(quota_subject, static_cast<int64_t>(response->ByteSizeLong()));
+  timer.Mark(FetchStage::kResponse);
+
+  auto latency = timer.Total();
+  metrics_->RecordFetchLatency(tp, latency);
+  double latency_ms = std::chrono::duration<double, std::milli>(latency).count();
+  MaybeLogSlowRequest("fetch", timer, trace_id, request->topic(), request->partition(), total_bytes, fetched_records);
 
   // Log success
-  streamit::common::StructuredLogger::Info(trace_id, "Fetch completed: batches={}, bytes={}, latency_ms={}",
-                                           response->batches().size(), total_bytes, latency_ms);
+  STREAMIT_LOG_SAMPLED(trace_id, "Fetch completed: batches={}, bytes={}, latency_ms={}", response->batches().size(),
+                       total_bytes, latency_ms);
 
-  return grpc::Status::OK;
+  co_return grpc::Status::OK;
+}
+
+void BrokerServiceImpl::SnapshotProducerState() noexcept {
+  std::vector<PartitionProducerSnapshot> snapshots;
+  {
+    // Hold every append stripe so no batch is in the log without its sequence in the table
+    std::vector<std::unique_lock<common::InstrumentedMutex>> locks;
+    locks.reserve(kAppendStripes);
+    for (auto& stripe : append_mutexes_) {
+      locks.emplace_back(stripe.mutex);
+    }
+    snapshots = producer_snapshots_.Capture();
+  }
+
+  auto write_status = producer_snapshots_.Write(snapshots);
+  if (!write_status.ok()) {
+    streamit::common::StructuredLogger::Warn({}, "Failed to write producer snapshots: {}",
+                                             std::string(write_status.message()));
+  }
+}
+
+void BrokerServiceImpl::ScheduleProducerSnapshot() noexcept {
+  if (producer_snapshot_interval_.count() <= 0) {
+    return;
+  }
+
+  timers_.ScheduleAfter(producer_snapshot_interval_, [this] {
+    // File writes stay off the timer thread; the next snapshot is armed once this one is done
+    lanes_.For(RequestClass::kAdmin).Post([this] {
+      SnapshotProducerState();
+      ScheduleProducerSnapshot();
+    });
+  });
+}
+
+void BrokerServiceImpl::CheckpointOffsets() noexcept {
+  auto checkpoint_status = log_dir_->Checkpoint();
+  if (!checkpoint_status.ok()) {
+    streamit::common::StructuredLogger::Warn({}, "Failed to checkpoint partition offsets: {}",
+                                             std::string(checkpoint_status.message()));
+  }
+}
+
+void BrokerServiceImpl::ScheduleCheckpoint() noexcept {
+  if (checkpoint_interval_.count() <= 0) {
+    return;
+  }
+
+  timers_.ScheduleAfter(checkpoint_interval_, [this] {
+    // One file write per interval for all partitions, kept off the timer thread and the produce path
+    lanes_.For(RequestClass::kAdmin).Post([this] {
+      CheckpointOffsets();
+      ScheduleCheckpoint();
+    });
+  });
+}
+
+void BrokerServiceImpl::RecordQueueDepths() noexcept {
+  for (size_t i = 0; i < kNumRequestClasses; ++i) {
+    auto request_class = static_cast<RequestClass>(i);
+    metrics_->SetExecutorQueueDepth(RequestLanes::Name(request_class), lanes_.For(request_class).QueueDepth());
+  }
+  metrics_->SetExecutorQueueDepth("flush", lanes_.Flush().QueueDepth());
+}
+
+std::chrono::milliseconds BrokerServiceImpl::TimeRemaining(const grpc::CallbackServerContext* context) noexcept {
+  auto deadline = context->deadline();
+  auto now = std::chrono::system_clock::now();
+  if (deadline <= now) {
+    return std::chrono::milliseconds(0);
+  }
+  return std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+}
+
+bool BrokerServiceImpl::ShouldShed(grpc::CallbackServerContext* context, std::string_view type,
+                                   std::string_view stage) noexcept {
+  if (context->deadline() > std::chrono::system_clock::now() && !context->IsCancelled()) {
+    return false;
+  }
+
+  metrics_->RecordShed(type, stage);
+  return true;
+}
+
+QuotaSubject BrokerServiceImpl::MakeQuotaSubject(const grpc::CallbackServerContext* context, int64_t producer_id,
+                                               const std::string& topic) {
+  return QuotaSubject{producer_id > 0 ? std::to_string(producer_id) : std::string(),
+                      QuotaManager::ClientAddress(context->peer()), topic};
+}
+
+std::chrono::milliseconds BrokerServiceImpl::GetFetchMaxWait(
+    const grpc::CallbackServerContext* context) const noexcept {
+  const auto& metadata = context->client_metadata();
+  auto it = metadata.find("x-max-wait-ms");
+  if (it == metadata.end()) {
+    return std::chrono::milliseconds(0);
+  }
+
+  try {
+    auto wait = std::chrono::milliseconds(std::stoll(std::string(it->second.data(), it->second.length())));
+    return std::clamp(wait, std::chrono::milliseconds(0), kMaxFetchWait);
+  } catch (const std::exception&) {
+    return std::chrono::milliseconds(0);
+  }
+}
+
+size_t BrokerServiceImpl::MaxFetchReservation() const noexcept {
+  size_t capacity = memory_budget_.Capacity();
+  if (capacity == 0) {
+    return std::numeric_limits<size_t>::max();
+  }
+  return std::max(capacity / kFetchBudgetShare, kMinFetchReservation);
+}
+
+common::Result<storage::Partition::AppendResult>
+BrokerServiceImpl::AppendIdempotent(storage::Partition& partition, const std::vector<storage::Record>& records,
+                                    const ProducerKey& key, int64_t sequence, SequenceCheck& check,
+                                    common::StageTimer<ProduceStage>& timer) {
+  std::lock_guard<common::InstrumentedMutex> lock(append_mutexes_[ProducerKeyShard(key, kAppendStripes)].mutex);
+  timer.Mark(ProduceStage::kAppendLock);
+
+  // The first check ran without the lock; the original of a retry may have landed since
+  check = idempotency_table_->CheckSequence(key, sequence);
+  if (check.status != SequenceStatus::kAccept) {
+    return storage::Partition::AppendResult{check.offset, nullptr};
+  }
+
+  auto result = partition.Append(records, key.producer_id, sequence);
+  if (result.ok()) {
+    idempotency_table_->UpdateSequence(key, sequence, result.value().base_offset);
+  }
+  return result;
+}
+
+common::Span BrokerServiceImpl::StartSpan(std::string_view name, grpc::CallbackServerContext* context) {
+  common::Span span(name, common::TraceContext::Extract(context), span_exporter_.get());
+  common::TraceContext::Inject(context, span.Context());
+  return span;
+}
+
+template <typename Stage>
+void BrokerServiceImpl::MaybeLogSlowRequest(std::string_view type, const common::StageTimer<Stage>& timer,
+                                            const common::TraceId& trace_id, const std::string& topic,
+                                            int32_t partition, int64_t bytes, int64_t records) noexcept {
+  auto total = timer.Total();
+  if (!slow_requests_ || !slow_requests_->ShouldRecord(total)) {
+    return;
+  }
+
+  slow_requests_->Record({std::string(type), trace_id.ToString(), topic, partition, bytes, records,
+                          std::chrono::system_clock::now(), total, timer.MarkedStages()});
+  STREAMIT_LOG_RATE_LIMITED(spdlog::level::warn, 10, trace_id, "Slow {}: topic={}, partition={}, total_us={}", type,
+                            topic, partition, total.count() / 1000);
+}
+
+void BrokerServiceImpl::SetSequenceResponse(const SequenceCheck& check, int64_t sequence,
+                                            streamit::v1::ProduceResponse* response) {
+  switch (check.status) {
+  case SequenceStatus::kAccept:
+    break;
+  case SequenceStatus::kDuplicate:
+    response->set_base_offset(check.offset);
+    response->set_error_code(streamit::v1::OK);
+    break;
+  case SequenceStatus::kPending: // The batch ahead never arrived within the wait
+  case SequenceStatus::kOutOfOrder:
+    response->set_error_code(streamit::v1::FAILED_PRECONDITION);
+    response->set_error_message("Out of order sequence " + std::to_string(sequence) + ", expected " +
+                                std::to_string(check.expected));
+    break;
+  case SequenceStatus::kStale:
+    response->set_error_code(streamit::v1::IDEMPOTENT_REPLAY);
+    response->set_error_message("Sequence " + std::to_string(sequence) + " is older than the last " +
+                                std::to_string(SequenceWindow::kSize) + " batches");
+    break;
+  }
 }
 
 grpc::Status BrokerServiceImpl::ValidateProduceRequest(const streamit::v1::ProduceRequest* request) const {
@@ -240,6 +736,14 @@ grpc::Status BrokerServiceImpl::ValidateProduceRequest(const streamit::v1::Produ
     return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Records cannot be empty");
   }
 
+  if (request->sequence() < 0) {
+    return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Sequence must be non-negative");
+  }
+
+  if (request->producer_id() < 0) {
+    return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Producer id must be non-negative");
+  }
+
   return grpc::Status::OK;
 }
 
@@ -294,14 +798,14 @@ void BrokerServiceImpl::ConvertRecords(const std::vector<storage::Record>& stora
 }
 
 BrokerServer::BrokerServer(const std::string& host, uint16_t port, std::shared_ptr<storage::LogDir> log_dir,
-                           std::shared_ptr<IdempotencyTable> idempotency_table)
+                           std::shared_ptr<IdempotencyTable> idempotency_table, BrokerServiceOptions options)
     : host_(host), port_(port), log_dir_(std::move(log_dir)), idempotency_table_(std::move(idempotency_table)),
-      running_(false) {
+      options_(std::move(options)), running_(false) {
 }
 
 bool BrokerServer::Start() noexcept {
   try {
-    service_ = std::make_unique<BrokerServiceImpl>(log_dir_, idempotency_table_);
+    service_ = std::make_unique<BrokerServiceImpl>(log_dir_, idempotency_table_, options_);
 
     grpc::ServerBuilder builder;
     std::string server_address = host_ + ":" + std::to_string(port_);
@@ -323,7 +827,9 @@ bool BrokerServer::Start() noexcept {
 
 bool BrokerServer::Stop() noexcept {
   if (server_) {
-    server_->Shutdown();
+    // A parked long poll would otherwise hold Shutdown for its whole wait
+    service_->BeginShutdown();
+    server_->Shutdown(std::chrono::system_clock::now() + kShutdownGracePeriod);
     running_.store(false);
     return true;
   }
@@ -340,4 +846,8 @@ bool BrokerServer::IsRunning() const noexcept {
   return running_.load();
 }
 
+common::Executor* BrokerServer::AdminExecutor() noexcept {
+  return service_ ? &service_->AdminExecutor() : nullptr;
+}
+
 } // namespace streamit::broker
@@ -0,0 +1,161 @@
+#include "streamit/broker/fetch_waiters.h"
+#include <algorithm>
+
+namespace streamit::broker {
+
+FetchWaiters::FetchWaiters(common::TimerService& timers) : timers_(timers) {
+}
+
+bool FetchWaiters::Register(const std::shared_ptr<Waiter>& waiter, int64_t offset,
+                            std::chrono::milliseconds timeout) noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  // The broker is stopping; answer now with whatever the log holds
+  if (stopped_) {
+    return false;
+  }
+
+  // Data may have been appended between the caller's read and this registration
+  auto& partition = partitions_[waiter->partition];
+  if (partition.end_offset > offset) {
+    waiter->notified = true;
+    return false;
+  }
+
+  waiter->timer_id = timers_.ScheduleAfter(timeout, [this, waiter] { Expire(waiter); });
+  if (waiter->timer_id == 0) {
+    // Timer service is shutting down; nothing would ever expire the wait
+    return false;
+  }
+
+  partition.waiters.push_back(waiter);
+  return true;
+}
+
+bool FetchWaiters::RegisterTopic(const std::shared_ptr<Waiter>& waiter, const common::TopicRegistry& topics,
+                                 std::chrono::milliseconds timeout) noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  if (stopped_) {
+    return false;
+  }
+
+  // The first produce may have interned the topic since the caller looked; NotifyTopic runs after Intern and takes
+  // mutex_, so either this check or that notification sees it
+  if (topics.Find(waiter->topic)) {
+    waiter->notified = true;
+    return false;
+  }
+
+  waiter->timer_id = timers_.ScheduleAfter(timeout, [this, waiter] { Expire(waiter); });
+  if (waiter->timer_id == 0) {
+    return false;
+  }
+
+  topic_waiters_[waiter->topic].push_back(waiter);
+  return true;
+}
+
+void FetchWaiters::Notify(common::TopicPartition partition, int64_t end_offset) noexcept {
+  std::vector<std::shared_ptr<Waiter>> ready;
+  {
+    std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+    auto& state = partitions_[partition];
+    state.end_offset = std::max(state.end_offset, end_offset);
+    ready.swap(state.waiters);
+  }
+
+  for (const auto& waiter : ready) {
+    timers_.Cancel(waiter->timer_id);
+    Resume(waiter, true);
+  }
+}
+
+void FetchWaiters::NotifyTopic(std::string_view topic) noexcept {
+  std::vector<std::shared_ptr<Waiter>> ready;
+  {
+    std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+    auto it = topic_waiters_.find(std::string(topic));
+    if (it == topic_waiters_.end()) {
+      return;
+    }
+    ready.swap(it->second);
+    topic_waiters_.erase(it);
+  }
+
+  for (const auto& waiter : ready) {
+    timers_.Cancel(waiter->timer_id);
+    Resume(waiter, true);
+  }
+}
+
+void FetchWaiters::Shutdown() noexcept {
+  std::vector<std::shared_ptr<Waiter>> parked;
+  {
+    std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+    stopped_ = true;
+    for (auto& [key, partition] : partitions_) {
+      parked.insert(parked.end(), partition.waiters.begin(), partition.waiters.end());
+      partition.waiters.clear();
+    }
+    for (auto& [topic, waiters] : topic_waiters_) {
+      parked.insert(parked.end(), waiters.begin(), waiters.end());
+    }
+    topic_waiters_.clear();
+  }
+
+  for (const auto& waiter : parked) {
+    timers_.Cancel(waiter->timer_id);
+    Resume(waiter, false);
+  }
+}
+
+size_t FetchWaiters::Size() const noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  size_t total = 0;
+  for (const auto& [key, partition] : partitions_) {
+    total += partition.waiters.size();
+  }
+  for (const auto& [topic, waiters] : topic_waiters_) {
+    total += waiters.size();
+  }
+  return total;
+}
+
+void FetchWaiters::Expire(const std::shared_ptr<Waiter>& waiter) noexcept {
+  {
+    std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+    if (!waiter->topic.empty()) {
+      auto it = topic_waiters_.find(waiter->topic);
+      if (it != topic_waiters_.end()) {
+        auto& waiters = it->second;
+        waiters.erase(std::remove(waiters.begin(), waiters.end(), waiter), waiters.end());
+        if (waiters.empty()) {
+          topic_waiters_.erase(it);
+        }
+      }
+    } else if (auto it = partitions_.find(waiter->partition); it != partitions_.end()) {
+      auto& waiters = it->second.waiters;
+      waiters.erase(std::remove(waiters.begin(), waiters.end(), waiter), waiters.end());
+    }
+  }
+
+  Resume(waiter, false);
+}
+
+void FetchWaiters::Resume(const std::shared_ptr<Waiter>& waiter, bool notified) noexcept {
+  if (waiter->fired.exchange(true)) {
+    return;
+  }
+
+  waiter->notified = notified;
+  auto handle = waiter->handle;
+  if (waiter->executor) {
+    waiter->executor->Post([handle] { handle.resume(); });
+  } else {
+    handle.resume();
+  }
+}
+
+} // namespace streamit::broker
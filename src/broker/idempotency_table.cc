@@ -1,70 +1,101 @@
 #include "streamit/broker/idempotency_table.h"
+#include <algorithm>
 
 namespace streamit::broker {
 
-bool IdempotencyTable::IsValidSequence(const ProducerKey& key, int64_t sequence) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+IdempotencyTable::IdempotencyTable(size_t num_shards) : shards_(std::max<size_t>(num_shards, 1)) {
+}
+
+SequenceCheck IdempotencyTable::CheckSequence(const ProducerKey& key, int64_t sequence) const noexcept {
+  const auto& shard = ShardFor(key);
+  std::lock_guard<common::InstrumentedMutex> lock(shard.mutex);
 
-  auto it = table_.find(key);
-  if (it == table_.end()) {
-    // New producer, sequence must be 0
-    return sequence == 0;
+  auto it = shard.table.find(key);
+  if (it == shard.table.end()) {
+    return SequenceWindow{}.Check(sequence);
   }
 
-  // Check if sequence is strictly increasing
-  return sequence > it->second.last_sequence;
+  return it->second.Check(sequence);
+}
+
+bool IdempotencyTable::IsValidSequence(const ProducerKey& key, int64_t sequence) const noexcept {
+  return CheckSequence(key, sequence).status == SequenceStatus::kAccept;
 }
 
 void IdempotencyTable::UpdateSequence(const ProducerKey& key, int64_t sequence, int64_t offset) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  auto& shard = ShardFor(key);
+  std::lock_guard<common::InstrumentedMutex> lock(shard.mutex);
 
-  table_[key] = ProducerSequence(sequence, offset);
+  shard.table[key].Record(sequence, offset);
 }
 
 int64_t IdempotencyTable::GetLastSequence(const ProducerKey& key) const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  const auto& shard = ShardFor(key);
+  std::lock_guard<common::InstrumentedMutex> lock(shard.mutex);
 
-  auto it = table_.find(key);
-  if (it == table_.end()) {
+  auto it = shard.table.find(key);
+  if (it == shard.table.end()) {
     return -1;
   }
 
-  return it->second.last_sequence;
+  return it->second.LastSequence();
 }
 
 int64_t IdempotencyTable::GetLastOffset(const ProducerKey& key) const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  const auto& shard = ShardFor(key);
+  std::lock_guard<common::InstrumentedMutex> lock(shard.mutex);
 
-  auto it = table_.find(key);
-  if (it == table_.end()) {
+  auto it = shard.table.find(key);
+  if (it == shard.table.end()) {
     return -1;
   }
 
-  return it->second.last_offset;
+  return it->second.LastOffset();
 }
 
-void IdempotencyTable::RemoveProducer(const std::string& producer_id) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
-
-  // Remove all entries for this producer
-  auto it = table_.begin();
-  while (it != table_.end()) {
-    if (it->first.producer_id == producer_id) {
-      it = table_.erase(it);
-    } else {
-      ++it;
-    }
+std::vector<std::pair<ProducerKey, SequenceWindow>> IdempotencyTable::Entries() const {
+  std::vector<std::pair<ProducerKey, SequenceWindow>> entries;
+  for (const auto& shard : shards_) {
+    std::lock_guard<common::InstrumentedMutex> lock(shard.mutex);
+    entries.insert(entries.end(), shard.table.begin(), shard.table.end());
+  }
+  return entries;
+}
+
+void IdempotencyTable::RemoveProducer(int64_t producer_id) noexcept {
+  // A producer's partitions hash to different shards, so every shard is visited
+  for (auto& shard : shards_) {
+    std::lock_guard<common::InstrumentedMutex> lock(shard.mutex);
+    std::erase_if(shard.table, [producer_id](const auto& entry) { return entry.first.producer_id == producer_id; });
   }
 }
 
 size_t IdempotencyTable::Size() const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return table_.size();
+  size_t total = 0;
+  for (const auto& shard : shards_) {
+    std::lock_guard<common::InstrumentedMutex> lock(shard.mutex);
+    total += shard.table.size();
+  }
+  return total;
 }
 
 void IdempotencyTable::Clear() noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
-  table_.clear();
+  for (auto& shard : shards_) {
+    std::lock_guard<common::InstrumentedMutex> lock(shard.mutex);
+    shard.table.clear();
+  }
+}
+
+size_t IdempotencyTable::NumShards() const noexcept {
+  return shards_.size();
+}
+
+IdempotencyTable::Shard& IdempotencyTable::ShardFor(const ProducerKey& key) noexcept {
+  return shards_[ProducerKeyShard(key, shards_.size())];
+}
+
+const IdempotencyTable::Shard& IdempotencyTable::ShardFor(const ProducerKey& key) const noexcept {
+  return shards_[ProducerKeyShard(key, shards_.size())];
 }
 
 } // namespace streamit::broker
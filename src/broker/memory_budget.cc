@@ -0,0 +1,169 @@
+#include "streamit/broker/memory_budget.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace streamit::broker {
+
+MemoryBudget::Reservation::Reservation(MemoryBudget* budget, size_t bytes) noexcept : budget_(budget), bytes_(bytes) {
+}
+
+MemoryBudget::Reservation::~Reservation() {
+  Release();
+}
+
+MemoryBudget::Reservation::Reservation(Reservation&& other) noexcept
+    : budget_(std::exchange(other.budget_, nullptr)), bytes_(std::exchange(other.bytes_, 0)) {
+}
+
+MemoryBudget::Reservation& MemoryBudget::Reservation::operator=(Reservation&& other) noexcept {
+  if (this != &other) {
+    Release();
+    budget_ = std::exchange(other.budget_, nullptr);
+    bytes_ = std::exchange(other.bytes_, 0);
+  }
+  return *this;
+}
+
+void MemoryBudget::Reservation::Shrink(size_t bytes) noexcept {
+  if (budget_ && bytes < bytes_) {
+    budget_->Release(bytes_ - bytes);
+    bytes_ = bytes;
+  }
+}
+
+void MemoryBudget::Reservation::Release() noexcept {
+  if (budget_) {
+    budget_->Release(bytes_);
+    budget_ = nullptr;
+    bytes_ = 0;
+  }
+}
+
+size_t MemoryBudget::Reservation::Bytes() const noexcept {
+  return bytes_;
+}
+
+MemoryBudget::MemoryBudget(size_t capacity_bytes, common::TimerService& timers)
+    : capacity_(capacity_bytes), used_(0), timers_(timers) {
+}
+
+std::optional<MemoryBudget::Reservation> MemoryBudget::TryReserve(size_t bytes) noexcept {
+  bytes = Clamp(bytes);
+  if (!TryAcquire(bytes)) {
+    return std::nullopt;
+  }
+  return Reservation(this, bytes);
+}
+
+size_t MemoryBudget::Used() const noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+  return used_;
+}
+
+size_t MemoryBudget::Capacity() const noexcept {
+  return capacity_;
+}
+
+size_t MemoryBudget::Waiting() const noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+  return waiters_.size();
+}
+
+size_t MemoryBudget::Clamp(size_t bytes) const noexcept {
+  return capacity_ == 0 ? bytes : std::min(bytes, capacity_);
+}
+
+bool MemoryBudget::TryAcquire(size_t bytes) noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  if (capacity_ != 0 && (!waiters_.empty() || used_ + bytes > capacity_)) {
+    return false;
+  }
+
+  used_ += bytes;
+  return true;
+}
+
+bool MemoryBudget::Enqueue(const std::shared_ptr<Waiter>& waiter, std::chrono::milliseconds timeout) noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  // Memory may have been released between the caller's check and this registration
+  if (waiters_.empty() && used_ + waiter->bytes <= capacity_) {
+    used_ += waiter->bytes;
+    waiter->granted = true;
+    return false;
+  }
+
+  waiter->timer_id = timers_.ScheduleAfter(timeout, [this, waiter] { Expire(waiter); });
+  if (waiter->timer_id == 0) {
+    // Timer service is shutting down; fail rather than wait forever
+    return false;
+  }
+
+  waiters_.push_back(waiter);
+  return true;
+}
+
+void MemoryBudget::Release(size_t bytes) noexcept {
+  std::vector<std::shared_ptr<Waiter>> ready;
+  {
+    std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+    used_ -= std::min(bytes, used_);
+
+    // Grant strictly in arrival order
+    while (!waiters_.empty() && used_ + waiters_.front()->bytes <= capacity_) {
+      used_ += waiters_.front()->bytes;
+      ready.push_back(std::move(waiters_.front()));
+      waiters_.pop_front();
+    }
+  }
+
+  for (const auto& waiter : ready) {
+    timers_.Cancel(waiter->timer_id);
+    Resume(waiter, true);
+  }
+}
+
+void MemoryBudget::Expire(const std::shared_ptr<Waiter>& waiter) noexcept {
+  std::vector<std::shared_ptr<Waiter>> ready;
+  {
+    std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+    auto it = std::find(waiters_.begin(), waiters_.end(), waiter);
+    if (it == waiters_.end()) {
+      // Already granted by a concurrent release
+      return;
+    }
+    bool was_head = it == waiters_.begin();
+    waiters_.erase(it);
+
+    // A timed-out head may have been blocking smaller waiters that fit
+    while (was_head && !waiters_.empty() && used_ + waiters_.front()->bytes <= capacity_) {
+      used_ += waiters_.front()->bytes;
+      ready.push_back(std::move(waiters_.front()));
+      waiters_.pop_front();
+    }
+  }
+
+  Resume(waiter, false);
+  for (const auto& granted : ready) {
+    timers_.Cancel(granted->timer_id);
+    Resume(granted, true);
+  }
+}
+
+void MemoryBudget::Resume(const std::shared_ptr<Waiter>& waiter, bool granted) noexcept {
+  if (waiter->fired.exchange(true)) {
+    return;
+  }
+
+  waiter->granted = granted;
+  auto handle = waiter->handle;
+  if (waiter->executor) {
+    waiter->executor->Post([handle] { handle.resume(); });
+  } else {
+    handle.resume();
+  }
+}
+
+} // namespace streamit::broker
@@ -0,0 +1,83 @@
+#include "streamit/broker/producer_id_manager.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace streamit::broker {
+
+ProducerIdManager::ProducerIdManager(std::filesystem::path path) : path_(std::move(path)) {
+}
+
+absl::Status ProducerIdManager::Load() noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  std::ifstream file(path_);
+  if (file.is_open()) {
+    int64_t block_end = 0;
+    if (!(file >> block_end) || block_end < 1) {
+      return absl::Status(absl::StatusCode::kDataLoss, "Invalid producer id reservation: " + path_.string());
+    }
+
+    // Every id below the recorded end may already belong to a producer
+    next_id_ = std::max(next_id_, block_end);
+    block_end_ = next_id_;
+  }
+
+  loaded_ = true;
+  return absl::OkStatus();
+}
+
+common::Result<int64_t> ProducerIdManager::Allocate() noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  if (!loaded_) {
+    return common::Error<int64_t>(absl::StatusCode::kUnavailable, "Producer id reservation not loaded");
+  }
+
+  if (next_id_ >= block_end_) {
+    auto reserve_status = Reserve(next_id_ + kBlockSize);
+    if (!reserve_status.ok()) {
+      return common::Error<int64_t>(reserve_status);
+    }
+    block_end_ = next_id_ + kBlockSize;
+  }
+
+  return common::Ok(next_id_++);
+}
+
+void ProducerIdManager::Observe(int64_t producer_id) noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  // Ids past the reservation can only come from a lost file; the next allocation reserves beyond them
+  next_id_ = std::max(next_id_, producer_id + 1);
+}
+
+absl::Status ProducerIdManager::Reserve(int64_t block_end) noexcept {
+  auto tmp_path = path_;
+  tmp_path += ".tmp";
+
+  int fd = open(tmp_path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+  if (fd < 0) {
+    return absl::Status(absl::StatusCode::kInternal, "Failed to create producer id file: " + tmp_path.string());
+  }
+
+  std::string contents = std::to_string(block_end) + "\n";
+  ssize_t bytes_written = write(fd, contents.data(), contents.size());
+  bool synced = fsync(fd) == 0;
+  close(fd);
+  if (bytes_written != static_cast<ssize_t>(contents.size()) || !synced) {
+    std::filesystem::remove(tmp_path);
+    return absl::Status(absl::StatusCode::kInternal, "Failed to write producer id file: " + tmp_path.string());
+  }
+
+  if (rename(tmp_path.c_str(), path_.c_str()) < 0) {
+    std::filesystem::remove(tmp_path);
+    return absl::Status(absl::StatusCode::kInternal, "Failed to rename producer id file: " + path_.string());
+  }
+
+  return absl::OkStatus();
+}
+
+} // namespace streamit::broker
@@ -0,0 +1,253 @@
+#include "streamit/broker/producer_snapshot.h"
+#include "streamit/common/crc32.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace streamit::broker {
+
+namespace {
+
+// File layout: magic, version, end offset, producer count, then per producer its id and
+// (sequence, offset) batches; a CRC32 of everything before it closes the file
+constexpr uint32_t kSnapshotMagic = 0x50534E50; // "PSNP"
+constexpr uint32_t kSnapshotVersion = 1;
+
+template <typename T>
+void Put(std::vector<std::byte>& data, T value) {
+  data.insert(data.end(), reinterpret_cast<const std::byte*>(&value),
+              reinterpret_cast<const std::byte*>(&value) + sizeof(value));
+}
+
+template <typename T>
+bool Take(std::span<const std::byte>& data, T& value) {
+  if (data.size() < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(&value, data.data(), sizeof(T));
+  data = data.subspan(sizeof(T));
+  return true;
+}
+
+} // namespace
+
+ProducerSnapshotter::ProducerSnapshotter(std::shared_ptr<storage::LogDir> log_dir,
+                                         std::shared_ptr<IdempotencyTable> table)
+    : log_dir_(std::move(log_dir)), table_(std::move(table)) {
+}
+
+common::Result<size_t> ProducerSnapshotter::Recover() noexcept {
+  size_t replayed = 0;
+  max_producer_id_ = 0;
+
+  for (auto tp : log_dir_->ListTopicPartitions()) {
+    auto end_offset_result = log_dir_->GetEndOffset(tp);
+    if (!end_offset_result.ok()) {
+      return common::Error<size_t>(end_offset_result.status());
+    }
+
+    // A missing or damaged snapshot, or one ahead of a log truncated by crash recovery, only costs a full
+    // replay of this partition
+    int64_t from_offset = 0;
+    auto snapshot_result = ReadFile(log_dir_->GetPartitionPath(tp) / kFileName);
+    if (snapshot_result.ok() && snapshot_result.value().end_offset <= end_offset_result.value()) {
+      const auto& snapshot = snapshot_result.value();
+      for (const auto& [producer_id, batches] : snapshot.producers) {
+        for (const auto& batch : batches) {
+          Restore(ProducerKey{producer_id, tp.topic, tp.partition}, batch.sequence, batch.offset);
+        }
+      }
+      from_offset = snapshot.end_offset;
+    }
+
+    auto replay_result = ReplayLog(tp, from_offset);
+    if (!replay_result.ok()) {
+      return replay_result;
+    }
+    replayed += replay_result.value();
+  }
+
+  return common::Ok(std::move(replayed));
+}
+
+int64_t ProducerSnapshotter::MaxProducerId() const noexcept {
+  return max_producer_id_;
+}
+
+std::vector<PartitionProducerSnapshot> ProducerSnapshotter::Capture() const {
+  std::vector<PartitionProducerSnapshot> snapshots;
+  std::unordered_map<common::TopicPartition, size_t, common::TopicPartitionHash> positions;
+
+  for (auto tp : log_dir_->ListTopicPartitions()) {
+    auto end_offset_result = log_dir_->GetEndOffset(tp);
+    if (!end_offset_result.ok()) {
+      continue;
+    }
+
+    positions[tp] = snapshots.size();
+    snapshots.push_back(PartitionProducerSnapshot{tp, ProducerSnapshot{end_offset_result.value(), {}}});
+  }
+
+  for (const auto& [key, window] : table_->Entries()) {
+    auto it = positions.find({key.topic, key.partition});
+    if (it != positions.end()) {
+      snapshots[it->second].snapshot.producers.emplace_back(key.producer_id, window.Batches());
+    }
+  }
+
+  return snapshots;
+}
+
+absl::Status ProducerSnapshotter::Write(const std::vector<PartitionProducerSnapshot>& snapshots) const noexcept {
+  // Keep going past a failed partition so one bad directory does not stall every snapshot
+  absl::Status result = absl::OkStatus();
+  for (const auto& entry : snapshots) {
+    auto write_result = WriteFile(log_dir_->GetPartitionPath(entry.partition) / kFileName, entry.snapshot);
+    if (!write_result.ok() && result.ok()) {
+      result = write_result;
+    }
+  }
+  return result;
+}
+
+absl::Status ProducerSnapshotter::WriteFile(const std::filesystem::path& path,
+                                            const ProducerSnapshot& snapshot) noexcept {
+  std::vector<std::byte> data;
+  Put(data, kSnapshotMagic);
+  Put(data, kSnapshotVersion);
+  Put(data, snapshot.end_offset);
+  Put(data, static_cast<int32_t>(snapshot.producers.size()));
+  for (const auto& [producer_id, batches] : snapshot.producers) {
+    Put(data, producer_id);
+    Put(data, static_cast<int32_t>(batches.size()));
+    for (const auto& batch : batches) {
+      Put(data, batch.sequence);
+      Put(data, batch.offset);
+    }
+  }
+  Put(data, common::Crc32::Compute(data));
+
+  // Write a temporary file and rename it over the old snapshot so a crash leaves one or the other intact
+  auto tmp_path = path;
+  tmp_path += ".tmp";
+
+  int fd = open(tmp_path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+  if (fd < 0) {
+    return absl::Status(absl::StatusCode::kInternal, "Failed to create snapshot file: " + tmp_path.string());
+  }
+
+  ssize_t bytes_written = write(fd, data.data(), data.size());
+  bool synced = fsync(fd) == 0;
+  close(fd);
+  if (bytes_written != static_cast<ssize_t>(data.size()) || !synced) {
+    std::filesystem::remove(tmp_path);
+    return absl::Status(absl::StatusCode::kInternal, "Failed to write snapshot file: " + tmp_path.string());
+  }
+
+  if (rename(tmp_path.c_str(), path.c_str()) < 0) {
+    std::filesystem::remove(tmp_path);
+    return absl::Status(absl::StatusCode::kInternal, "Failed to rename snapshot file: " + path.string());
+  }
+
+  return absl::OkStatus();
+}
+
+common::Result<ProducerSnapshot> ProducerSnapshotter::ReadFile(const std::filesystem::path& path) noexcept {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    return common::Error<ProducerSnapshot>(absl::StatusCode::kNotFound, "Snapshot file not found: " + path.string());
+  }
+
+  std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  std::span<const std::byte> data(reinterpret_cast<const std::byte*>(contents.data()), contents.size());
+
+  // Check the trailing CRC before trusting any length field
+  uint32_t crc32;
+  if (data.size() < sizeof(crc32)) {
+    return common::Error<ProducerSnapshot>(absl::StatusCode::kDataLoss, "Snapshot file truncated");
+  }
+  std::memcpy(&crc32, data.data() + data.size() - sizeof(crc32), sizeof(crc32));
+  data = data.first(data.size() - sizeof(crc32));
+  if (common::Crc32::Compute(data) != crc32) {
+    return common::Error<ProducerSnapshot>(absl::StatusCode::kDataLoss, "Snapshot file CRC32 mismatch");
+  }
+
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  ProducerSnapshot snapshot;
+  int32_t producer_count = 0;
+  if (!Take(data, magic) || !Take(data, version) || magic != kSnapshotMagic || version != kSnapshotVersion) {
+    return common::Error<ProducerSnapshot>(absl::StatusCode::kDataLoss, "Invalid snapshot header");
+  }
+  if (!Take(data, snapshot.end_offset) || !Take(data, producer_count) || producer_count < 0) {
+    return common::Error<ProducerSnapshot>(absl::StatusCode::kDataLoss, "Invalid snapshot header");
+  }
+
+  for (int32_t i = 0; i < producer_count; ++i) {
+    int64_t producer_id = 0;
+    if (!Take(data, producer_id) || producer_id <= 0) {
+      return common::Error<ProducerSnapshot>(absl::StatusCode::kDataLoss, "Invalid snapshot producer id");
+    }
+
+    int32_t batch_count = 0;
+    if (!Take(data, batch_count) || batch_count < 0 || batch_count > static_cast<int32_t>(SequenceWindow::kSize)) {
+      return common::Error<ProducerSnapshot>(absl::StatusCode::kDataLoss, "Invalid snapshot batch count");
+    }
+
+    std::vector<SequenceWindow::Batch> batches(batch_count);
+    for (auto& batch : batches) {
+      if (!Take(data, batch.sequence) || !Take(data, batch.offset)) {
+        return common::Error<ProducerSnapshot>(absl::StatusCode::kDataLoss, "Snapshot file truncated");
+      }
+    }
+    snapshot.producers.emplace_back(producer_id, std::move(batches));
+  }
+
+  return common::Ok(std::move(snapshot));
+}
+
+void ProducerSnapshotter::Restore(const ProducerKey& key, int64_t sequence, int64_t offset) noexcept {
+  table_->UpdateSequence(key, sequence, offset);
+  max_producer_id_ = std::max(max_producer_id_, key.producer_id);
+}
+
+common::Result<size_t> ProducerSnapshotter::ReplayLog(common::TopicPartition tp, int64_t from_offset) noexcept {
+  auto segments_result = log_dir_->GetSegments(tp);
+  if (!segments_result.ok()) {
+    return common::Error<size_t>(segments_result.status());
+  }
+
+  size_t replayed = 0;
+  for (const auto& segment : segments_result.value()) {
+    int64_t offset = std::max(from_offset, segment->BaseOffset());
+    while (offset < segment->EndOffset()) {
+      auto batches_result = segment->Read(offset, kReplayChunkBytes);
+      if (batches_result.ok() && batches_result.value().empty()) {
+        // The next batch is larger than a chunk
+        batches_result = segment->Read(offset, segment->Size());
+      }
+      if (!batches_result.ok()) {
+        return common::Error<size_t>(batches_result.status());
+      }
+      if (batches_result.value().empty()) {
+        break;
+      }
+
+      for (const auto& batch : batches_result.value()) {
+        if (batch.producer_id > 0) {
+          Restore(ProducerKey{batch.producer_id, tp.topic, tp.partition}, batch.sequence, batch.base_offset);
+        }
+        offset = batch.base_offset + static_cast<int64_t>(batch.records.size());
+        ++replayed;
+      }
+    }
+  }
+
+  return common::Ok(std::move(replayed));
+}
+
+} // namespace streamit::broker
@@ -0,0 +1,172 @@
+#include "streamit/broker/quota_manager.h"
+#include <algorithm>
+#include <cmath>
+
+namespace streamit::broker {
+
+namespace {
+// Buckets hold one second of their rate so short bursts are absorbed
+constexpr double kBurstSeconds = 1.0;
+} // namespace
+
+TokenBucket::TokenBucket(double rate_per_sec, double burst, Clock::time_point now) noexcept
+    : rate_per_sec_(rate_per_sec), burst_(burst), tokens_(burst), last_update_(now) {
+}
+
+std::chrono::milliseconds TokenBucket::Delay(Clock::time_point now) noexcept {
+  // A zero rate means the bucket is unlimited
+  if (rate_per_sec_ <= 0) {
+    return std::chrono::milliseconds(0);
+  }
+
+  Refill(now);
+  if (tokens_ >= 0) {
+    return std::chrono::milliseconds(0);
+  }
+
+  return std::chrono::milliseconds(static_cast<int64_t>(std::ceil(-tokens_ / rate_per_sec_ * 1000.0)));
+}
+
+void TokenBucket::Consume(double amount, Clock::time_point now) noexcept {
+  if (rate_per_sec_ <= 0) {
+    return;
+  }
+
+  Refill(now);
+  tokens_ -= amount;
+}
+
+TokenBucket::Clock::time_point TokenBucket::LastUpdate() const noexcept {
+  return last_update_;
+}
+
+void TokenBucket::Refill(Clock::time_point now) noexcept {
+  if (now <= last_update_) {
+    return;
+  }
+
+  double elapsed_sec = std::chrono::duration<double>(now - last_update_).count();
+  tokens_ = std::min(burst_, tokens_ + elapsed_sec * rate_per_sec_);
+  last_update_ = now;
+}
+
+QuotaManager::QuotaManager(QuotaConfig config) : config_(config), requests_since_sweep_(0) {
+}
+
+QuotaDecision QuotaManager::Acquire(const QuotaSubject& subject, int64_t bytes, Clock::time_point now) noexcept {
+  if (!Enabled()) {
+    return {};
+  }
+
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  if (++requests_since_sweep_ >= kSweepInterval) {
+    SweepIdle(now);
+    requests_since_sweep_ = 0;
+  }
+
+  EntityBuckets* producer = GetBuckets(producers_, config_.producer, subject.producer_id, now);
+  EntityBuckets* client = GetBuckets(clients_, config_.client, subject.client, now);
+  EntityBuckets* topic = GetBuckets(topics_, config_.topic, subject.topic, now);
+
+  // Report the entity with the longest delay so the client backs off long enough for all of them
+  QuotaDecision decision;
+  for (auto [buckets, entity] : {std::pair{producer, "producer"}, std::pair{client, "client"},
+                                 std::pair{topic, "topic"}}) {
+    auto delay = Delay(buckets, now);
+    if (delay > decision.throttle) {
+      decision.throttle = delay;
+      decision.entity = entity;
+    }
+  }
+
+  if (decision.Throttled()) {
+    return decision;
+  }
+
+  for (EntityBuckets* buckets : {producer, client, topic}) {
+    if (buckets) {
+      buckets->requests.Consume(1, now);
+      buckets->bytes.Consume(static_cast<double>(bytes), now);
+    }
+  }
+  return decision;
+}
+
+void QuotaManager::RecordBytes(const QuotaSubject& subject, int64_t bytes, Clock::time_point now) noexcept {
+  if (!Enabled() || bytes <= 0) {
+    return;
+  }
+
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  for (EntityBuckets* buckets : {GetBuckets(producers_, config_.producer, subject.producer_id, now),
+                                 GetBuckets(clients_, config_.client, subject.client, now),
+                                 GetBuckets(topics_, config_.topic, subject.topic, now)}) {
+    if (buckets) {
+      buckets->bytes.Consume(static_cast<double>(bytes), now);
+    }
+  }
+}
+
+bool QuotaManager::Enabled() const noexcept {
+  return config_.producer.Enabled() || config_.client.Enabled() || config_.topic.Enabled();
+}
+
+size_t QuotaManager::Size() const noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+  return producers_.size() + clients_.size() + topics_.size();
+}
+
+std::string QuotaManager::ClientAddress(std::string_view peer) noexcept {
+  auto prefix_end = peer.find(':');
+  if (prefix_end != std::string_view::npos && (peer.starts_with("ipv4:") || peer.starts_with("ipv6:"))) {
+    peer.remove_prefix(prefix_end + 1);
+  }
+
+  // Drop the port; IPv6 addresses are bracketed so the last colon is always the port separator
+  auto port_start = peer.rfind(':');
+  if (port_start != std::string_view::npos && (peer.front() == '[' || peer.find(':') == port_start)) {
+    peer = peer.substr(0, port_start);
+  }
+
+  if (peer.size() >= 2 && peer.front() == '[' && peer.back() == ']') {
+    peer = peer.substr(1, peer.size() - 2);
+  }
+
+  return std::string(peer);
+}
+
+QuotaManager::EntityBuckets* QuotaManager::GetBuckets(BucketMap& map, const QuotaLimit& limit,
+                                                      const std::string& name, Clock::time_point now) noexcept {
+  if (!limit.Enabled() || name.empty()) {
+    return nullptr;
+  }
+
+  auto it = map.find(name);
+  if (it == map.end()) {
+    it = map.emplace(name, EntityBuckets{TokenBucket(limit.bytes_per_sec, limit.bytes_per_sec * kBurstSeconds, now),
+                                         TokenBucket(limit.requests_per_sec, limit.requests_per_sec * kBurstSeconds,
+                                                     now)})
+             .first;
+  }
+  return &it->second;
+}
+
+std::chrono::milliseconds QuotaManager::Delay(EntityBuckets* buckets, Clock::time_point now) noexcept {
+  if (!buckets) {
+    return std::chrono::milliseconds(0);
+  }
+  return std::max(buckets->bytes.Delay(now), buckets->requests.Delay(now));
+}
+
+void QuotaManager::SweepIdle(Clock::time_point now) noexcept {
+  for (BucketMap* map : {&producers_, &clients_, &topics_}) {
+    std::erase_if(*map, [now](const auto& entry) {
+      auto last_update = std::max(entry.second.bytes.LastUpdate(), entry.second.requests.LastUpdate());
+      return now - last_update > kIdleTimeout;
+    });
+  }
+}
+
+} // namespace streamit::broker
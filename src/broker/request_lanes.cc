@@ -0,0 +1,51 @@
+#include "streamit/broker/request_lanes.h"
+#include <string>
+
+namespace streamit::broker {
+
+RequestLanes::RequestLanes(const RequestLaneConfig& config)
+    : tail_fetch_max_lag_(config.tail_fetch_max_lag), flush_executor_("broker-flush", config.flush_threads) {
+  const std::array<size_t, kNumRequestClasses> threads{config.produce_threads, config.tail_fetch_threads,
+                                                       config.catch_up_fetch_threads, config.admin_threads};
+
+  for (size_t i = 0; i < kNumRequestClasses; ++i) {
+    auto request_class = static_cast<RequestClass>(i);
+    executors_[i] =
+        std::make_unique<common::Executor>("broker-" + std::string(Name(request_class)), threads[i]);
+  }
+}
+
+common::Executor& RequestLanes::For(RequestClass request_class) noexcept {
+  return *executors_[static_cast<size_t>(request_class)];
+}
+
+common::Executor& RequestLanes::Flush() noexcept {
+  return flush_executor_;
+}
+
+RequestClass RequestLanes::ClassifyFetch(int64_t offset, int64_t high_watermark) const noexcept {
+  return high_watermark - offset <= tail_fetch_max_lag_ ? RequestClass::kTailFetch : RequestClass::kCatchUpFetch;
+}
+
+void RequestLanes::Shutdown() noexcept {
+  for (auto& executor : executors_) {
+    executor->Shutdown();
+  }
+  flush_executor_.Shutdown();
+}
+
+std::string_view RequestLanes::Name(RequestClass request_class) noexcept {
+  switch (request_class) {
+  case RequestClass::kProduce:
+    return "produce";
+  case RequestClass::kTailFetch:
+    return "tail_fetch";
+  case RequestClass::kCatchUpFetch:
+    return "catch_up_fetch";
+  case RequestClass::kAdmin:
+    return "admin";
+  }
+  return "unknown";
+}
+
+} // namespace streamit::broker
@@ -0,0 +1,117 @@
+#include "streamit/broker/sequence_waiters.h"
+#include <algorithm>
+
+namespace streamit::broker {
+
+SequenceWaiters::SequenceWaiters(const IdempotencyTable& table, common::TimerService& timers)
+    : table_(table), timers_(timers) {
+}
+
+bool SequenceWaiters::Register(const std::shared_ptr<Waiter>& waiter, std::chrono::milliseconds timeout) noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  if (stopped_) {
+    return false;
+  }
+
+  // The batch ahead may have been appended between the caller's check and this registration; Notify runs after
+  // the table is updated and takes mutex_, so either this check or that Notify sees it
+  if (table_.CheckSequence(waiter->key, waiter->sequence).status != SequenceStatus::kPending) {
+    waiter->ready = true;
+    return false;
+  }
+
+  waiter->timer_id = timers_.ScheduleAfter(timeout, [this, waiter] { Expire(waiter); });
+  if (waiter->timer_id == 0) {
+    // Timer service is shutting down; nothing would ever expire the wait
+    return false;
+  }
+
+  waiters_[waiter->key].push_back(waiter);
+  return true;
+}
+
+void SequenceWaiters::Notify(const ProducerKey& key, int64_t sequence) noexcept {
+  std::vector<std::shared_ptr<Waiter>> ready;
+  {
+    std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+    auto it = waiters_.find(key);
+    if (it == waiters_.end()) {
+      return;
+    }
+
+    auto& waiters = it->second;
+    auto next = std::partition(waiters.begin(), waiters.end(), [sequence](const std::shared_ptr<Waiter>& waiter) {
+      return waiter->sequence != sequence + 1;
+    });
+    ready.assign(next, waiters.end());
+    waiters.erase(next, waiters.end());
+    if (waiters.empty()) {
+      waiters_.erase(it);
+    }
+  }
+
+  for (const auto& waiter : ready) {
+    timers_.Cancel(waiter->timer_id);
+    Resume(waiter, true);
+  }
+}
+
+void SequenceWaiters::Shutdown() noexcept {
+  std::vector<std::shared_ptr<Waiter>> parked;
+  {
+    std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+    stopped_ = true;
+    for (auto& [key, waiters] : waiters_) {
+      parked.insert(parked.end(), waiters.begin(), waiters.end());
+    }
+    waiters_.clear();
+  }
+
+  for (const auto& waiter : parked) {
+    timers_.Cancel(waiter->timer_id);
+    Resume(waiter, false);
+  }
+}
+
+size_t SequenceWaiters::Size() const noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  size_t total = 0;
+  for (const auto& [key, waiters] : waiters_) {
+    total += waiters.size();
+  }
+  return total;
+}
+
+void SequenceWaiters::Expire(const std::shared_ptr<Waiter>& waiter) noexcept {
+  {
+    std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+    auto it = waiters_.find(waiter->key);
+    if (it != waiters_.end()) {
+      auto& waiters = it->second;
+      waiters.erase(std::remove(waiters.begin(), waiters.end(), waiter), waiters.end());
+      if (waiters.empty()) {
+        waiters_.erase(it);
+      }
+    }
+  }
+
+  Resume(waiter, false);
+}
+
+void SequenceWaiters::Resume(const std::shared_ptr<Waiter>& waiter, bool ready) noexcept {
+  if (waiter->fired.exchange(true)) {
+    return;
+  }
+
+  waiter->ready = ready;
+  auto handle = waiter->handle;
+  if (waiter->executor) {
+    waiter->executor->Post([handle] { handle.resume(); });
+  } else {
+    handle.resume();
+  }
+}
+
+} // namespace streamit::broker
@@ -0,0 +1,64 @@
+#include "streamit/broker/sequence_window.h"
+#include <algorithm>
+
+namespace streamit::broker {
+
+SequenceCheck SequenceWindow::Check(int64_t sequence) const noexcept {
+  if (size_ == 0) {
+    // A producer the table has never seen (or has forgotten) may start at any sequence
+    return SequenceCheck{SequenceStatus::kAccept, -1, -1};
+  }
+
+  int64_t expected = last_sequence_ + 1;
+  if (sequence == expected) {
+    return SequenceCheck{SequenceStatus::kAccept, -1, expected};
+  }
+  if (sequence > expected && sequence - expected < static_cast<int64_t>(kSize)) {
+    return SequenceCheck{SequenceStatus::kPending, -1, expected};
+  }
+  if (sequence > expected) {
+    return SequenceCheck{SequenceStatus::kOutOfOrder, -1, expected};
+  }
+  if (sequence > last_sequence_ - static_cast<int64_t>(size_)) {
+    return SequenceCheck{SequenceStatus::kDuplicate, offsets_[SlotOf(sequence)], expected};
+  }
+  return SequenceCheck{SequenceStatus::kStale, -1, expected};
+}
+
+void SequenceWindow::Record(int64_t sequence, int64_t offset) noexcept {
+  if (size_ == 0 || sequence != last_sequence_ + 1) {
+    size_ = 0;
+  }
+
+  offsets_[SlotOf(sequence)] = offset;
+  last_sequence_ = sequence;
+  size_ = std::min(size_ + 1, kSize);
+}
+
+int64_t SequenceWindow::LastSequence() const noexcept {
+  return size_ == 0 ? -1 : last_sequence_;
+}
+
+int64_t SequenceWindow::LastOffset() const noexcept {
+  return size_ == 0 ? -1 : offsets_[SlotOf(last_sequence_)];
+}
+
+size_t SequenceWindow::Size() const noexcept {
+  return size_;
+}
+
+std::vector<SequenceWindow::Batch> SequenceWindow::Batches() const {
+  std::vector<Batch> batches;
+  batches.reserve(size_);
+  for (int64_t sequence = last_sequence_ - static_cast<int64_t>(size_) + 1; sequence <= last_sequence_; ++sequence) {
+    batches.push_back(Batch{sequence, offsets_[SlotOf(sequence)]});
+  }
+  return batches;
+}
+
+size_t SequenceWindow::SlotOf(int64_t sequence) noexcept {
+  // Sequences are non-negative (validated at the RPC boundary)
+  return static_cast<size_t>(sequence) % kSize;
+}
+
+} // namespace streamit::broker
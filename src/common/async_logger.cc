@@ -0,0 +1,135 @@
+#include "streamit/common/async_logger.h"
+
+namespace streamit::common {
+
+namespace {
+
+int64_t SteadyNanos(std::chrono::steady_clock::time_point time) noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+AsyncLogger::AsyncLogger(std::shared_ptr<spdlog::logger> logger, size_t capacity)
+    : logger_(std::move(logger)), queue_(capacity), writer_([this] { Run(); }) {
+}
+
+AsyncLogger::~AsyncLogger() {
+  Stop();
+}
+
+void AsyncLogger::Log(spdlog::level::level_enum level, std::string message) noexcept {
+  if (stopping_.load(std::memory_order_acquire)) {
+    logger_->log(spdlog::source_loc{}, level, message);
+    return;
+  }
+
+  if (!queue_.TryPush(Record{level, spdlog::log_clock::now(), std::move(message)})) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  queued_.fetch_add(1, std::memory_order_release);
+  Wake();
+}
+
+void AsyncLogger::Flush() {
+  auto target = queued_.load(std::memory_order_acquire);
+  while (!stopping_.load(std::memory_order_acquire) && written_.load(std::memory_order_acquire) < target) {
+    Wake();
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  logger_->flush();
+}
+
+void AsyncLogger::Stop() {
+  if (stopping_.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  Wake();
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+
+  // Pick up anything pushed while the writer was finishing
+  written_.fetch_add(static_cast<int64_t>(Drain()), std::memory_order_release);
+  logger_->flush();
+}
+
+int64_t AsyncLogger::Dropped() const noexcept {
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+void AsyncLogger::Run() {
+  int64_t reported_drops = 0;
+  while (true) {
+    // Read before draining, so everything queued before Stop is written before the thread exits
+    bool stopping = stopping_.load(std::memory_order_acquire);
+
+    size_t written = Drain();
+    auto dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reported_drops) {
+      logger_->log(spdlog::level::warn, "Dropped {} log messages: queue full", dropped - reported_drops);
+      reported_drops = dropped;
+    }
+    if (written > 0) {
+      logger_->flush();
+      written_.fetch_add(static_cast<int64_t>(written), std::memory_order_release);
+    }
+    if (stopping) {
+      return;
+    }
+
+    // Sleep until a producer pushes. The fences pair with the one in Wake: either the producer sees sleeping_ set,
+    // or this thread sees the producer's record.
+    sleeping_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!queue_.Empty() || stopping_.load(std::memory_order_relaxed)) {
+      sleeping_.store(false, std::memory_order_relaxed);
+      continue;
+    }
+    sleeping_.wait(true, std::memory_order_acquire);
+  }
+}
+
+size_t AsyncLogger::Drain() {
+  size_t written = 0;
+  Record record;
+  while (queue_.TryPop(record)) {
+    logger_->log(record.time, spdlog::source_loc{}, record.level, record.message);
+    ++written;
+  }
+  return written;
+}
+
+void AsyncLogger::Wake() noexcept {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleeping_.load(std::memory_order_relaxed) && sleeping_.exchange(false, std::memory_order_acq_rel)) {
+    sleeping_.notify_one();
+  }
+}
+
+LogRateLimiter::LogRateLimiter(int64_t per_second) noexcept
+    : per_second_(per_second), window_start_ns_(SteadyNanos(std::chrono::steady_clock::now())) {
+}
+
+bool LogRateLimiter::Allow(int64_t& suppressed) noexcept {
+  return Allow(suppressed, std::chrono::steady_clock::now());
+}
+
+bool LogRateLimiter::Allow(int64_t& suppressed, std::chrono::steady_clock::time_point now) noexcept {
+  auto now_ns = SteadyNanos(now);
+  auto start = window_start_ns_.load(std::memory_order_relaxed);
+  if (now_ns - start >= 1'000'000'000 &&
+      window_start_ns_.compare_exchange_strong(start, now_ns, std::memory_order_relaxed)) {
+    window_count_.store(0, std::memory_order_relaxed);
+  }
+
+  if (window_count_.fetch_add(1, std::memory_order_relaxed) >= per_second_) {
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+  return true;
+}
+
+} // namespace streamit::common
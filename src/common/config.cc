@@ -107,6 +107,20 @@ int64_t GetInt64(const std::unordered_map<std::string, std::string>& config, con
   }
 }
 
+// Helper to get double value with default
+double GetDouble(const std::unordered_map<std::string, std::string>& config, const std::string& key,
+                 double default_value) {
+  auto it = config.find(key);
+  if (it == config.end()) {
+    return default_value;
+  }
+  try {
+    return std::stod(it->second);
+  } catch (...) {
+    return default_value;
+  }
+}
+
 } // namespace
 
 BrokerConfig ConfigLoader::LoadBrokerConfig(const std::string& config_path) {
@@ -126,6 +140,14 @@ BrokerConfig ConfigLoader::LoadBrokerConfig(const std::string& config_path) {
   broker_config.max_segment_size_bytes = GetSizeT(config, "max_segment_size_bytes", 128 * 1024 * 1024);
   broker_config.segment_roll_interval_ms = GetInt64(config, "segment_roll_interval_ms", 3600000);
   broker_config.max_inflight_bytes = GetSizeT(config, "max_inflight_bytes", 100 * 1024 * 1024);
+  broker_config.max_inflight_wait_ms = GetInt32(config, "max_inflight_wait_ms", 1000);
+  broker_config.idempotency_shards = GetSizeT(config, "idempotency_shards", 16);
+  broker_config.producer_snapshot_interval_ms = GetInt64(config, "producer_snapshot_interval_ms", 60000);
+  broker_config.checkpoint_interval_ms = GetInt64(config, "checkpoint_interval_ms", 5000);
+  broker_config.slow_request_threshold_ms = GetInt64(config, "slow_request_threshold_ms", 100);
+  broker_config.slow_request_log_size = GetSizeT(config, "slow_request_log_size", 256);
+  broker_config.slow_request_sample_one_in =
+      static_cast<uint32_t>(GetInt64(config, "slow_request_sample_one_in", 1));
   broker_config.replication_factor = GetInt32(config, "replication_factor", 1);
   broker_config.min_insync_replicas = GetInt32(config, "min_insync_replicas", 1);
   broker_config.request_timeout_ms = GetInt32(config, "request_timeout_ms", 30000);
@@ -133,6 +155,26 @@ BrokerConfig ConfigLoader::LoadBrokerConfig(const std::string& config_path) {
   broker_config.enable_metrics = GetString(config, "enable_metrics", "true") == "true";
   broker_config.metrics_port = GetUint16(config, "metrics_port", 8080);
   broker_config.log_level = GetString(config, "log_level", "info");
+  broker_config.log_sample_one_in = static_cast<uint32_t>(GetInt64(config, "log_sample_one_in", 100));
+  broker_config.log_queue_capacity = GetSizeT(config, "log_queue_capacity", 8192);
+  broker_config.lock_profiling = GetString(config, "lock_profiling", "sampled");
+  broker_config.trace_otlp_endpoint = GetString(config, "trace_otlp_endpoint", "");
+  broker_config.trace_export_path = GetString(config, "trace_export_path", "");
+  broker_config.trace_export_interval_ms = GetInt64(config, "trace_export_interval_ms", 1000);
+  broker_config.trace_export_batch_size = GetSizeT(config, "trace_export_batch_size", 512);
+  broker_config.trace_queue_capacity = GetSizeT(config, "trace_queue_capacity", 65536);
+  broker_config.produce_threads = GetSizeT(config, "produce_threads", 4);
+  broker_config.tail_fetch_threads = GetSizeT(config, "tail_fetch_threads", 2);
+  broker_config.catch_up_fetch_threads = GetSizeT(config, "catch_up_fetch_threads", 2);
+  broker_config.admin_threads = GetSizeT(config, "admin_threads", 1);
+  broker_config.flush_threads = GetSizeT(config, "flush_threads", 2);
+  broker_config.tail_fetch_max_lag = GetInt64(config, "tail_fetch_max_lag", 1000);
+  broker_config.quota_producer_bytes_per_sec = GetDouble(config, "quota_producer_bytes_per_sec", 0);
+  broker_config.quota_producer_requests_per_sec = GetDouble(config, "quota_producer_requests_per_sec", 0);
+  broker_config.quota_client_bytes_per_sec = GetDouble(config, "quota_client_bytes_per_sec", 0);
+  broker_config.quota_client_requests_per_sec = GetDouble(config, "quota_client_requests_per_sec", 0);
+  broker_config.quota_topic_bytes_per_sec = GetDouble(config, "quota_topic_bytes_per_sec", 0);
+  broker_config.quota_topic_requests_per_sec = GetDouble(config, "quota_topic_requests_per_sec", 0);
 
   return broker_config;
 }
@@ -0,0 +1,219 @@
+#include "streamit/common/cpu_profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <csignal>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fmt/format.h>
+#include <map>
+#include <memory>
+#include <sys/prctl.h>
+#include <sys/time.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace streamit::common {
+
+namespace {
+
+constexpr int kMaxDepth = 48;
+
+// Innermost frames of every backtrace taken in the handler: the handler itself and the signal trampoline
+constexpr int kSkipFrames = 2;
+
+// Upper bound on buffered samples per profile (about 25MB at kMaxDepth)
+constexpr size_t kMaxSamples = 1 << 16;
+
+struct Sample {
+  char thread[16]; // Thread name as set by pthread_setname_np
+  int depth;
+  void* frames[kMaxDepth];
+};
+
+struct Profile {
+  explicit Profile(size_t capacity) : samples(new Sample[capacity]), capacity(capacity) {
+  }
+
+  std::unique_ptr<Sample[]> samples;
+  size_t capacity;
+  std::atomic<size_t> next{0};
+};
+
+// Profile being sampled, and handlers currently running against it. Both are seq_cst so Stop either sees a
+// handler in flight or the handler sees the profile gone.
+std::atomic<Profile*> g_profile{nullptr};
+std::atomic<int> g_handlers{0};
+std::atomic<bool> g_busy{false};
+
+// Async-signal-safe: no locks, no allocation. backtrace() is warmed up before the timer starts so its lazy
+// loading of the unwinder has already happened.
+void OnSigprof(int, siginfo_t*, void*) {
+  int saved_errno = errno;
+  g_handlers.fetch_add(1);
+  if (auto* profile = g_profile.load(); profile != nullptr) {
+    auto index = profile->next.fetch_add(1, std::memory_order_relaxed);
+    if (index < profile->capacity) {
+      auto& sample = profile->samples[index];
+      sample.depth = backtrace(sample.frames, kMaxDepth);
+      if (prctl(PR_GET_NAME, sample.thread) != 0) {
+        sample.thread[0] = '\0';
+      }
+    }
+  }
+  g_handlers.fetch_sub(1);
+  errno = saved_errno;
+}
+
+bool SetTimer(int frequency_hz) {
+  itimerval timer{};
+  if (frequency_hz > 0) {
+    timer.it_interval.tv_usec = 1000000 / frequency_hz;
+    timer.it_value = timer.it_interval;
+  }
+  return setitimer(ITIMER_PROF, &timer, nullptr) == 0;
+}
+
+// Function name for an address, or module+offset when the symbol is not exported
+std::string Symbolize(void* address) {
+  Dl_info info{};
+  if (dladdr(address, &info) == 0) {
+    return fmt::format("{}", address);
+  }
+  if (info.dli_sname != nullptr) {
+    int status = 0;
+    std::unique_ptr<char, decltype(&std::free)> demangled(abi::__cxa_demangle(info.dli_sname, nullptr, nullptr,
+                                                                              &status),
+                                                          &std::free);
+    std::string name = status == 0 ? demangled.get() : info.dli_sname;
+
+    // Folded stacks separate frames with ';'
+    std::replace(name.begin(), name.end(), ';', ':');
+    return name;
+  }
+  std::string_view module = info.dli_fname != nullptr ? info.dli_fname : "?";
+  module = module.substr(module.rfind('/') + 1);
+  return fmt::format("{}+{:#x}", module,
+                     reinterpret_cast<uintptr_t>(address) - reinterpret_cast<uintptr_t>(info.dli_fbase));
+}
+
+std::string Fold(const Profile& profile, size_t count) {
+  std::unordered_map<void*, std::string> symbols;
+  std::map<std::string, int64_t> stacks;
+
+  std::string stack;
+  for (size_t i = 0; i < count; ++i) {
+    const auto& sample = profile.samples[i];
+    stack.assign(sample.thread[0] != '\0' ? sample.thread : "unknown");
+    for (int frame = sample.depth - 1; frame >= kSkipFrames; --frame) {
+      // Return addresses point after the call; step back into it. The innermost frame is the interrupted pc.
+      auto* address = static_cast<char*>(sample.frames[frame]) - (frame == kSkipFrames ? 0 : 1);
+      auto [it, inserted] = symbols.try_emplace(address);
+      if (inserted) {
+        it->second = Symbolize(address);
+      }
+      stack += ';';
+      stack += it->second;
+    }
+    ++stacks[stack];
+  }
+
+  std::string out;
+  for (const auto& [folded, samples] : stacks) {
+    out += fmt::format("{} {}\n", folded, samples);
+  }
+  return out;
+}
+
+} // namespace
+
+Result<std::string> CpuProfiler::Collect(const CpuProfileOptions& options) {
+  if (options.duration <= std::chrono::seconds(0) || options.duration > kMaxDuration) {
+    return Error<std::string>(absl::StatusCode::kInvalidArgument,
+                              fmt::format("Profile duration must be 1 to {} seconds", kMaxDuration.count()));
+  }
+  if (options.frequency_hz <= 0 || options.frequency_hz > kMaxFrequencyHz) {
+    return Error<std::string>(absl::StatusCode::kInvalidArgument,
+                              fmt::format("Profile frequency must be 1 to {} Hz", kMaxFrequencyHz));
+  }
+  if (g_busy.exchange(true)) {
+    return Error<std::string>(absl::StatusCode::kUnavailable, "A CPU profile is already running");
+  }
+
+  // Warm up the unwinder outside the signal handler
+  void* warmup[1];
+  backtrace(warmup, 1);
+
+  // Installed once and left in place: a SIGPROF still pending when a profile stops must not hit SIG_DFL
+  static const bool installed = [] {
+    struct sigaction action{};
+    action.sa_sigaction = OnSigprof;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    return sigaction(SIGPROF, &action, nullptr) == 0;
+  }();
+  if (!installed) {
+    g_busy.store(false);
+    return Error<std::string>(absl::StatusCode::kInternal, "Cannot install the SIGPROF handler");
+  }
+
+  // Enough room for every core to be busy for the whole profile
+  auto expected = static_cast<size_t>(options.frequency_hz) * static_cast<size_t>(options.duration.count()) *
+                  std::max(1u, std::thread::hardware_concurrency());
+  Profile profile(std::min(expected, kMaxSamples));
+
+  g_profile.store(&profile);
+  if (!SetTimer(options.frequency_hz)) {
+    g_profile.store(nullptr);
+    g_busy.store(false);
+    return Error<std::string>(absl::StatusCode::kInternal, "Cannot start the profiling timer");
+  }
+  std::this_thread::sleep_for(options.duration);
+  SetTimer(0);
+
+  // Handlers that already saw the profile finish before it is read
+  g_profile.store(nullptr);
+  while (g_handlers.load() != 0) {
+    std::this_thread::yield();
+  }
+
+  auto taken = profile.next.load();
+  auto folded = Fold(profile, std::min(taken, profile.capacity));
+  if (taken > profile.capacity) {
+    folded += fmt::format("dropped {}\n", taken - profile.capacity);
+  }
+  g_busy.store(false);
+  return folded;
+}
+
+HttpResponse ServeCpuProfile(const HttpRequest& request) {
+  CpuProfileOptions options;
+  auto parse = [&request](const char* key, int& value) {
+    auto it = request.query.find(key);
+    if (it == request.query.end()) {
+      return true;
+    }
+    const auto& text = it->second;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+  };
+
+  int seconds = static_cast<int>(options.duration.count());
+  if (!parse("seconds", seconds) || !parse("hz", options.frequency_hz)) {
+    return {400, "seconds and hz must be integers\n"};
+  }
+  options.duration = std::chrono::seconds(seconds);
+
+  auto profile = CpuProfiler::Collect(options);
+  if (!profile.ok()) {
+    int code = profile.status().code() == absl::StatusCode::kInvalidArgument ? 400 : 503;
+    return {code, std::string(profile.status().message()) + "\n"};
+  }
+  return {200, std::move(*profile)};
+}
+
+} // namespace streamit::common
@@ -0,0 +1,98 @@
+#include "streamit/common/executor.h"
+#include <pthread.h>
+
+namespace streamit::common {
+
+namespace {
+thread_local Executor* current_executor = nullptr;
+} // namespace
+
+Executor::Executor(std::string name, size_t num_threads) : name_(std::move(name)), stopped_(false) {
+  if (num_threads == 0) {
+    num_threads = 1;
+  }
+
+  workers_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(&Executor::WorkerLoop, this);
+  }
+}
+
+Executor::~Executor() {
+  Shutdown();
+}
+
+bool Executor::Post(std::function<void()> fn) noexcept {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) {
+      return false;
+    }
+    queue_.push_back(std::move(fn));
+  }
+  cv_.notify_one();
+  return true;
+}
+
+void Executor::Shutdown() noexcept {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+  }
+  cv_.notify_all();
+
+  for (auto& worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+size_t Executor::QueueDepth() const noexcept {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.size();
+}
+
+size_t Executor::NumThreads() const noexcept {
+  return workers_.size();
+}
+
+const std::string& Executor::Name() const noexcept {
+  return name_;
+}
+
+Executor* Executor::Current() noexcept {
+  return current_executor;
+}
+
+void Executor::WorkerLoop() noexcept {
+  current_executor = this;
+
+  // Shows up in profiles and top -H (the kernel keeps 15 characters)
+  pthread_setname_np(pthread_self(), name_.substr(0, 15).c_str());
+
+  while (true) {
+    std::function<void()> fn;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return stopped_ || !queue_.empty(); });
+
+      // Drain remaining work before exiting so suspended coroutines are not lost
+      if (queue_.empty()) {
+        break;
+      }
+
+      fn = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    fn();
+  }
+
+  current_executor = nullptr;
+}
+
+} // namespace streamit::common
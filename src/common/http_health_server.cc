@@ -1,20 +1,74 @@
 #include "streamit/common/http_health_server.h"
+#include <cerrno>
 #include <cstring>
 #include <netinet/in.h>
 #include <sstream>
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <unistd.h>
 
 namespace streamit::common {
 
-HttpHealthServer::HttpHealthServer(const std::string& host, uint16_t port, std::shared_ptr<HealthCheckManager> manager)
-    : host_(host), port_(port), manager_(std::move(manager)), running_(false) {
+HttpHealthServer::HttpHealthServer(const std::string& host, uint16_t port, std::shared_ptr<HealthCheckManager> manager,
+                                   Executor* executor)
+    : host_(host), port_(port), manager_(std::move(manager)), running_(false), executor_(executor),
+      listen_socket_(-1), pending_requests_(0) {
 }
 
 HttpHealthServer::~HttpHealthServer() {
   Stop();
 }
 
+void HttpHealthServer::AddHandler(std::string path, HttpHandler handler) {
+  handlers_[std::move(path)] = std::move(handler);
+}
+
+void HttpHealthServer::AddBlockingHandler(std::string path, HttpHandler handler) {
+  blocking_paths_.insert(path);
+  AddHandler(std::move(path), std::move(handler));
+}
+
+HttpRequest HttpHealthServer::ParseRequestLine(const std::string& request) noexcept {
+  HttpRequest parsed;
+
+  auto line_end = request.find("\r\n");
+  std::string line = request.substr(0, line_end);
+
+  auto method_end = line.find(' ');
+  if (method_end == std::string::npos) {
+    return parsed;
+  }
+  parsed.method = line.substr(0, method_end);
+
+  auto target_end = line.find(' ', method_end + 1);
+  std::string target = line.substr(method_end + 1, target_end == std::string::npos ? std::string::npos
+                                                                                      : target_end - method_end - 1);
+
+  auto query_start = target.find('?');
+  parsed.path = target.substr(0, query_start);
+  if (query_start == std::string::npos) {
+    return parsed;
+  }
+
+  // a=1&b=2 (values are not percent-decoded; the endpoints only take plain numbers and names)
+  std::string query = target.substr(query_start + 1);
+  size_t pos = 0;
+  while (pos <= query.size()) {
+    auto pair_end = query.find('&', pos);
+    std::string pair = query.substr(pos, pair_end == std::string::npos ? std::string::npos : pair_end - pos);
+    if (!pair.empty()) {
+      auto eq = pair.find('=');
+      parsed.query[pair.substr(0, eq)] = eq == std::string::npos ? "" : pair.substr(eq + 1);
+    }
+    if (pair_end == std::string::npos) {
+      break;
+    }
+    pos = pair_end + 1;
+  }
+
+  return parsed;
+}
+
 bool HttpHealthServer::Start() noexcept {
   if (running_.load()) {
     return true;
@@ -31,9 +85,16 @@ bool HttpHealthServer::Stop() noexcept {
   }
 
   running_.store(false);
+  if (int socket = listen_socket_.load(); socket >= 0) {
+    shutdown(socket, SHUT_RDWR);
+  }
   if (server_thread_ && server_thread_->joinable()) {
     server_thread_->join();
   }
+
+  // Handlers running on the executor reference this server
+  std::unique_lock<std::mutex> lock(pending_mutex_);
+  pending_cv_.wait(lock, [this] { return pending_requests_ == 0; });
   return true;
 }
 
@@ -64,6 +125,7 @@ void HttpHealthServer::ServerLoop() {
     close(server_socket);
     return;
   }
+  listen_socket_.store(server_socket);
 
   while (running_.load()) {
     struct sockaddr_in client_addr;
@@ -71,31 +133,88 @@ void HttpHealthServer::ServerLoop() {
 
     int client_socket = accept(server_socket, (struct sockaddr*)&client_addr, &client_len);
     if (client_socket < 0) {
+      if (errno == EINVAL) {
+        break; // Shut down by Stop
+      }
       continue;
     }
 
-    HandleRequest(client_socket);
-    close(client_socket);
+    // The request is read here, under a timeout, so a client that connects and goes quiet delays accepts by at
+    // most kClientTimeout and never holds an executor thread
+    SetClientTimeouts(client_socket);
+    auto request = ReadRequest(client_socket);
+    if (!request) {
+      close(client_socket);
+      continue;
+    }
+    Dispatch(client_socket, std::move(*request));
   }
 
+  listen_socket_.store(-1);
   close(server_socket);
 }
 
-void HttpHealthServer::HandleRequest(int client_socket) {
+void HttpHealthServer::SetClientTimeouts(int client_socket) noexcept {
+  struct timeval timeout{};
+  timeout.tv_sec = kClientTimeout.count();
+  setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(client_socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+std::optional<HttpRequest> HttpHealthServer::ReadRequest(int client_socket) noexcept {
   char buffer[1024];
   ssize_t bytes_read = read(client_socket, buffer, sizeof(buffer) - 1);
   if (bytes_read <= 0) {
-    return;
+    return std::nullopt; // Closed, failed or timed out
   }
 
   buffer[bytes_read] = '\0';
-  std::string request(buffer);
+  return ParseRequestLine(buffer);
+}
 
-  // Simple HTTP request parsing
-  if (request.find("GET /live") != std::string::npos) {
+void HttpHealthServer::Dispatch(int client_socket, HttpRequest request) {
+  if (request.method == "GET" && blocking_paths_.contains(request.path)) {
+    ServeOnOwnThread(client_socket, handlers_.at(request.path), std::move(request));
+    return;
+  }
+
+  if (executor_) {
+    {
+      std::lock_guard<std::mutex> lock(pending_mutex_);
+      ++pending_requests_;
+    }
+    if (executor_->Post([this, client_socket, request] {
+          ServeClient(client_socket, request);
+          std::lock_guard<std::mutex> lock(pending_mutex_);
+          --pending_requests_;
+          pending_cv_.notify_all();
+        })) {
+      return;
+    }
+
+    // Executor already shut down: serve inline
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    --pending_requests_;
+  }
+
+  ServeClient(client_socket, request);
+}
+
+void HttpHealthServer::ServeClient(int client_socket, const HttpRequest& request) {
+  HandleRequest(client_socket, request);
+  close(client_socket);
+}
+
+void HttpHealthServer::HandleRequest(int client_socket, const HttpRequest& parsed) {
+  if (parsed.method != "GET") {
+    SendResponse(client_socket, 404, "Not Found");
+    return;
+  }
+
+  if (parsed.path == "/live") {
     // Liveness check - always return OK if server is running
     SendResponse(client_socket, 200, "OK");
-  } else if (request.find("GET /ready") != std::string::npos) {
+  } else if (parsed.path == "/ready") {
     // Readiness check - run health checks
     if (manager_) {
       auto result = manager_->RunChecks();
@@ -107,15 +226,39 @@ void HttpHealthServer::HandleRequest(int client_socket) {
     } else {
       SendResponse(client_socket, 200, "OK");
     }
-  } else if (request.find("GET /metrics") != std::string::npos) {
-    // Metrics endpoint - return Prometheus metrics
-    SendResponse(client_socket, 200, "# Metrics endpoint - implement Prometheus export here");
+  } else if (auto it = handlers_.find(parsed.path); it != handlers_.end()) {
+    auto response = RunHandler(it->second, parsed);
+    SendResponse(client_socket, response.status_code, response.body, response.content_type);
   } else {
     SendResponse(client_socket, 404, "Not Found");
   }
 }
 
-void HttpHealthServer::SendResponse(int client_socket, int status_code, const std::string& body) {
+void HttpHealthServer::ServeOnOwnThread(int socket, const HttpHandler& handler, HttpRequest request) {
+  {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    ++pending_requests_;
+  }
+  std::thread([this, socket, &handler, request = std::move(request)] {
+    auto response = RunHandler(handler, request);
+    SendResponse(socket, response.status_code, response.body, response.content_type);
+    close(socket);
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    --pending_requests_;
+    pending_cv_.notify_all();
+  }).detach();
+}
+
+HttpResponse HttpHealthServer::RunHandler(const HttpHandler& handler, const HttpRequest& request) noexcept {
+  try {
+    return handler(request);
+  } catch (const std::exception& e) {
+    return {500, std::string("Handler failed: ") + e.what()};
+  }
+}
+
+void HttpHealthServer::SendResponse(int client_socket, int status_code, const std::string& body,
+                                    const std::string& content_type) {
   std::ostringstream response;
   response << "HTTP/1.1 " << status_code << " ";
 
@@ -123,6 +266,9 @@ void HttpHealthServer::SendResponse(int client_socket, int status_code, const st
   case 200:
     response << "OK";
     break;
+  case 400:
+    response << "Bad Request";
+    break;
   case 404:
     response << "Not Found";
     break;
@@ -135,14 +281,22 @@ void HttpHealthServer::SendResponse(int client_socket, int status_code, const st
   }
 
   response << "\r\n";
-  response << "Content-Type: text/plain\r\n";
+  response << "Content-Type: " << content_type << "\r\n";
   response << "Content-Length: " << body.length() << "\r\n";
   response << "Connection: close\r\n";
   response << "\r\n";
   response << body;
 
   std::string response_str = response.str();
-  send(client_socket, response_str.c_str(), response_str.length(), 0);
+  // A scrape can be larger than one send accepts
+  size_t sent = 0;
+  while (sent < response_str.length()) {
+    ssize_t bytes = send(client_socket, response_str.c_str() + sent, response_str.length() - sent, MSG_NOSIGNAL);
+    if (bytes <= 0) {
+      break;
+    }
+    sent += static_cast<size_t>(bytes);
+  }
 }
 
 } // namespace streamit::common
@@ -0,0 +1,160 @@
+#include "streamit/common/instrumented_mutex.h"
+#include "streamit/common/json.h"
+#include "streamit/common/metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <fmt/format.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace streamit::common {
+
+class LockSite {
+public:
+  explicit LockSite(std::string name) : name_(std::move(name)) {
+    auto& registry = MetricsRegistry::Instance();
+    MetricLabels labels{{"lock", name_}};
+    acquisitions = registry.CounterFamily("streamit_lock_acquisitions_total", "Lock acquisitions")->WithLabels(labels);
+    contended = registry.CounterFamily("streamit_lock_contended_total", "Lock acquisitions that had to wait")
+                    ->WithLabels(labels);
+    wait_ns = registry.HistogramFamily("streamit_lock_wait_ns", "Wait of contended lock acquisitions in nanoseconds")
+                  ->WithLabels(labels);
+    hold_ns = registry.HistogramFamily("streamit_lock_hold_ns", "Sampled lock hold times in nanoseconds")
+                  ->WithLabels(labels);
+  }
+
+  const std::string& Name() const noexcept {
+    return name_;
+  }
+
+  std::shared_ptr<Counter> acquisitions;
+  std::shared_ptr<Counter> contended;
+  std::shared_ptr<Histogram> wait_ns;
+  std::shared_ptr<Histogram> hold_ns;
+
+private:
+  std::string name_;
+};
+
+namespace {
+
+std::atomic<LockProfiling> g_mode{LockProfiling::kSampled};
+
+int64_t NowNanos() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Sites by name. A plain mutex: instrumenting the profiler's own lock would report on itself.
+struct LockSites {
+  std::mutex mutex;
+  std::map<std::string, std::unique_ptr<LockSite>, std::less<>> sites;
+};
+
+LockSites& Sites() {
+  static auto* sites = new LockSites(); // Never destroyed, so mutexes in static objects can outlive main
+  return *sites;
+}
+
+} // namespace
+
+LockProfiling LockProfilingMode() noexcept {
+  return g_mode.load(std::memory_order_relaxed);
+}
+
+void SetLockProfilingMode(LockProfiling mode) noexcept {
+  g_mode.store(mode, std::memory_order_relaxed);
+}
+
+LockProfiling ParseLockProfiling(std::string_view mode) noexcept {
+  if (mode == "off") {
+    return LockProfiling::kOff;
+  }
+  if (mode == "full") {
+    return LockProfiling::kFull;
+  }
+  return LockProfiling::kSampled;
+}
+
+InstrumentedMutex::InstrumentedMutex(std::string_view name) : site_(LockProfiler::Site(name)) {
+}
+
+void InstrumentedMutex::LockProfiled() {
+  if (mutex_.try_lock()) {
+    Acquired(false, 0);
+    return;
+  }
+
+  auto start = NowNanos();
+  mutex_.lock();
+  Acquired(true, NowNanos() - start);
+}
+
+void InstrumentedMutex::UnlockProfiled() {
+  auto held = NowNanos() - held_since_ns_;
+  held_since_ns_ = 0;
+  mutex_.unlock();
+  site_->hold_ns->Record(held);
+}
+
+void InstrumentedMutex::Acquired(bool contended, int64_t wait_ns) noexcept {
+  site_->acquisitions->Increment();
+  if (contended) {
+    site_->contended->Increment();
+    site_->wait_ns->Record(wait_ns);
+  }
+
+  thread_local uint32_t acquisitions = 0;
+  if (LockProfilingMode() == LockProfiling::kFull || ++acquisitions % kHoldSampleEvery == 0) {
+    held_since_ns_ = NowNanos();
+  }
+}
+
+LockSite* LockProfiler::Site(std::string_view name) {
+  auto& sites = Sites();
+  std::lock_guard<std::mutex> lock(sites.mutex);
+  auto it = sites.sites.find(name);
+  if (it == sites.sites.end()) {
+    it = sites.sites.emplace(std::string(name), std::make_unique<LockSite>(std::string(name))).first;
+  }
+  return it->second.get();
+}
+
+std::string LockProfiler::RenderJson() {
+  struct Row {
+    const LockSite* site;
+    int64_t acquisitions;
+    int64_t contended;
+    HistogramSnapshot wait;
+    HistogramSnapshot hold;
+  };
+
+  std::vector<Row> rows;
+  {
+    auto& sites = Sites();
+    std::lock_guard<std::mutex> lock(sites.mutex);
+    for (const auto& [name, site] : sites.sites) {
+      rows.push_back({site.get(), site->acquisitions->Value(), site->contended->Value(), site->wait_ns->Snapshot(),
+                      site->hold_ns->Snapshot()});
+    }
+  }
+
+  // The lock costing the most waiting is the one limiting scaling
+  std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.wait.Sum() > b.wait.Sum(); });
+
+  std::string out = "[";
+  for (size_t i = 0; i < rows.size(); ++i) {
+    const auto& row = rows[i];
+    out += fmt::format("{}\n{{\"lock\":{},\"acquisitions\":{},\"contended\":{},\"wait_total_ns\":{},"
+                       "\"wait_p50_ns\":{},\"wait_p99_ns\":{},\"wait_max_ns\":{},\"hold_samples\":{},"
+                       "\"hold_p50_ns\":{},\"hold_p99_ns\":{},\"hold_max_ns\":{}}}",
+                       i ? "," : "", JsonString(row.site->Name()), row.acquisitions, row.contended, row.wait.Sum(),
+                       row.wait.Quantile(0.5), row.wait.Quantile(0.99), row.wait.Max(), row.hold.Count(),
+                       row.hold.Quantile(0.5), row.hold.Quantile(0.99), row.hold.Max());
+  }
+  return out + "\n]\n";
+}
+
+} // namespace streamit::common
@@ -0,0 +1,30 @@
+#include "streamit/common/json.h"
+#include <fmt/format.h>
+
+namespace streamit::common {
+
+std::string JsonString(std::string_view value) {
+  std::string out = "\"";
+  for (char c : value) {
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        out += fmt::format("\\u{:04x}", static_cast<int>(c));
+      } else {
+        out += c;
+      }
+    }
+  }
+  return out + "\"";
+}
+
+} // namespace streamit::common
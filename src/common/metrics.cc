@@ -1,128 +1,306 @@
 #include "streamit/common/metrics.h"
-#include <iostream>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
 #include <mutex>
 
 namespace streamit::common {
 
-// Simple metrics implementation without external dependencies
-class SimpleHistogram {
-public:
-  void Observe(double value) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    total_ += value;
-    count_++;
-    if (value > max_)
-      max_ = value;
-    if (count_ == 1 || value < min_)
-      min_ = value;
+namespace {
+
+// Escape a label value: backslash, double quote and newline
+std::string EscapeLabelValue(const std::string& value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (char c : value) {
+    switch (c) {
+    case '\\':
+      escaped += "\\\\";
+      break;
+    case '"':
+      escaped += "\\\"";
+      break;
+    case '\n':
+      escaped += "\\n";
+      break;
+    default:
+      escaped += c;
+    }
   }
+  return escaped;
+}
 
-  double GetSum() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return total_;
+// Escape help text: backslash and newline
+std::string EscapeHelp(const std::string& help) {
+  std::string escaped;
+  escaped.reserve(help.size());
+  for (char c : help) {
+    if (c == '\\') {
+      escaped += "\\\\";
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
   }
+  return escaped;
+}
 
-  double GetCount() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return count_;
+// `{name="value",...}`, with an optional extra label last; empty if there are no labels
+std::string FormatLabels(const MetricLabels& labels, const char* extra_label, const std::string& extra_value) {
+  if (labels.empty() && !extra_label) {
+    return {};
   }
 
-  double GetMax() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return max_;
+  std::string out = "{";
+  for (const auto& [name, value] : labels) {
+    if (out.size() > 1) {
+      out += ",";
+    }
+    out += name + "=\"" + EscapeLabelValue(value) + "\"";
+  }
+  if (extra_label) {
+    if (out.size() > 1) {
+      out += ",";
+    }
+    out += std::string(extra_label) + "=\"" + extra_value + "\"";
   }
+  return out + "}";
+}
 
-  double GetMin() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return min_;
+// Shortest representation that round-trips
+std::string FormatDouble(double value) {
+  char buffer[32];
+  auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  return std::string(buffer, end);
+}
+
+} // namespace
+
+size_t MetricShard() noexcept {
+  static std::atomic<size_t> next_shard{0};
+  thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+  return shard;
+}
+
+int64_t Counter::Value() const noexcept {
+  int64_t total = 0;
+  for (const auto& shard : shards_) {
+    total += shard.value.load(std::memory_order_relaxed);
   }
+  return total;
+}
 
-private:
-  mutable std::mutex mutex_;
-  double total_ = 0.0;
-  double count_ = 0.0;
-  double max_ = 0.0;
-  double min_ = 0.0;
-};
+HistogramSnapshot::HistogramSnapshot() : buckets_(Histogram::kBucketCount, 0) {
+}
 
-class SimpleCounter {
-public:
-  void Increment(double value = 1.0) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    value_ += value;
+void HistogramSnapshot::Merge(const HistogramSnapshot& other) noexcept {
+  if (other.count_ == 0) {
+    return;
   }
 
-  double GetValue() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return value_;
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    buckets_[i] += other.buckets_[i];
   }
+  min_ = count_ == 0 ? other.min_ : std::min(min_, other.min_);
+  max_ = count_ == 0 ? other.max_ : std::max(max_, other.max_);
+  count_ += other.count_;
+  sum_ += other.sum_;
+}
 
-private:
-  mutable std::mutex mutex_;
-  double value_ = 0.0;
-};
+int64_t HistogramSnapshot::Quantile(double q) const noexcept {
+  if (count_ == 0) {
+    return 0;
+  }
 
-class SimpleGauge {
-public:
-  void Set(double value) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    value_ = value;
+  // Rank of the wanted observation, counting from 1
+  q = std::clamp(q, 0.0, 1.0);
+  auto rank = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(q * static_cast<double>(count_))));
+  if (rank == 1) {
+    return min_;
+  }
+  if (rank == count_) {
+    return max_;
   }
 
-  void Increment(double value = 1.0) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    value_ += value;
+  int64_t seen = 0;
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      // Report the middle of the bucket, kept within what was actually observed
+      int64_t lower = Histogram::BucketLowerBound(i);
+      int64_t middle = lower + (Histogram::BucketUpperBound(i) - lower) / 2;
+      return std::clamp(middle, min_, max_);
+    }
   }
+  return max_;
+}
 
-  double GetValue() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return value_;
+int64_t HistogramSnapshot::Count() const noexcept {
+  return count_;
+}
+
+int64_t HistogramSnapshot::Sum() const noexcept {
+  return sum_;
+}
+
+int64_t HistogramSnapshot::Min() const noexcept {
+  return min_;
+}
+
+int64_t HistogramSnapshot::Max() const noexcept {
+  return max_;
+}
+
+double HistogramSnapshot::Mean() const noexcept {
+  return count_ == 0 ? 0.0 : static_cast<double>(sum_) / static_cast<double>(count_);
+}
+
+const std::vector<int64_t>& HistogramSnapshot::Buckets() const noexcept {
+  return buckets_;
+}
+
+Histogram::~Histogram() {
+  for (auto& shard : shards_) {
+    delete shard.load(std::memory_order_relaxed);
   }
+}
 
-private:
-  mutable std::mutex mutex_;
-  double value_ = 0.0;
-};
+Histogram::Shard* Histogram::AllocateShard(size_t index) noexcept {
+  auto shard = std::make_unique<Shard>();
+  Shard* expected = nullptr;
+  if (shards_[index].compare_exchange_strong(expected, shard.get(), std::memory_order_acq_rel)) {
+    return shard.release();
+  }
+  // Another thread sharing the shard got there first
+  return expected;
+}
+
+HistogramSnapshot Histogram::Snapshot() const noexcept {
+  // Shards are read one at a time while writers keep going, so the result is consistent only to within the
+  // observations that raced with it
+  HistogramSnapshot snapshot;
+  for (const auto& slot : shards_) {
+    const Shard* shard = slot.load(std::memory_order_acquire);
+    if (shard == nullptr) {
+      continue;
+    }
+    for (size_t i = 0; i < kBucketCount; ++i) {
+      int64_t count = shard->buckets[i].load(std::memory_order_relaxed);
+      snapshot.buckets_[i] += count;
+      snapshot.count_ += count;
+    }
+    snapshot.sum_ += shard->sum.load(std::memory_order_relaxed);
+  }
+
+  if (snapshot.count_ > 0) {
+    snapshot.min_ = min_.load(std::memory_order_relaxed);
+    snapshot.max_ = max_.load(std::memory_order_relaxed);
+  }
+  return snapshot;
+}
 
 MetricsRegistry& MetricsRegistry::Instance() {
   static MetricsRegistry instance;
   return instance;
 }
 
-std::shared_ptr<SimpleHistogram> MetricsRegistry::CreateLatencyHistogram(
-    const std::string& name, const std::string& help, const std::map<std::string, std::string>& labels) {
-
+std::shared_ptr<MetricFamily<Histogram>> MetricsRegistry::HistogramFamily(const std::string& name,
+                                                                          const std::string& help) {
   std::lock_guard<std::mutex> lock(mutex_);
-  auto key = name + "_" + std::to_string(std::hash<std::string>{}(help));
-  if (histograms_.find(key) == histograms_.end()) {
-    histograms_[key] = std::make_shared<SimpleHistogram>();
+  auto& family = histograms_[name];
+  if (!family) {
+    family = std::make_shared<MetricFamily<Histogram>>(name, help);
   }
-  return histograms_[key];
+  return family;
 }
 
-std::shared_ptr<SimpleCounter> MetricsRegistry::CreateCounter(const std::string& name, const std::string& help,
-                                                              const std::map<std::string, std::string>& labels) {
+std::shared_ptr<MetricFamily<Counter>> MetricsRegistry::CounterFamily(const std::string& name,
+                                                                      const std::string& help) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& family = counters_[name];
+  if (!family) {
+    family = std::make_shared<MetricFamily<Counter>>(name, help);
+  }
+  return family;
+}
 
+std::shared_ptr<MetricFamily<Gauge>> MetricsRegistry::GaugeFamily(const std::string& name, const std::string& help) {
   std::lock_guard<std::mutex> lock(mutex_);
-  auto key = name + "_" + std::to_string(std::hash<std::string>{}(help));
-  if (counters_.find(key) == counters_.end()) {
-    counters_[key] = std::make_shared<SimpleCounter>();
+  auto& family = gauges_[name];
+  if (!family) {
+    family = std::make_shared<MetricFamily<Gauge>>(name, help);
   }
-  return counters_[key];
+  return family;
 }
 
-std::shared_ptr<SimpleGauge> MetricsRegistry::CreateGauge(const std::string& name, const std::string& help,
-                                                          const std::map<std::string, std::string>& labels) {
+std::shared_ptr<Histogram> MetricsRegistry::CreateLatencyHistogram(const std::string& name, const std::string& help,
+                                                                   const MetricLabels& labels) {
+  return HistogramFamily(name, help)->WithLabels(labels);
+}
 
-  std::lock_guard<std::mutex> lock(mutex_);
-  auto key = name + "_" + std::to_string(std::hash<std::string>{}(help));
-  if (gauges_.find(key) == gauges_.end()) {
-    gauges_[key] = std::make_shared<SimpleGauge>();
+std::shared_ptr<Counter> MetricsRegistry::CreateCounter(const std::string& name, const std::string& help,
+                                                        const MetricLabels& labels) {
+  return CounterFamily(name, help)->WithLabels(labels);
+}
+
+std::shared_ptr<Gauge> MetricsRegistry::CreateGauge(const std::string& name, const std::string& help,
+                                                    const MetricLabels& labels) {
+  return GaugeFamily(name, help)->WithLabels(labels);
+}
+
+std::string MetricsRegistry::RenderPrometheus() const {
+  // Copy the family lists so rendering does not hold the registry lock
+  std::map<std::string, std::shared_ptr<MetricFamily<Histogram>>> histograms;
+  std::map<std::string, std::shared_ptr<MetricFamily<Counter>>> counters;
+  std::map<std::string, std::shared_ptr<MetricFamily<Gauge>>> gauges;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    histograms = histograms_;
+    counters = counters_;
+    gauges = gauges_;
   }
-  return gauges_[key];
+
+  std::string out;
+  auto header = [&out](const auto& family, std::string_view type) {
+    out += "# HELP " + family.Name() + " " + EscapeHelp(family.Help()) + "\n";
+    out += "# TYPE " + family.Name() + " " + std::string(type) + "\n";
+  };
+  auto sample = [&out](const std::string& name, const MetricLabels& labels, const std::string& value,
+                       const char* extra_label = nullptr, const std::string& extra_value = {}) {
+    out += name + FormatLabels(labels, extra_label, extra_value) + " " + value + "\n";
+  };
+
+  for (const auto& [name, family] : counters) {
+    header(*family, "counter");
+    family->ForEach([&](const MetricLabels& labels, const Counter& counter) {
+      sample(name, labels, std::to_string(counter.Value()));
+    });
+  }
+
+  for (const auto& [name, family] : gauges) {
+    header(*family, "gauge");
+    family->ForEach([&](const MetricLabels& labels, const Gauge& gauge) {
+      sample(name, labels, FormatDouble(gauge.Value()));
+    });
+  }
+
+  for (const auto& [name, family] : histograms) {
+    header(*family, "summary");
+    family->ForEach([&](const MetricLabels& labels, const Histogram& histogram) {
+      auto snapshot = histogram.Snapshot();
+      for (double q : kExportedQuantiles) {
+        sample(name, labels, std::to_string(snapshot.Quantile(q)), "quantile", FormatDouble(q));
+      }
+      sample(name + "_sum", labels, std::to_string(snapshot.Sum()));
+      sample(name + "_count", labels, std::to_string(snapshot.Count()));
+    });
+  }
+
+  return out;
 }
 
-ScopedTimer::ScopedTimer(std::shared_ptr<SimpleHistogram> histogram)
+ScopedTimer::ScopedTimer(std::shared_ptr<Histogram> histogram)
     : histogram_(histogram), start_time_(std::chrono::steady_clock::now()) {
 }
 
@@ -130,7 +308,7 @@ ScopedTimer::~ScopedTimer() {
   if (histogram_) {
     auto end_time = std::chrono::steady_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time_).count();
-    histogram_->Observe(duration);
+    histogram_->Record(duration);
   }
 }
 
@@ -0,0 +1,71 @@
+#include "streamit/common/slow_request_log.h"
+#include "streamit/common/json.h"
+#include <fmt/format.h>
+
+namespace streamit::common {
+
+SlowRequestLog::SlowRequestLog(std::chrono::nanoseconds threshold, size_t capacity, uint32_t sample_one_in)
+    : threshold_(threshold), capacity_(capacity), sample_one_in_(sample_one_in == 0 ? 1 : sample_one_in) {
+  entries_.reserve(capacity_);
+}
+
+bool SlowRequestLog::ShouldRecord(std::chrono::nanoseconds total) noexcept {
+  if (threshold_.count() <= 0 || capacity_ == 0 || total < threshold_) {
+    return false;
+  }
+
+  // Sample by arrival order, so a burst of slow requests still leaves a trace without flooding the buffer
+  auto count = slow_count_.fetch_add(1, std::memory_order_relaxed);
+  return count % sample_one_in_ == 0;
+}
+
+void SlowRequestLog::Record(SlowRequest request) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (entries_.size() < capacity_) {
+    entries_.push_back(std::move(request));
+  } else {
+    entries_[next_] = std::move(request);
+  }
+  next_ = (next_ + 1) % capacity_;
+}
+
+std::vector<SlowRequest> SlowRequestLog::Entries() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (entries_.size() < capacity_) {
+    return entries_;
+  }
+
+  // Full ring: the oldest entry is the one about to be overwritten
+  std::vector<SlowRequest> entries;
+  entries.reserve(entries_.size());
+  entries.insert(entries.end(), entries_.begin() + next_, entries_.end());
+  entries.insert(entries.end(), entries_.begin(), entries_.begin() + next_);
+  return entries;
+}
+
+std::string SlowRequestLog::RenderJson() const {
+  std::string out = "[";
+  bool first = true;
+  for (const auto& entry : Entries()) {
+    auto finished_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(entry.finished_at.time_since_epoch()).count();
+
+    out += first ? "\n" : ",\n";
+    first = false;
+    out += fmt::format("{{\"type\":{},\"trace_id\":{},\"topic\":{},\"partition\":{},\"bytes\":{},\"records\":{},"
+                       "\"finished_at_ms\":{},\"total_ns\":{},\"stages_ns\":{{",
+                       JsonString(entry.type), JsonString(entry.trace_id), JsonString(entry.topic), entry.partition,
+                       entry.bytes, entry.records, finished_ms, entry.total.count());
+    for (size_t i = 0; i < entry.stages.size(); ++i) {
+      out += fmt::format("{}{}:{}", i ? "," : "", JsonString(entry.stages[i].first), entry.stages[i].second.count());
+    }
+    out += "}}";
+  }
+  return out + "\n]\n";
+}
+
+int64_t SlowRequestLog::SlowCount() const noexcept {
+  return slow_count_.load(std::memory_order_relaxed);
+}
+
+} // namespace streamit::common
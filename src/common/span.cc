@@ -0,0 +1,409 @@
+#include "streamit/common/span.h"
+#include "streamit/common/json.h"
+#include <functional>
+#include <netdb.h>
+#include <random>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace streamit::common {
+
+namespace {
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+// Per-thread seed; random_device is only touched once per thread
+uint64_t ThreadSeed() noexcept {
+  uint64_t seed = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+  seed ^= std::hash<std::thread::id>{}(std::this_thread::get_id()) * 0x9e3779b97f4a7c15ULL;
+  try {
+    std::random_device device;
+    seed ^= (static_cast<uint64_t>(device()) << 32) | device();
+  } catch (...) {
+    // Time and thread id alone still give distinct streams
+  }
+  return seed;
+}
+
+void WriteHex(uint64_t value, char* out) noexcept {
+  for (int i = 15; i >= 0; --i) {
+    out[i] = kHexDigits[value & 0xf];
+    value >>= 4;
+  }
+}
+
+int HexValue(char c) noexcept {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+// Parse exactly `hex.size()` (at most 16) hex digits
+std::optional<uint64_t> ParseHex64(std::string_view hex) noexcept {
+  uint64_t value = 0;
+  for (char c : hex) {
+    int digit = HexValue(c);
+    if (digit < 0) {
+      return std::nullopt;
+    }
+    value = (value << 4) | static_cast<uint64_t>(digit);
+  }
+  return value;
+}
+
+// Lowercase hex only, as the W3C header requires
+bool IsLowerHex(std::string_view hex) noexcept {
+  for (char c : hex) {
+    if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string SpanIdHex(uint64_t span_id) {
+  std::string hex(16, '0');
+  WriteHex(span_id, hex.data());
+  return hex;
+}
+
+int64_t UnixNanos() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+uint64_t NonZeroRandom() noexcept {
+  uint64_t value;
+  do {
+    value = ThreadLocalRandom();
+  } while (value == 0);
+  return value;
+}
+
+} // namespace
+
+uint64_t ThreadLocalRandom() noexcept {
+  thread_local uint64_t state = ThreadSeed();
+  uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+TraceId TraceId::Generate() noexcept {
+  return TraceId{ThreadLocalRandom(), NonZeroRandom()};
+}
+
+std::optional<TraceId> TraceId::FromHex(std::string_view hex) noexcept {
+  if (hex.empty() || hex.size() > 32) {
+    return std::nullopt;
+  }
+  auto split = hex.size() > 16 ? hex.size() - 16 : 0;
+  auto high = ParseHex64(hex.substr(0, split));
+  auto low = ParseHex64(hex.substr(split));
+  if (!high || !low) {
+    return std::nullopt;
+  }
+  TraceId id{*high, *low};
+  if (!id.IsValid()) {
+    return std::nullopt;
+  }
+  return id;
+}
+
+std::array<char, 32> TraceId::Hex() const noexcept {
+  std::array<char, 32> hex;
+  WriteHex(high, hex.data());
+  WriteHex(low, hex.data() + 16);
+  return hex;
+}
+
+std::string TraceId::ToString() const {
+  auto hex = Hex();
+  return std::string(hex.data(), hex.size());
+}
+
+std::optional<SpanContext> ParseTraceparent(std::string_view header) noexcept {
+  // version "-" trace-id "-" parent-id "-" trace-flags
+  constexpr size_t kLength = 55;
+  if (header.size() < kLength || header[2] != '-' || header[35] != '-' || header[52] != '-') {
+    return std::nullopt;
+  }
+  auto version = header.substr(0, 2);
+  if (!IsLowerHex(version) || version == "ff") {
+    return std::nullopt;
+  }
+  // Later versions may append fields; version 00 may not
+  if (header.size() > kLength && (version == "00" || header[kLength] != '-')) {
+    return std::nullopt;
+  }
+
+  auto trace_hex = header.substr(3, 32);
+  auto span_hex = header.substr(36, 16);
+  auto flags_hex = header.substr(53, 2);
+  if (!IsLowerHex(trace_hex) || !IsLowerHex(span_hex) || !IsLowerHex(flags_hex)) {
+    return std::nullopt;
+  }
+
+  SpanContext context;
+  context.trace_id = TraceId{*ParseHex64(trace_hex.substr(0, 16)), *ParseHex64(trace_hex.substr(16))};
+  context.span_id = *ParseHex64(span_hex);
+  context.sampled = (*ParseHex64(flags_hex) & 0x1) != 0;
+  if (!context.IsValid()) {
+    return std::nullopt;
+  }
+  return context;
+}
+
+std::string FormatTraceparent(const SpanContext& context) {
+  std::string header = "00-";
+  auto trace_hex = context.trace_id.Hex();
+  header.append(trace_hex.data(), trace_hex.size());
+  header += '-';
+  header += SpanIdHex(context.span_id);
+  header += context.sampled ? "-01" : "-00";
+  return header;
+}
+
+std::string RenderOtlpJson(const std::vector<SpanRecord>& spans, std::string_view service_name) {
+  std::string out = fmt::format("{{\"resourceSpans\":[{{\"resource\":{{\"attributes\":[{{\"key\":\"service.name\","
+                                "\"value\":{{\"stringValue\":{}}}}}]}},\"scopeSpans\":[{{\"scope\":{{\"name\":"
+                                "\"streamit\"}},\"spans\":[",
+                                JsonString(service_name));
+  for (size_t i = 0; i < spans.size(); ++i) {
+    const auto& span = spans[i];
+
+    // Server kind (2); OTLP/JSON carries ids as hex and 64-bit integers as strings
+    out += fmt::format("{}{{\"traceId\":\"{}\",\"spanId\":\"{}\",\"parentSpanId\":\"{}\",\"name\":{},\"kind\":2,"
+                       "\"startTimeUnixNano\":\"{}\",\"endTimeUnixNano\":\"{}\",\"attributes\":[",
+                       i ? "," : "", span.trace_id, SpanIdHex(span.span_id),
+                       span.parent_span_id ? SpanIdHex(span.parent_span_id) : "", JsonString(span.name),
+                       span.start_unix_nanos, span.end_unix_nanos);
+    for (size_t j = 0; j < span.attribute_count; ++j) {
+      const auto& attribute = span.attributes[j];
+      out += fmt::format("{}{{\"key\":{},\"value\":", j ? "," : "", JsonString(attribute.key));
+      if (const auto* number = std::get_if<int64_t>(&attribute.value)) {
+        out += fmt::format("{{\"intValue\":\"{}\"}}}}", *number);
+      } else {
+        out += fmt::format("{{\"stringValue\":{}}}}}", JsonString(std::get<std::string>(attribute.value)));
+      }
+    }
+    out += fmt::format("],\"status\":{{\"code\":{}", span.error ? 2 : 1);
+    if (span.error) {
+      out += fmt::format(",\"message\":{}", JsonString(span.status_message));
+    }
+    out += "}}";
+  }
+  return out + "]}]}]}";
+}
+
+FileSpanSink::FileSpanSink(std::string path, std::string service_name)
+    : path_(std::move(path)), service_name_(std::move(service_name)), out_(path_, std::ios::app) {
+}
+
+absl::Status FileSpanSink::Export(const std::vector<SpanRecord>& spans) {
+  if (!out_.is_open()) {
+    return absl::UnavailableError("Cannot open span file " + path_);
+  }
+  out_ << RenderOtlpJson(spans, service_name_) << '\n';
+  out_.flush();
+  if (!out_) {
+    return absl::InternalError("Failed to write span file " + path_);
+  }
+  return absl::OkStatus();
+}
+
+OtlpHttpSpanSink::OtlpHttpSpanSink(std::string host, uint16_t port, std::string service_name)
+    : host_(std::move(host)), port_(port), service_name_(std::move(service_name)) {
+}
+
+absl::Status OtlpHttpSpanSink::Export(const std::vector<SpanRecord>& spans) {
+  auto body = RenderOtlpJson(spans, service_name_);
+  auto request = fmt::format("POST /v1/traces HTTP/1.1\r\nHost: {}:{}\r\nContent-Type: application/json\r\n"
+                             "Content-Length: {}\r\nConnection: close\r\n\r\n",
+                             host_, port_, body.size());
+  request += body;
+
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* addresses = nullptr;
+  if (getaddrinfo(host_.c_str(), std::to_string(port_).c_str(), &hints, &addresses) != 0) {
+    return absl::UnavailableError("Cannot resolve trace collector " + host_);
+  }
+  int fd = -1;
+  for (auto* address = addresses; address != nullptr && fd < 0; address = address->ai_next) {
+    fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (fd >= 0 && connect(fd, address->ai_addr, address->ai_addrlen) != 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  freeaddrinfo(addresses);
+  if (fd < 0) {
+    return absl::UnavailableError(fmt::format("Cannot connect to trace collector {}:{}", host_, port_));
+  }
+
+  size_t sent = 0;
+  while (sent < request.size()) {
+    auto n = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0) {
+      close(fd);
+      return absl::UnavailableError("Failed to send spans to trace collector");
+    }
+    sent += static_cast<size_t>(n);
+  }
+
+  // Only the status line matters
+  char status_line[64] = {};
+  auto received = recv(fd, status_line, sizeof(status_line) - 1, 0);
+  close(fd);
+  std::string_view status(status_line, received > 0 ? static_cast<size_t>(received) : 0);
+  if (status.size() < 12 || status[9] != '2') {
+    return absl::UnavailableError(
+        fmt::format("Trace collector rejected spans: {}", std::string(status.substr(0, status.find('\r')))));
+  }
+  return absl::OkStatus();
+}
+
+SpanExporter::SpanExporter(std::unique_ptr<SpanSink> sink, SpanExporterOptions options)
+    : sink_(std::move(sink)), options_(options), queue_(options.queue_capacity), thread_([this] { Run(); }) {
+}
+
+SpanExporter::~SpanExporter() {
+  Stop();
+}
+
+void SpanExporter::Export(SpanRecord span) noexcept {
+  if (stopping_.load(std::memory_order_relaxed) || !queue_.TryPush(std::move(span))) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  // Wake the exporter once per full batch rather than on every span
+  auto pending = pending_.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (pending == static_cast<int64_t>(options_.max_batch)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wake_.notify_one();
+  }
+}
+
+void SpanExporter::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_.exchange(true)) {
+      return;
+    }
+  }
+  wake_.notify_one();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+int64_t SpanExporter::Exported() const noexcept {
+  return exported_.load(std::memory_order_relaxed);
+}
+
+int64_t SpanExporter::Dropped() const noexcept {
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+void SpanExporter::Run() {
+  std::vector<SpanRecord> batch;
+  batch.reserve(options_.max_batch);
+  while (true) {
+    bool stopping;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait_for(lock, options_.interval, [this] {
+        return stopping_.load() ||
+               pending_.load(std::memory_order_relaxed) >= static_cast<int64_t>(options_.max_batch);
+      });
+      stopping = stopping_.load();
+    }
+
+    while (ExportBatch(batch) > 0) {
+    }
+    if (stopping) {
+      return;
+    }
+  }
+}
+
+size_t SpanExporter::ExportBatch(std::vector<SpanRecord>& batch) {
+  batch.clear();
+  SpanRecord span;
+  while (batch.size() < options_.max_batch && queue_.TryPop(span)) {
+    batch.push_back(std::move(span));
+  }
+  if (batch.empty()) {
+    return 0;
+  }
+  pending_.fetch_sub(static_cast<int64_t>(batch.size()), std::memory_order_relaxed);
+
+  auto status = sink_->Export(batch);
+  (status.ok() ? exported_ : dropped_).fetch_add(static_cast<int64_t>(batch.size()), std::memory_order_relaxed);
+  return batch.size();
+}
+
+Span::Span(std::string_view name, const SpanContext& parent, SpanExporter* exporter) noexcept
+    : exporter_(exporter) {
+  // A parent with a trace id but no span id (a legacy `x-trace-id` caller) is continued without a parent span
+  bool continues_trace = parent.trace_id.IsValid();
+  context_.trace_id = continues_trace ? parent.trace_id : TraceId::Generate();
+  context_.span_id = NonZeroRandom();
+  context_.sampled = continues_trace ? parent.sampled : true;
+
+  record_.trace_id = context_.trace_id;
+  record_.span_id = context_.span_id;
+  record_.parent_span_id = continues_trace ? parent.span_id : 0;
+  record_.name = name;
+  record_.start_unix_nanos = UnixNanos();
+}
+
+Span::~Span() {
+  End();
+}
+
+Span::Span(Span&& other) noexcept
+    : context_(other.context_), record_(std::move(other.record_)), exporter_(other.exporter_), ended_(other.ended_) {
+  other.ended_ = true;
+}
+
+void Span::SetAttribute(std::string_view key, int64_t value) {
+  if (record_.attribute_count < SpanRecord::kMaxAttributes) {
+    record_.attributes[record_.attribute_count++] = SpanAttribute{key, value};
+  }
+}
+
+void Span::SetAttribute(std::string_view key, std::string value) {
+  if (record_.attribute_count < SpanRecord::kMaxAttributes) {
+    record_.attributes[record_.attribute_count++] = SpanAttribute{key, std::move(value)};
+  }
+}
+
+void Span::SetError(std::string message) {
+  record_.error = true;
+  record_.status_message = std::move(message);
+}
+
+void Span::End() noexcept {
+  if (ended_) {
+    return;
+  }
+  ended_ = true;
+  if (exporter_ != nullptr && context_.sampled) {
+    record_.end_unix_nanos = UnixNanos();
+    exporter_->Export(std::move(record_));
+  }
+}
+
+} // namespace streamit::common
@@ -0,0 +1,98 @@
+#include "streamit/common/timer_service.h"
+
+namespace streamit::common {
+
+TimerService::TimerService() : next_id_(1), stopped_(false) {
+  thread_ = std::thread(&TimerService::Run, this);
+}
+
+TimerService::~TimerService() {
+  Shutdown();
+}
+
+TimerService::TimerId TimerService::ScheduleAfter(std::chrono::milliseconds delay,
+                                                  std::function<void()> callback) noexcept {
+  auto deadline = Clock::now() + delay;
+  TimerId id;
+  bool is_earliest;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) {
+      return 0;
+    }
+    id = next_id_++;
+    timers_.emplace(std::make_pair(deadline, id), std::move(callback));
+    deadlines_.emplace(id, deadline);
+    is_earliest = timers_.begin()->first.second == id;
+  }
+
+  // Only wake the timer thread if its current wait deadline moved earlier
+  if (is_earliest) {
+    cv_.notify_one();
+  }
+  return id;
+}
+
+bool TimerService::Cancel(TimerId id) noexcept {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = deadlines_.find(id);
+  if (it == deadlines_.end()) {
+    return false;
+  }
+
+  timers_.erase(std::make_pair(it->second, id));
+  deadlines_.erase(it);
+  return true;
+}
+
+void TimerService::Shutdown() noexcept {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+  }
+  cv_.notify_all();
+
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  timers_.clear();
+  deadlines_.clear();
+}
+
+size_t TimerService::Size() const noexcept {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return timers_.size();
+}
+
+void TimerService::Run() noexcept {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (!stopped_) {
+    if (timers_.empty()) {
+      cv_.wait(lock);
+      continue;
+    }
+
+    auto deadline = timers_.begin()->first.first;
+    if (Clock::now() < deadline) {
+      cv_.wait_until(lock, deadline);
+      continue;
+    }
+
+    auto node = timers_.extract(timers_.begin());
+    deadlines_.erase(node.key().second);
+
+    // Run the callback without holding the lock so it can schedule or cancel timers
+    lock.unlock();
+    node.mapped()();
+    lock.lock();
+  }
+}
+
+} // namespace streamit::common
@@ -0,0 +1,44 @@
+#include "streamit/common/topic_registry.h"
+#include <mutex>
+
+namespace streamit::common {
+
+TopicId TopicRegistry::Intern(std::string_view name) {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+      return it->second;
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto [it, inserted] = ids_.try_emplace(std::string(name), static_cast<TopicId>(names_.size()));
+  if (inserted) {
+    names_.emplace_back(name);
+  }
+  return it->second;
+}
+
+std::optional<TopicId> TopicRegistry::Find(std::string_view name) const noexcept {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = ids_.find(name);
+  if (it == ids_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+const std::string& TopicRegistry::Name(TopicId id) const noexcept {
+  static const std::string kUnknown;
+
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return id < names_.size() ? names_[id] : kUnknown;
+}
+
+size_t TopicRegistry::Size() const noexcept {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return names_.size();
+}
+
+} // namespace streamit::common
@@ -1,45 +1,62 @@
 #include "streamit/common/tracing.h"
+#include <cstdlib>
 #include <grpcpp/grpcpp.h>
-#include <random>
+#include <mutex>
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
 namespace streamit::common {
 
-std::random_device TraceContext::rd_;
-std::mt19937_64 TraceContext::gen_(rd_());
-std::uniform_int_distribution<uint64_t> TraceContext::dis_;
+std::atomic<spdlog::level::level_enum> StructuredLogger::level_{spdlog::level::off};
+std::atomic<uint32_t> StructuredLogger::request_sample_one_in_{1};
 
-std::string TraceContext::GenerateTraceId() noexcept {
-  uint64_t value = dis_(gen_);
+namespace {
 
-  std::ostringstream oss;
-  oss << std::hex << std::setfill('0') << std::setw(16) << value;
-  return oss.str();
+// Writer behind StructuredLogger. Never destroyed: detached threads (profiles, executor workers) may still log
+// during static teardown, after Shutdown has stopped the writer thread and later messages are written inline
+std::atomic<AsyncLogger*> g_async_logger{nullptr};
+
+} // namespace
+
+TraceId TraceContext::GenerateTraceId() noexcept {
+  return TraceId::Generate();
 }
 
-std::string TraceContext::ExtractTraceId(const grpc::ServerContext* context) noexcept {
+SpanContext TraceContext::Extract(const grpc::ServerContextBase* context) noexcept {
   if (!context) {
-    return GenerateTraceId();
+    return {};
   }
 
-  auto metadata = context->client_metadata();
-  auto it = metadata.find("x-trace-id");
+  const auto& metadata = context->client_metadata();
+  auto it = metadata.find("traceparent");
   if (it != metadata.end()) {
-    return std::string(it->second.data(), it->second.length());
+    if (auto parent = ParseTraceparent(std::string_view(it->second.data(), it->second.length()))) {
+      return *parent;
+    }
   }
 
-  return GenerateTraceId();
+  // Older clients send only a trace id; the server span joins that trace as its root
+  it = metadata.find("x-trace-id");
+  if (it != metadata.end()) {
+    if (auto trace_id = TraceId::FromHex(std::string_view(it->second.data(), it->second.length()))) {
+      SpanContext parent;
+      parent.trace_id = *trace_id;
+      return parent;
+    }
+  }
+  return {};
 }
 
-void TraceContext::SetTraceId(grpc::ServerContext* context, const std::string& trace_id) noexcept {
-  if (context) {
-    context->AddInitialMetadata("x-trace-id", trace_id);
+void TraceContext::Inject(grpc::ServerContextBase* context, const SpanContext& span) noexcept {
+  if (context && span.IsValid()) {
+    context->AddInitialMetadata("traceparent", FormatTraceparent(span));
+    // Older clients read back only the trace id
+    context->AddInitialMetadata("x-trace-id", span.trace_id.ToString());
   }
 }
 
-void StructuredLogger::Initialize(const std::string& level) {
+void StructuredLogger::Initialize(const std::string& level, uint32_t request_sample_one_in, size_t queue_capacity) {
   // Create console sink
   auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
   console_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] [%t] %v");
@@ -67,6 +84,29 @@ void StructuredLogger::Initialize(const std::string& level) {
 
   spdlog::register_logger(logger);
   spdlog::set_default_logger(logger);
+
+  request_sample_one_in_.store(request_sample_one_in == 0 ? 1 : request_sample_one_in, std::memory_order_relaxed);
+  // A writer replaced by a second Initialize is stopped but kept, since other threads may still hold it
+  if (auto* previous = g_async_logger.exchange(new AsyncLogger(logger, queue_capacity), std::memory_order_acq_rel)) {
+    previous->Stop();
+  }
+
+  // Still flush queued messages when a process exits without calling Shutdown
+  static std::once_flag stop_at_exit;
+  std::call_once(stop_at_exit, [] { std::atexit([] { Shutdown(); }); });
+  level_.store(logger->level(), std::memory_order_release);
+}
+
+void StructuredLogger::Shutdown() {
+  if (auto* logger = g_async_logger.load(std::memory_order_acquire)) {
+    logger->Stop();
+  }
+}
+
+void StructuredLogger::Write(spdlog::level::level_enum level, std::string message) noexcept {
+  if (auto* logger = g_async_logger.load(std::memory_order_acquire)) {
+    logger->Log(level, std::move(message));
+  }
 }
 
 } // namespace streamit::common
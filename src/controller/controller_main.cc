@@ -1,4 +1,7 @@
 #include "streamit/common/config.h"
+#include "streamit/common/cpu_profiler.h"
+#include "streamit/common/http_health_server.h"
+#include "streamit/common/metrics.h"
 #include "streamit/controller/controller_service.h"
 #include <iostream>
 #include <signal.h>
@@ -7,6 +10,7 @@
 
 namespace {
 std::unique_ptr<streamit::controller::ControllerServer> g_server;
+std::unique_ptr<streamit::common::HttpHealthServer> g_health_server;
 
 void SignalHandler(int signal) {
   if (g_server) {
@@ -76,6 +80,22 @@ int main(int argc, char* argv[]) {
 
     spdlog::info("Controller server started successfully");
 
+    // Operational endpoints: Prometheus scrape and on-demand CPU profiles
+    g_health_server = std::make_unique<streamit::common::HttpHealthServer>(
+        "0.0.0.0", config.metrics_port, std::make_shared<streamit::common::HealthCheckManager>());
+    if (config.enable_metrics) {
+      g_health_server->AddHandler("/metrics", [](const streamit::common::HttpRequest&) {
+        return streamit::common::HttpResponse{200, streamit::common::MetricsRegistry::Instance().RenderPrometheus(),
+                                              "text/plain; version=0.0.4"};
+      });
+    }
+    g_health_server->AddBlockingHandler("/debug/pprof/profile", streamit::common::ServeCpuProfile);
+    if (!g_health_server->Start()) {
+      spdlog::warn("Failed to start health check server");
+    } else {
+      spdlog::info("Health check server started on port {}", config.metrics_port);
+    }
+
     // Setup signal handlers
     signal(SIGINT, SignalHandler);
     signal(SIGTERM, SignalHandler);
@@ -83,6 +103,7 @@ int main(int argc, char* argv[]) {
     // Wait for server to finish
     g_server->Wait();
 
+    (void)g_health_server->Stop();
     spdlog::info("Controller server stopped");
     return 0;
 
@@ -8,7 +8,7 @@ TopicManager::TopicManager() = default;
 
 Result<void> TopicManager::CreateTopic(const std::string& name, int32_t partitions,
                                        int32_t replication_factor) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   if (topics_.find(name) != topics_.end()) {
     return Error<void>(absl::StatusCode::kAlreadyExists, "Topic already exists: " + name);
@@ -31,7 +31,7 @@ Result<void> TopicManager::CreateTopic(const std::string& name, int32_t partitio
 }
 
 Result<TopicInfo> TopicManager::GetTopic(const std::string& name) const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   auto it = topics_.find(name);
   if (it == topics_.end()) {
@@ -42,7 +42,7 @@ Result<TopicInfo> TopicManager::GetTopic(const std::string& name) const noexcept
 }
 
 std::vector<std::string> TopicManager::ListTopics() const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   std::vector<std::string> topic_names;
   topic_names.reserve(topics_.size());
@@ -56,12 +56,12 @@ std::vector<std::string> TopicManager::ListTopics() const noexcept {
 }
 
 bool TopicManager::TopicExists(const std::string& name) const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
   return topics_.find(name) != topics_.end();
 }
 
 Result<void> TopicManager::DeleteTopic(const std::string& name) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   auto it = topics_.find(name);
   if (it == topics_.end()) {
@@ -73,7 +73,7 @@ Result<void> TopicManager::DeleteTopic(const std::string& name) noexcept {
 }
 
 Result<void> TopicManager::UpdatePartitionLeader(const std::string& topic, int32_t partition, int32_t leader) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   auto topic_it = topics_.find(topic);
   if (topic_it == topics_.end()) {
@@ -94,7 +94,7 @@ Result<void> TopicManager::UpdatePartitionLeader(const std::string& topic, int32
 
 Result<void> TopicManager::UpdatePartitionHighWaterMark(const std::string& topic, int32_t partition,
                                                         int64_t high_watermark) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   auto topic_it = topics_.find(topic);
   if (topic_it == topics_.end()) {
@@ -114,7 +114,7 @@ Result<void> TopicManager::UpdatePartitionHighWaterMark(const std::string& topic
 }
 
 Result<PartitionInfo> TopicManager::GetPartitionInfo(const std::string& topic, int32_t partition) const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   auto topic_it = topics_.find(topic);
   if (topic_it == topics_.end()) {
@@ -11,7 +11,7 @@ ConsumerGroupManager::ConsumerGroupManager(int32_t heartbeat_interval_ms, int32_
 
 Result<void> ConsumerGroupManager::JoinGroup(const std::string& group_id, const std::string& member_id,
                                              const std::vector<std::string>& topics) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   // Find or create group
   auto group_it = groups_.find(group_id);
@@ -48,7 +48,7 @@ Result<void> ConsumerGroupManager::JoinGroup(const std::string& group_id, const
 }
 
 Result<void> ConsumerGroupManager::LeaveGroup(const std::string& group_id, const std::string& member_id) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   auto group_it = groups_.find(group_id);
   if (group_it == groups_.end()) {
@@ -75,7 +75,7 @@ Result<void> ConsumerGroupManager::LeaveGroup(const std::string& group_id, const
 }
 
 Result<void> ConsumerGroupManager::Heartbeat(const std::string& group_id, const std::string& member_id) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   auto group_it = groups_.find(group_id);
   if (group_it == groups_.end()) {
@@ -101,7 +101,7 @@ Result<void> ConsumerGroupManager::Heartbeat(const std::string& group_id, const
 
 Result<std::vector<PartitionAssignment>> ConsumerGroupManager::GetAssignments(
     const std::string& group_id, const std::string& member_id) const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   auto group_it = groups_.find(group_id);
   if (group_it == groups_.end()) {
@@ -121,7 +121,7 @@ Result<std::vector<PartitionAssignment>> ConsumerGroupManager::GetAssignments(
 
 Result<void> ConsumerGroupManager::CommitOffset(const std::string& group_id, const std::string& topic,
                                                 int32_t partition, int64_t offset) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   auto group_it = groups_.find(group_id);
   if (group_it == groups_.end()) {
@@ -136,7 +136,7 @@ Result<void> ConsumerGroupManager::CommitOffset(const std::string& group_id, con
 
 Result<int64_t> ConsumerGroupManager::GetCommittedOffset(const std::string& group_id, const std::string& topic,
                                                          int32_t partition) const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   auto group_it = groups_.find(group_id);
   if (group_it == groups_.end()) {
@@ -214,7 +214,7 @@ Result<void> ConsumerGroupManager::RebalanceGroup(const std::string& group_id) n
 }
 
 void ConsumerGroupManager::CleanupInactiveMembers() noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   for (auto& group_pair : groups_) {
     ConsumerGroup& group = group_pair.second;
@@ -232,7 +232,7 @@ void ConsumerGroupManager::CleanupInactiveMembers() noexcept {
 }
 
 std::vector<std::string> ConsumerGroupManager::ListGroups() const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   std::vector<std::string> group_ids;
   group_ids.reserve(groups_.size());
@@ -246,7 +246,7 @@ std::vector<std::string> ConsumerGroupManager::ListGroups() const noexcept {
 }
 
 Result<ConsumerGroup> ConsumerGroupManager::GetGroup(const std::string& group_id) const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   auto group_it = groups_.find(group_id);
   if (group_it == groups_.end()) {
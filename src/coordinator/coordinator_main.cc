@@ -1,4 +1,7 @@
 #include "streamit/common/config.h"
+#include "streamit/common/cpu_profiler.h"
+#include "streamit/common/http_health_server.h"
+#include "streamit/common/metrics.h"
 #include "streamit/coordinator/coordinator_service.h"
 #include <iostream>
 #include <signal.h>
@@ -8,6 +11,7 @@
 
 namespace {
 std::unique_ptr<streamit::coordinator::CoordinatorServer> g_server;
+std::unique_ptr<streamit::common::HttpHealthServer> g_health_server;
 std::unique_ptr<streamit::coordinator::ConsumerGroupManager> g_group_manager;
 
 void SignalHandler(int signal) {
@@ -77,6 +81,22 @@ int main(int argc, char* argv[]) {
 
     spdlog::info("Coordinator server started successfully");
 
+    // Operational endpoints: Prometheus scrape and on-demand CPU profiles
+    g_health_server = std::make_unique<streamit::common::HttpHealthServer>(
+        "0.0.0.0", config.metrics_port, std::make_shared<streamit::common::HealthCheckManager>());
+    if (config.enable_metrics) {
+      g_health_server->AddHandler("/metrics", [](const streamit::common::HttpRequest&) {
+        return streamit::common::HttpResponse{200, streamit::common::MetricsRegistry::Instance().RenderPrometheus(),
+                                              "text/plain; version=0.0.4"};
+      });
+    }
+    g_health_server->AddBlockingHandler("/debug/pprof/profile", streamit::common::ServeCpuProfile);
+    if (!g_health_server->Start()) {
+      spdlog::warn("Failed to start health check server");
+    } else {
+      spdlog::info("Health check server started on port {}", config.metrics_port);
+    }
+
     // Start cleanup task
     std::thread cleanup_thread(CleanupTask);
 
@@ -90,6 +110,7 @@ int main(int argc, char* argv[]) {
     // Wait for cleanup thread
     cleanup_thread.join();
 
+    (void)g_health_server->Stop();
     spdlog::info("Coordinator server stopped");
     return 0;
 
@@ -21,6 +21,7 @@
 #include "google/protobuf/arenastring.h"
 #include "google/protobuf/extension_set.h" // IWYU pragma: export
 #include "google/protobuf/generated_enum_reflection.h"
+#include "google/protobuf/generated_message_bases.h"
 #include "google/protobuf/generated_message_reflection.h"
 #include "google/protobuf/generated_message_tctable_decl.h"
 #include "google/protobuf/generated_message_util.h"
@@ -99,6 +100,14 @@ class FindLeaderResponse;
 struct FindLeaderResponseDefaultTypeInternal;
 extern FindLeaderResponseDefaultTypeInternal _FindLeaderResponse_default_instance_;
 extern const ::google::protobuf::internal::ClassDataFull FindLeaderResponse_class_data_;
+class InitProducerIdRequest;
+struct InitProducerIdRequestDefaultTypeInternal;
+extern InitProducerIdRequestDefaultTypeInternal _InitProducerIdRequest_default_instance_;
+extern const ::google::protobuf::internal::ClassDataFull InitProducerIdRequest_class_data_;
+class InitProducerIdResponse;
+struct InitProducerIdResponseDefaultTypeInternal;
+extern InitProducerIdResponseDefaultTypeInternal _InitProducerIdResponse_default_instance_;
+extern const ::google::protobuf::internal::ClassDataFull InitProducerIdResponse_class_data_;
 class PartitionMetadata;
 struct PartitionMetadataDefaultTypeInternal;
 extern PartitionMetadataDefaultTypeInternal _PartitionMetadata_default_instance_;
@@ -741,7 +750,7 @@ public:
   static const ProduceResponse& default_instance() {
     return *reinterpret_cast<const ProduceResponse*>(&_ProduceResponse_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 3;
+  static constexpr int kIndexInFileMessages = 5;
   friend void swap(ProduceResponse& a, ProduceResponse& b) {
     a.Swap(&b);
   }
@@ -1000,7 +1009,7 @@ public:
     return *reinterpret_cast<const PollAssignmentResponse_Assignment*>(
         &_PollAssignmentResponse_Assignment_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 9;
+  static constexpr int kIndexInFileMessages = 11;
   friend void swap(PollAssignmentResponse_Assignment& a, PollAssignmentResponse_Assignment& b) {
     a.Swap(&b);
   }
@@ -1229,7 +1238,7 @@ public:
   static const PollAssignmentRequest& default_instance() {
     return *reinterpret_cast<const PollAssignmentRequest*>(&_PollAssignmentRequest_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 8;
+  static constexpr int kIndexInFileMessages = 10;
   friend void swap(PollAssignmentRequest& a, PollAssignmentRequest& b) {
     a.Swap(&b);
   }
@@ -1474,7 +1483,7 @@ public:
   static const PartitionMetadata& default_instance() {
     return *reinterpret_cast<const PartitionMetadata*>(&_PartitionMetadata_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 14;
+  static constexpr int kIndexInFileMessages = 16;
   friend void swap(PartitionMetadata& a, PartitionMetadata& b) {
     a.Swap(&b);
   }
@@ -1672,6 +1681,373 @@ private:
 extern const ::google::protobuf::internal::ClassDataFull PartitionMetadata_class_data_;
 // -------------------------------------------------------------------
 
+class InitProducerIdResponse final : public ::google::protobuf::Message
+/* @@protoc_insertion_point(class_definition:streamit.v1.InitProducerIdResponse) */ {
+public:
+  inline InitProducerIdResponse() : InitProducerIdResponse(nullptr) {
+  }
+  ~InitProducerIdResponse() PROTOBUF_FINAL;
+
+#if defined(PROTOBUF_CUSTOM_VTABLE)
+  void operator delete(InitProducerIdResponse* PROTOBUF_NONNULL msg, ::std::destroying_delete_t) {
+    SharedDtor(*msg);
+    ::google::protobuf::internal::SizedDelete(msg, sizeof(InitProducerIdResponse));
+  }
+#endif
+
+  template <typename = void>
+  explicit PROTOBUF_CONSTEXPR InitProducerIdResponse(::google::protobuf::internal::ConstantInitialized);
+
+  inline InitProducerIdResponse(const InitProducerIdResponse& from) : InitProducerIdResponse(nullptr, from) {
+  }
+  inline InitProducerIdResponse(InitProducerIdResponse&& from) noexcept
+      : InitProducerIdResponse(nullptr, ::std::move(from)) {
+  }
+  inline InitProducerIdResponse& operator=(const InitProducerIdResponse& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline InitProducerIdResponse& operator=(InitProducerIdResponse&& from) noexcept {
+    if (this == &from)
+      return *this;
+    if (::google::protobuf::internal::CanMoveWithInternalSwap(GetArena(), from.GetArena())) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const ABSL_ATTRIBUTE_LIFETIME_BOUND {
+    return _internal_metadata_.unknown_fields<::google::protobuf::UnknownFieldSet>(
+        ::google::protobuf::UnknownFieldSet::default_instance);
+  }
+  inline ::google::protobuf::UnknownFieldSet* PROTOBUF_NONNULL mutable_unknown_fields() ABSL_ATTRIBUTE_LIFETIME_BOUND {
+    return _internal_metadata_.mutable_unknown_fields<::google::protobuf::UnknownFieldSet>();
+  }
+
+  static const ::google::protobuf::Descriptor* PROTOBUF_NONNULL descriptor() {
+    return GetDescriptor();
+  }
+  static const ::google::protobuf::Descriptor* PROTOBUF_NONNULL GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::google::protobuf::Reflection* PROTOBUF_NONNULL GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const InitProducerIdResponse& default_instance() {
+    return *reinterpret_cast<const InitProducerIdResponse*>(&_InitProducerIdResponse_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages = 3;
+  friend void swap(InitProducerIdResponse& a, InitProducerIdResponse& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(InitProducerIdResponse* PROTOBUF_NONNULL other) {
+    if (other == this)
+      return;
+    if (::google::protobuf::internal::CanUseInternalSwap(GetArena(), other->GetArena())) {
+      InternalSwap(other);
+    } else {
+      ::google::protobuf::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(InitProducerIdResponse* PROTOBUF_NONNULL other) {
+    if (other == this)
+      return;
+    ABSL_DCHECK(GetArena() == other->GetArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  InitProducerIdResponse* PROTOBUF_NONNULL New(::google::protobuf::Arena* PROTOBUF_NULLABLE arena = nullptr) const {
+    return ::google::protobuf::Message::DefaultConstruct<InitProducerIdResponse>(arena);
+  }
+  using ::google::protobuf::Message::CopyFrom;
+  void CopyFrom(const InitProducerIdResponse& from);
+  using ::google::protobuf::Message::MergeFrom;
+  void MergeFrom(const InitProducerIdResponse& from) {
+    InitProducerIdResponse::MergeImpl(*this, from);
+  }
+
+private:
+  static void MergeImpl(::google::protobuf::MessageLite& to_msg, const ::google::protobuf::MessageLite& from_msg);
+
+public:
+  bool IsInitialized() const {
+    return true;
+  }
+  ABSL_ATTRIBUTE_REINITIALIZES void Clear() PROTOBUF_FINAL;
+#if defined(PROTOBUF_CUSTOM_VTABLE)
+private:
+  static ::size_t ByteSizeLong(const ::google::protobuf::MessageLite& msg);
+  static ::uint8_t* PROTOBUF_NONNULL
+  _InternalSerialize(const ::google::protobuf::MessageLite& msg, ::uint8_t* PROTOBUF_NONNULL target,
+                     ::google::protobuf::io::EpsCopyOutputStream* PROTOBUF_NONNULL stream);
+
+public:
+  ::size_t ByteSizeLong() const {
+    return ByteSizeLong(*this);
+  }
+  ::uint8_t* PROTOBUF_NONNULL _InternalSerialize(
+      ::uint8_t* PROTOBUF_NONNULL target, ::google::protobuf::io::EpsCopyOutputStream* PROTOBUF_NONNULL stream) const {
+    return _InternalSerialize(*this, target, stream);
+  }
+#else  // PROTOBUF_CUSTOM_VTABLE
+  ::size_t ByteSizeLong() const final;
+  ::uint8_t* PROTOBUF_NONNULL
+  _InternalSerialize(::uint8_t* PROTOBUF_NONNULL target,
+                     ::google::protobuf::io::EpsCopyOutputStream* PROTOBUF_NONNULL stream) const final;
+#endif // PROTOBUF_CUSTOM_VTABLE
+  int GetCachedSize() const {
+    return _impl_._cached_size_.Get();
+  }
+
+private:
+  void SharedCtor(::google::protobuf::Arena* PROTOBUF_NULLABLE arena);
+  static void SharedDtor(MessageLite& self);
+  void InternalSwap(InitProducerIdResponse* PROTOBUF_NONNULL other);
+
+private:
+  template <typename T>
+  friend ::absl::string_view(::google::protobuf::internal::GetAnyMessageName)();
+  static ::absl::string_view FullMessageName() {
+    return "streamit.v1.InitProducerIdResponse";
+  }
+
+protected:
+  explicit InitProducerIdResponse(::google::protobuf::Arena* PROTOBUF_NULLABLE arena);
+  InitProducerIdResponse(::google::protobuf::Arena* PROTOBUF_NULLABLE arena, const InitProducerIdResponse& from);
+  InitProducerIdResponse(::google::protobuf::Arena* PROTOBUF_NULLABLE arena, InitProducerIdResponse&& from) noexcept
+      : InitProducerIdResponse(arena) {
+    *this = ::std::move(from);
+  }
+  const ::google::protobuf::internal::ClassData* PROTOBUF_NONNULL GetClassData() const PROTOBUF_FINAL;
+  static void* PROTOBUF_NONNULL PlacementNew_(const void* PROTOBUF_NONNULL, void* PROTOBUF_NONNULL mem,
+                                              ::google::protobuf::Arena* PROTOBUF_NULLABLE arena);
+  static constexpr auto InternalNewImpl_();
+
+public:
+  static constexpr auto InternalGenerateClassData_();
+
+  ::google::protobuf::Metadata GetMetadata() const;
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+  enum : int {
+    kErrorMessageFieldNumber = 3,
+    kProducerIdFieldNumber = 1,
+    kErrorCodeFieldNumber = 2,
+  };
+  // string error_message = 3;
+  void clear_error_message();
+  const ::std::string& error_message() const;
+  template <typename Arg_ = const ::std::string&, typename... Args_>
+  void set_error_message(Arg_&& arg, Args_... args);
+  ::std::string* PROTOBUF_NONNULL mutable_error_message();
+  [[nodiscard]] ::std::string* PROTOBUF_NULLABLE release_error_message();
+  void set_allocated_error_message(::std::string* PROTOBUF_NULLABLE value);
+
+private:
+  const ::std::string& _internal_error_message() const;
+  PROTOBUF_ALWAYS_INLINE void _internal_set_error_message(const ::std::string& value);
+  ::std::string* PROTOBUF_NONNULL _internal_mutable_error_message();
+
+public:
+  // int64 producer_id = 1;
+  void clear_producer_id();
+  ::int64_t producer_id() const;
+  void set_producer_id(::int64_t value);
+
+private:
+  ::int64_t _internal_producer_id() const;
+  void _internal_set_producer_id(::int64_t value);
+
+public:
+  // .streamit.v1.ErrorCode error_code = 2;
+  void clear_error_code();
+  ::streamit::v1::ErrorCode error_code() const;
+  void set_error_code(::streamit::v1::ErrorCode value);
+
+private:
+  ::streamit::v1::ErrorCode _internal_error_code() const;
+  void _internal_set_error_code(::streamit::v1::ErrorCode value);
+
+public:
+  // @@protoc_insertion_point(class_scope:streamit.v1.InitProducerIdResponse)
+private:
+  class _Internal;
+  friend class ::google::protobuf::internal::TcParser;
+  static const ::google::protobuf::internal::TcParseTable<2, 3, 0, 56, 2> _table_;
+
+  friend class ::google::protobuf::MessageLite;
+  friend class ::google::protobuf::Arena;
+  template <typename T>
+  friend class ::google::protobuf::Arena::InternalHelper;
+  using InternalArenaConstructable_ = void;
+  using DestructorSkippable_ = void;
+  struct Impl_ {
+    inline explicit constexpr Impl_(::google::protobuf::internal::ConstantInitialized) noexcept;
+    inline explicit Impl_(::google::protobuf::internal::InternalVisibility visibility,
+                          ::google::protobuf::Arena* PROTOBUF_NULLABLE arena);
+    inline explicit Impl_(::google::protobuf::internal::InternalVisibility visibility,
+                          ::google::protobuf::Arena* PROTOBUF_NULLABLE arena, const Impl_& from,
+                          const InitProducerIdResponse& from_msg);
+    ::google::protobuf::internal::HasBits<1> _has_bits_;
+    ::google::protobuf::internal::CachedSize _cached_size_;
+    ::google::protobuf::internal::ArenaStringPtr error_message_;
+    ::int64_t producer_id_;
+    int error_code_;
+    PROTOBUF_TSAN_DECLARE_MEMBER
+  };
+  union {
+    Impl_ _impl_;
+  };
+  friend struct ::TableStruct_proto_2fstreamit_2eproto;
+};
+
+extern const ::google::protobuf::internal::ClassDataFull InitProducerIdResponse_class_data_;
+// -------------------------------------------------------------------
+
+class InitProducerIdRequest final : public ::google::protobuf::internal::ZeroFieldsBase
+/* @@protoc_insertion_point(class_definition:streamit.v1.InitProducerIdRequest) */ {
+public:
+  inline InitProducerIdRequest() : InitProducerIdRequest(nullptr) {
+  }
+
+#if defined(PROTOBUF_CUSTOM_VTABLE)
+  void operator delete(InitProducerIdRequest* PROTOBUF_NONNULL msg, ::std::destroying_delete_t) {
+    SharedDtor(*msg);
+    ::google::protobuf::internal::SizedDelete(msg, sizeof(InitProducerIdRequest));
+  }
+#endif
+
+  template <typename = void>
+  explicit PROTOBUF_CONSTEXPR InitProducerIdRequest(::google::protobuf::internal::ConstantInitialized);
+
+  inline InitProducerIdRequest(const InitProducerIdRequest& from) : InitProducerIdRequest(nullptr, from) {
+  }
+  inline InitProducerIdRequest(InitProducerIdRequest&& from) noexcept
+      : InitProducerIdRequest(nullptr, ::std::move(from)) {
+  }
+  inline InitProducerIdRequest& operator=(const InitProducerIdRequest& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline InitProducerIdRequest& operator=(InitProducerIdRequest&& from) noexcept {
+    if (this == &from)
+      return *this;
+    if (::google::protobuf::internal::CanMoveWithInternalSwap(GetArena(), from.GetArena())) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  inline const ::google::protobuf::UnknownFieldSet& unknown_fields() const ABSL_ATTRIBUTE_LIFETIME_BOUND {
+    return _internal_metadata_.unknown_fields<::google::protobuf::UnknownFieldSet>(
+        ::google::protobuf::UnknownFieldSet::default_instance);
+  }
+  inline ::google::protobuf::UnknownFieldSet* PROTOBUF_NONNULL mutable_unknown_fields() ABSL_ATTRIBUTE_LIFETIME_BOUND {
+    return _internal_metadata_.mutable_unknown_fields<::google::protobuf::UnknownFieldSet>();
+  }
+
+  static const ::google::protobuf::Descriptor* PROTOBUF_NONNULL descriptor() {
+    return GetDescriptor();
+  }
+  static const ::google::protobuf::Descriptor* PROTOBUF_NONNULL GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::google::protobuf::Reflection* PROTOBUF_NONNULL GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const InitProducerIdRequest& default_instance() {
+    return *reinterpret_cast<const InitProducerIdRequest*>(&_InitProducerIdRequest_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages = 2;
+  friend void swap(InitProducerIdRequest& a, InitProducerIdRequest& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(InitProducerIdRequest* PROTOBUF_NONNULL other) {
+    if (other == this)
+      return;
+    if (::google::protobuf::internal::CanUseInternalSwap(GetArena(), other->GetArena())) {
+      InternalSwap(other);
+    } else {
+      ::google::protobuf::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(InitProducerIdRequest* PROTOBUF_NONNULL other) {
+    if (other == this)
+      return;
+    ABSL_DCHECK(GetArena() == other->GetArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  InitProducerIdRequest* PROTOBUF_NONNULL New(::google::protobuf::Arena* PROTOBUF_NULLABLE arena = nullptr) const {
+    return ::google::protobuf::internal::ZeroFieldsBase::DefaultConstruct<InitProducerIdRequest>(arena);
+  }
+  using ::google::protobuf::internal::ZeroFieldsBase::CopyFrom;
+  inline void CopyFrom(const InitProducerIdRequest& from) {
+    ::google::protobuf::internal::ZeroFieldsBase::CopyImpl(*this, from);
+  }
+  using ::google::protobuf::internal::ZeroFieldsBase::MergeFrom;
+  void MergeFrom(const InitProducerIdRequest& from) {
+    ::google::protobuf::internal::ZeroFieldsBase::MergeImpl(*this, from);
+  }
+
+public:
+  bool IsInitialized() const {
+    return true;
+  }
+
+private:
+  template <typename T>
+  friend ::absl::string_view(::google::protobuf::internal::GetAnyMessageName)();
+  static ::absl::string_view FullMessageName() {
+    return "streamit.v1.InitProducerIdRequest";
+  }
+
+protected:
+  explicit InitProducerIdRequest(::google::protobuf::Arena* PROTOBUF_NULLABLE arena);
+  InitProducerIdRequest(::google::protobuf::Arena* PROTOBUF_NULLABLE arena, const InitProducerIdRequest& from);
+  InitProducerIdRequest(::google::protobuf::Arena* PROTOBUF_NULLABLE arena, InitProducerIdRequest&& from) noexcept
+      : InitProducerIdRequest(arena) {
+    *this = ::std::move(from);
+  }
+  const ::google::protobuf::internal::ClassData* PROTOBUF_NONNULL GetClassData() const PROTOBUF_FINAL;
+  static void* PROTOBUF_NONNULL PlacementNew_(const void* PROTOBUF_NONNULL, void* PROTOBUF_NONNULL mem,
+                                              ::google::protobuf::Arena* PROTOBUF_NULLABLE arena);
+  static constexpr auto InternalNewImpl_();
+
+public:
+  static constexpr auto InternalGenerateClassData_();
+
+  ::google::protobuf::Metadata GetMetadata() const;
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+  // @@protoc_insertion_point(class_scope:streamit.v1.InitProducerIdRequest)
+private:
+  class _Internal;
+  friend class ::google::protobuf::internal::TcParser;
+  static const ::google::protobuf::internal::TcParseTable<0, 0, 0, 0, 2> _table_;
+
+  friend class ::google::protobuf::MessageLite;
+  friend class ::google::protobuf::Arena;
+  template <typename T>
+  friend class ::google::protobuf::Arena::InternalHelper;
+  using InternalArenaConstructable_ = void;
+  using DestructorSkippable_ = void;
+  friend struct ::TableStruct_proto_2fstreamit_2eproto;
+};
+
+extern const ::google::protobuf::internal::ClassDataFull InitProducerIdRequest_class_data_;
+// -------------------------------------------------------------------
+
 class FindLeaderResponse final : public ::google::protobuf::Message
 /* @@protoc_insertion_point(class_definition:streamit.v1.FindLeaderResponse) */ {
 public:
@@ -1728,7 +2104,7 @@ public:
   static const FindLeaderResponse& default_instance() {
     return *reinterpret_cast<const FindLeaderResponse*>(&_FindLeaderResponse_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 18;
+  static constexpr int kIndexInFileMessages = 20;
   friend void swap(FindLeaderResponse& a, FindLeaderResponse& b) {
     a.Swap(&b);
   }
@@ -1984,7 +2360,7 @@ public:
   static const FindLeaderRequest& default_instance() {
     return *reinterpret_cast<const FindLeaderRequest*>(&_FindLeaderRequest_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 17;
+  static constexpr int kIndexInFileMessages = 19;
   friend void swap(FindLeaderRequest& a, FindLeaderRequest& b) {
     a.Swap(&b);
   }
@@ -2199,7 +2575,7 @@ public:
   static const FetchRequest& default_instance() {
     return *reinterpret_cast<const FetchRequest*>(&_FetchRequest_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 4;
+  static constexpr int kIndexInFileMessages = 6;
   friend void swap(FetchRequest& a, FetchRequest& b) {
     a.Swap(&b);
   }
@@ -2437,7 +2813,7 @@ public:
   static const DescribeTopicRequest& default_instance() {
     return *reinterpret_cast<const DescribeTopicRequest*>(&_DescribeTopicRequest_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 15;
+  static constexpr int kIndexInFileMessages = 17;
   friend void swap(DescribeTopicRequest& a, DescribeTopicRequest& b) {
     a.Swap(&b);
   }
@@ -2640,7 +3016,7 @@ public:
   static const CreateTopicResponse& default_instance() {
     return *reinterpret_cast<const CreateTopicResponse*>(&_CreateTopicResponse_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 12;
+  static constexpr int kIndexInFileMessages = 14;
   friend void swap(CreateTopicResponse& a, CreateTopicResponse& b) {
     a.Swap(&b);
   }
@@ -2867,7 +3243,7 @@ public:
   static const CreateTopicRequest& default_instance() {
     return *reinterpret_cast<const CreateTopicRequest*>(&_CreateTopicRequest_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 11;
+  static constexpr int kIndexInFileMessages = 13;
   friend void swap(CreateTopicRequest& a, CreateTopicRequest& b) {
     a.Swap(&b);
   }
@@ -3094,7 +3470,7 @@ public:
   static const CommitOffsetResponse& default_instance() {
     return *reinterpret_cast<const CommitOffsetResponse*>(&_CommitOffsetResponse_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 7;
+  static constexpr int kIndexInFileMessages = 9;
   friend void swap(CommitOffsetResponse& a, CommitOffsetResponse& b) {
     a.Swap(&b);
   }
@@ -3309,7 +3685,7 @@ public:
   static const CommitOffsetRequest& default_instance() {
     return *reinterpret_cast<const CommitOffsetRequest*>(&_CommitOffsetRequest_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 6;
+  static constexpr int kIndexInFileMessages = 8;
   friend void swap(CommitOffsetRequest& a, CommitOffsetRequest& b) {
     a.Swap(&b);
   }
@@ -3553,7 +3929,7 @@ public:
   static const TopicMetadata& default_instance() {
     return *reinterpret_cast<const TopicMetadata*>(&_TopicMetadata_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 13;
+  static constexpr int kIndexInFileMessages = 15;
   friend void swap(TopicMetadata& a, TopicMetadata& b) {
     a.Swap(&b);
   }
@@ -3803,7 +4179,7 @@ public:
   static const ProduceRequest& default_instance() {
     return *reinterpret_cast<const ProduceRequest*>(&_ProduceRequest_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 2;
+  static constexpr int kIndexInFileMessages = 4;
   friend void swap(ProduceRequest& a, ProduceRequest& b) {
     a.Swap(&b);
   }
@@ -3902,10 +4278,10 @@ public:
   enum : int {
     kRecordsFieldNumber = 3,
     kTopicFieldNumber = 1,
-    kProducerIdFieldNumber = 5,
     kPartitionFieldNumber = 2,
     kAckFieldNumber = 4,
     kSequenceFieldNumber = 6,
+    kProducerIdFieldNumber = 7,
   };
   // repeated .streamit.v1.Record records = 3;
   int records_size() const;
@@ -3940,21 +4316,6 @@ private:
   PROTOBUF_ALWAYS_INLINE void _internal_set_topic(const ::std::string& value);
   ::std::string* PROTOBUF_NONNULL _internal_mutable_topic();
 
-public:
-  // string producer_id = 5;
-  void clear_producer_id();
-  const ::std::string& producer_id() const;
-  template <typename Arg_ = const ::std::string&, typename... Args_>
-  void set_producer_id(Arg_&& arg, Args_... args);
-  ::std::string* PROTOBUF_NONNULL mutable_producer_id();
-  [[nodiscard]] ::std::string* PROTOBUF_NULLABLE release_producer_id();
-  void set_allocated_producer_id(::std::string* PROTOBUF_NULLABLE value);
-
-private:
-  const ::std::string& _internal_producer_id() const;
-  PROTOBUF_ALWAYS_INLINE void _internal_set_producer_id(const ::std::string& value);
-  ::std::string* PROTOBUF_NONNULL _internal_mutable_producer_id();
-
 public:
   // int32 partition = 2;
   void clear_partition();
@@ -3985,12 +4346,22 @@ private:
   ::int64_t _internal_sequence() const;
   void _internal_set_sequence(::int64_t value);
 
+public:
+  // int64 producer_id = 7;
+  void clear_producer_id();
+  ::int64_t producer_id() const;
+  void set_producer_id(::int64_t value);
+
+private:
+  ::int64_t _internal_producer_id() const;
+  void _internal_set_producer_id(::int64_t value);
+
 public:
   // @@protoc_insertion_point(class_scope:streamit.v1.ProduceRequest)
 private:
   class _Internal;
   friend class ::google::protobuf::internal::TcParser;
-  static const ::google::protobuf::internal::TcParseTable<3, 6, 1, 51, 2> _table_;
+  static const ::google::protobuf::internal::TcParseTable<3, 6, 1, 40, 2> _table_;
 
   friend class ::google::protobuf::MessageLite;
   friend class ::google::protobuf::Arena;
@@ -4009,10 +4380,10 @@ private:
     ::google::protobuf::internal::CachedSize _cached_size_;
     ::google::protobuf::RepeatedPtrField<::streamit::v1::Record> records_;
     ::google::protobuf::internal::ArenaStringPtr topic_;
-    ::google::protobuf::internal::ArenaStringPtr producer_id_;
     ::int32_t partition_;
     int ack_;
     ::int64_t sequence_;
+    ::int64_t producer_id_;
     PROTOBUF_TSAN_DECLARE_MEMBER
   };
   union {
@@ -4081,7 +4452,7 @@ public:
   static const PollAssignmentResponse& default_instance() {
     return *reinterpret_cast<const PollAssignmentResponse*>(&_PollAssignmentResponse_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 10;
+  static constexpr int kIndexInFileMessages = 12;
   friend void swap(PollAssignmentResponse& a, PollAssignmentResponse& b) {
     a.Swap(&b);
   }
@@ -4333,7 +4704,7 @@ public:
   static const FetchResponse& default_instance() {
     return *reinterpret_cast<const FetchResponse*>(&_FetchResponse_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 5;
+  static constexpr int kIndexInFileMessages = 7;
   friend void swap(FetchResponse& a, FetchResponse& b) {
     a.Swap(&b);
   }
@@ -4611,7 +4982,7 @@ public:
   static const DescribeTopicResponse& default_instance() {
     return *reinterpret_cast<const DescribeTopicResponse*>(&_DescribeTopicResponse_default_instance_);
   }
-  static constexpr int kIndexInFileMessages = 16;
+  static constexpr int kIndexInFileMessages = 18;
   friend void swap(DescribeTopicResponse& a, DescribeTopicResponse& b) {
     a.Swap(&b);
   }
@@ -5065,6 +5436,127 @@ inline void RecordBatch::_internal_set_crc32(::uint32_t value) {
 
 // -------------------------------------------------------------------
 
+// InitProducerIdRequest
+
+// -------------------------------------------------------------------
+
+// InitProducerIdResponse
+
+// InitProducerIdResponse
+
+// int64 producer_id = 1;
+inline void InitProducerIdResponse::clear_producer_id() {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.producer_id_ = ::int64_t{0};
+  _impl_._has_bits_[0] &= ~0x00000002U;
+}
+inline ::int64_t InitProducerIdResponse::producer_id() const {
+  // @@protoc_insertion_point(field_get:streamit.v1.InitProducerIdResponse.producer_id)
+  return _internal_producer_id();
+}
+inline void InitProducerIdResponse::set_producer_id(::int64_t value) {
+  _internal_set_producer_id(value);
+  _impl_._has_bits_[0] |= 0x00000002U;
+  // @@protoc_insertion_point(field_set:streamit.v1.InitProducerIdResponse.producer_id)
+}
+inline ::int64_t InitProducerIdResponse::_internal_producer_id() const {
+  ::google::protobuf::internal::TSanRead(&_impl_);
+  return _impl_.producer_id_;
+}
+inline void InitProducerIdResponse::_internal_set_producer_id(::int64_t value) {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.producer_id_ = value;
+}
+
+// .streamit.v1.ErrorCode error_code = 2;
+inline void InitProducerIdResponse::clear_error_code() {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.error_code_ = 0;
+  _impl_._has_bits_[0] &= ~0x00000004U;
+}
+inline ::streamit::v1::ErrorCode InitProducerIdResponse::error_code() const {
+  // @@protoc_insertion_point(field_get:streamit.v1.InitProducerIdResponse.error_code)
+  return _internal_error_code();
+}
+inline void InitProducerIdResponse::set_error_code(::streamit::v1::ErrorCode value) {
+  _internal_set_error_code(value);
+  _impl_._has_bits_[0] |= 0x00000004U;
+  // @@protoc_insertion_point(field_set:streamit.v1.InitProducerIdResponse.error_code)
+}
+inline ::streamit::v1::ErrorCode InitProducerIdResponse::_internal_error_code() const {
+  ::google::protobuf::internal::TSanRead(&_impl_);
+  return static_cast<::streamit::v1::ErrorCode>(_impl_.error_code_);
+}
+inline void InitProducerIdResponse::_internal_set_error_code(::streamit::v1::ErrorCode value) {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.error_code_ = value;
+}
+
+// string error_message = 3;
+inline void InitProducerIdResponse::clear_error_message() {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.error_message_.ClearToEmpty();
+  _impl_._has_bits_[0] &= ~0x00000001U;
+}
+inline const ::std::string& InitProducerIdResponse::error_message() const ABSL_ATTRIBUTE_LIFETIME_BOUND {
+  // @@protoc_insertion_point(field_get:streamit.v1.InitProducerIdResponse.error_message)
+  return _internal_error_message();
+}
+template <typename Arg_, typename... Args_>
+PROTOBUF_ALWAYS_INLINE void InitProducerIdResponse::set_error_message(Arg_&& arg, Args_... args) {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_._has_bits_[0] |= 0x00000001U;
+  _impl_.error_message_.Set(static_cast<Arg_&&>(arg), args..., GetArena());
+  // @@protoc_insertion_point(field_set:streamit.v1.InitProducerIdResponse.error_message)
+}
+inline ::std::string* PROTOBUF_NONNULL InitProducerIdResponse::mutable_error_message() ABSL_ATTRIBUTE_LIFETIME_BOUND {
+  ::std::string* _s = _internal_mutable_error_message();
+  // @@protoc_insertion_point(field_mutable:streamit.v1.InitProducerIdResponse.error_message)
+  return _s;
+}
+inline const ::std::string& InitProducerIdResponse::_internal_error_message() const {
+  ::google::protobuf::internal::TSanRead(&_impl_);
+  return _impl_.error_message_.Get();
+}
+inline void InitProducerIdResponse::_internal_set_error_message(const ::std::string& value) {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_._has_bits_[0] |= 0x00000001U;
+  _impl_.error_message_.Set(value, GetArena());
+}
+inline ::std::string* PROTOBUF_NONNULL InitProducerIdResponse::_internal_mutable_error_message() {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_._has_bits_[0] |= 0x00000001U;
+  return _impl_.error_message_.Mutable(GetArena());
+}
+inline ::std::string* PROTOBUF_NULLABLE InitProducerIdResponse::release_error_message() {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  // @@protoc_insertion_point(field_release:streamit.v1.InitProducerIdResponse.error_message)
+  if ((_impl_._has_bits_[0] & 0x00000001U) == 0) {
+    return nullptr;
+  }
+  _impl_._has_bits_[0] &= ~0x00000001U;
+  auto* released = _impl_.error_message_.Release();
+  if (::google::protobuf::internal::DebugHardenForceCopyDefaultString()) {
+    _impl_.error_message_.Set("", GetArena());
+  }
+  return released;
+}
+inline void InitProducerIdResponse::set_allocated_error_message(::std::string* PROTOBUF_NULLABLE value) {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  if (value != nullptr) {
+    _impl_._has_bits_[0] |= 0x00000001U;
+  } else {
+    _impl_._has_bits_[0] &= ~0x00000001U;
+  }
+  _impl_.error_message_.SetAllocated(value, GetArena());
+  if (::google::protobuf::internal::DebugHardenForceCopyDefaultString() && _impl_.error_message_.IsDefault()) {
+    _impl_.error_message_.Set("", GetArena());
+  }
+  // @@protoc_insertion_point(field_set_allocated:streamit.v1.InitProducerIdResponse.error_message)
+}
+
+// -------------------------------------------------------------------
+
 // ProduceRequest
 
 // string topic = 1;
@@ -5134,7 +5626,7 @@ inline void ProduceRequest::set_allocated_topic(::std::string* PROTOBUF_NULLABLE
 inline void ProduceRequest::clear_partition() {
   ::google::protobuf::internal::TSanWrite(&_impl_);
   _impl_.partition_ = 0;
-  _impl_._has_bits_[0] &= ~0x00000004U;
+  _impl_._has_bits_[0] &= ~0x00000002U;
 }
 inline ::int32_t ProduceRequest::partition() const {
   // @@protoc_insertion_point(field_get:streamit.v1.ProduceRequest.partition)
@@ -5142,7 +5634,7 @@ inline ::int32_t ProduceRequest::partition() const {
 }
 inline void ProduceRequest::set_partition(::int32_t value) {
   _internal_set_partition(value);
-  _impl_._has_bits_[0] |= 0x00000004U;
+  _impl_._has_bits_[0] |= 0x00000002U;
   // @@protoc_insertion_point(field_set:streamit.v1.ProduceRequest.partition)
 }
 inline ::int32_t ProduceRequest::_internal_partition() const {
@@ -5205,7 +5697,7 @@ ProduceRequest::_internal_mutable_records() {
 inline void ProduceRequest::clear_ack() {
   ::google::protobuf::internal::TSanWrite(&_impl_);
   _impl_.ack_ = 0;
-  _impl_._has_bits_[0] &= ~0x00000008U;
+  _impl_._has_bits_[0] &= ~0x00000004U;
 }
 inline ::streamit::v1::Ack ProduceRequest::ack() const {
   // @@protoc_insertion_point(field_get:streamit.v1.ProduceRequest.ack)
@@ -5213,7 +5705,7 @@ inline ::streamit::v1::Ack ProduceRequest::ack() const {
 }
 inline void ProduceRequest::set_ack(::streamit::v1::Ack value) {
   _internal_set_ack(value);
-  _impl_._has_bits_[0] |= 0x00000008U;
+  _impl_._has_bits_[0] |= 0x00000004U;
   // @@protoc_insertion_point(field_set:streamit.v1.ProduceRequest.ack)
 }
 inline ::streamit::v1::Ack ProduceRequest::_internal_ack() const {
@@ -5225,74 +5717,11 @@ inline void ProduceRequest::_internal_set_ack(::streamit::v1::Ack value) {
   _impl_.ack_ = value;
 }
 
-// string producer_id = 5;
-inline void ProduceRequest::clear_producer_id() {
-  ::google::protobuf::internal::TSanWrite(&_impl_);
-  _impl_.producer_id_.ClearToEmpty();
-  _impl_._has_bits_[0] &= ~0x00000002U;
-}
-inline const ::std::string& ProduceRequest::producer_id() const ABSL_ATTRIBUTE_LIFETIME_BOUND {
-  // @@protoc_insertion_point(field_get:streamit.v1.ProduceRequest.producer_id)
-  return _internal_producer_id();
-}
-template <typename Arg_, typename... Args_>
-PROTOBUF_ALWAYS_INLINE void ProduceRequest::set_producer_id(Arg_&& arg, Args_... args) {
-  ::google::protobuf::internal::TSanWrite(&_impl_);
-  _impl_._has_bits_[0] |= 0x00000002U;
-  _impl_.producer_id_.Set(static_cast<Arg_&&>(arg), args..., GetArena());
-  // @@protoc_insertion_point(field_set:streamit.v1.ProduceRequest.producer_id)
-}
-inline ::std::string* PROTOBUF_NONNULL ProduceRequest::mutable_producer_id() ABSL_ATTRIBUTE_LIFETIME_BOUND {
-  ::std::string* _s = _internal_mutable_producer_id();
-  // @@protoc_insertion_point(field_mutable:streamit.v1.ProduceRequest.producer_id)
-  return _s;
-}
-inline const ::std::string& ProduceRequest::_internal_producer_id() const {
-  ::google::protobuf::internal::TSanRead(&_impl_);
-  return _impl_.producer_id_.Get();
-}
-inline void ProduceRequest::_internal_set_producer_id(const ::std::string& value) {
-  ::google::protobuf::internal::TSanWrite(&_impl_);
-  _impl_._has_bits_[0] |= 0x00000002U;
-  _impl_.producer_id_.Set(value, GetArena());
-}
-inline ::std::string* PROTOBUF_NONNULL ProduceRequest::_internal_mutable_producer_id() {
-  ::google::protobuf::internal::TSanWrite(&_impl_);
-  _impl_._has_bits_[0] |= 0x00000002U;
-  return _impl_.producer_id_.Mutable(GetArena());
-}
-inline ::std::string* PROTOBUF_NULLABLE ProduceRequest::release_producer_id() {
-  ::google::protobuf::internal::TSanWrite(&_impl_);
-  // @@protoc_insertion_point(field_release:streamit.v1.ProduceRequest.producer_id)
-  if ((_impl_._has_bits_[0] & 0x00000002U) == 0) {
-    return nullptr;
-  }
-  _impl_._has_bits_[0] &= ~0x00000002U;
-  auto* released = _impl_.producer_id_.Release();
-  if (::google::protobuf::internal::DebugHardenForceCopyDefaultString()) {
-    _impl_.producer_id_.Set("", GetArena());
-  }
-  return released;
-}
-inline void ProduceRequest::set_allocated_producer_id(::std::string* PROTOBUF_NULLABLE value) {
-  ::google::protobuf::internal::TSanWrite(&_impl_);
-  if (value != nullptr) {
-    _impl_._has_bits_[0] |= 0x00000002U;
-  } else {
-    _impl_._has_bits_[0] &= ~0x00000002U;
-  }
-  _impl_.producer_id_.SetAllocated(value, GetArena());
-  if (::google::protobuf::internal::DebugHardenForceCopyDefaultString() && _impl_.producer_id_.IsDefault()) {
-    _impl_.producer_id_.Set("", GetArena());
-  }
-  // @@protoc_insertion_point(field_set_allocated:streamit.v1.ProduceRequest.producer_id)
-}
-
 // int64 sequence = 6;
 inline void ProduceRequest::clear_sequence() {
   ::google::protobuf::internal::TSanWrite(&_impl_);
   _impl_.sequence_ = ::int64_t{0};
-  _impl_._has_bits_[0] &= ~0x00000010U;
+  _impl_._has_bits_[0] &= ~0x00000008U;
 }
 inline ::int64_t ProduceRequest::sequence() const {
   // @@protoc_insertion_point(field_get:streamit.v1.ProduceRequest.sequence)
@@ -5300,7 +5729,7 @@ inline ::int64_t ProduceRequest::sequence() const {
 }
 inline void ProduceRequest::set_sequence(::int64_t value) {
   _internal_set_sequence(value);
-  _impl_._has_bits_[0] |= 0x00000010U;
+  _impl_._has_bits_[0] |= 0x00000008U;
   // @@protoc_insertion_point(field_set:streamit.v1.ProduceRequest.sequence)
 }
 inline ::int64_t ProduceRequest::_internal_sequence() const {
@@ -5312,6 +5741,31 @@ inline void ProduceRequest::_internal_set_sequence(::int64_t value) {
   _impl_.sequence_ = value;
 }
 
+
+// int64 producer_id = 7;
+inline void ProduceRequest::clear_producer_id() {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.producer_id_ = ::int64_t{0};
+  _impl_._has_bits_[0] &= ~0x00000010U;
+}
+inline ::int64_t ProduceRequest::producer_id() const {
+  // @@protoc_insertion_point(field_get:streamit.v1.ProduceRequest.producer_id)
+  return _internal_producer_id();
+}
+inline void ProduceRequest::set_producer_id(::int64_t value) {
+  _internal_set_producer_id(value);
+  _impl_._has_bits_[0] |= 0x00000010U;
+  // @@protoc_insertion_point(field_set:streamit.v1.ProduceRequest.producer_id)
+}
+inline ::int64_t ProduceRequest::_internal_producer_id() const {
+  ::google::protobuf::internal::TSanRead(&_impl_);
+  return _impl_.producer_id_;
+}
+inline void ProduceRequest::_internal_set_producer_id(::int64_t value) {
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  _impl_.producer_id_ = value;
+}
+
 // -------------------------------------------------------------------
 
 // ProduceResponse
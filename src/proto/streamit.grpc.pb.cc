@@ -24,6 +24,7 @@ namespace streamit {
 namespace v1 {
 
 static const char* Broker_method_names[] = {
+    "/streamit.v1.Broker/InitProducerId",
     "/streamit.v1.Broker/Produce",
     "/streamit.v1.Broker/Fetch",
 };
@@ -36,12 +37,54 @@ std::unique_ptr<Broker::Stub> Broker::NewStub(const std::shared_ptr<::grpc::Chan
 }
 
 Broker::Stub::Stub(const std::shared_ptr<::grpc::ChannelInterface>& channel, const ::grpc::StubOptions& options)
-    : channel_(channel), rpcmethod_Produce_(Broker_method_names[0], options.suffix_for_stats(),
-                                            ::grpc::internal::RpcMethod::NORMAL_RPC, channel),
-      rpcmethod_Fetch_(Broker_method_names[1], options.suffix_for_stats(), ::grpc::internal::RpcMethod::NORMAL_RPC,
+    : channel_(channel), rpcmethod_InitProducerId_(Broker_method_names[0], options.suffix_for_stats(),
+                                                   ::grpc::internal::RpcMethod::NORMAL_RPC, channel),
+      rpcmethod_Produce_(Broker_method_names[1], options.suffix_for_stats(), ::grpc::internal::RpcMethod::NORMAL_RPC,
+                         channel),
+      rpcmethod_Fetch_(Broker_method_names[2], options.suffix_for_stats(), ::grpc::internal::RpcMethod::NORMAL_RPC,
                        channel) {
 }
 
+::grpc::Status Broker::Stub::InitProducerId(::grpc::ClientContext* context,
+                                            const ::streamit::v1::InitProducerIdRequest& request,
+                                            ::streamit::v1::InitProducerIdResponse* response) {
+  return ::grpc::internal::BlockingUnaryCall<::streamit::v1::InitProducerIdRequest,
+                                             ::streamit::v1::InitProducerIdResponse, ::grpc::protobuf::MessageLite,
+                                             ::grpc::protobuf::MessageLite>(channel_.get(), rpcmethod_InitProducerId_,
+                                                                            context, request, response);
+}
+
+void Broker::Stub::async::InitProducerId(::grpc::ClientContext* context,
+                                         const ::streamit::v1::InitProducerIdRequest* request,
+                                         ::streamit::v1::InitProducerIdResponse* response,
+                                         std::function<void(::grpc::Status)> f) {
+  ::grpc::internal::CallbackUnaryCall<::streamit::v1::InitProducerIdRequest, ::streamit::v1::InitProducerIdResponse,
+                                      ::grpc::protobuf::MessageLite, ::grpc::protobuf::MessageLite>(
+      stub_->channel_.get(), stub_->rpcmethod_InitProducerId_, context, request, response, std::move(f));
+}
+
+void Broker::Stub::async::InitProducerId(::grpc::ClientContext* context,
+                                         const ::streamit::v1::InitProducerIdRequest* request,
+                                         ::streamit::v1::InitProducerIdResponse* response,
+                                         ::grpc::ClientUnaryReactor* reactor) {
+  ::grpc::internal::ClientCallbackUnaryFactory::Create<::grpc::protobuf::MessageLite, ::grpc::protobuf::MessageLite>(
+      stub_->channel_.get(), stub_->rpcmethod_InitProducerId_, context, request, response, reactor);
+}
+
+::grpc::ClientAsyncResponseReader<::streamit::v1::InitProducerIdResponse>* Broker::Stub::PrepareAsyncInitProducerIdRaw(
+    ::grpc::ClientContext* context, const ::streamit::v1::InitProducerIdRequest& request, ::grpc::CompletionQueue* cq) {
+  return ::grpc::internal::ClientAsyncResponseReaderHelper::Create<
+      ::streamit::v1::InitProducerIdResponse, ::streamit::v1::InitProducerIdRequest, ::grpc::protobuf::MessageLite,
+      ::grpc::protobuf::MessageLite>(channel_.get(), cq, rpcmethod_InitProducerId_, context, request);
+}
+
+::grpc::ClientAsyncResponseReader<::streamit::v1::InitProducerIdResponse>* Broker::Stub::AsyncInitProducerIdRaw(
+    ::grpc::ClientContext* context, const ::streamit::v1::InitProducerIdRequest& request, ::grpc::CompletionQueue* cq) {
+  auto* result = this->PrepareAsyncInitProducerIdRaw(context, request, cq);
+  result->StartCall();
+  return result;
+}
+
 ::grpc::Status Broker::Stub::Produce(::grpc::ClientContext* context, const ::streamit::v1::ProduceRequest& request,
                                      ::streamit::v1::ProduceResponse* response) {
   return ::grpc::internal::BlockingUnaryCall<::streamit::v1::ProduceRequest, ::streamit::v1::ProduceResponse,
@@ -113,6 +156,14 @@ void Broker::Stub::async::Fetch(::grpc::ClientContext* context, const ::streamit
 Broker::Service::Service() {
   AddMethod(new ::grpc::internal::RpcServiceMethod(
       Broker_method_names[0], ::grpc::internal::RpcMethod::NORMAL_RPC,
+      new ::grpc::internal::RpcMethodHandler<Broker::Service, ::streamit::v1::InitProducerIdRequest,
+                                             ::streamit::v1::InitProducerIdResponse, ::grpc::protobuf::MessageLite,
+                                             ::grpc::protobuf::MessageLite>(
+          [](Broker::Service* service, ::grpc::ServerContext* ctx, const ::streamit::v1::InitProducerIdRequest* req,
+             ::streamit::v1::InitProducerIdResponse* resp) { return service->InitProducerId(ctx, req, resp); },
+          this)));
+  AddMethod(new ::grpc::internal::RpcServiceMethod(
+      Broker_method_names[1], ::grpc::internal::RpcMethod::NORMAL_RPC,
       new ::grpc::internal::RpcMethodHandler<Broker::Service, ::streamit::v1::ProduceRequest,
                                              ::streamit::v1::ProduceResponse, ::grpc::protobuf::MessageLite,
                                              ::grpc::protobuf::MessageLite>(
@@ -120,7 +171,7 @@ Broker::Service::Service() {
              ::streamit::v1::ProduceResponse* resp) { return service->Produce(ctx, req, resp); },
           this)));
   AddMethod(new ::grpc::internal::RpcServiceMethod(
-      Broker_method_names[1], ::grpc::internal::RpcMethod::NORMAL_RPC,
+      Broker_method_names[2], ::grpc::internal::RpcMethod::NORMAL_RPC,
       new ::grpc::internal::RpcMethodHandler<Broker::Service, ::streamit::v1::FetchRequest,
                                              ::streamit::v1::FetchResponse, ::grpc::protobuf::MessageLite,
                                              ::grpc::protobuf::MessageLite>(
@@ -132,6 +183,15 @@ Broker::Service::Service() {
 Broker::Service::~Service() {
 }
 
+::grpc::Status Broker::Service::InitProducerId(::grpc::ServerContext* context,
+                                               const ::streamit::v1::InitProducerIdRequest* request,
+                                               ::streamit::v1::InitProducerIdResponse* response) {
+  (void)context;
+  (void)request;
+  (void)response;
+  return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+}
+
 ::grpc::Status Broker::Service::Produce(::grpc::ServerContext* context, const ::streamit::v1::ProduceRequest* request,
                                         ::streamit::v1::ProduceResponse* response) {
   (void)context;
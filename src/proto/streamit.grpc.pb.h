@@ -39,6 +39,21 @@ public:
   public:
     virtual ~StubInterface() {
     }
+    virtual ::grpc::Status InitProducerId(::grpc::ClientContext* context,
+                                          const ::streamit::v1::InitProducerIdRequest& request,
+                                          ::streamit::v1::InitProducerIdResponse* response) = 0;
+    std::unique_ptr<::grpc::ClientAsyncResponseReaderInterface<::streamit::v1::InitProducerIdResponse>>
+    AsyncInitProducerId(::grpc::ClientContext* context, const ::streamit::v1::InitProducerIdRequest& request,
+                        ::grpc::CompletionQueue* cq) {
+      return std::unique_ptr<::grpc::ClientAsyncResponseReaderInterface<::streamit::v1::InitProducerIdResponse>>(
+          AsyncInitProducerIdRaw(context, request, cq));
+    }
+    std::unique_ptr<::grpc::ClientAsyncResponseReaderInterface<::streamit::v1::InitProducerIdResponse>>
+    PrepareAsyncInitProducerId(::grpc::ClientContext* context, const ::streamit::v1::InitProducerIdRequest& request,
+                               ::grpc::CompletionQueue* cq) {
+      return std::unique_ptr<::grpc::ClientAsyncResponseReaderInterface<::streamit::v1::InitProducerIdResponse>>(
+          PrepareAsyncInitProducerIdRaw(context, request, cq));
+    }
     virtual ::grpc::Status Produce(::grpc::ClientContext* context, const ::streamit::v1::ProduceRequest& request,
                                    ::streamit::v1::ProduceResponse* response) = 0;
     std::unique_ptr<::grpc::ClientAsyncResponseReaderInterface<::streamit::v1::ProduceResponse>> AsyncProduce(
@@ -67,6 +82,12 @@ public:
     public:
       virtual ~async_interface() {
       }
+      virtual void InitProducerId(::grpc::ClientContext* context, const ::streamit::v1::InitProducerIdRequest* request,
+                                  ::streamit::v1::InitProducerIdResponse* response,
+                                  std::function<void(::grpc::Status)>) = 0;
+      virtual void InitProducerId(::grpc::ClientContext* context, const ::streamit::v1::InitProducerIdRequest* request,
+                                  ::streamit::v1::InitProducerIdResponse* response,
+                                  ::grpc::ClientUnaryReactor* reactor) = 0;
       virtual void Produce(::grpc::ClientContext* context, const ::streamit::v1::ProduceRequest* request,
                            ::streamit::v1::ProduceResponse* response, std::function<void(::grpc::Status)>) = 0;
       virtual void Produce(::grpc::ClientContext* context, const ::streamit::v1::ProduceRequest* request,
@@ -85,6 +106,12 @@ public:
     }
 
   private:
+    virtual ::grpc::ClientAsyncResponseReaderInterface<::streamit::v1::InitProducerIdResponse>* AsyncInitProducerIdRaw(
+        ::grpc::ClientContext* context, const ::streamit::v1::InitProducerIdRequest& request,
+        ::grpc::CompletionQueue* cq) = 0;
+    virtual ::grpc::ClientAsyncResponseReaderInterface<::streamit::v1::InitProducerIdResponse>*
+    PrepareAsyncInitProducerIdRaw(::grpc::ClientContext* context, const ::streamit::v1::InitProducerIdRequest& request,
+                                  ::grpc::CompletionQueue* cq) = 0;
     virtual ::grpc::ClientAsyncResponseReaderInterface<::streamit::v1::ProduceResponse>* AsyncProduceRaw(
         ::grpc::ClientContext* context, const ::streamit::v1::ProduceRequest& request, ::grpc::CompletionQueue* cq) = 0;
     virtual ::grpc::ClientAsyncResponseReaderInterface<::streamit::v1::ProduceResponse>* PrepareAsyncProduceRaw(
@@ -98,6 +125,20 @@ public:
   public:
     Stub(const std::shared_ptr<::grpc::ChannelInterface>& channel,
          const ::grpc::StubOptions& options = ::grpc::StubOptions());
+    ::grpc::Status InitProducerId(::grpc::ClientContext* context, const ::streamit::v1::InitProducerIdRequest& request,
+                                  ::streamit::v1::InitProducerIdResponse* response) override;
+    std::unique_ptr<::grpc::ClientAsyncResponseReader<::streamit::v1::InitProducerIdResponse>> AsyncInitProducerId(
+        ::grpc::ClientContext* context, const ::streamit::v1::InitProducerIdRequest& request,
+        ::grpc::CompletionQueue* cq) {
+      return std::unique_ptr<::grpc::ClientAsyncResponseReader<::streamit::v1::InitProducerIdResponse>>(
+          AsyncInitProducerIdRaw(context, request, cq));
+    }
+    std::unique_ptr<::grpc::ClientAsyncResponseReader<::streamit::v1::InitProducerIdResponse>>
+    PrepareAsyncInitProducerId(::grpc::ClientContext* context, const ::streamit::v1::InitProducerIdRequest& request,
+                               ::grpc::CompletionQueue* cq) {
+      return std::unique_ptr<::grpc::ClientAsyncResponseReader<::streamit::v1::InitProducerIdResponse>>(
+          PrepareAsyncInitProducerIdRaw(context, request, cq));
+    }
     ::grpc::Status Produce(::grpc::ClientContext* context, const ::streamit::v1::ProduceRequest& request,
                            ::streamit::v1::ProduceResponse* response) override;
     std::unique_ptr<::grpc::ClientAsyncResponseReader<::streamit::v1::ProduceResponse>> AsyncProduce(
@@ -124,6 +165,12 @@ public:
     }
     class async final : public StubInterface::async_interface {
     public:
+      void InitProducerId(::grpc::ClientContext* context, const ::streamit::v1::InitProducerIdRequest* request,
+                          ::streamit::v1::InitProducerIdResponse* response,
+                          std::function<void(::grpc::Status)>) override;
+      void InitProducerId(::grpc::ClientContext* context, const ::streamit::v1::InitProducerIdRequest* request,
+                          ::streamit::v1::InitProducerIdResponse* response,
+                          ::grpc::ClientUnaryReactor* reactor) override;
       void Produce(::grpc::ClientContext* context, const ::streamit::v1::ProduceRequest* request,
                    ::streamit::v1::ProduceResponse* response, std::function<void(::grpc::Status)>) override;
       void Produce(::grpc::ClientContext* context, const ::streamit::v1::ProduceRequest* request,
@@ -149,6 +196,12 @@ public:
   private:
     std::shared_ptr<::grpc::ChannelInterface> channel_;
     class async async_stub_{this};
+    ::grpc::ClientAsyncResponseReader<::streamit::v1::InitProducerIdResponse>* AsyncInitProducerIdRaw(
+        ::grpc::ClientContext* context, const ::streamit::v1::InitProducerIdRequest& request,
+        ::grpc::CompletionQueue* cq) override;
+    ::grpc::ClientAsyncResponseReader<::streamit::v1::InitProducerIdResponse>* PrepareAsyncInitProducerIdRaw(
+        ::grpc::ClientContext* context, const ::streamit::v1::InitProducerIdRequest& request,
+        ::grpc::CompletionQueue* cq) override;
     ::grpc::ClientAsyncResponseReader<::streamit::v1::ProduceResponse>* AsyncProduceRaw(
         ::grpc::ClientContext* context, const ::streamit::v1::ProduceRequest& request,
         ::grpc::CompletionQueue* cq) override;
@@ -161,6 +214,7 @@ public:
     ::grpc::ClientAsyncResponseReader<::streamit::v1::FetchResponse>* PrepareAsyncFetchRaw(
         ::grpc::ClientContext* context, const ::streamit::v1::FetchRequest& request,
         ::grpc::CompletionQueue* cq) override;
+    const ::grpc::internal::RpcMethod rpcmethod_InitProducerId_;
     const ::grpc::internal::RpcMethod rpcmethod_Produce_;
     const ::grpc::internal::RpcMethod rpcmethod_Fetch_;
   };
@@ -171,12 +225,42 @@ public:
   public:
     Service();
     virtual ~Service();
+    virtual ::grpc::Status InitProducerId(::grpc::ServerContext* context,
+                                          const ::streamit::v1::InitProducerIdRequest* request,
+                                          ::streamit::v1::InitProducerIdResponse* response);
     virtual ::grpc::Status Produce(::grpc::ServerContext* context, const ::streamit::v1::ProduceRequest* request,
                                    ::streamit::v1::ProduceResponse* response);
     virtual ::grpc::Status Fetch(::grpc::ServerContext* context, const ::streamit::v1::FetchRequest* request,
                                  ::streamit::v1::FetchResponse* response);
   };
   template <class BaseClass>
+  class WithAsyncMethod_InitProducerId : public BaseClass {
+  private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {
+    }
+
+  public:
+    WithAsyncMethod_InitProducerId() {
+      ::grpc::Service::MarkMethodAsync(0);
+    }
+    ~WithAsyncMethod_InitProducerId() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable synchronous version of this method
+    ::grpc::Status InitProducerId(::grpc::ServerContext* /*context*/,
+                                  const ::streamit::v1::InitProducerIdRequest* /*request*/,
+                                  ::streamit::v1::InitProducerIdResponse* /*response*/) override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+    void RequestInitProducerId(::grpc::ServerContext* context, ::streamit::v1::InitProducerIdRequest* request,
+                               ::grpc::ServerAsyncResponseWriter<::streamit::v1::InitProducerIdResponse>* response,
+                               ::grpc::CompletionQueue* new_call_cq, ::grpc::ServerCompletionQueue* notification_cq,
+                               void* tag) {
+      ::grpc::Service::RequestAsyncUnary(0, context, request, response, new_call_cq, notification_cq, tag);
+    }
+  };
+  template <class BaseClass>
   class WithAsyncMethod_Produce : public BaseClass {
   private:
     void BaseClassMustBeDerivedFromService(const Service* /*service*/) {
@@ -184,7 +268,7 @@ public:
 
   public:
     WithAsyncMethod_Produce() {
-      ::grpc::Service::MarkMethodAsync(0);
+      ::grpc::Service::MarkMethodAsync(1);
     }
     ~WithAsyncMethod_Produce() override {
       BaseClassMustBeDerivedFromService(this);
@@ -199,7 +283,7 @@ public:
                         ::grpc::ServerAsyncResponseWriter<::streamit::v1::ProduceResponse>* response,
                         ::grpc::CompletionQueue* new_call_cq, ::grpc::ServerCompletionQueue* notification_cq,
                         void* tag) {
-      ::grpc::Service::RequestAsyncUnary(0, context, request, response, new_call_cq, notification_cq, tag);
+      ::grpc::Service::RequestAsyncUnary(1, context, request, response, new_call_cq, notification_cq, tag);
     }
   };
   template <class BaseClass>
@@ -210,7 +294,7 @@ public:
 
   public:
     WithAsyncMethod_Fetch() {
-      ::grpc::Service::MarkMethodAsync(1);
+      ::grpc::Service::MarkMethodAsync(2);
     }
     ~WithAsyncMethod_Fetch() override {
       BaseClassMustBeDerivedFromService(this);
@@ -224,10 +308,50 @@ public:
     void RequestFetch(::grpc::ServerContext* context, ::streamit::v1::FetchRequest* request,
                       ::grpc::ServerAsyncResponseWriter<::streamit::v1::FetchResponse>* response,
                       ::grpc::CompletionQueue* new_call_cq, ::grpc::ServerCompletionQueue* notification_cq, void* tag) {
-      ::grpc::Service::RequestAsyncUnary(1, context, request, response, new_call_cq, notification_cq, tag);
+      ::grpc::Service::RequestAsyncUnary(2, context, request, response, new_call_cq, notification_cq, tag);
+    }
+  };
+  typedef WithAsyncMethod_InitProducerId<WithAsyncMethod_Produce<WithAsyncMethod_Fetch<Service>>> AsyncService;
+  template <class BaseClass>
+  class WithCallbackMethod_InitProducerId : public BaseClass {
+  private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {
+    }
+
+  public:
+    WithCallbackMethod_InitProducerId() {
+      ::grpc::Service::MarkMethodCallback(
+          0, new ::grpc::internal::CallbackUnaryHandler<::streamit::v1::InitProducerIdRequest,
+                                                        ::streamit::v1::InitProducerIdResponse>(
+                 [this](::grpc::CallbackServerContext* context, const ::streamit::v1::InitProducerIdRequest* request,
+                        ::streamit::v1::InitProducerIdResponse* response) {
+                   return this->InitProducerId(context, request, response);
+                 }));
+    }
+    void SetMessageAllocatorFor_InitProducerId(
+        ::grpc::MessageAllocator<::streamit::v1::InitProducerIdRequest, ::streamit::v1::InitProducerIdResponse>*
+            allocator) {
+      ::grpc::internal::MethodHandler* const handler = ::grpc::Service::GetHandler(0);
+      static_cast<::grpc::internal::CallbackUnaryHandler<::streamit::v1::InitProducerIdRequest,
+                                                         ::streamit::v1::InitProducerIdResponse>*>(handler)
+          ->SetMessageAllocator(allocator);
+    }
+    ~WithCallbackMethod_InitProducerId() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable synchronous version of this method
+    ::grpc::Status InitProducerId(::grpc::ServerContext* /*context*/,
+                                  const ::streamit::v1::InitProducerIdRequest* /*request*/,
+                                  ::streamit::v1::InitProducerIdResponse* /*response*/) override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+    virtual ::grpc::ServerUnaryReactor* InitProducerId(::grpc::CallbackServerContext* /*context*/,
+                                                       const ::streamit::v1::InitProducerIdRequest* /*request*/,
+                                                       ::streamit::v1::InitProducerIdResponse* /*response*/) {
+      return nullptr;
     }
   };
-  typedef WithAsyncMethod_Produce<WithAsyncMethod_Fetch<Service>> AsyncService;
   template <class BaseClass>
   class WithCallbackMethod_Produce : public BaseClass {
   private:
@@ -237,14 +361,14 @@ public:
   public:
     WithCallbackMethod_Produce() {
       ::grpc::Service::MarkMethodCallback(
-          0,
+          1,
           new ::grpc::internal::CallbackUnaryHandler<::streamit::v1::ProduceRequest, ::streamit::v1::ProduceResponse>(
               [this](::grpc::CallbackServerContext* context, const ::streamit::v1::ProduceRequest* request,
                      ::streamit::v1::ProduceResponse* response) { return this->Produce(context, request, response); }));
     }
     void SetMessageAllocatorFor_Produce(
         ::grpc::MessageAllocator<::streamit::v1::ProduceRequest, ::streamit::v1::ProduceResponse>* allocator) {
-      ::grpc::internal::MethodHandler* const handler = ::grpc::Service::GetHandler(0);
+      ::grpc::internal::MethodHandler* const handler = ::grpc::Service::GetHandler(1);
       static_cast<
           ::grpc::internal::CallbackUnaryHandler<::streamit::v1::ProduceRequest, ::streamit::v1::ProduceResponse>*>(
           handler)
@@ -274,13 +398,13 @@ public:
   public:
     WithCallbackMethod_Fetch() {
       ::grpc::Service::MarkMethodCallback(
-          1, new ::grpc::internal::CallbackUnaryHandler<::streamit::v1::FetchRequest, ::streamit::v1::FetchResponse>(
+          2, new ::grpc::internal::CallbackUnaryHandler<::streamit::v1::FetchRequest, ::streamit::v1::FetchResponse>(
                  [this](::grpc::CallbackServerContext* context, const ::streamit::v1::FetchRequest* request,
                         ::streamit::v1::FetchResponse* response) { return this->Fetch(context, request, response); }));
     }
     void SetMessageAllocatorFor_Fetch(
         ::grpc::MessageAllocator<::streamit::v1::FetchRequest, ::streamit::v1::FetchResponse>* allocator) {
-      ::grpc::internal::MethodHandler* const handler = ::grpc::Service::GetHandler(1);
+      ::grpc::internal::MethodHandler* const handler = ::grpc::Service::GetHandler(2);
       static_cast<::grpc::internal::CallbackUnaryHandler<::streamit::v1::FetchRequest, ::streamit::v1::FetchResponse>*>(
           handler)
           ->SetMessageAllocator(allocator);
@@ -300,9 +424,31 @@ public:
       return nullptr;
     }
   };
-  typedef WithCallbackMethod_Produce<WithCallbackMethod_Fetch<Service>> CallbackService;
+  typedef WithCallbackMethod_InitProducerId<WithCallbackMethod_Produce<WithCallbackMethod_Fetch<Service>>>
+      CallbackService;
   typedef CallbackService ExperimentalCallbackService;
   template <class BaseClass>
+  class WithGenericMethod_InitProducerId : public BaseClass {
+  private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {
+    }
+
+  public:
+    WithGenericMethod_InitProducerId() {
+      ::grpc::Service::MarkMethodGeneric(0);
+    }
+    ~WithGenericMethod_InitProducerId() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable synchronous version of this method
+    ::grpc::Status InitProducerId(::grpc::ServerContext* /*context*/,
+                                  const ::streamit::v1::InitProducerIdRequest* /*request*/,
+                                  ::streamit::v1::InitProducerIdResponse* /*response*/) override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+  };
+  template <class BaseClass>
   class WithGenericMethod_Produce : public BaseClass {
   private:
     void BaseClassMustBeDerivedFromService(const Service* /*service*/) {
@@ -310,7 +456,7 @@ public:
 
   public:
     WithGenericMethod_Produce() {
-      ::grpc::Service::MarkMethodGeneric(0);
+      ::grpc::Service::MarkMethodGeneric(1);
     }
     ~WithGenericMethod_Produce() override {
       BaseClassMustBeDerivedFromService(this);
@@ -330,7 +476,7 @@ public:
 
   public:
     WithGenericMethod_Fetch() {
-      ::grpc::Service::MarkMethodGeneric(1);
+      ::grpc::Service::MarkMethodGeneric(2);
     }
     ~WithGenericMethod_Fetch() override {
       BaseClassMustBeDerivedFromService(this);
@@ -343,6 +489,33 @@ public:
     }
   };
   template <class BaseClass>
+  class WithRawMethod_InitProducerId : public BaseClass {
+  private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {
+    }
+
+  public:
+    WithRawMethod_InitProducerId() {
+      ::grpc::Service::MarkMethodRaw(0);
+    }
+    ~WithRawMethod_InitProducerId() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable synchronous version of this method
+    ::grpc::Status InitProducerId(::grpc::ServerContext* /*context*/,
+                                  const ::streamit::v1::InitProducerIdRequest* /*request*/,
+                                  ::streamit::v1::InitProducerIdResponse* /*response*/) override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+    void RequestInitProducerId(::grpc::ServerContext* context, ::grpc::ByteBuffer* request,
+                               ::grpc::ServerAsyncResponseWriter<::grpc::ByteBuffer>* response,
+                               ::grpc::CompletionQueue* new_call_cq, ::grpc::ServerCompletionQueue* notification_cq,
+                               void* tag) {
+      ::grpc::Service::RequestAsyncUnary(0, context, request, response, new_call_cq, notification_cq, tag);
+    }
+  };
+  template <class BaseClass>
   class WithRawMethod_Produce : public BaseClass {
   private:
     void BaseClassMustBeDerivedFromService(const Service* /*service*/) {
@@ -350,7 +523,7 @@ public:
 
   public:
     WithRawMethod_Produce() {
-      ::grpc::Service::MarkMethodRaw(0);
+      ::grpc::Service::MarkMethodRaw(1);
     }
     ~WithRawMethod_Produce() override {
       BaseClassMustBeDerivedFromService(this);
@@ -365,7 +538,7 @@ public:
                         ::grpc::ServerAsyncResponseWriter<::grpc::ByteBuffer>* response,
                         ::grpc::CompletionQueue* new_call_cq, ::grpc::ServerCompletionQueue* notification_cq,
                         void* tag) {
-      ::grpc::Service::RequestAsyncUnary(0, context, request, response, new_call_cq, notification_cq, tag);
+      ::grpc::Service::RequestAsyncUnary(1, context, request, response, new_call_cq, notification_cq, tag);
     }
   };
   template <class BaseClass>
@@ -376,7 +549,7 @@ public:
 
   public:
     WithRawMethod_Fetch() {
-      ::grpc::Service::MarkMethodRaw(1);
+      ::grpc::Service::MarkMethodRaw(2);
     }
     ~WithRawMethod_Fetch() override {
       BaseClassMustBeDerivedFromService(this);
@@ -390,7 +563,36 @@ public:
     void RequestFetch(::grpc::ServerContext* context, ::grpc::ByteBuffer* request,
                       ::grpc::ServerAsyncResponseWriter<::grpc::ByteBuffer>* response,
                       ::grpc::CompletionQueue* new_call_cq, ::grpc::ServerCompletionQueue* notification_cq, void* tag) {
-      ::grpc::Service::RequestAsyncUnary(1, context, request, response, new_call_cq, notification_cq, tag);
+      ::grpc::Service::RequestAsyncUnary(2, context, request, response, new_call_cq, notification_cq, tag);
+    }
+  };
+  template <class BaseClass>
+  class WithRawCallbackMethod_InitProducerId : public BaseClass {
+  private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {
+    }
+
+  public:
+    WithRawCallbackMethod_InitProducerId() {
+      ::grpc::Service::MarkMethodRawCallback(
+          0, new ::grpc::internal::CallbackUnaryHandler<::grpc::ByteBuffer, ::grpc::ByteBuffer>(
+                 [this](::grpc::CallbackServerContext* context, const ::grpc::ByteBuffer* request,
+                        ::grpc::ByteBuffer* response) { return this->InitProducerId(context, request, response); }));
+    }
+    ~WithRawCallbackMethod_InitProducerId() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable synchronous version of this method
+    ::grpc::Status InitProducerId(::grpc::ServerContext* /*context*/,
+                                  const ::streamit::v1::InitProducerIdRequest* /*request*/,
+                                  ::streamit::v1::InitProducerIdResponse* /*response*/) override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+    virtual ::grpc::ServerUnaryReactor* InitProducerId(::grpc::CallbackServerContext* /*context*/,
+                                                       const ::grpc::ByteBuffer* /*request*/,
+                                                       ::grpc::ByteBuffer* /*response*/) {
+      return nullptr;
     }
   };
   template <class BaseClass>
@@ -402,7 +604,7 @@ public:
   public:
     WithRawCallbackMethod_Produce() {
       ::grpc::Service::MarkMethodRawCallback(
-          0, new ::grpc::internal::CallbackUnaryHandler<::grpc::ByteBuffer, ::grpc::ByteBuffer>(
+          1, new ::grpc::internal::CallbackUnaryHandler<::grpc::ByteBuffer, ::grpc::ByteBuffer>(
                  [this](::grpc::CallbackServerContext* context, const ::grpc::ByteBuffer* request,
                         ::grpc::ByteBuffer* response) { return this->Produce(context, request, response); }));
     }
@@ -430,7 +632,7 @@ public:
   public:
     WithRawCallbackMethod_Fetch() {
       ::grpc::Service::MarkMethodRawCallback(
-          1, new ::grpc::internal::CallbackUnaryHandler<::grpc::ByteBuffer, ::grpc::ByteBuffer>(
+          2, new ::grpc::internal::CallbackUnaryHandler<::grpc::ByteBuffer, ::grpc::ByteBuffer>(
                  [this](::grpc::CallbackServerContext* context, const ::grpc::ByteBuffer* request,
                         ::grpc::ByteBuffer* response) { return this->Fetch(context, request, response); }));
     }
@@ -449,6 +651,39 @@ public:
     }
   };
   template <class BaseClass>
+  class WithStreamedUnaryMethod_InitProducerId : public BaseClass {
+  private:
+    void BaseClassMustBeDerivedFromService(const Service* /*service*/) {
+    }
+
+  public:
+    WithStreamedUnaryMethod_InitProducerId() {
+      ::grpc::Service::MarkMethodStreamed(
+          0, new ::grpc::internal::StreamedUnaryHandler<::streamit::v1::InitProducerIdRequest,
+                                                        ::streamit::v1::InitProducerIdResponse>(
+                 [this](::grpc::ServerContext* context,
+                        ::grpc::ServerUnaryStreamer<::streamit::v1::InitProducerIdRequest,
+                                                    ::streamit::v1::InitProducerIdResponse>* streamer) {
+                   return this->StreamedInitProducerId(context, streamer);
+                 }));
+    }
+    ~WithStreamedUnaryMethod_InitProducerId() override {
+      BaseClassMustBeDerivedFromService(this);
+    }
+    // disable regular version of this method
+    ::grpc::Status InitProducerId(::grpc::ServerContext* /*context*/,
+                                  const ::streamit::v1::InitProducerIdRequest* /*request*/,
+                                  ::streamit::v1::InitProducerIdResponse* /*response*/) override {
+      abort();
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "");
+    }
+    // replace default version of method with streamed unary
+    virtual ::grpc::Status StreamedInitProducerId(
+        ::grpc::ServerContext* context,
+        ::grpc::ServerUnaryStreamer<::streamit::v1::InitProducerIdRequest, ::streamit::v1::InitProducerIdResponse>*
+            server_unary_streamer) = 0;
+  };
+  template <class BaseClass>
   class WithStreamedUnaryMethod_Produce : public BaseClass {
   private:
     void BaseClassMustBeDerivedFromService(const Service* /*service*/) {
@@ -457,7 +692,7 @@ public:
   public:
     WithStreamedUnaryMethod_Produce() {
       ::grpc::Service::MarkMethodStreamed(
-          0,
+          1,
           new ::grpc::internal::StreamedUnaryHandler<::streamit::v1::ProduceRequest, ::streamit::v1::ProduceResponse>(
               [this](::grpc::ServerContext* context,
                      ::grpc::ServerUnaryStreamer<::streamit::v1::ProduceRequest, ::streamit::v1::ProduceResponse>*
@@ -487,7 +722,7 @@ public:
   public:
     WithStreamedUnaryMethod_Fetch() {
       ::grpc::Service::MarkMethodStreamed(
-          1,
+          2,
           new ::grpc::internal::StreamedUnaryHandler<::streamit::v1::FetchRequest, ::streamit::v1::FetchResponse>(
               [this](
                   ::grpc::ServerContext* context,
@@ -510,9 +745,13 @@ public:
         ::grpc::ServerUnaryStreamer<::streamit::v1::FetchRequest, ::streamit::v1::FetchResponse>*
             server_unary_streamer) = 0;
   };
-  typedef WithStreamedUnaryMethod_Produce<WithStreamedUnaryMethod_Fetch<Service>> StreamedUnaryService;
+  typedef WithStreamedUnaryMethod_InitProducerId<
+      WithStreamedUnaryMethod_Produce<WithStreamedUnaryMethod_Fetch<Service>>>
+      StreamedUnaryService;
   typedef Service SplitStreamedService;
-  typedef WithStreamedUnaryMethod_Produce<WithStreamedUnaryMethod_Fetch<Service>> StreamedService;
+  typedef WithStreamedUnaryMethod_InitProducerId<
+      WithStreamedUnaryMethod_Produce<WithStreamedUnaryMethod_Fetch<Service>>>
+      StreamedService;
 };
 
 class Coordinator final {
@@ -194,6 +194,55 @@ struct PartitionMetadataDefaultTypeInternal {
 PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 PartitionMetadataDefaultTypeInternal
     _PartitionMetadata_default_instance_;
 
+inline constexpr InitProducerIdResponse::Impl_::Impl_(::_pbi::ConstantInitialized) noexcept
+    : _cached_size_{0},
+      error_message_(&::google::protobuf::internal::fixed_address_empty_string, ::_pbi::ConstantInitialized()),
+      producer_id_{::int64_t{0}}, error_code_{static_cast<::streamit::v1::ErrorCode>(0)} {
+}
+
+template <typename>
+PROTOBUF_CONSTEXPR InitProducerIdResponse::InitProducerIdResponse(::_pbi::ConstantInitialized)
+#if defined(PROTOBUF_CUSTOM_VTABLE)
+    : ::google::protobuf::Message(InitProducerIdResponse_class_data_.base()),
+#else  // PROTOBUF_CUSTOM_VTABLE
+    : ::google::protobuf::Message(),
+#endif // PROTOBUF_CUSTOM_VTABLE
+      _impl_(::_pbi::ConstantInitialized()) {
+}
+struct InitProducerIdResponseDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR InitProducerIdResponseDefaultTypeInternal() : _instance(::_pbi::ConstantInitialized{}) {
+  }
+  ~InitProducerIdResponseDefaultTypeInternal() {
+  }
+  union {
+    InitProducerIdResponse _instance;
+  };
+};
+
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1
+    InitProducerIdResponseDefaultTypeInternal _InitProducerIdResponse_default_instance_;
+template <typename>
+PROTOBUF_CONSTEXPR InitProducerIdRequest::InitProducerIdRequest(::_pbi::ConstantInitialized)
+#if defined(PROTOBUF_CUSTOM_VTABLE)
+    : ::google::protobuf::internal::ZeroFieldsBase(InitProducerIdRequest_class_data_.base()) {
+}
+#else  // PROTOBUF_CUSTOM_VTABLE
+    : ::google::protobuf::internal::ZeroFieldsBase() {
+}
+#endif // PROTOBUF_CUSTOM_VTABLE
+struct InitProducerIdRequestDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR InitProducerIdRequestDefaultTypeInternal() : _instance(::_pbi::ConstantInitialized{}) {
+  }
+  ~InitProducerIdRequestDefaultTypeInternal() {
+  }
+  union {
+    InitProducerIdRequest _instance;
+  };
+};
+
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1
+    InitProducerIdRequestDefaultTypeInternal _InitProducerIdRequest_default_instance_;
+
 inline constexpr FindLeaderResponse::Impl_::Impl_(::_pbi::ConstantInitialized) noexcept
     : _cached_size_{0},
       leader_host_(&::google::protobuf::internal::fixed_address_empty_string, ::_pbi::ConstantInitialized()),
@@ -449,8 +498,7 @@ PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORIT
 inline constexpr ProduceRequest::Impl_::Impl_(::_pbi::ConstantInitialized) noexcept
     : _cached_size_{0}, records_{},
       topic_(&::google::protobuf::internal::fixed_address_empty_string, ::_pbi::ConstantInitialized()),
-      producer_id_(&::google::protobuf::internal::fixed_address_empty_string, ::_pbi::ConstantInitialized()),
-      partition_{0}, ack_{static_cast<::streamit::v1::Ack>(0)}, sequence_{::int64_t{0}} {
+      partition_{0}, ack_{static_cast<::streamit::v1::Ack>(0)}, sequence_{::int64_t{0}}, producer_id_{::int64_t{0}} {
 }
 
 template <typename>
@@ -583,6 +631,16 @@ const ::uint32_t TableStruct_proto_2fstreamit_2eproto::offsets[] ABSL_ATTRIBUTE_
     1,
     0,
     2,
+    0x000, // bitmap
+    0x081, // bitmap
+    PROTOBUF_FIELD_OFFSET(::streamit::v1::InitProducerIdResponse, _impl_._has_bits_),
+    6, // hasbit index offset
+    PROTOBUF_FIELD_OFFSET(::streamit::v1::InitProducerIdResponse, _impl_.producer_id_),
+    PROTOBUF_FIELD_OFFSET(::streamit::v1::InitProducerIdResponse, _impl_.error_code_),
+    PROTOBUF_FIELD_OFFSET(::streamit::v1::InitProducerIdResponse, _impl_.error_message_),
+    1,
+    2,
+    0,
     0x081, // bitmap
     PROTOBUF_FIELD_OFFSET(::streamit::v1::ProduceRequest, _impl_._has_bits_),
     9, // hasbit index offset
@@ -590,13 +648,13 @@ const ::uint32_t TableStruct_proto_2fstreamit_2eproto::offsets[] ABSL_ATTRIBUTE_
     PROTOBUF_FIELD_OFFSET(::streamit::v1::ProduceRequest, _impl_.partition_),
     PROTOBUF_FIELD_OFFSET(::streamit::v1::ProduceRequest, _impl_.records_),
     PROTOBUF_FIELD_OFFSET(::streamit::v1::ProduceRequest, _impl_.ack_),
-    PROTOBUF_FIELD_OFFSET(::streamit::v1::ProduceRequest, _impl_.producer_id_),
     PROTOBUF_FIELD_OFFSET(::streamit::v1::ProduceRequest, _impl_.sequence_),
+    PROTOBUF_FIELD_OFFSET(::streamit::v1::ProduceRequest, _impl_.producer_id_),
     0,
-    2,
+    1,
     ~0u,
+    2,
     3,
-    1,
     4,
     0x081, // bitmap
     PROTOBUF_FIELD_OFFSET(::streamit::v1::ProduceResponse, _impl_._has_bits_),
@@ -761,27 +819,31 @@ const ::uint32_t TableStruct_proto_2fstreamit_2eproto::offsets[] ABSL_ATTRIBUTE_
 static const ::_pbi::MigrationSchema schemas[] ABSL_ATTRIBUTE_SECTION_VARIABLE(protodesc_cold) = {
     {0, sizeof(::streamit::v1::Record)},
     {9, sizeof(::streamit::v1::RecordBatch)},
-    {18, sizeof(::streamit::v1::ProduceRequest)},
-    {33, sizeof(::streamit::v1::ProduceResponse)},
-    {46, sizeof(::streamit::v1::FetchRequest)},
-    {57, sizeof(::streamit::v1::FetchResponse)},
-    {72, sizeof(::streamit::v1::CommitOffsetRequest)},
-    {83, sizeof(::streamit::v1::CommitOffsetResponse)},
-    {90, sizeof(::streamit::v1::PollAssignmentRequest)},
-    {99, sizeof(::streamit::v1::PollAssignmentResponse_Assignment)},
-    {106, sizeof(::streamit::v1::PollAssignmentResponse)},
-    {117, sizeof(::streamit::v1::CreateTopicRequest)},
-    {126, sizeof(::streamit::v1::CreateTopicResponse)},
-    {135, sizeof(::streamit::v1::TopicMetadata)},
-    {146, sizeof(::streamit::v1::PartitionMetadata)},
-    {157, sizeof(::streamit::v1::DescribeTopicRequest)},
-    {162, sizeof(::streamit::v1::DescribeTopicResponse)},
-    {171, sizeof(::streamit::v1::FindLeaderRequest)},
-    {178, sizeof(::streamit::v1::FindLeaderResponse)},
+    {18, sizeof(::streamit::v1::InitProducerIdRequest)},
+    {19, sizeof(::streamit::v1::InitProducerIdResponse)},
+    {28, sizeof(::streamit::v1::ProduceRequest)},
+    {43, sizeof(::streamit::v1::ProduceResponse)},
+    {56, sizeof(::streamit::v1::FetchRequest)},
+    {67, sizeof(::streamit::v1::FetchResponse)},
+    {82, sizeof(::streamit::v1::CommitOffsetRequest)},
+    {93, sizeof(::streamit::v1::CommitOffsetResponse)},
+    {100, sizeof(::streamit::v1::PollAssignmentRequest)},
+    {109, sizeof(::streamit::v1::PollAssignmentResponse_Assignment)},
+    {116, sizeof(::streamit::v1::PollAssignmentResponse)},
+    {127, sizeof(::streamit::v1::CreateTopicRequest)},
+    {136, sizeof(::streamit::v1::CreateTopicResponse)},
+    {145, sizeof(::streamit::v1::TopicMetadata)},
+    {156, sizeof(::streamit::v1::PartitionMetadata)},
+    {167, sizeof(::streamit::v1::DescribeTopicRequest)},
+    {172, sizeof(::streamit::v1::DescribeTopicResponse)},
+    {181, sizeof(::streamit::v1::FindLeaderRequest)},
+    {188, sizeof(::streamit::v1::FindLeaderResponse)},
 };
 static const ::_pb::Message* PROTOBUF_NONNULL const file_default_instances[] = {
     &::streamit::v1::_Record_default_instance_._instance,
     &::streamit::v1::_RecordBatch_default_instance_._instance,
+    &::streamit::v1::_InitProducerIdRequest_default_instance_._instance,
+    &::streamit::v1::_InitProducerIdResponse_default_instance_._instance,
     &::streamit::v1::_ProduceRequest_default_instance_._instance,
     &::streamit::v1::_ProduceResponse_default_instance_._instance,
     &::streamit::v1::_FetchRequest_default_instance_._instance,
@@ -805,92 +867,98 @@ const char descriptor_table_protodef_proto_2fstreamit_2eproto[] ABSL_ATTRIBUTE_S
     "ecord\022\013\n\003key\030\001 \001(\014\022\r\n\005value\030\002 \001(\014\022\024\n\014tim"
     "estamp_ms\030\003 \001(\003\"B\n\013RecordBatch\022\023\n\013base_o"
     "ffset\030\001 \001(\003\022\017\n\007payload\030\002 \001(\014\022\r\n\005crc32\030\003 "
-    "\001(\r\"\236\001\n\016ProduceRequest\022\r\n\005topic\030\001 \001(\t\022\021\n"
-    "\tpartition\030\002 \001(\005\022$\n\007records\030\003 \003(\0132\023.stre"
-    "amit.v1.Record\022\035\n\003ack\030\004 \001(\0162\020.streamit.v"
-    "1.Ack\022\023\n\013producer_id\030\005 \001(\t\022\020\n\010sequence\030\006"
-    " \001(\003\"\226\001\n\017ProduceResponse\022\023\n\013base_offset\030"
-    "\001 \001(\003\022*\n\nerror_code\030\002 \001(\0162\026.streamit.v1."
-    "ErrorCode\022\025\n\rerror_message\030\003 \001(\t\022\026\n\016retr"
-    "y_after_ms\030\004 \001(\005\022\023\n\013leader_hint\030\005 \001(\t\"S\n"
-    "\014FetchRequest\022\r\n\005topic\030\001 \001(\t\022\021\n\tpartitio"
-    "n\030\002 \001(\005\022\016\n\006offset\030\003 \001(\003\022\021\n\tmax_bytes\030\004 \001"
-    "(\005\"\302\001\n\rFetchResponse\022\026\n\016high_watermark\030\001"
-    " \001(\003\022)\n\007batches\030\002 \003(\0132\030.streamit.v1.Reco"
-    "rdBatch\022*\n\nerror_code\030\003 \001(\0162\026.streamit.v"
-    "1.ErrorCode\022\025\n\rerror_message\030\004 \001(\t\022\026\n\016re"
-    "try_after_ms\030\005 \001(\005\022\023\n\013leader_hint\030\006 \001(\t\""
-    "V\n\023CommitOffsetRequest\022\r\n\005group\030\001 \001(\t\022\r\n"
-    "\005topic\030\002 \001(\t\022\021\n\tpartition\030\003 \001(\005\022\016\n\006offse"
-    "t\030\004 \001(\003\"Y\n\024CommitOffsetResponse\022*\n\nerror"
-    "_code\030\001 \001(\0162\026.streamit.v1.ErrorCode\022\025\n\re"
-    "rror_message\030\002 \001(\t\"I\n\025PollAssignmentRequ"
-    "est\022\r\n\005group\030\001 \001(\t\022\021\n\tmember_id\030\002 \001(\t\022\016\n"
-    "\006topics\030\003 \003(\t\"\360\001\n\026PollAssignmentResponse"
-    "\022C\n\013assignments\030\001 \003(\0132..streamit.v1.Poll"
-    "AssignmentResponse.Assignment\022\035\n\025heartbe"
-    "at_interval_ms\030\002 \001(\005\022*\n\nerror_code\030\003 \001(\016"
-    "2\026.streamit.v1.ErrorCode\022\025\n\rerror_messag"
-    "e\030\004 \001(\t\032/\n\nAssignment\022\r\n\005topic\030\001 \001(\t\022\022\n\n"
-    "partitions\030\002 \003(\005\"S\n\022CreateTopicRequest\022\r"
-    "\n\005topic\030\001 \001(\t\022\022\n\npartitions\030\002 \001(\005\022\032\n\022rep"
-    "lication_factor\030\003 \001(\005\"i\n\023CreateTopicResp"
-    "onse\022\017\n\007success\030\001 \001(\010\022\025\n\rerror_message\030\002"
-    " \001(\t\022*\n\nerror_code\030\003 \001(\0162\026.streamit.v1.E"
-    "rrorCode\"\212\001\n\rTopicMetadata\022\r\n\005topic\030\001 \001("
-    "\t\022\022\n\npartitions\030\002 \001(\005\022\032\n\022replication_fac"
-    "tor\030\003 \001(\005\022:\n\022partition_metadata\030\004 \003(\0132\036."
-    "streamit.v1.PartitionMetadata\"U\n\021Partiti"
-    "onMetadata\022\021\n\tpartition\030\001 \001(\005\022\016\n\006leader\030"
-    "\002 \001(\005\022\020\n\010replicas\030\003 \003(\005\022\013\n\003isr\030\004 \003(\005\"%\n\024"
-    "DescribeTopicRequest\022\r\n\005topic\030\001 \001(\t\"\210\001\n\025"
-    "DescribeTopicResponse\022,\n\010metadata\030\001 \001(\0132"
-    "\032.streamit.v1.TopicMetadata\022*\n\nerror_cod"
-    "e\030\002 \001(\0162\026.streamit.v1.ErrorCode\022\025\n\rerror"
-    "_message\030\003 \001(\t\"5\n\021FindLeaderRequest\022\r\n\005t"
-    "opic\030\001 \001(\t\022\021\n\tpartition\030\002 \001(\005\"\233\001\n\022FindLe"
-    "aderResponse\022\030\n\020leader_broker_id\030\001 \001(\005\022\023"
-    "\n\013leader_host\030\002 \001(\t\022\023\n\013leader_port\030\003 \001(\005"
-    "\022*\n\nerror_code\030\004 \001(\0162\026.streamit.v1.Error"
-    "Code\022\025\n\rerror_message\030\005 \001(\t*%\n\003Ack\022\016\n\nAC"
-    "K_LEADER\020\000\022\016\n\nACK_QUORUM\020\001*\221\003\n\tErrorCode"
-    "\022\006\n\002OK\020\000\022\r\n\tTHROTTLED\020\001\022\016\n\nNOT_LEADER\020\002\022"
-    "\021\n\rUNKNOWN_TOPIC\020\003\022\027\n\023OFFSET_OUT_OF_RANG"
-    "E\020\004\022\025\n\021IDEMPOTENT_REPLAY\020\005\022\014\n\010INTERNAL\020\006"
-    "\022\024\n\020INVALID_ARGUMENT\020\007\022\r\n\tNOT_FOUND\020\010\022\022\n"
-    "\016ALREADY_EXISTS\020\t\022\025\n\021PERMISSION_DENIED\020\n"
-    "\022\026\n\022RESOURCE_EXHAUSTED\020\013\022\027\n\023FAILED_PRECO"
-    "NDITION\020\014\022\020\n\014OUT_OF_RANGE\020\r\022\021\n\rUNIMPLEME"
-    "NTED\020\016\022\017\n\013UNAVAILABLE\020\017\022\r\n\tDATA_LOSS\020\020\022\023"
-    "\n\017UNAUTHENTICATED\020\021\022\025\n\021DEADLINE_EXCEEDED"
-    "\020\022\022\r\n\tCANCELLED\020\023\022\013\n\007UNKNOWN\020\0242\216\001\n\006Broke"
-    "r\022D\n\007Produce\022\033.streamit.v1.ProduceReques"
-    "t\032\034.streamit.v1.ProduceResponse\022>\n\005Fetch"
-    "\022\031.streamit.v1.FetchRequest\032\032.streamit.v"
-    "1.FetchResponse2\275\001\n\013Coordinator\022S\n\014Commi"
-    "tOffset\022 .streamit.v1.CommitOffsetReques"
-    "t\032!.streamit.v1.CommitOffsetResponse\022Y\n\016"
-    "PollAssignment\022\".streamit.v1.PollAssignm"
-    "entRequest\032#.streamit.v1.PollAssignmentR"
-    "esponse2\205\002\n\nController\022P\n\013CreateTopic\022\037."
-    "streamit.v1.CreateTopicRequest\032 .streami"
-    "t.v1.CreateTopicResponse\022V\n\rDescribeTopi"
-    "c\022!.streamit.v1.DescribeTopicRequest\032\".s"
-    "treamit.v1.DescribeTopicResponse\022M\n\nFind"
-    "Leader\022\036.streamit.v1.FindLeaderRequest\032\037"
-    ".streamit.v1.FindLeaderResponseB\'Z%githu"
-    "b.com/streamit/proto/streamit/v1b\006proto3"};
+    "\001(\r\"\027\n\025InitProducerIdRequest\"p\n\026InitProd"
+    "ucerIdResponse\022\023\n\013producer_id\030\001 \001(\003\022*\n\ne"
+    "rror_code\030\002 \001(\0162\026.streamit.v1.ErrorCode\022"
+    "\025\n\rerror_message\030\003 \001(\t\"\244\001\n\016ProduceReques"
+    "t\022\r\n\005topic\030\001 \001(\t\022\021\n\tpartition\030\002 \001(\005\022$\n\007r"
+    "ecords\030\003 \003(\0132\023.streamit.v1.Record\022\035\n\003ack"
+    "\030\004 \001(\0162\020.streamit.v1.Ack\022\020\n\010sequence\030\006 \001"
+    "(\003\022\023\n\013producer_id\030\007 \001(\003J\004\010\005\020\006\"\226\001\n\017Produc"
+    "eResponse\022\023\n\013base_offset\030\001 \001(\003\022*\n\nerror_"
+    "code\030\002 \001(\0162\026.streamit.v1.ErrorCode\022\025\n\rer"
+    "ror_message\030\003 \001(\t\022\026\n\016retry_after_ms\030\004 \001("
+    "\005\022\023\n\013leader_hint\030\005 \001(\t\"S\n\014FetchRequest\022\r"
+    "\n\005topic\030\001 \001(\t\022\021\n\tpartition\030\002 \001(\005\022\016\n\006offs"
+    "et\030\003 \001(\003\022\021\n\tmax_bytes\030\004 \001(\005\"\302\001\n\rFetchRes"
+    "ponse\022\026\n\016high_watermark\030\001 \001(\003\022)\n\007batches"
+    "\030\002 \003(\0132\030.streamit.v1.RecordBatch\022*\n\nerro"
+    "r_code\030\003 \001(\0162\026.streamit.v1.ErrorCode\022\025\n\r"
+    "error_message\030\004 \001(\t\022\026\n\016retry_after_ms\030\005 "
+    "\001(\005\022\023\n\013leader_hint\030\006 \001(\t\"V\n\023CommitOffset"
+    "Request\022\r\n\005group\030\001 \001(\t\022\r\n\005topic\030\002 \001(\t\022\021\n"
+    "\tpartition\030\003 \001(\005\022\016\n\006offset\030\004 \001(\003\"Y\n\024Comm"
+    "itOffsetResponse\022*\n\nerror_code\030\001 \001(\0162\026.s"
+    "treamit.v1.ErrorCode\022\025\n\rerror_message\030\002 "
+    "\001(\t\"I\n\025PollAssignmentRequest\022\r\n\005group\030\001 "
+    "\001(\t\022\021\n\tmember_id\030\002 \001(\t\022\016\n\006topics\030\003 \003(\t\"\360"
+    "\001\n\026PollAssignmentResponse\022C\n\013assignments"
+    "\030\001 \003(\0132..streamit.v1.PollAssignmentRespo"
+    "nse.Assignment\022\035\n\025heartbeat_interval_ms\030"
+    "\002 \001(\005\022*\n\nerror_code\030\003 \001(\0162\026.streamit.v1."
+    "ErrorCode\022\025\n\rerror_message\030\004 \001(\t\032/\n\nAssi"
+    "gnment\022\r\n\005topic\030\001 \001(\t\022\022\n\npartitions\030\002 \003("
+    "\005\"S\n\022CreateTopicRequest\022\r\n\005topic\030\001 \001(\t\022\022"
+    "\n\npartitions\030\002 \001(\005\022\032\n\022replication_factor"
+    "\030\003 \001(\005\"i\n\023CreateTopicResponse\022\017\n\007success"
+    "\030\001 \001(\010\022\025\n\rerror_message\030\002 \001(\t\022*\n\nerror_c"
+    "ode\030\003 \001(\0162\026.streamit.v1.ErrorCode\"\212\001\n\rTo"
+    "picMetadata\022\r\n\005topic\030\001 \001(\t\022\022\n\npartitions"
+    "\030\002 \001(\005\022\032\n\022replication_factor\030\003 \001(\005\022:\n\022pa"
+    "rtition_metadata\030\004 \003(\0132\036.streamit.v1.Par"
+    "titionMetadata\"U\n\021PartitionMetadata\022\021\n\tp"
+    "artition\030\001 \001(\005\022\016\n\006leader\030\002 \001(\005\022\020\n\010replic"
+    "as\030\003 \003(\005\022\013\n\003isr\030\004 \003(\005\"%\n\024DescribeTopicRe"
+    "quest\022\r\n\005topic\030\001 \001(\t\"\210\001\n\025DescribeTopicRe"
+    "sponse\022,\n\010metadata\030\001 \001(\0132\032.streamit.v1.T"
+    "opicMetadata\022*\n\nerror_code\030\002 \001(\0162\026.strea"
+    "mit.v1.ErrorCode\022\025\n\rerror_message\030\003 \001(\t\""
+    "5\n\021FindLeaderRequest\022\r\n\005topic\030\001 \001(\t\022\021\n\tp"
+    "artition\030\002 \001(\005\"\233\001\n\022FindLeaderResponse\022\030\n"
+    "\020leader_broker_id\030\001 \001(\005\022\023\n\013leader_host\030\002"
+    " \001(\t\022\023\n\013leader_port\030\003 \001(\005\022*\n\nerror_code\030"
+    "\004 \001(\0162\026.streamit.v1.ErrorCode\022\025\n\rerror_m"
+    "essage\030\005 \001(\t*%\n\003Ack\022\016\n\nACK_LEADER\020\000\022\016\n\nA"
+    "CK_QUORUM\020\001*\221\003\n\tErrorCode\022\006\n\002OK\020\000\022\r\n\tTHR"
+    "OTTLED\020\001\022\016\n\nNOT_LEADER\020\002\022\021\n\rUNKNOWN_TOPI"
+    "C\020\003\022\027\n\023OFFSET_OUT_OF_RANGE\020\004\022\025\n\021IDEMPOTE"
+    "NT_REPLAY\020\005\022\014\n\010INTERNAL\020\006\022\024\n\020INVALID_ARG"
+    "UMENT\020\007\022\r\n\tNOT_FOUND\020\010\022\022\n\016ALREADY_EXISTS"
+    "\020\t\022\025\n\021PERMISSION_DENIED\020\n\022\026\n\022RESOURCE_EX"
+    "HAUSTED\020\013\022\027\n\023FAILED_PRECONDITION\020\014\022\020\n\014OU"
+    "T_OF_RANGE\020\r\022\021\n\rUNIMPLEMENTED\020\016\022\017\n\013UNAVA"
+    "ILABLE\020\017\022\r\n\tDATA_LOSS\020\020\022\023\n\017UNAUTHENTICAT"
+    "ED\020\021\022\025\n\021DEADLINE_EXCEEDED\020\022\022\r\n\tCANCELLED"
+    "\020\023\022\013\n\007UNKNOWN\020\0242\351\001\n\006Broker\022Y\n\016InitProduc"
+    "erId\022\".streamit.v1.InitProducerIdRequest"
+    "\032#.streamit.v1.InitProducerIdResponse\022D\n"
+    "\007Produce\022\033.streamit.v1.ProduceRequest\032\034."
+    "streamit.v1.ProduceResponse\022>\n\005Fetch\022\031.s"
+    "treamit.v1.FetchRequest\032\032.streamit.v1.Fe"
+    "tchResponse2\275\001\n\013Coordinator\022S\n\014CommitOff"
+    "set\022 .streamit.v1.CommitOffsetRequest\032!."
+    "streamit.v1.CommitOffsetResponse\022Y\n\016Poll"
+    "Assignment\022\".streamit.v1.PollAssignmentR"
+    "equest\032#.streamit.v1.PollAssignmentRespo"
+    "nse2\205\002\n\nController\022P\n\013CreateTopic\022\037.stre"
+    "amit.v1.CreateTopicRequest\032 .streamit.v1"
+    ".CreateTopicResponse\022V\n\rDescribeTopic\022!."
+    "streamit.v1.DescribeTopicRequest\032\".strea"
+    "mit.v1.DescribeTopicResponse\022M\n\nFindLead"
+    "er\022\036.streamit.v1.FindLeaderRequest\032\037.str"
+    "eamit.v1.FindLeaderResponseB\'Z%github.co"
+    "m/streamit/proto/streamit/v1b\006proto3"};
 static ::absl::once_flag descriptor_table_proto_2fstreamit_2eproto_once;
 PROTOBUF_CONSTINIT const ::_pbi::DescriptorTable descriptor_table_proto_2fstreamit_2eproto = {
     false,
     false,
-    3160,
+    3396,
     descriptor_table_protodef_proto_2fstreamit_2eproto,
     "proto/streamit.proto",
     &descriptor_table_proto_2fstreamit_2eproto_once,
     nullptr,
     0,
-    19,
+    21,
     schemas,
     file_default_instances,
     TableStruct_proto_2fstreamit_2eproto::offsets,
@@ -1561,6 +1629,441 @@ void RecordBatch::InternalSwap(RecordBatch* PROTOBUF_RESTRICT PROTOBUF_NONNULL o
 }
 // ===================================================================
 
+class InitProducerIdRequest::_Internal {
+public:
+};
+
+InitProducerIdRequest::InitProducerIdRequest(::google::protobuf::Arena* PROTOBUF_NULLABLE arena)
+#if defined(PROTOBUF_CUSTOM_VTABLE)
+    : ::google::protobuf::internal::ZeroFieldsBase(arena, InitProducerIdRequest_class_data_.base()) {
+#else  // PROTOBUF_CUSTOM_VTABLE
+    : ::google::protobuf::internal::ZeroFieldsBase(arena) {
+#endif // PROTOBUF_CUSTOM_VTABLE
+  // @@protoc_insertion_point(arena_constructor:streamit.v1.InitProducerIdRequest)
+}
+InitProducerIdRequest::InitProducerIdRequest(::google::protobuf::Arena* PROTOBUF_NULLABLE arena,
+                                             const InitProducerIdRequest& from)
+#if defined(PROTOBUF_CUSTOM_VTABLE)
+    : ::google::protobuf::internal::ZeroFieldsBase(arena, InitProducerIdRequest_class_data_.base()) {
+#else  // PROTOBUF_CUSTOM_VTABLE
+    : ::google::protobuf::internal::ZeroFieldsBase(arena) {
+#endif // PROTOBUF_CUSTOM_VTABLE
+  InitProducerIdRequest* const _this = this;
+  (void)_this;
+  _internal_metadata_.MergeFrom<::google::protobuf::UnknownFieldSet>(from._internal_metadata_);
+
+  // @@protoc_insertion_point(copy_constructor:streamit.v1.InitProducerIdRequest)
+}
+
+inline void* PROTOBUF_NONNULL InitProducerIdRequest::PlacementNew_(
+    const void* PROTOBUF_NONNULL, void* PROTOBUF_NONNULL mem, ::google::protobuf::Arena* PROTOBUF_NULLABLE arena) {
+  return ::new (mem) InitProducerIdRequest(arena);
+}
+constexpr auto InitProducerIdRequest::InternalNewImpl_() {
+  return ::google::protobuf::internal::MessageCreator::ZeroInit(sizeof(InitProducerIdRequest),
+                                                                alignof(InitProducerIdRequest));
+}
+constexpr auto InitProducerIdRequest::InternalGenerateClassData_() {
+  return ::google::protobuf::internal::ClassDataFull{
+      ::google::protobuf::internal::ClassData{
+          &_InitProducerIdRequest_default_instance_._instance,
+          &_table_.header,
+          nullptr, // OnDemandRegisterArenaDtor
+          nullptr, // IsInitialized
+          &InitProducerIdRequest::MergeImpl,
+          ::google::protobuf::internal::ZeroFieldsBase::GetNewImpl<InitProducerIdRequest>(),
+#if defined(PROTOBUF_CUSTOM_VTABLE)
+          &InitProducerIdRequest::SharedDtor,
+          ::google::protobuf::internal::ZeroFieldsBase::GetClearImpl<InitProducerIdRequest>(),
+          &InitProducerIdRequest::ByteSizeLong,
+          &InitProducerIdRequest::_InternalSerialize,
+#endif // PROTOBUF_CUSTOM_VTABLE
+          PROTOBUF_FIELD_OFFSET(InitProducerIdRequest, _impl_._cached_size_),
+          false,
+      },
+      &InitProducerIdRequest::kDescriptorMethods,
+      &descriptor_table_proto_2fstreamit_2eproto,
+      nullptr, // tracker
+  };
+}
+
+PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 const ::google::protobuf::internal::ClassDataFull
+    InitProducerIdRequest_class_data_ = InitProducerIdRequest::InternalGenerateClassData_();
+
+PROTOBUF_ATTRIBUTE_WEAK const ::google::protobuf::internal::ClassData* PROTOBUF_NONNULL
+InitProducerIdRequest::GetClassData() const {
+  ::google::protobuf::internal::PrefetchToLocalCache(&InitProducerIdRequest_class_data_);
+  ::google::protobuf::internal::PrefetchToLocalCache(InitProducerIdRequest_class_data_.tc_table);
+  return InitProducerIdRequest_class_data_.base();
+}
+PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 const ::_pbi::TcParseTable<0, 0, 0, 0, 2>
+    InitProducerIdRequest::_table_ = {
+        {
+            0, // no _has_bits_
+            0, // no _extensions_
+            0,
+            0, // max_field_number, fast_idx_mask
+            offsetof(decltype(_table_), field_lookup_table),
+            4294967295, // skipmap
+            offsetof(decltype(_table_), field_names), // no field_entries
+            0,                                        // num_field_entries
+            0,                                        // num_aux_entries
+            offsetof(decltype(_table_), field_names), // no aux_entries
+            InitProducerIdRequest_class_data_.base(),
+            nullptr,                           // post_loop_handler
+            ::_pbi::TcParser::GenericFallback, // fallback
+#ifdef PROTOBUF_PREFETCH_PARSE_TABLE
+            ::_pbi::TcParser::GetTable<::streamit::v1::InitProducerIdRequest>(), // to_prefetch
+#endif                                                                           // PROTOBUF_PREFETCH_PARSE_TABLE
+        },
+        {{
+            {::_pbi::TcParser::MiniParse, {}},
+        }},
+        {{65535, 65535}},
+        // no field_entries, or aux_entries
+        {{}},
+    };
+
+::google::protobuf::Metadata InitProducerIdRequest::GetMetadata() const {
+  return ::google::protobuf::Message::GetMetadataImpl(GetClassData()->full());
+}
+// ===================================================================
+
+class InitProducerIdResponse::_Internal {
+public:
+  using HasBits = decltype(::std::declval<InitProducerIdResponse>()._impl_._has_bits_);
+  static constexpr ::int32_t kHasBitsOffset = 8 * PROTOBUF_FIELD_OFFSET(InitProducerIdResponse, _impl_._has_bits_);
+};
+
+InitProducerIdResponse::InitProducerIdResponse(::google::protobuf::Arena* PROTOBUF_NULLABLE arena)
+#if defined(PROTOBUF_CUSTOM_VTABLE)
+    : ::google::protobuf::Message(arena, InitProducerIdResponse_class_data_.base()) {
+#else  // PROTOBUF_CUSTOM_VTABLE
+    : ::google::protobuf::Message(arena) {
+#endif // PROTOBUF_CUSTOM_VTABLE
+  SharedCtor(arena);
+  // @@protoc_insertion_point(arena_constructor:streamit.v1.InitProducerIdResponse)
+}
+PROTOBUF_NDEBUG_INLINE InitProducerIdResponse::Impl_::Impl_(
+    [[maybe_unused]] ::google::protobuf::internal::InternalVisibility visibility,
+    [[maybe_unused]] ::google::protobuf::Arena* PROTOBUF_NULLABLE arena, const Impl_& from,
+    [[maybe_unused]] const ::streamit::v1::InitProducerIdResponse& from_msg)
+    : _has_bits_{from._has_bits_}, _cached_size_{0}, error_message_(arena, from.error_message_) {
+}
+
+InitProducerIdResponse::InitProducerIdResponse(::google::protobuf::Arena* PROTOBUF_NULLABLE arena,
+                                               const InitProducerIdResponse& from)
+#if defined(PROTOBUF_CUSTOM_VTABLE)
+    : ::google::protobuf::Message(arena, InitProducerIdResponse_class_data_.base()) {
+#else  // PROTOBUF_CUSTOM_VTABLE
+    : ::google::protobuf::Message(arena) {
+#endif // PROTOBUF_CUSTOM_VTABLE
+  InitProducerIdResponse* const _this = this;
+  (void)_this;
+  _internal_metadata_.MergeFrom<::google::protobuf::UnknownFieldSet>(from._internal_metadata_);
+  new (&_impl_) Impl_(internal_visibility(), arena, from._impl_, from);
+  ::memcpy(reinterpret_cast<char*>(&_impl_) + offsetof(Impl_, producer_id_),
+           reinterpret_cast<const char*>(&from._impl_) + offsetof(Impl_, producer_id_),
+           offsetof(Impl_, error_code_) - offsetof(Impl_, producer_id_) + sizeof(Impl_::error_code_));
+
+  // @@protoc_insertion_point(copy_constructor:streamit.v1.InitProducerIdResponse)
+}
+PROTOBUF_NDEBUG_INLINE InitProducerIdResponse::Impl_::Impl_(
+    [[maybe_unused]] ::google::protobuf::internal::InternalVisibility visibility,
+    [[maybe_unused]] ::google::protobuf::Arena* PROTOBUF_NULLABLE arena)
+    : _cached_size_{0}, error_message_(arena) {
+}
+
+inline void InitProducerIdResponse::SharedCtor(::_pb::Arena* PROTOBUF_NULLABLE arena) {
+  new (&_impl_) Impl_(internal_visibility(), arena);
+  ::memset(reinterpret_cast<char*>(&_impl_) + offsetof(Impl_, producer_id_), 0,
+           offsetof(Impl_, error_code_) - offsetof(Impl_, producer_id_) + sizeof(Impl_::error_code_));
+}
+InitProducerIdResponse::~InitProducerIdResponse() {
+  // @@protoc_insertion_point(destructor:streamit.v1.InitProducerIdResponse)
+  SharedDtor(*this);
+}
+inline void InitProducerIdResponse::SharedDtor(MessageLite& self) {
+  InitProducerIdResponse& this_ = static_cast<InitProducerIdResponse&>(self);
+  if constexpr (::_pbi::DebugHardenVerifyHasBitConsistency()) {
+    this_.VerifyHasBitConsistency();
+  }
+  this_._internal_metadata_.Delete<::google::protobuf::UnknownFieldSet>();
+  ABSL_DCHECK(this_.GetArena() == nullptr);
+  this_._impl_.error_message_.Destroy();
+  this_._impl_.~Impl_();
+}
+
+inline void* PROTOBUF_NONNULL InitProducerIdResponse::PlacementNew_(
+    const void* PROTOBUF_NONNULL, void* PROTOBUF_NONNULL mem, ::google::protobuf::Arena* PROTOBUF_NULLABLE arena) {
+  return ::new (mem) InitProducerIdResponse(arena);
+}
+constexpr auto InitProducerIdResponse::InternalNewImpl_() {
+  return ::google::protobuf::internal::MessageCreator::CopyInit(sizeof(InitProducerIdResponse),
+                                                                alignof(InitProducerIdResponse));
+}
+constexpr auto InitProducerIdResponse::InternalGenerateClassData_() {
+  return ::google::protobuf::internal::ClassDataFull{
+      ::google::protobuf::internal::ClassData{
+          &_InitProducerIdResponse_default_instance_._instance,
+          &_table_.header,
+          nullptr, // OnDemandRegisterArenaDtor
+          nullptr, // IsInitialized
+          &InitProducerIdResponse::MergeImpl,
+          ::google::protobuf::Message::GetNewImpl<InitProducerIdResponse>(),
+#if defined(PROTOBUF_CUSTOM_VTABLE)
+          &InitProducerIdResponse::SharedDtor,
+          ::google::protobuf::Message::GetClearImpl<InitProducerIdResponse>(),
+          &InitProducerIdResponse::ByteSizeLong,
+          &InitProducerIdResponse::_InternalSerialize,
+#endif // PROTOBUF_CUSTOM_VTABLE
+          PROTOBUF_FIELD_OFFSET(InitProducerIdResponse, _impl_._cached_size_),
+          false,
+      },
+      &InitProducerIdResponse::kDescriptorMethods,
+      &descriptor_table_proto_2fstreamit_2eproto,
+      nullptr, // tracker
+  };
+}
+
+PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 const ::google::protobuf::internal::ClassDataFull
+    InitProducerIdResponse_class_data_ = InitProducerIdResponse::InternalGenerateClassData_();
+
+PROTOBUF_ATTRIBUTE_WEAK const ::google::protobuf::internal::ClassData* PROTOBUF_NONNULL
+InitProducerIdResponse::GetClassData() const {
+  ::google::protobuf::internal::PrefetchToLocalCache(&InitProducerIdResponse_class_data_);
+  ::google::protobuf::internal::PrefetchToLocalCache(InitProducerIdResponse_class_data_.tc_table);
+  return InitProducerIdResponse_class_data_.base();
+}
+PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 const ::_pbi::TcParseTable<2, 3, 0, 56, 2>
+    InitProducerIdResponse::_table_ = {
+        {
+            PROTOBUF_FIELD_OFFSET(InitProducerIdResponse, _impl_._has_bits_),
+            0, // no _extensions_
+            3,
+            24, // max_field_number, fast_idx_mask
+            offsetof(decltype(_table_), field_lookup_table),
+            4294967288, // skipmap
+            offsetof(decltype(_table_), field_entries),
+            3,                                        // num_field_entries
+            0,                                        // num_aux_entries
+            offsetof(decltype(_table_), field_names), // no aux_entries
+            InitProducerIdResponse_class_data_.base(),
+            nullptr,                           // post_loop_handler
+            ::_pbi::TcParser::GenericFallback, // fallback
+#ifdef PROTOBUF_PREFETCH_PARSE_TABLE
+            ::_pbi::TcParser::GetTable<::streamit::v1::InitProducerIdResponse>(), // to_prefetch
+#endif                                                                            // PROTOBUF_PREFETCH_PARSE_TABLE
+        },
+        {{
+            {::_pbi::TcParser::MiniParse, {}},
+            // int64 producer_id = 1;
+            {::_pbi::TcParser::SingularVarintNoZag1<::uint64_t, offsetof(InitProducerIdResponse, _impl_.producer_id_),
+                                                    1>(),
+             {8, 1, 0, PROTOBUF_FIELD_OFFSET(InitProducerIdResponse, _impl_.producer_id_)}},
+            // .streamit.v1.ErrorCode error_code = 2;
+            {::_pbi::TcParser::SingularVarintNoZag1<::uint32_t, offsetof(InitProducerIdResponse, _impl_.error_code_),
+                                                    2>(),
+             {16, 2, 0, PROTOBUF_FIELD_OFFSET(InitProducerIdResponse, _impl_.error_code_)}},
+            // string error_message = 3;
+            {::_pbi::TcParser::FastUS1,
+             {26, 0, 0, PROTOBUF_FIELD_OFFSET(InitProducerIdResponse, _impl_.error_message_)}},
+        }},
+        {{65535, 65535}},
+        {{
+            // int64 producer_id = 1;
+            {PROTOBUF_FIELD_OFFSET(InitProducerIdResponse, _impl_.producer_id_), _Internal::kHasBitsOffset + 1, 0,
+             (0 | ::_fl::kFcOptional | ::_fl::kInt64)},
+            // .streamit.v1.ErrorCode error_code = 2;
+            {PROTOBUF_FIELD_OFFSET(InitProducerIdResponse, _impl_.error_code_), _Internal::kHasBitsOffset + 2, 0,
+             (0 | ::_fl::kFcOptional | ::_fl::kOpenEnum)},
+            // string error_message = 3;
+            {PROTOBUF_FIELD_OFFSET(InitProducerIdResponse, _impl_.error_message_), _Internal::kHasBitsOffset + 0, 0,
+             (0 | ::_fl::kFcOptional | ::_fl::kUtf8String | ::_fl::kRepAString)},
+        }},
+        // no aux_entries
+        {{"\42\0\0\15\0\0\0\0"
+          "streamit.v1.InitProducerIdResponse"
+          "error_message"}},
+    };
+PROTOBUF_NOINLINE void InitProducerIdResponse::Clear() {
+  // @@protoc_insertion_point(message_clear_start:streamit.v1.InitProducerIdResponse)
+  ::google::protobuf::internal::TSanWrite(&_impl_);
+  ::uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void)cached_has_bits;
+
+  cached_has_bits = _impl_._has_bits_[0];
+  if ((cached_has_bits & 0x00000001U) != 0) {
+    _impl_.error_message_.ClearNonDefaultToEmpty();
+  }
+  if ((cached_has_bits & 0x00000006U) != 0) {
+    ::memset(&_impl_.producer_id_, 0,
+             static_cast<::size_t>(reinterpret_cast<char*>(&_impl_.error_code_) -
+                                   reinterpret_cast<char*>(&_impl_.producer_id_)) +
+                 sizeof(_impl_.error_code_));
+  }
+  _impl_._has_bits_.Clear();
+  _internal_metadata_.Clear<::google::protobuf::UnknownFieldSet>();
+}
+
+#if defined(PROTOBUF_CUSTOM_VTABLE)
+::uint8_t* PROTOBUF_NONNULL InitProducerIdResponse::_InternalSerialize(
+    const ::google::protobuf::MessageLite& base, ::uint8_t* PROTOBUF_NONNULL target,
+    ::google::protobuf::io::EpsCopyOutputStream* PROTOBUF_NONNULL stream) {
+  const InitProducerIdResponse& this_ = static_cast<const InitProducerIdResponse&>(base);
+#else  // PROTOBUF_CUSTOM_VTABLE
+::uint8_t* PROTOBUF_NONNULL InitProducerIdResponse::_InternalSerialize(
+    ::uint8_t* PROTOBUF_NONNULL target, ::google::protobuf::io::EpsCopyOutputStream* PROTOBUF_NONNULL stream) const {
+  const InitProducerIdResponse& this_ = *this;
+#endif // PROTOBUF_CUSTOM_VTABLE
+  if constexpr (::_pbi::DebugHardenVerifyHasBitConsistency()) {
+    this_.VerifyHasBitConsistency();
+  }
+  // @@protoc_insertion_point(serialize_to_array_start:streamit.v1.InitProducerIdResponse)
+  ::uint32_t cached_has_bits = 0;
+  (void)cached_has_bits;
+
+  // int64 producer_id = 1;
+  if ((this_._impl_._has_bits_[0] & 0x00000002U) != 0) {
+    if (this_._internal_producer_id() != 0) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArrayWithField<1>(
+          stream, this_._internal_producer_id(), target);
+    }
+  }
+
+  // .streamit.v1.ErrorCode error_code = 2;
+  if ((this_._impl_._has_bits_[0] & 0x00000004U) != 0) {
+    if (this_._internal_error_code() != 0) {
+      target = stream->EnsureSpace(target);
+      target = ::_pbi::WireFormatLite::WriteEnumToArray(2, this_._internal_error_code(), target);
+    }
+  }
+
+  // string error_message = 3;
+  if ((this_._impl_._has_bits_[0] & 0x00000001U) != 0) {
+    if (!this_._internal_error_message().empty()) {
+      const ::std::string& _s = this_._internal_error_message();
+      ::google::protobuf::internal::WireFormatLite::VerifyUtf8String(
+          _s.data(), static_cast<int>(_s.length()), ::google::protobuf::internal::WireFormatLite::SERIALIZE,
+          "streamit.v1.InitProducerIdResponse.error_message");
+      target = stream->WriteStringMaybeAliased(3, _s, target);
+    }
+  }
+
+  if (ABSL_PREDICT_FALSE(this_._internal_metadata_.have_unknown_fields())) {
+    target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
+        this_._internal_metadata_.unknown_fields<::google::protobuf::UnknownFieldSet>(
+            ::google::protobuf::UnknownFieldSet::default_instance),
+        target, stream);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:streamit.v1.InitProducerIdResponse)
+  return target;
+}
+
+#if defined(PROTOBUF_CUSTOM_VTABLE)
+::size_t InitProducerIdResponse::ByteSizeLong(const MessageLite& base) {
+  const InitProducerIdResponse& this_ = static_cast<const InitProducerIdResponse&>(base);
+#else  // PROTOBUF_CUSTOM_VTABLE
+::size_t InitProducerIdResponse::ByteSizeLong() const {
+  const InitProducerIdResponse& this_ = *this;
+#endif // PROTOBUF_CUSTOM_VTABLE
+  // @@protoc_insertion_point(message_byte_size_start:streamit.v1.InitProducerIdResponse)
+  ::size_t total_size = 0;
+
+  ::uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void)cached_has_bits;
+
+  ::_pbi::Prefetch5LinesFrom7Lines(&this_);
+  cached_has_bits = this_._impl_._has_bits_[0];
+  if ((cached_has_bits & 0x00000007U) != 0) {
+    // string error_message = 3;
+    if ((cached_has_bits & 0x00000001U) != 0) {
+      if (!this_._internal_error_message().empty()) {
+        total_size += 1 + ::google::protobuf::internal::WireFormatLite::StringSize(this_._internal_error_message());
+      }
+    }
+    // int64 producer_id = 1;
+    if ((cached_has_bits & 0x00000002U) != 0) {
+      if (this_._internal_producer_id() != 0) {
+        total_size += ::_pbi::WireFormatLite::Int64SizePlusOne(this_._internal_producer_id());
+      }
+    }
+    // .streamit.v1.ErrorCode error_code = 2;
+    if ((cached_has_bits & 0x00000004U) != 0) {
+      if (this_._internal_error_code() != 0) {
+        total_size += 1 + ::_pbi::WireFormatLite::EnumSize(this_._internal_error_code());
+      }
+    }
+  }
+  return this_.MaybeComputeUnknownFieldsSize(total_size, &this_._impl_._cached_size_);
+}
+
+void InitProducerIdResponse::MergeImpl(::google::protobuf::MessageLite& to_msg,
+                                       const ::google::protobuf::MessageLite& from_msg) {
+  auto* const _this = static_cast<InitProducerIdResponse*>(&to_msg);
+  auto& from = static_cast<const InitProducerIdResponse&>(from_msg);
+  if constexpr (::_pbi::DebugHardenVerifyHasBitConsistency()) {
+    from.VerifyHasBitConsistency();
+  }
+  // @@protoc_insertion_point(class_specific_merge_from_start:streamit.v1.InitProducerIdResponse)
+  ABSL_DCHECK_NE(&from, _this);
+  ::uint32_t cached_has_bits = 0;
+  (void)cached_has_bits;
+
+  cached_has_bits = from._impl_._has_bits_[0];
+  if ((cached_has_bits & 0x00000007U) != 0) {
+    if ((cached_has_bits & 0x00000001U) != 0) {
+      if (!from._internal_error_message().empty()) {
+        _this->_internal_set_error_message(from._internal_error_message());
+      } else {
+        if (_this->_impl_.error_message_.IsDefault()) {
+          _this->_internal_set_error_message("");
+        }
+      }
+    }
+    if ((cached_has_bits & 0x00000002U) != 0) {
+      if (from._internal_producer_id() != 0) {
+        _this->_impl_.producer_id_ = from._impl_.producer_id_;
+      }
+    }
+    if ((cached_has_bits & 0x00000004U) != 0) {
+      if (from._internal_error_code() != 0) {
+        _this->_impl_.error_code_ = from._impl_.error_code_;
+      }
+    }
+  }
+  _this->_impl_._has_bits_[0] |= cached_has_bits;
+  _this->_internal_metadata_.MergeFrom<::google::protobuf::UnknownFieldSet>(from._internal_metadata_);
+}
+
+void InitProducerIdResponse::CopyFrom(const InitProducerIdResponse& from) {
+  // @@protoc_insertion_point(class_specific_copy_from_start:streamit.v1.InitProducerIdResponse)
+  if (&from == this)
+    return;
+  Clear();
+  MergeFrom(from);
+}
+
+void InitProducerIdResponse::InternalSwap(InitProducerIdResponse* PROTOBUF_RESTRICT PROTOBUF_NONNULL other) {
+  using ::std::swap;
+  auto* arena = GetArena();
+  ABSL_DCHECK_EQ(arena, other->GetArena());
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  swap(_impl_._has_bits_[0], other->_impl_._has_bits_[0]);
+  ::_pbi::ArenaStringPtr::InternalSwap(&_impl_.error_message_, &other->_impl_.error_message_, arena);
+  ::google::protobuf::internal::memswap<PROTOBUF_FIELD_OFFSET(InitProducerIdResponse, _impl_.error_code_) +
+                                        sizeof(InitProducerIdResponse::_impl_.error_code_) -
+                                        PROTOBUF_FIELD_OFFSET(InitProducerIdResponse, _impl_.producer_id_)>(
+      reinterpret_cast<char*>(&_impl_.producer_id_), reinterpret_cast<char*>(&other->_impl_.producer_id_));
+}
+
+::google::protobuf::Metadata InitProducerIdResponse::GetMetadata() const {
+  return ::google::protobuf::Message::GetMetadataImpl(GetClassData()->full());
+}
+// ===================================================================
+
 class ProduceRequest::_Internal {
 public:
   using HasBits = decltype(::std::declval<ProduceRequest>()._impl_._has_bits_);
@@ -1581,7 +2084,7 @@ PROTOBUF_NDEBUG_INLINE ProduceRequest::Impl_::Impl_(
     [[maybe_unused]] ::google::protobuf::Arena* PROTOBUF_NULLABLE arena, const Impl_& from,
     [[maybe_unused]] const ::streamit::v1::ProduceRequest& from_msg)
     : _has_bits_{from._has_bits_}, _cached_size_{0}, records_{visibility, arena, from.records_},
-      topic_(arena, from.topic_), producer_id_(arena, from.producer_id_) {
+      topic_(arena, from.topic_) {
 }
 
 ProduceRequest::ProduceRequest(::google::protobuf::Arena* PROTOBUF_NULLABLE arena, const ProduceRequest& from)
@@ -1596,20 +2099,20 @@ ProduceRequest::ProduceRequest(::google::protobuf::Arena* PROTOBUF_NULLABLE aren
   new (&_impl_) Impl_(internal_visibility(), arena, from._impl_, from);
   ::memcpy(reinterpret_cast<char*>(&_impl_) + offsetof(Impl_, partition_),
            reinterpret_cast<const char*>(&from._impl_) + offsetof(Impl_, partition_),
-           offsetof(Impl_, sequence_) - offsetof(Impl_, partition_) + sizeof(Impl_::sequence_));
+           offsetof(Impl_, producer_id_) - offsetof(Impl_, partition_) + sizeof(Impl_::producer_id_));
 
   // @@protoc_insertion_point(copy_constructor:streamit.v1.ProduceRequest)
 }
 PROTOBUF_NDEBUG_INLINE ProduceRequest::Impl_::Impl_(
     [[maybe_unused]] ::google::protobuf::internal::InternalVisibility visibility,
     [[maybe_unused]] ::google::protobuf::Arena* PROTOBUF_NULLABLE arena)
-    : _cached_size_{0}, records_{visibility, arena}, topic_(arena), producer_id_(arena) {
+    : _cached_size_{0}, records_{visibility, arena}, topic_(arena) {
 }
 
 inline void ProduceRequest::SharedCtor(::_pb::Arena* PROTOBUF_NULLABLE arena) {
   new (&_impl_) Impl_(internal_visibility(), arena);
   ::memset(reinterpret_cast<char*>(&_impl_) + offsetof(Impl_, partition_), 0,
-           offsetof(Impl_, sequence_) - offsetof(Impl_, partition_) + sizeof(Impl_::sequence_));
+           offsetof(Impl_, producer_id_) - offsetof(Impl_, partition_) + sizeof(Impl_::producer_id_));
 }
 ProduceRequest::~ProduceRequest() {
   // @@protoc_insertion_point(destructor:streamit.v1.ProduceRequest)
@@ -1623,7 +2126,6 @@ inline void ProduceRequest::SharedDtor(MessageLite& self) {
   this_._internal_metadata_.Delete<::google::protobuf::UnknownFieldSet>();
   ABSL_DCHECK(this_.GetArena() == nullptr);
   this_._impl_.topic_.Destroy();
-  this_._impl_.producer_id_.Destroy();
   this_._impl_.~Impl_();
 }
 
@@ -1678,15 +2180,15 @@ ProduceRequest::GetClassData() const {
   ::google::protobuf::internal::PrefetchToLocalCache(ProduceRequest_class_data_.tc_table);
   return ProduceRequest_class_data_.base();
 }
-PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 const ::_pbi::TcParseTable<3, 6, 1, 51, 2>
+PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 const ::_pbi::TcParseTable<3, 6, 1, 40, 2>
     ProduceRequest::_table_ = {
         {
             PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_._has_bits_),
             0, // no _extensions_
-            6,
+            7,
             56, // max_field_number, fast_idx_mask
             offsetof(decltype(_table_), field_lookup_table),
-            4294967232, // skipmap
+            4294967184, // skipmap
             offsetof(decltype(_table_), field_entries),
             6, // num_field_entries
             1, // num_aux_entries
@@ -1703,19 +2205,20 @@ PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 const ::_pbi::TcParseTable<
             // string topic = 1;
             {::_pbi::TcParser::FastUS1, {10, 0, 0, PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.topic_)}},
             // int32 partition = 2;
-            {::_pbi::TcParser::SingularVarintNoZag1<::uint32_t, offsetof(ProduceRequest, _impl_.partition_), 2>(),
-             {16, 2, 0, PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.partition_)}},
+            {::_pbi::TcParser::SingularVarintNoZag1<::uint32_t, offsetof(ProduceRequest, _impl_.partition_), 1>(),
+             {16, 1, 0, PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.partition_)}},
             // repeated .streamit.v1.Record records = 3;
             {::_pbi::TcParser::FastMtR1, {26, 63, 0, PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.records_)}},
             // .streamit.v1.Ack ack = 4;
-            {::_pbi::TcParser::SingularVarintNoZag1<::uint32_t, offsetof(ProduceRequest, _impl_.ack_), 3>(),
-             {32, 3, 0, PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.ack_)}},
-            // string producer_id = 5;
-            {::_pbi::TcParser::FastUS1, {42, 1, 0, PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.producer_id_)}},
-            // int64 sequence = 6;
-            {::_pbi::TcParser::SingularVarintNoZag1<::uint64_t, offsetof(ProduceRequest, _impl_.sequence_), 4>(),
-             {48, 4, 0, PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.sequence_)}},
+            {::_pbi::TcParser::SingularVarintNoZag1<::uint32_t, offsetof(ProduceRequest, _impl_.ack_), 2>(),
+             {32, 2, 0, PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.ack_)}},
             {::_pbi::TcParser::MiniParse, {}},
+            // int64 sequence = 6;
+            {::_pbi::TcParser::SingularVarintNoZag1<::uint64_t, offsetof(ProduceRequest, _impl_.sequence_), 3>(),
+             {48, 3, 0, PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.sequence_)}},
+            // int64 producer_id = 7;
+            {::_pbi::TcParser::SingularVarintNoZag1<::uint64_t, offsetof(ProduceRequest, _impl_.producer_id_), 4>(),
+             {56, 4, 0, PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.producer_id_)}},
         }},
         {{65535, 65535}},
         {{
@@ -1723,28 +2226,27 @@ PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 const ::_pbi::TcParseTable<
             {PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.topic_), _Internal::kHasBitsOffset + 0, 0,
              (0 | ::_fl::kFcOptional | ::_fl::kUtf8String | ::_fl::kRepAString)},
             // int32 partition = 2;
-            {PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.partition_), _Internal::kHasBitsOffset + 2, 0,
+            {PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.partition_), _Internal::kHasBitsOffset + 1, 0,
              (0 | ::_fl::kFcOptional | ::_fl::kInt32)},
             // repeated .streamit.v1.Record records = 3;
             {PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.records_), -1, 0,
              (0 | ::_fl::kFcRepeated | ::_fl::kMessage | ::_fl::kTvTable)},
             // .streamit.v1.Ack ack = 4;
-            {PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.ack_), _Internal::kHasBitsOffset + 3, 0,
+            {PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.ack_), _Internal::kHasBitsOffset + 2, 0,
              (0 | ::_fl::kFcOptional | ::_fl::kOpenEnum)},
-            // string producer_id = 5;
-            {PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.producer_id_), _Internal::kHasBitsOffset + 1, 0,
-             (0 | ::_fl::kFcOptional | ::_fl::kUtf8String | ::_fl::kRepAString)},
             // int64 sequence = 6;
-            {PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.sequence_), _Internal::kHasBitsOffset + 4, 0,
+            {PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.sequence_), _Internal::kHasBitsOffset + 3, 0,
+             (0 | ::_fl::kFcOptional | ::_fl::kInt64)},
+            // int64 producer_id = 7;
+            {PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.producer_id_), _Internal::kHasBitsOffset + 4, 0,
              (0 | ::_fl::kFcOptional | ::_fl::kInt64)},
         }},
         {{
             {::_pbi::TcParser::GetTable<::streamit::v1::Record>()},
         }},
-        {{"\32\5\0\0\0\13\0\0"
+        {{"\32\5\0\0\0\0\0\0"
           "streamit.v1.ProduceRequest"
-          "topic"
-          "producer_id"}},
+          "topic"}},
     };
 PROTOBUF_NOINLINE void ProduceRequest::Clear() {
   // @@protoc_insertion_point(message_clear_start:streamit.v1.ProduceRequest)
@@ -1755,19 +2257,14 @@ PROTOBUF_NOINLINE void ProduceRequest::Clear() {
 
   _impl_.records_.Clear();
   cached_has_bits = _impl_._has_bits_[0];
-  if ((cached_has_bits & 0x00000003U) != 0) {
-    if ((cached_has_bits & 0x00000001U) != 0) {
-      _impl_.topic_.ClearNonDefaultToEmpty();
-    }
-    if ((cached_has_bits & 0x00000002U) != 0) {
-      _impl_.producer_id_.ClearNonDefaultToEmpty();
-    }
+  if ((cached_has_bits & 0x00000001U) != 0) {
+    _impl_.topic_.ClearNonDefaultToEmpty();
   }
-  if ((cached_has_bits & 0x0000001cU) != 0) {
+  if ((cached_has_bits & 0x0000001eU) != 0) {
     ::memset(&_impl_.partition_, 0,
-             static_cast<::size_t>(reinterpret_cast<char*>(&_impl_.sequence_) -
+             static_cast<::size_t>(reinterpret_cast<char*>(&_impl_.producer_id_) -
                                    reinterpret_cast<char*>(&_impl_.partition_)) +
-                 sizeof(_impl_.sequence_));
+                 sizeof(_impl_.producer_id_));
   }
   _impl_._has_bits_.Clear();
   _internal_metadata_.Clear<::google::protobuf::UnknownFieldSet>();
@@ -1802,7 +2299,7 @@ ProduceRequest::_InternalSerialize(const ::google::protobuf::MessageLite& base,
   }
 
   // int32 partition = 2;
-  if ((this_._impl_._has_bits_[0] & 0x00000004U) != 0) {
+  if ((this_._impl_._has_bits_[0] & 0x00000002U) != 0) {
     if (this_._internal_partition() != 0) {
       target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArrayWithField<2>(
           stream, this_._internal_partition(), target);
@@ -1817,32 +2314,29 @@ ProduceRequest::_InternalSerialize(const ::google::protobuf::MessageLite& base,
   }
 
   // .streamit.v1.Ack ack = 4;
-  if ((this_._impl_._has_bits_[0] & 0x00000008U) != 0) {
+  if ((this_._impl_._has_bits_[0] & 0x00000004U) != 0) {
     if (this_._internal_ack() != 0) {
       target = stream->EnsureSpace(target);
       target = ::_pbi::WireFormatLite::WriteEnumToArray(4, this_._internal_ack(), target);
     }
   }
 
-  // string producer_id = 5;
-  if ((this_._impl_._has_bits_[0] & 0x00000002U) != 0) {
-    if (!this_._internal_producer_id().empty()) {
-      const ::std::string& _s = this_._internal_producer_id();
-      ::google::protobuf::internal::WireFormatLite::VerifyUtf8String(
-          _s.data(), static_cast<int>(_s.length()), ::google::protobuf::internal::WireFormatLite::SERIALIZE,
-          "streamit.v1.ProduceRequest.producer_id");
-      target = stream->WriteStringMaybeAliased(5, _s, target);
-    }
-  }
-
   // int64 sequence = 6;
-  if ((this_._impl_._has_bits_[0] & 0x00000010U) != 0) {
+  if ((this_._impl_._has_bits_[0] & 0x00000008U) != 0) {
     if (this_._internal_sequence() != 0) {
       target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArrayWithField<6>(
           stream, this_._internal_sequence(), target);
     }
   }
 
+  // int64 producer_id = 7;
+  if ((this_._impl_._has_bits_[0] & 0x00000010U) != 0) {
+    if (this_._internal_producer_id() != 0) {
+      target = ::google::protobuf::internal::WireFormatLite::WriteInt64ToArrayWithField<7>(
+          stream, this_._internal_producer_id(), target);
+    }
+  }
+
   if (ABSL_PREDICT_FALSE(this_._internal_metadata_.have_unknown_fields())) {
     target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
         this_._internal_metadata_.unknown_fields<::google::protobuf::UnknownFieldSet>(
@@ -1885,30 +2379,30 @@ ProduceRequest::_InternalSerialize(const ::google::protobuf::MessageLite& base,
         total_size += 1 + ::google::protobuf::internal::WireFormatLite::StringSize(this_._internal_topic());
       }
     }
-    // string producer_id = 5;
-    if ((cached_has_bits & 0x00000002U) != 0) {
-      if (!this_._internal_producer_id().empty()) {
-        total_size += 1 + ::google::protobuf::internal::WireFormatLite::StringSize(this_._internal_producer_id());
-      }
-    }
     // int32 partition = 2;
-    if ((cached_has_bits & 0x00000004U) != 0) {
+    if ((cached_has_bits & 0x00000002U) != 0) {
       if (this_._internal_partition() != 0) {
         total_size += ::_pbi::WireFormatLite::Int32SizePlusOne(this_._internal_partition());
       }
     }
     // .streamit.v1.Ack ack = 4;
-    if ((cached_has_bits & 0x00000008U) != 0) {
+    if ((cached_has_bits & 0x00000004U) != 0) {
       if (this_._internal_ack() != 0) {
         total_size += 1 + ::_pbi::WireFormatLite::EnumSize(this_._internal_ack());
       }
     }
     // int64 sequence = 6;
-    if ((cached_has_bits & 0x00000010U) != 0) {
+    if ((cached_has_bits & 0x00000008U) != 0) {
       if (this_._internal_sequence() != 0) {
         total_size += ::_pbi::WireFormatLite::Int64SizePlusOne(this_._internal_sequence());
       }
     }
+    // int64 producer_id = 7;
+    if ((cached_has_bits & 0x00000010U) != 0) {
+      if (this_._internal_producer_id() != 0) {
+        total_size += ::_pbi::WireFormatLite::Int64SizePlusOne(this_._internal_producer_id());
+      }
+    }
   }
   return this_.MaybeComputeUnknownFieldsSize(total_size, &this_._impl_._cached_size_);
 }
@@ -1938,29 +2432,25 @@ void ProduceRequest::MergeImpl(::google::protobuf::MessageLite& to_msg,
       }
     }
     if ((cached_has_bits & 0x00000002U) != 0) {
-      if (!from._internal_producer_id().empty()) {
-        _this->_internal_set_producer_id(from._internal_producer_id());
-      } else {
-        if (_this->_impl_.producer_id_.IsDefault()) {
-          _this->_internal_set_producer_id("");
-        }
-      }
-    }
-    if ((cached_has_bits & 0x00000004U) != 0) {
       if (from._internal_partition() != 0) {
         _this->_impl_.partition_ = from._impl_.partition_;
       }
     }
-    if ((cached_has_bits & 0x00000008U) != 0) {
+    if ((cached_has_bits & 0x00000004U) != 0) {
       if (from._internal_ack() != 0) {
         _this->_impl_.ack_ = from._impl_.ack_;
       }
     }
-    if ((cached_has_bits & 0x00000010U) != 0) {
+    if ((cached_has_bits & 0x00000008U) != 0) {
       if (from._internal_sequence() != 0) {
         _this->_impl_.sequence_ = from._impl_.sequence_;
       }
     }
+    if ((cached_has_bits & 0x00000010U) != 0) {
+      if (from._internal_producer_id() != 0) {
+        _this->_impl_.producer_id_ = from._impl_.producer_id_;
+      }
+    }
   }
   _this->_impl_._has_bits_[0] |= cached_has_bits;
   _this->_internal_metadata_.MergeFrom<::google::protobuf::UnknownFieldSet>(from._internal_metadata_);
@@ -1982,9 +2472,8 @@ void ProduceRequest::InternalSwap(ProduceRequest* PROTOBUF_RESTRICT PROTOBUF_NON
   swap(_impl_._has_bits_[0], other->_impl_._has_bits_[0]);
   _impl_.records_.InternalSwap(&other->_impl_.records_);
   ::_pbi::ArenaStringPtr::InternalSwap(&_impl_.topic_, &other->_impl_.topic_, arena);
-  ::_pbi::ArenaStringPtr::InternalSwap(&_impl_.producer_id_, &other->_impl_.producer_id_, arena);
-  ::google::protobuf::internal::memswap<PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.sequence_) +
-                                        sizeof(ProduceRequest::_impl_.sequence_) -
+  ::google::protobuf::internal::memswap<PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.producer_id_) +
+                                        sizeof(ProduceRequest::_impl_.producer_id_) -
                                         PROTOBUF_FIELD_OFFSET(ProduceRequest, _impl_.partition_)>(
       reinterpret_cast<char*>(&_impl_.partition_), reinterpret_cast<char*>(&other->_impl_.partition_));
 }
@@ -2,12 +2,13 @@
 #include "streamit/common/status.h"
 #include <algorithm>
 #include <filesystem>
-#include <fstream>
 
 namespace streamit::storage {
 
 LogDir::LogDir(std::filesystem::path root_path, size_t max_segment_size_bytes)
-    : root_path_(std::move(root_path)), max_segment_size_bytes_(max_segment_size_bytes) {
+    : root_path_(std::move(root_path)), max_segment_size_bytes_(max_segment_size_bytes),
+      topics_(std::make_shared<common::TopicRegistry>()), partitions_(std::make_shared<const PartitionMap>()),
+      checkpoint_(root_path_ / OffsetCheckpoint::kFileName), roll_executor_("log-roll", 1) {
 
   // Create root directory if it doesn't exist
   std::filesystem::create_directories(root_path_);
@@ -37,9 +38,9 @@ Result<std::unique_ptr<LogDir>> LogDir::Open(std::filesystem::path root_path, si
         int32_t partition = std::stoi(partition_str);
 
         // Load segments for this partition
-        auto load_result = log_dir->LoadSegments(topic, partition);
-        if (!load_result.ok()) {
-          return Error<std::unique_ptr<LogDir>>(load_result.status().code(), load_result.status().message());
+        auto load_status = log_dir->LoadPartition({log_dir->topics_->Intern(topic), partition});
+        if (!load_status.ok()) {
+          return Error<std::unique_ptr<LogDir>>(load_status);
         }
       } catch (const std::exception&) {
         // Skip invalid partition directories
@@ -48,198 +49,244 @@ Result<std::unique_ptr<LogDir>> LogDir::Open(std::filesystem::path root_path, si
     }
   }
 
+  log_dir->RestoreCheckpoint();
+
   return Ok(std::move(log_dir));
 }
 
-Result<std::shared_ptr<Segment>> LogDir::GetSegment(const std::string& topic, int32_t partition) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
-
-  // Check if we have an active segment
-  auto active_result = GetActiveSegment(topic, partition);
-  if (active_result.ok() && !active_result.value()->IsFull() && !active_result.value()->IsClosed()) {
-    return active_result;
-  }
+const std::filesystem::path& LogDir::RootPath() const noexcept {
+  return root_path_;
+}
 
-  // Create a new segment
-  return RollSegment(topic, partition);
+const std::shared_ptr<common::TopicRegistry>& LogDir::Topics() const noexcept {
+  return topics_;
 }
 
-Result<std::vector<std::shared_ptr<Segment>>> LogDir::GetSegments(const std::string& topic,
-                                                                  int32_t partition) const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+std::shared_ptr<Partition> LogDir::GetPartition(common::TopicPartition tp) const noexcept {
+  auto partitions = partitions_.load(std::memory_order_acquire);
+  auto it = partitions->find(tp);
+  return it == partitions->end() ? nullptr : it->second;
+}
 
-  auto topic_it = segments_.find(topic);
-  if (topic_it == segments_.end()) {
-    return Ok(std::vector<std::shared_ptr<Segment>>{});
+std::shared_ptr<Partition> LogDir::GetOrCreatePartition(common::TopicPartition tp) noexcept {
+  if (auto partition = GetPartition(tp)) {
+    return partition;
   }
 
-  auto partition_it = topic_it->second.find(partition);
-  if (partition_it == topic_it->second.end()) {
-    return Ok(std::vector<std::shared_ptr<Segment>>{});
+  std::lock_guard<common::InstrumentedMutex> lock(create_mutex_);
+
+  // Creation is rare, so copying the map keeps every lookup lock-free
+  auto partitions = partitions_.load(std::memory_order_acquire);
+  auto it = partitions->find(tp);
+  if (it != partitions->end()) {
+    return it->second;
   }
 
-  return Ok(partition_it->second);
+  auto partition = std::make_shared<Partition>(tp, GetPartitionPath(tp), max_segment_size_bytes_,
+                                               Partition::SegmentList{}, 0, &roll_executor_);
+  auto updated = std::make_shared<PartitionMap>(*partitions);
+  updated->emplace(tp, partition);
+  partitions_.store(std::move(updated), std::memory_order_release);
+
+  return partition;
 }
 
-Result<std::shared_ptr<Segment>> LogDir::GetActiveSegment(const std::string& topic, int32_t partition) const noexcept {
-  auto segments_result = GetSegments(topic, partition);
-  if (!segments_result.ok()) {
-    return Error<std::shared_ptr<Segment>>(segments_result.status().code(), segments_result.status().message());
-  }
+Result<std::shared_ptr<Segment>> LogDir::GetSegment(common::TopicPartition tp) noexcept {
+  return GetOrCreatePartition(tp)->ActiveSegment();
+}
 
-  const auto& segments = segments_result.value();
-  if (segments.empty()) {
-    return Error<std::shared_ptr<Segment>>(absl::StatusCode::kNotFound, "No segments found");
+Result<std::shared_ptr<Segment>> LogDir::GetSegment(const std::string& topic, int32_t partition) noexcept {
+  return GetSegment({topics_->Intern(topic), partition});
+}
+
+Result<std::vector<std::shared_ptr<Segment>>> LogDir::GetSegments(common::TopicPartition tp) const noexcept {
+  auto partition = GetPartition(tp);
+  if (!partition) {
+    return Ok(Partition::SegmentList{});
   }
 
-  // Return the last (most recent) segment
-  return Ok(segments.back());
+  return Ok(Partition::SegmentList(*partition->Segments()));
 }
 
-Result<std::shared_ptr<Segment>> LogDir::RollSegment(const std::string& topic, int32_t partition) noexcept {
-  // Get current end offset
-  auto end_offset_result = GetEndOffset(topic, partition);
-  if (!end_offset_result.ok()) {
-    return Error<std::shared_ptr<Segment>>(end_offset_result.status().code(), end_offset_result.status().message());
+Result<std::vector<std::shared_ptr<Segment>>> LogDir::GetSegments(const std::string& topic,
+                                                                  int32_t partition) const noexcept {
+  auto topic_id = topics_->Find(topic);
+  if (!topic_id) {
+    return Ok(Partition::SegmentList{});
   }
+  return GetSegments({*topic_id, partition});
+}
 
-  int64_t base_offset = end_offset_result.value();
-
-  // Create new segment
-  auto segment_result = CreateSegment(topic, partition, base_offset);
-  if (!segment_result.ok()) {
-    return segment_result;
+Result<std::shared_ptr<Segment>> LogDir::GetActiveSegment(common::TopicPartition tp) const noexcept {
+  auto partition = GetPartition(tp);
+  auto segments = partition ? partition->Segments() : nullptr;
+  if (!segments || segments->empty()) {
+    return Error<std::shared_ptr<Segment>>(absl::StatusCode::kNotFound, "No segments found");
   }
 
-  auto segment = segment_result.value();
+  // Return the last (most recent) segment
+  return Ok(std::shared_ptr<Segment>(segments->back()));
+}
 
-  // Add to segments map
-  segments_[topic][partition].push_back(segment);
+Result<std::shared_ptr<Segment>> LogDir::RollSegment(common::TopicPartition tp) noexcept {
+  return GetOrCreatePartition(tp)->Roll();
+}
 
-  return Ok(segment);
+Result<std::shared_ptr<Segment>> LogDir::RollSegment(const std::string& topic, int32_t partition) noexcept {
+  return RollSegment({topics_->Intern(topic), partition});
 }
 
-Result<int64_t> LogDir::GetEndOffset(const std::string& topic, int32_t partition) const noexcept {
-  auto segments_result = GetSegments(topic, partition);
-  if (!segments_result.ok()) {
-    return Error<int64_t>(segments_result.status().code(), segments_result.status().message());
-  }
+Result<int64_t> LogDir::GetEndOffset(common::TopicPartition tp) const noexcept {
+  auto partition = GetPartition(tp);
+  return Ok(partition ? partition->EndOffset() : int64_t{0});
+}
 
-  const auto& segments = segments_result.value();
-  if (segments.empty()) {
+Result<int64_t> LogDir::GetEndOffset(const std::string& topic, int32_t partition) const noexcept {
+  auto topic_id = topics_->Find(topic);
+  if (!topic_id) {
     return Ok(0);
   }
+  return GetEndOffset({*topic_id, partition});
+}
 
-  // Return the end offset of the last segment
-  return Ok(segments.back()->EndOffset());
+Result<int64_t> LogDir::GetHighWaterMark(common::TopicPartition tp) const noexcept {
+  auto partition = GetPartition(tp);
+  return Ok(partition ? partition->HighWaterMark() : int64_t{0});
 }
 
 Result<int64_t> LogDir::GetHighWaterMark(const std::string& topic, int32_t partition) const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
-
-  auto topic_it = high_water_marks_.find(topic);
-  if (topic_it == high_water_marks_.end()) {
-    return Ok(0);
-  }
-
-  auto partition_it = topic_it->second.find(partition);
-  if (partition_it == topic_it->second.end()) {
+  auto topic_id = topics_->Find(topic);
+  if (!topic_id) {
     return Ok(0);
   }
+  return GetHighWaterMark({*topic_id, partition});
+}
 
-  return Ok(partition_it->second);
+void LogDir::SetHighWaterMark(common::TopicPartition tp, int64_t offset) noexcept {
+  GetOrCreatePartition(tp)->SetHighWaterMark(offset);
 }
 
-Result<void> LogDir::SetHighWaterMark(const std::string& topic, int32_t partition, int64_t offset) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+void LogDir::SetHighWaterMark(const std::string& topic, int32_t partition, int64_t offset) noexcept {
+  SetHighWaterMark({topics_->Intern(topic), partition}, offset);
+}
 
-  high_water_marks_[topic][partition] = offset;
+absl::Status LogDir::Checkpoint() noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(checkpoint_mutex_);
 
-  // Persist to disk (simplified - in practice would write to a metadata file)
-  auto partition_path = GetPartitionPath(topic, partition);
-  std::filesystem::create_directories(partition_path);
+  std::vector<PartitionOffsets> offsets;
+  for (const auto& tp : ListTopicPartitions()) {
+    auto partition = GetPartition(tp);
+    offsets.push_back({topics_->Name(tp.topic), tp.partition, partition->EndOffset(), partition->HighWaterMark()});
+  }
 
-  auto hwm_path = partition_path / "high_water_mark";
-  std::ofstream file(hwm_path);
-  if (file.is_open()) {
-    file << offset;
+  // An idle broker does not rewrite the file every interval
+  if (offsets == last_checkpoint_) {
+    return absl::OkStatus();
   }
 
-  return Ok();
+  auto write_status = checkpoint_.Write(offsets);
+  if (write_status.ok()) {
+    last_checkpoint_ = std::move(offsets);
+  }
+  return write_status;
 }
 
 std::vector<std::string> LogDir::ListTopics() const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
-
   std::vector<std::string> topics;
-  for (const auto& topic_entry : segments_) {
-    topics.push_back(topic_entry.first);
+  for (const auto& tp : ListTopicPartitions()) {
+    const auto& name = topics_->Name(tp.topic);
+    if (std::find(topics.begin(), topics.end(), name) == topics.end()) {
+      topics.push_back(name);
+    }
   }
 
   return topics;
 }
 
 Result<std::vector<int32_t>> LogDir::ListPartitions(const std::string& topic) const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
-
-  auto topic_it = segments_.find(topic);
-  if (topic_it == segments_.end()) {
+  auto topic_id = topics_->Find(topic);
+  if (!topic_id) {
     return Ok(std::vector<int32_t>{});
   }
 
   std::vector<int32_t> partitions;
-  for (const auto& partition_entry : topic_it->second) {
-    partitions.push_back(partition_entry.first);
+  for (const auto& tp : ListTopicPartitions()) {
+    if (tp.topic == *topic_id) {
+      partitions.push_back(tp.partition);
+    }
   }
 
-  std::sort(partitions.begin(), partitions.end());
   return Ok(std::move(partitions));
 }
 
-Result<void> LogDir::CleanupOldSegments(const std::string& topic, int32_t partition, int64_t retention_bytes) noexcept {
-  auto segments_result = GetSegments(topic, partition);
-  if (!segments_result.ok()) {
-    return segments_result;
-  }
+std::vector<common::TopicPartition> LogDir::ListTopicPartitions() const noexcept {
+  auto snapshot = partitions_.load(std::memory_order_acquire);
 
-  auto& segments = segments_result.value();
-  if (segments.size() <= 1) {
-    return Ok(); // Keep at least one segment
+  std::vector<common::TopicPartition> partitions;
+  partitions.reserve(snapshot->size());
+  for (const auto& partition_entry : *snapshot) {
+    partitions.push_back(partition_entry.first);
   }
 
-  // Calculate total size and remove old segments
-  size_t total_size = 0;
-  size_t segments_to_keep = 1; // Always keep the last segment
+  std::sort(partitions.begin(), partitions.end(), [](common::TopicPartition a, common::TopicPartition b) {
+    return a.topic != b.topic ? a.topic < b.topic : a.partition < b.partition;
+  });
+  return partitions;
+}
 
-  for (auto it = segments.rbegin() + 1; it != segments.rend(); ++it) {
-    total_size += (*it)->Size();
-    if (total_size > static_cast<size_t>(retention_bytes)) {
-      break;
-    }
-    ++segments_to_keep;
+absl::Status LogDir::CleanupOldSegments(const std::string& topic, int32_t partition,
+                                        int64_t retention_bytes) noexcept {
+  auto topic_id = topics_->Find(topic);
+  if (!topic_id) {
+    return absl::OkStatus();
   }
 
-  // Remove old segments
-  size_t segments_to_remove = segments.size() - segments_to_keep;
-  if (segments_to_remove > 0) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    segments.erase(segments.begin(), segments.begin() + segments_to_remove);
+  auto state = GetPartition({*topic_id, partition});
+  if (!state) {
+    return absl::OkStatus();
   }
 
-  return Ok();
+  return state->Cleanup(retention_bytes);
+}
+
+std::filesystem::path LogDir::GetPartitionPath(common::TopicPartition tp) const noexcept {
+  return root_path_ / topics_->Name(tp.topic) / std::to_string(tp.partition);
 }
 
 std::filesystem::path LogDir::GetPartitionPath(const std::string& topic, int32_t partition) const noexcept {
   return root_path_ / topic / std::to_string(partition);
 }
 
-Result<void> LogDir::LoadSegments(const std::string& topic, int32_t partition) noexcept {
-  auto partition_path = GetPartitionPath(topic, partition);
+void LogDir::RestoreCheckpoint() noexcept {
+  // A missing or damaged checkpoint only loses high water marks, which the next produce to each partition restores
+  auto read_result = checkpoint_.Read();
+  if (!read_result.ok()) {
+    return;
+  }
+
+  for (const auto& entry : read_result.value()) {
+    auto topic_id = topics_->Find(entry.topic);
+    auto partition = topic_id ? GetPartition({*topic_id, entry.partition}) : nullptr;
+    if (!partition) {
+      continue; // Partition directory is gone
+    }
+
+    // A tail truncated during recovery cannot stay below the high water mark
+    partition->SetHighWaterMark(std::min(entry.high_watermark, partition->EndOffset()));
+  }
+
+  std::lock_guard<common::InstrumentedMutex> lock(checkpoint_mutex_);
+  last_checkpoint_ = std::move(read_result.value());
+}
+
+absl::Status LogDir::LoadPartition(common::TopicPartition tp) noexcept {
+  auto partition_path = GetPartitionPath(tp);
   if (!std::filesystem::exists(partition_path)) {
-    return Ok(); // No segments to load
+    return absl::OkStatus(); // No segments to load
   }
 
-  std::vector<std::shared_ptr<Segment>> segments;
+  Partition::SegmentList segments;
+  int64_t next_segment_number = 0;
 
   // Find all segment files
   for (const auto& entry : std::filesystem::directory_iterator(partition_path)) {
@@ -252,11 +299,32 @@ Result<void> LogDir::LoadSegments(const std::string& topic, int32_t partition) n
       auto log_path = entry.path();
       auto index_path = entry.path().parent_path() / (segment_name + ".index");
 
+      // New segments are numbered past every existing file so a roll never truncates one
+      try {
+        next_segment_number = std::max<int64_t>(next_segment_number, std::stoll(segment_name) + 1);
+      } catch (const std::exception&) {
+        // Not a numbered segment
+      }
+
       if (std::filesystem::exists(index_path)) {
         auto segment_result = Segment::Open(log_path, index_path);
-        if (segment_result.ok()) {
-          segments.push_back(std::move(segment_result.value()));
+        if (!segment_result.ok()) {
+          // Skipping a segment in an unreadable format would reissue its offsets
+          if (segment_result.status().code() == absl::StatusCode::kFailedPrecondition) {
+            return segment_result.status();
+          }
+          continue;
+        }
+
+        // A spare that was never rolled into holds no records
+        if (segment_result.value()->BaseOffset() == Segment::kUnassignedBaseOffset) {
+          segment_result.value().reset();
+          std::error_code ec;
+          std::filesystem::remove(log_path, ec);
+          std::filesystem::remove(index_path, ec);
+          continue;
         }
+        segments.push_back(std::move(segment_result.value()));
       }
     }
   }
@@ -266,46 +334,15 @@ Result<void> LogDir::LoadSegments(const std::string& topic, int32_t partition) n
     return a->BaseOffset() < b->BaseOffset();
   });
 
-  // Add to segments map
-  segments_[topic][partition] = std::move(segments);
-
-  return Ok();
-}
+  auto partition = std::make_shared<Partition>(tp, std::move(partition_path), max_segment_size_bytes_,
+                                               std::move(segments), next_segment_number, &roll_executor_);
 
-Result<std::shared_ptr<Segment>> LogDir::CreateSegment(const std::string& topic, int32_t partition,
-                                                       int64_t base_offset) noexcept {
-  auto partition_path = GetPartitionPath(topic, partition);
-  std::filesystem::create_directories(partition_path);
-
-  int64_t segment_number = GetNextSegmentNumber(topic, partition);
-  std::string segment_name = std::to_string(segment_number);
-
-  auto log_path = partition_path / (segment_name + ".log");
-  auto index_path = partition_path / (segment_name + ".index");
-
-  try {
-    auto segment = std::make_shared<Segment>(log_path, index_path, base_offset, max_segment_size_bytes_);
-    return Ok(std::move(segment));
-  } catch (const std::exception& e) {
-    return Error<std::shared_ptr<Segment>>(absl::StatusCode::kInternal,
-                                           "Failed to create segment: " + std::string(e.what()));
-  }
-}
-
-int64_t LogDir::GetNextSegmentNumber(const std::string& topic, int32_t partition) const noexcept {
-  auto segments_result = GetSegments(topic, partition);
-  if (!segments_result.ok() || segments_result.value().empty()) {
-    return 0;
-  }
-
-  // Get the highest segment number and increment
-  int64_t max_segment = 0;
-  for (const auto& segment : segments_result.value()) {
-    // Extract segment number from path (simplified)
-    max_segment = std::max(max_segment, segment->BaseOffset() / 1000); // Rough estimation
-  }
+  std::lock_guard<common::InstrumentedMutex> lock(create_mutex_);
+  auto updated = std::make_shared<PartitionMap>(*partitions_.load(std::memory_order_acquire));
+  (*updated)[tp] = std::move(partition);
+  partitions_.store(std::move(updated), std::memory_order_release);
 
-  return max_segment + 1;
+  return absl::OkStatus();
 }
 
 } // namespace streamit::storage
@@ -0,0 +1,129 @@
+#include "streamit/storage/offset_checkpoint.h"
+#include "streamit/common/crc32.h"
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <unistd.h>
+
+namespace streamit::storage {
+
+namespace {
+
+// File layout: magic, version, partition count, then per partition its topic name (length-prefixed),
+// partition number, next offset and high water mark; a CRC32 of everything before it closes the file
+constexpr uint32_t kCheckpointMagic = 0x4F434B50; // "OCKP"
+constexpr uint32_t kCheckpointVersion = 1;
+
+template <typename T>
+void Put(std::vector<std::byte>& data, T value) {
+  data.insert(data.end(), reinterpret_cast<const std::byte*>(&value),
+              reinterpret_cast<const std::byte*>(&value) + sizeof(value));
+}
+
+template <typename T>
+bool Take(std::span<const std::byte>& data, T& value) {
+  if (data.size() < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(&value, data.data(), sizeof(T));
+  data = data.subspan(sizeof(T));
+  return true;
+}
+
+} // namespace
+
+OffsetCheckpoint::OffsetCheckpoint(std::filesystem::path path) : path_(std::move(path)) {
+}
+
+absl::Status OffsetCheckpoint::Write(const std::vector<PartitionOffsets>& offsets) const noexcept {
+  std::vector<std::byte> data;
+  Put(data, kCheckpointMagic);
+  Put(data, kCheckpointVersion);
+  Put(data, static_cast<int32_t>(offsets.size()));
+  for (const auto& entry : offsets) {
+    Put(data, static_cast<int32_t>(entry.topic.size()));
+    auto topic = std::as_bytes(std::span(entry.topic.data(), entry.topic.size()));
+    data.insert(data.end(), topic.begin(), topic.end());
+    Put(data, entry.partition);
+    Put(data, entry.next_offset);
+    Put(data, entry.high_watermark);
+  }
+  Put(data, common::Crc32::Compute(data));
+
+  auto tmp_path = path_;
+  tmp_path += ".tmp";
+
+  int fd = open(tmp_path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+  if (fd < 0) {
+    return absl::Status(absl::StatusCode::kInternal, "Failed to create checkpoint file: " + tmp_path.string());
+  }
+
+  ssize_t bytes_written = write(fd, data.data(), data.size());
+  bool synced = fsync(fd) == 0;
+  close(fd);
+  if (bytes_written != static_cast<ssize_t>(data.size()) || !synced) {
+    std::filesystem::remove(tmp_path);
+    return absl::Status(absl::StatusCode::kInternal, "Failed to write checkpoint file: " + tmp_path.string());
+  }
+
+  if (rename(tmp_path.c_str(), path_.c_str()) < 0) {
+    std::filesystem::remove(tmp_path);
+    return absl::Status(absl::StatusCode::kInternal, "Failed to rename checkpoint file: " + path_.string());
+  }
+
+  return absl::OkStatus();
+}
+
+common::Result<std::vector<PartitionOffsets>> OffsetCheckpoint::Read() const noexcept {
+  using Offsets = std::vector<PartitionOffsets>;
+
+  std::ifstream file(path_, std::ios::binary);
+  if (!file.is_open()) {
+    return common::Error<Offsets>(absl::StatusCode::kNotFound, "Checkpoint file not found: " + path_.string());
+  }
+
+  std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  std::span<const std::byte> data(reinterpret_cast<const std::byte*>(contents.data()), contents.size());
+
+  // Check the trailing CRC before trusting any length field
+  uint32_t crc32;
+  if (data.size() < sizeof(crc32)) {
+    return common::Error<Offsets>(absl::StatusCode::kDataLoss, "Checkpoint file truncated");
+  }
+  std::memcpy(&crc32, data.data() + data.size() - sizeof(crc32), sizeof(crc32));
+  data = data.first(data.size() - sizeof(crc32));
+  if (common::Crc32::Compute(data) != crc32) {
+    return common::Error<Offsets>(absl::StatusCode::kDataLoss, "Checkpoint file CRC32 mismatch");
+  }
+
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  int32_t count = 0;
+  if (!Take(data, magic) || !Take(data, version) || magic != kCheckpointMagic || version != kCheckpointVersion ||
+      !Take(data, count) || count < 0) {
+    return common::Error<Offsets>(absl::StatusCode::kDataLoss, "Invalid checkpoint header");
+  }
+
+  Offsets offsets;
+  offsets.reserve(count);
+  for (int32_t i = 0; i < count; ++i) {
+    PartitionOffsets entry;
+    int32_t topic_size = 0;
+    if (!Take(data, topic_size) || topic_size < 0 || data.size() < static_cast<size_t>(topic_size)) {
+      return common::Error<Offsets>(absl::StatusCode::kDataLoss, "Invalid checkpoint topic");
+    }
+    entry.topic.assign(reinterpret_cast<const char*>(data.data()), topic_size);
+    data = data.subspan(topic_size);
+
+    if (!Take(data, entry.partition) || !Take(data, entry.next_offset) || !Take(data, entry.high_watermark)) {
+      return common::Error<Offsets>(absl::StatusCode::kDataLoss, "Checkpoint file truncated");
+    }
+    offsets.push_back(std::move(entry));
+  }
+
+  return common::Ok(std::move(offsets));
+}
+
+} // namespace streamit::storage
@@ -0,0 +1,241 @@
+#include "streamit/storage/partition.h"
+#include <algorithm>
+#include <string>
+
+namespace streamit::storage {
+
+Partition::Partition(common::TopicPartition id, std::filesystem::path path, size_t max_segment_size_bytes,
+                     SegmentList segments, int64_t next_segment_number, common::Executor* background)
+    : id_(id), path_(std::move(path)), max_segment_size_bytes_(max_segment_size_bytes), background_(background),
+      segments_(std::make_shared<const SegmentList>(std::move(segments))), next_segment_number_(next_segment_number) {
+}
+
+common::TopicPartition Partition::Id() const noexcept {
+  return id_;
+}
+
+const std::filesystem::path& Partition::Path() const noexcept {
+  return path_;
+}
+
+std::shared_ptr<const Partition::SegmentList> Partition::Segments() const noexcept {
+  return segments_.load(std::memory_order_acquire);
+}
+
+Partition::SegmentList::const_iterator Partition::FindSegment(const SegmentList& segments, int64_t offset) noexcept {
+  // Last segment starting at or before the offset; base offsets only grow, so the list is sorted by them
+  auto it = std::upper_bound(segments.begin(), segments.end(), offset,
+                             [](int64_t target, const std::shared_ptr<Segment>& segment) {
+                               return target < segment->BaseOffset();
+                             });
+  if (it == segments.begin()) {
+    return segments.end();
+  }
+
+  --it;
+  return offset < (*it)->EndOffset() ? it : segments.end();
+}
+
+common::Result<std::shared_ptr<Segment>> Partition::ActiveSegment() noexcept {
+  // Fast path: the current segment still takes appends
+  auto segments = Segments();
+  if (!segments->empty() && !NeedsRoll(*segments->back())) {
+    return common::Ok(std::shared_ptr<Segment>(segments->back()));
+  }
+
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  // Another appender may have rolled while we waited
+  segments = Segments();
+  if (!segments->empty() && !NeedsRoll(*segments->back())) {
+    return common::Ok(std::shared_ptr<Segment>(segments->back()));
+  }
+
+  return RollLocked();
+}
+
+common::Result<Partition::AppendResult> Partition::Append(std::span<const Record> records, int64_t producer_id,
+                                                         int64_t sequence) noexcept {
+  for (int attempt = 1;; ++attempt) {
+    auto segment_result = ActiveSegment();
+    if (!segment_result.ok()) {
+      return common::Error<AppendResult>(segment_result.status());
+    }
+    auto segment = std::move(segment_result.value());
+
+    auto append_result = segment->Append(records, producer_id, sequence);
+    if (append_result.ok()) {
+      MaybePrepareSpare(*segment);
+      return common::Ok(AppendResult{append_result.value(), std::move(segment)});
+    }
+
+    // A batch that overflows an empty segment would overflow the next one too
+    bool overflowed = append_result.status().code() == absl::StatusCode::kResourceExhausted;
+    if (!overflowed || segment->EndOffset() == segment->BaseOffset() || attempt == kMaxAppendAttempts) {
+      return common::Error<AppendResult>(append_result.status());
+    }
+
+    auto roll_status = RollPast(*segment);
+    if (!roll_status.ok()) {
+      return common::Error<AppendResult>(roll_status);
+    }
+  }
+}
+
+common::Result<std::shared_ptr<Segment>> Partition::Roll() noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+  return RollLocked();
+}
+
+int64_t Partition::EndOffset() const noexcept {
+  auto segments = Segments();
+  return segments->empty() ? 0 : segments->back()->EndOffset();
+}
+
+int64_t Partition::HighWaterMark() const noexcept {
+  return high_water_mark_.load(std::memory_order_acquire);
+}
+
+void Partition::SetHighWaterMark(int64_t offset) noexcept {
+  int64_t current = high_water_mark_.load(std::memory_order_relaxed);
+  while (current < offset &&
+         !high_water_mark_.compare_exchange_weak(current, offset, std::memory_order_release,
+                                                 std::memory_order_relaxed)) {
+  }
+}
+
+absl::Status Partition::Cleanup(int64_t retention_bytes) noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  auto segments = Segments();
+  if (segments->size() <= 1) {
+    return absl::OkStatus(); // Keep at least one segment
+  }
+
+  // Calculate total size and remove old segments
+  size_t total_size = 0;
+  size_t segments_to_keep = 1; // Always keep the last segment
+
+  for (auto segment_it = segments->rbegin() + 1; segment_it != segments->rend(); ++segment_it) {
+    total_size += (*segment_it)->Size();
+    if (total_size > static_cast<size_t>(retention_bytes)) {
+      break;
+    }
+    ++segments_to_keep;
+  }
+
+  // Fetches still holding the old list keep reading the dropped segments until they finish
+  if (segments_to_keep < segments->size()) {
+    auto kept = std::make_shared<const SegmentList>(segments->end() - segments_to_keep, segments->end());
+    segments_.store(std::move(kept), std::memory_order_release);
+  }
+
+  return absl::OkStatus();
+}
+
+bool Partition::NeedsRoll(const Segment& segment) noexcept {
+  return segment.IsFull() || segment.IsClosed();
+}
+
+common::Result<std::shared_ptr<Segment>> Partition::CreateSegment(int64_t number, int64_t base_offset) noexcept {
+  std::string segment_name = std::to_string(number);
+  auto log_path = path_ / (segment_name + ".log");
+  auto index_path = path_ / (segment_name + ".index");
+
+  try {
+    std::filesystem::create_directories(path_);
+    return common::Ok(std::make_shared<Segment>(log_path, index_path, base_offset, max_segment_size_bytes_));
+  } catch (const std::exception& e) {
+    return common::Error<std::shared_ptr<Segment>>(absl::StatusCode::kInternal,
+                                                   "Failed to create segment: " + std::string(e.what()));
+  }
+}
+
+absl::Status Partition::RollPast(const Segment& full) noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  auto segments = Segments();
+  if (segments->empty() || segments->back().get() != &full) {
+    return absl::OkStatus(); // Another appender already rolled
+  }
+
+  return RollLocked().status();
+}
+
+void Partition::MaybePrepareSpare(const Segment& active) noexcept {
+  if (!background_ || spare_requested_.load(std::memory_order_relaxed) ||
+      active.Size() < max_segment_size_bytes_ / 4 * 3) {
+    return;
+  }
+  if (spare_requested_.exchange(true, std::memory_order_acq_rel)) {
+    return; // Another appender got here first
+  }
+
+  int64_t number;
+  {
+    std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+    number = next_segment_number_++;
+    spare_pending_ = true;
+  }
+
+  // The task must not keep a dropped partition alive
+  std::weak_ptr<Partition> weak = weak_from_this();
+  bool posted = background_->Post([weak, number] {
+    if (auto partition = weak.lock()) {
+      partition->CreateSpare(number);
+    }
+  });
+  if (!posted) {
+    std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+    spare_pending_ = false;
+    spare_requested_.store(false, std::memory_order_release);
+  }
+}
+
+void Partition::CreateSpare(int64_t number) noexcept {
+  // File creation and preallocation happen here, outside mutex_
+  auto segment_result = CreateSegment(number, Segment::kUnassignedBaseOffset);
+
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+  spare_pending_ = false;
+  if (segment_result.ok()) {
+    spare_ = std::move(segment_result.value());
+  } else {
+    spare_requested_.store(false, std::memory_order_release); // A later append asks again
+  }
+}
+
+common::Result<std::shared_ptr<Segment>> Partition::RollLocked() noexcept {
+  auto segments = Segments();
+
+  // The new segment starts where the current one ends
+  int64_t base_offset = segments->empty() ? 0 : segments->back()->EndOffset();
+
+  // Take over the spare if it is ready; otherwise create the segment here
+  std::shared_ptr<Segment> segment;
+  if (spare_ && spare_->Rebase(base_offset).ok()) {
+    segment = std::move(spare_);
+  } else {
+    auto segment_result = CreateSegment(next_segment_number_, base_offset);
+    if (!segment_result.ok()) {
+      return segment_result;
+    }
+    segment = std::move(segment_result.value());
+    ++next_segment_number_;
+  }
+  spare_.reset();
+
+  // A spare still being created serves the next roll, so only ask for another if none is on its way
+  if (!spare_pending_) {
+    spare_requested_.store(false, std::memory_order_release);
+  }
+
+  // Publish a copy with the new segment appended; readers of the old list are unaffected
+  auto rolled = std::make_shared<SegmentList>(*segments);
+  rolled->push_back(segment);
+  segments_.store(std::move(rolled), std::memory_order_release);
+
+  return common::Ok(std::move(segment));
+}
+
+} // namespace streamit::storage
@@ -86,25 +86,7 @@ void RecordBatch::ComputeCrc32() noexcept {
   // Serialize the batch without CRC32 for computing CRC32
   std::vector<std::byte> data;
   data.reserve(SerializedSize() - sizeof(crc32));
-
-  // Serialize base offset
-  data.insert(data.end(), reinterpret_cast<const std::byte*>(&base_offset),
-              reinterpret_cast<const std::byte*>(&base_offset) + sizeof(base_offset));
-
-  // Serialize timestamp
-  data.insert(data.end(), reinterpret_cast<const std::byte*>(&timestamp_ms),
-              reinterpret_cast<const std::byte*>(&timestamp_ms) + sizeof(timestamp_ms));
-
-  // Serialize record count
-  int32_t record_count = static_cast<int32_t>(records.size());
-  data.insert(data.end(), reinterpret_cast<const std::byte*>(&record_count),
-              reinterpret_cast<const std::byte*>(&record_count) + sizeof(record_count));
-
-  // Serialize records
-  for (const auto& record : records) {
-    auto record_data = record.Serialize();
-    data.insert(data.end(), record_data.begin(), record_data.end());
-  }
+  SerializeBody(data);
 
   crc32 = streamit::common::Crc32::Compute(data);
 }
@@ -113,31 +95,14 @@ bool RecordBatch::VerifyCrc32() const noexcept {
   // Serialize the batch without CRC32 for verification
   std::vector<std::byte> data;
   data.reserve(SerializedSize() - sizeof(crc32));
-
-  // Serialize base offset
-  data.insert(data.end(), reinterpret_cast<const std::byte*>(&base_offset),
-              reinterpret_cast<const std::byte*>(&base_offset) + sizeof(base_offset));
-
-  // Serialize timestamp
-  data.insert(data.end(), reinterpret_cast<const std::byte*>(&timestamp_ms),
-              reinterpret_cast<const std::byte*>(&timestamp_ms) + sizeof(timestamp_ms));
-
-  // Serialize record count
-  int32_t record_count = static_cast<int32_t>(records.size());
-  data.insert(data.end(), reinterpret_cast<const std::byte*>(&record_count),
-              reinterpret_cast<const std::byte*>(&record_count) + sizeof(record_count));
-
-  // Serialize records
-  for (const auto& record : records) {
-    auto record_data = record.Serialize();
-    data.insert(data.end(), record_data.begin(), record_data.end());
-  }
+  SerializeBody(data);
 
   return streamit::common::Crc32::Compute(data) == crc32;
 }
 
 size_t RecordBatch::SerializedSize() const noexcept {
-  size_t size = sizeof(base_offset) + sizeof(timestamp_ms) + sizeof(int32_t) + sizeof(crc32);
+  size_t size = sizeof(base_offset) + sizeof(timestamp_ms) + sizeof(producer_id) + sizeof(sequence) +
+                sizeof(int32_t) + sizeof(crc32);
   for (const auto& record : records) {
     size += record.SerializedSize();
   }
@@ -147,7 +112,16 @@ size_t RecordBatch::SerializedSize() const noexcept {
 std::vector<std::byte> RecordBatch::Serialize() const {
   std::vector<std::byte> data;
   data.reserve(SerializedSize());
+  SerializeBody(data);
 
+  // Serialize CRC32
+  data.insert(data.end(), reinterpret_cast<const std::byte*>(&crc32),
+              reinterpret_cast<const std::byte*>(&crc32) + sizeof(crc32));
+
+  return data;
+}
+
+void RecordBatch::SerializeBody(std::vector<std::byte>& data) const {
   // Serialize base offset
   data.insert(data.end(), reinterpret_cast<const std::byte*>(&base_offset),
               reinterpret_cast<const std::byte*>(&base_offset) + sizeof(base_offset));
@@ -156,6 +130,12 @@ std::vector<std::byte> RecordBatch::Serialize() const {
   data.insert(data.end(), reinterpret_cast<const std::byte*>(&timestamp_ms),
               reinterpret_cast<const std::byte*>(&timestamp_ms) + sizeof(timestamp_ms));
 
+  // Serialize producer id and sequence
+  data.insert(data.end(), reinterpret_cast<const std::byte*>(&producer_id),
+              reinterpret_cast<const std::byte*>(&producer_id) + sizeof(producer_id));
+  data.insert(data.end(), reinterpret_cast<const std::byte*>(&sequence),
+              reinterpret_cast<const std::byte*>(&sequence) + sizeof(sequence));
+
   // Serialize record count
   int32_t record_count = static_cast<int32_t>(records.size());
   data.insert(data.end(), reinterpret_cast<const std::byte*>(&record_count),
@@ -166,16 +146,11 @@ std::vector<std::byte> RecordBatch::Serialize() const {
     auto record_data = record.Serialize();
     data.insert(data.end(), record_data.begin(), record_data.end());
   }
-
-  // Serialize CRC32
-  data.insert(data.end(), reinterpret_cast<const std::byte*>(&crc32),
-              reinterpret_cast<const std::byte*>(&crc32) + sizeof(crc32));
-
-  return data;
 }
 
 RecordBatch RecordBatch::Deserialize(std::span<const std::byte> data) {
-  if (data.size() < sizeof(int64_t) + sizeof(int64_t) + sizeof(int32_t) + sizeof(uint32_t)) {
+  if (data.size() <
+      sizeof(int64_t) + sizeof(int64_t) + sizeof(int64_t) + sizeof(int64_t) + sizeof(int32_t) + sizeof(uint32_t)) {
     throw std::runtime_error("Invalid batch data: too short");
   }
 
@@ -191,6 +166,15 @@ RecordBatch RecordBatch::Deserialize(std::span<const std::byte> data) {
   std::memcpy(&timestamp_ms, data.data() + offset, sizeof(timestamp_ms));
   offset += sizeof(timestamp_ms);
 
+  // Deserialize producer id and sequence
+  int64_t producer_id;
+  std::memcpy(&producer_id, data.data() + offset, sizeof(producer_id));
+  offset += sizeof(producer_id);
+
+  int64_t sequence;
+  std::memcpy(&sequence, data.data() + offset, sizeof(sequence));
+  offset += sizeof(sequence);
+
   // Deserialize record count
   int32_t record_count;
   std::memcpy(&record_count, data.data() + offset, sizeof(record_count));
@@ -243,7 +227,7 @@ RecordBatch RecordBatch::Deserialize(std::span<const std::byte> data) {
   uint32_t crc32;
   std::memcpy(&crc32, data.data() + offset, sizeof(crc32));
 
-  RecordBatch batch(base_offset, std::move(records), timestamp_ms);
+  RecordBatch batch(base_offset, std::move(records), timestamp_ms, producer_id, sequence);
   batch.crc32 = crc32;
 
   if (!batch.VerifyCrc32()) {
@@ -4,6 +4,7 @@
 #include <chrono>
 #include <cstring>
 #include <fcntl.h>
+#include <string>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -36,9 +37,6 @@ Segment::Segment(std::filesystem::path log_path, std::filesystem::path index_pat
     throw std::runtime_error("Failed to write segment header: " + header_result.status().message());
   }
 
-  // Create manifest manager
-  manifest_manager_ = std::make_unique<ManifestManager>(log_path_.parent_path());
-
   // Preallocate space for better performance
   auto prealloc_result = Preallocate(max_size_bytes_);
   if (!prealloc_result.ok()) {
@@ -80,12 +78,9 @@ Segment::Segment(std::filesystem::path log_path, std::filesystem::path index_pat
   }
 
   // Get current file positions
-  log_position_ = lseek(log_fd_, 0, SEEK_END);
+  log_position_.store(lseek(log_fd_, 0, SEEK_END), std::memory_order_release);
   index_position_ = lseek(index_fd_, 0, SEEK_END);
 
-  // Create manifest manager
-  manifest_manager_ = std::make_unique<ManifestManager>(log_path_.parent_path());
-
   // Recover from crash if needed
   auto recover_result = RecoverTail();
   if (!recover_result.ok()) {
@@ -106,9 +101,11 @@ Segment::~Segment() {
 
 Segment::Segment(Segment&& other) noexcept
     : log_path_(std::move(other.log_path_)), index_path_(std::move(other.index_path_)),
-      base_offset_(other.base_offset_), max_size_bytes_(other.max_size_bytes_), end_offset_(other.end_offset_),
-      closed_(other.closed_), log_fd_(other.log_fd_), index_fd_(other.index_fd_), log_position_(other.log_position_),
-      index_position_(other.index_position_), index_entries_(std::move(other.index_entries_)) {
+      base_offset_(other.base_offset_), max_size_bytes_(other.max_size_bytes_),
+      end_offset_(other.end_offset_.load(std::memory_order_relaxed)),
+      closed_(other.closed_.load(std::memory_order_relaxed)), log_fd_(other.log_fd_), index_fd_(other.index_fd_),
+      log_position_(other.log_position_.load(std::memory_order_relaxed)), index_position_(other.index_position_),
+      index_entries_(std::move(other.index_entries_)) {
 
   other.log_fd_ = -1;
   other.index_fd_ = -1;
@@ -125,11 +122,11 @@ Segment& Segment::operator=(Segment&& other) noexcept {
     index_path_ = std::move(other.index_path_);
     base_offset_ = other.base_offset_;
     max_size_bytes_ = other.max_size_bytes_;
-    end_offset_ = other.end_offset_;
-    closed_ = other.closed_;
+    end_offset_.store(other.end_offset_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    closed_.store(other.closed_.load(std::memory_order_relaxed), std::memory_order_relaxed);
     log_fd_ = other.log_fd_;
     index_fd_ = other.index_fd_;
-    log_position_ = other.log_position_;
+    log_position_.store(other.log_position_.load(std::memory_order_relaxed), std::memory_order_relaxed);
     index_position_ = other.index_position_;
     index_entries_ = std::move(other.index_entries_);
 
@@ -155,10 +152,18 @@ Result<std::unique_ptr<Segment>> Segment::Open(std::filesystem::path log_path, s
     return Error<std::unique_ptr<Segment>>(absl::StatusCode::kDataLoss, "Failed to read segment header");
   }
 
-  if (header.magic != SegmentHeader::kMagic || header.version != SegmentHeader::kVersion) {
+  if (header.magic != SegmentHeader::kMagic) {
     return Error<std::unique_ptr<Segment>>(absl::StatusCode::kDataLoss, "Invalid segment header");
   }
 
+  // Batches in another format would be misread, so refuse the segment rather than guess
+  if (header.version != SegmentHeader::kVersion) {
+    return Error<std::unique_ptr<Segment>>(absl::StatusCode::kFailedPrecondition,
+                                           "Unsupported segment format version " + std::to_string(header.version) +
+                                               " (expected " + std::to_string(SegmentHeader::kVersion) +
+                                               "): " + log_path.string());
+  }
+
   // Get file size to determine end offset
   struct stat st;
   if (stat(log_path.c_str(), &st) < 0) {
@@ -173,26 +178,29 @@ Result<std::unique_ptr<Segment>> Segment::Open(std::filesystem::path log_path, s
   return Ok(std::move(segment));
 }
 
-Result<int64_t> Segment::Append(std::span<const Record> records) noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+Result<int64_t> Segment::Append(std::span<const Record> records, int64_t producer_id, int64_t sequence) noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
-  if (closed_) {
+  if (closed_.load(std::memory_order_relaxed)) {
     return Error<int64_t>(absl::StatusCode::kFailedPrecondition, "Segment is closed");
   }
 
+  // Only appenders (holding mutex_) write the end offset
+  int64_t base_offset = end_offset_.load(std::memory_order_relaxed);
   if (records.empty()) {
-    return Ok(end_offset_);
+    return Ok(base_offset);
   }
 
   // Create record batch
   RecordBatch batch(
-      end_offset_, std::vector<Record>(records.begin(), records.end()),
+      base_offset, std::vector<Record>(records.begin(), records.end()),
       std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
-          .count());
+          .count(),
+      producer_id, sequence);
 
   // Check if segment would be too large
   size_t batch_size = batch.SerializedSize();
-  if (log_position_ + batch_size > max_size_bytes_) {
+  if (log_position_.load(std::memory_order_relaxed) + batch_size > max_size_bytes_) {
     return Error<int64_t>(absl::StatusCode::kResourceExhausted, "Segment would exceed max size");
   }
 
@@ -206,7 +214,8 @@ Result<int64_t> Segment::Append(std::span<const Record> records) noexcept {
   }
 
   // Create index entry
-  IndexEntry index_entry(end_offset_ - base_offset_, log_position_ - batch_size, batch_size);
+  IndexEntry index_entry(base_offset - base_offset_, log_position_.load(std::memory_order_relaxed) - batch_size,
+                         batch_size);
 
   // Write index entry
   auto index_result = WriteIndexEntry(index_entry);
@@ -214,9 +223,9 @@ Result<int64_t> Segment::Append(std::span<const Record> records) noexcept {
     return Error<int64_t>(index_result.status().code(), index_result.status().message());
   }
 
-  // Update end offset
-  int64_t base_offset = end_offset_;
-  end_offset_ += records.size();
+  // Publish the new end offset only once the batch and its index entry are written
+  int64_t end_offset = base_offset + static_cast<int64_t>(records.size());
+  end_offset_.store(end_offset, std::memory_order_release);
 
   // Flush if needed according to policy
   auto flush_result = FlushIfNeeded();
@@ -224,21 +233,39 @@ Result<int64_t> Segment::Append(std::span<const Record> records) noexcept {
     return Error<int64_t>(flush_result.status().code(), flush_result.status().message());
   }
 
-  // Update manifest
-  if (manifest_manager_) {
-    auto manifest_result = manifest_manager_->UpdateOffsets(end_offset_, end_offset_);
-    if (!manifest_result.ok()) {
-      // Log warning but don't fail the request
-    }
+  return Ok(base_offset);
+}
+
+absl::Status Segment::Rebase(int64_t base_offset) noexcept {
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+
+  if (end_offset_.load(std::memory_order_relaxed) != base_offset_ || !index_entries_.empty()) {
+    return absl::Status(absl::StatusCode::kFailedPrecondition, "Only an empty segment can be rebased");
   }
 
-  return Ok(base_offset);
+  SegmentHeader header;
+  header.base_offset = base_offset;
+  header.timestamp_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  header.magic = SegmentHeader::kMagic;
+  header.version = SegmentHeader::kVersion;
+
+  // The header sits at the start of the file; pwrite leaves the append position alone
+  if (pwrite(log_fd_, &header, sizeof(header), 0) != sizeof(header)) {
+    return absl::Status(absl::StatusCode::kInternal, "Failed to rewrite segment header");
+  }
+
+  base_offset_ = base_offset;
+  end_offset_.store(base_offset, std::memory_order_release);
+  return absl::OkStatus();
 }
 
 Result<std::vector<RecordBatch>> Segment::Read(int64_t from_offset, size_t max_bytes) const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
-  if (from_offset < base_offset_ || from_offset >= end_offset_) {
+  int64_t end_offset = end_offset_.load(std::memory_order_relaxed);
+  if (from_offset < base_offset_ || from_offset >= end_offset) {
     return Ok(std::vector<RecordBatch>{}); // Empty result for out-of-range
   }
 
@@ -256,7 +283,7 @@ Result<std::vector<RecordBatch>> Segment::Read(int64_t from_offset, size_t max_b
   for (size_t i = index_entry - index_entries_.data(); i < index_entries_.size(); ++i) {
     const auto& entry = index_entries_[i];
 
-    if (current_offset >= end_offset_) {
+    if (current_offset >= end_offset) {
       break;
     }
 
@@ -273,9 +300,9 @@ Result<std::vector<RecordBatch>> Segment::Read(int64_t from_offset, size_t max_b
     // Deserialize batch
     try {
       auto batch = RecordBatch::Deserialize(batch_data_result.value());
-      batches.push_back(std::move(batch));
       bytes_read += entry.batch_size;
       current_offset += batch.records.size();
+      batches.push_back(std::move(batch));
     } catch (const std::exception& e) {
       return Error<std::vector<RecordBatch>>(absl::StatusCode::kDataLoss,
                                              "Failed to deserialize batch: " + std::string(e.what()));
@@ -286,7 +313,7 @@ Result<std::vector<RecordBatch>> Segment::Read(int64_t from_offset, size_t max_b
 }
 
 Result<void> Segment::Flush() noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<common::InstrumentedMutex> lock(mutex_);
 
   if (fsync(log_fd_) < 0) {
     return Error<void>(absl::StatusCode::kInternal, "Failed to fsync log file");
@@ -300,8 +327,7 @@ Result<void> Segment::Flush() noexcept {
 }
 
 int64_t Segment::EndOffset() const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return end_offset_;
+  return end_offset_.load(std::memory_order_acquire);
 }
 
 int64_t Segment::BaseOffset() const noexcept {
@@ -309,35 +335,29 @@ int64_t Segment::BaseOffset() const noexcept {
 }
 
 bool Segment::IsFull() const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return log_position_ >= max_size_bytes_;
+  return static_cast<size_t>(log_position_.load(std::memory_order_acquire)) >= max_size_bytes_;
 }
 
 bool Segment::IsClosed() const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return closed_;
+  return closed_.load(std::memory_order_acquire);
 }
 
 Result<void> Segment::Close() noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
-
-  if (closed_) {
-    return Ok();
-  }
-
-  // Flush data
-  auto flush_result = Flush();
-  if (!flush_result.ok()) {
-    return flush_result;
+  {
+    // Stop appends first so nothing lands after the flush
+    std::lock_guard<common::InstrumentedMutex> lock(mutex_);
+    if (closed_.load(std::memory_order_relaxed)) {
+      return Ok();
+    }
+    closed_.store(true, std::memory_order_release);
   }
 
-  closed_ = true;
-  return Ok();
+  // Flush data (Flush takes mutex_ itself)
+  return Flush();
 }
 
 size_t Segment::Size() const noexcept {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return log_position_;
+  return static_cast<size_t>(log_position_.load(std::memory_order_acquire));
 }
 
 Result<void> Segment::WriteHeader() noexcept {
@@ -354,7 +374,7 @@ Result<void> Segment::WriteHeader() noexcept {
     return Error<void>(absl::StatusCode::kInternal, "Failed to write segment header");
   }
 
-  log_position_ += sizeof(header);
+  log_position_.fetch_add(sizeof(header), std::memory_order_release);
   return Ok();
 }
 
@@ -415,7 +435,7 @@ Result<void> Segment::WriteLogData(std::span<const std::byte> data) noexcept {
     return Error<void>(absl::StatusCode::kInternal, "Failed to write log data");
   }
 
-  log_position_ += data.size();
+  log_position_.fetch_add(static_cast<int64_t>(data.size()), std::memory_order_release);
   return Ok();
 }
 
@@ -512,12 +532,13 @@ Result<void> Segment::RecoverTail() noexcept {
     if (ftruncate(log_fd_, last_valid_pos) < 0) {
       return Error<void>(absl::StatusCode::kInternal, "Failed to truncate corrupted segment");
     }
-    log_position_ = last_valid_pos;
+    log_position_.store(last_valid_pos, std::memory_order_release);
 
     // Update end offset based on last valid batch
     if (!index_entries_.empty()) {
       const auto& last_entry = index_entries_.back();
-      end_offset_ = base_offset_ + last_entry.relative_offset + 1; // +1 for the batch itself
+      end_offset_.store(base_offset_ + last_entry.relative_offset + 1, // +1 for the batch itself
+                        std::memory_order_release);
     }
   }
 
@@ -12,6 +12,8 @@ std::vector<std::byte> Serializer::SerializeBatch(const RecordBatch& batch) noex
   // Write batch header
   WriteInt64(data, batch.base_offset);
   WriteInt64(data, batch.timestamp_ms);
+  WriteInt64(data, batch.producer_id);
+  WriteInt64(data, batch.sequence);
   WriteInt32(data, static_cast<int32_t>(batch.records.size()));
 
   // Write records
@@ -27,7 +29,8 @@ std::vector<std::byte> Serializer::SerializeBatch(const RecordBatch& batch) noex
 }
 
 Result<RecordBatch> Serializer::DeserializeBatch(std::span<const std::byte> data) noexcept {
-  if (data.size() < sizeof(int64_t) + sizeof(int64_t) + sizeof(int32_t) + sizeof(uint32_t)) {
+  if (data.size() <
+      sizeof(int64_t) + sizeof(int64_t) + sizeof(int64_t) + sizeof(int64_t) + sizeof(int32_t) + sizeof(uint32_t)) {
     return Error<RecordBatch>(absl::StatusCode::kInvalidArgument, "Data too short for batch");
   }
 
@@ -42,6 +45,14 @@ Result<RecordBatch> Serializer::DeserializeBatch(std::span<const std::byte> data
   if (!timestamp_result.ok())
     return Error<RecordBatch>(timestamp_result.status());
 
+  auto producer_id_result = ReadInt64(remaining_data);
+  if (!producer_id_result.ok())
+    return Error<RecordBatch>(producer_id_result.status());
+
+  auto sequence_result = ReadInt64(remaining_data);
+  if (!sequence_result.ok())
+    return Error<RecordBatch>(sequence_result.status());
+
   auto record_count_result = ReadInt32(remaining_data);
   if (!record_count_result.ok())
     return Error<RecordBatch>(record_count_result.status());
@@ -70,7 +81,7 @@ Result<RecordBatch> Serializer::DeserializeBatch(std::span<const std::byte> data
   uint32_t crc32 = crc32_result.value();
 
   // Create batch
-  RecordBatch batch(base_offset, std::move(records), timestamp_ms);
+  RecordBatch batch(base_offset, std::move(records), timestamp_ms, producer_id_result.value(), sequence_result.value());
   batch.crc32 = crc32;
 
   // Verify CRC32
@@ -151,7 +162,9 @@ Result<Record> Serializer::DeserializeRecord(std::span<const std::byte> data) no
 }
 
 size_t Serializer::GetBatchSize(const RecordBatch& batch) noexcept {
-  size_t size = sizeof(int64_t) + sizeof(int64_t) + sizeof(int32_t) + sizeof(uint32_t); // Header + CRC32
+  // Header (including producer id and sequence) + CRC32
+  size_t size =
+      sizeof(int64_t) + sizeof(int64_t) + sizeof(int64_t) + sizeof(int64_t) + sizeof(int32_t) + sizeof(uint32_t);
   for (const auto& record : batch.records) {
     size += GetRecordSize(record);
   }
@@ -101,7 +101,7 @@ TEST_F(BrokerIntegrationTest, SegmentRolling) {
 
 TEST_F(BrokerIntegrationTest, Idempotency) {
   // Test idempotent producer
-  streamit::broker::ProducerKey key{"producer1", "test-topic", 0};
+  streamit::broker::ProducerKey key{1, log_dir_->Topics()->Intern("test-topic"), 0};
   
   // First sequence should be valid
   EXPECT_TRUE(idempotency_table_->IsValidSequence(key, 0));
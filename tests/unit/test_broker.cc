@@ -1,6 +1,26 @@
 #include <gtest/gtest.h>
+#include "streamit/broker/bounded_idempotency_table.h"
+#include "streamit/broker/broker_service.h"
+#include "streamit/broker/fetch_waiters.h"
 #include "streamit/broker/idempotency_table.h"
+#include "streamit/broker/memory_budget.h"
+#include "streamit/broker/producer_id_manager.h"
+#include "streamit/broker/producer_snapshot.h"
+#include "streamit/broker/quota_manager.h"
+#include "streamit/broker/request_lanes.h"
+#include "streamit/broker/sequence_waiters.h"
+#include "streamit/common/metrics.h"
+#include "streamit/common/span.h"
+#include "streamit/common/task.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <grpcpp/grpcpp.h>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 namespace streamit::broker {
 namespace {
@@ -8,7 +28,7 @@ namespace {
 TEST(IdempotencyTableTest, IsValidSequence) {
   IdempotencyTable table;
   
-  ProducerKey key{"producer1", "topic1", 0};
+  ProducerKey key{1, 1, 0};
   
   // First sequence should be valid
   EXPECT_TRUE(table.IsValidSequence(key, 0));
@@ -18,6 +38,7 @@ TEST(IdempotencyTableTest, IsValidSequence) {
   
   // Next sequence should be valid
   EXPECT_TRUE(table.IsValidSequence(key, 1));
+  table.UpdateSequence(key, 1, 200);
   
   // Same sequence should be invalid
   EXPECT_FALSE(table.IsValidSequence(key, 1));
@@ -26,10 +47,56 @@ TEST(IdempotencyTableTest, IsValidSequence) {
   EXPECT_FALSE(table.IsValidSequence(key, 0));
 }
 
+TEST(IdempotencyTableTest, DuplicatesReturnOriginalOffset) {
+  IdempotencyTable table;
+  ProducerKey key{1, 1, 0};
+
+  // A producer may start at any sequence
+  EXPECT_EQ(table.CheckSequence(key, 7).status, SequenceStatus::kAccept);
+
+  // Pipelined batches are accepted in order
+  for (int64_t sequence = 7; sequence < 14; ++sequence) {
+    ASSERT_TRUE(table.IsValidSequence(key, sequence));
+    table.UpdateSequence(key, sequence, sequence * 100);
+  }
+
+  // Retries of the last kSize batches get their original offsets back
+  for (int64_t sequence = 9; sequence < 14; ++sequence) {
+    auto check = table.CheckSequence(key, sequence);
+    EXPECT_EQ(check.status, SequenceStatus::kDuplicate);
+    EXPECT_EQ(check.offset, sequence * 100);
+  }
+
+  // Anything older is no longer known. A batch less than a window ahead waits for the ones before it, and
+  // anything further ahead means a batch was lost.
+  EXPECT_EQ(table.CheckSequence(key, 8).status, SequenceStatus::kStale);
+  auto ahead = table.CheckSequence(key, 15);
+  EXPECT_EQ(ahead.status, SequenceStatus::kPending);
+  EXPECT_EQ(ahead.expected, 14);
+  EXPECT_EQ(table.CheckSequence(key, 18).status, SequenceStatus::kPending);
+  EXPECT_EQ(table.CheckSequence(key, 19).status, SequenceStatus::kOutOfOrder);
+}
+
+TEST(SequenceWindowTest, RestartsOnGap) {
+  SequenceWindow window;
+  EXPECT_EQ(window.LastSequence(), -1);
+
+  window.Record(0, 10);
+  window.Record(1, 20);
+  EXPECT_EQ(window.Size(), 2);
+
+  // A forced restart (e.g. an administrative reset) keeps only the new batch
+  window.Record(40, 30);
+  EXPECT_EQ(window.Size(), 1);
+  EXPECT_EQ(window.LastOffset(), 30);
+  EXPECT_EQ(window.Check(1).status, SequenceStatus::kStale);
+  EXPECT_EQ(window.Check(41).status, SequenceStatus::kAccept);
+}
+
 TEST(IdempotencyTableTest, UpdateSequence) {
   IdempotencyTable table;
   
-  ProducerKey key{"producer1", "topic1", 0};
+  ProducerKey key{1, 1, 0};
   
   table.UpdateSequence(key, 0, 100);
   EXPECT_EQ(table.GetLastSequence(key), 0);
@@ -43,9 +110,9 @@ TEST(IdempotencyTableTest, UpdateSequence) {
 TEST(IdempotencyTableTest, RemoveProducer) {
   IdempotencyTable table;
   
-  ProducerKey key1{"producer1", "topic1", 0};
-  ProducerKey key2{"producer1", "topic2", 0};
-  ProducerKey key3{"producer2", "topic1", 0};
+  ProducerKey key1{1, 1, 0};
+  ProducerKey key2{1, 2, 0};
+  ProducerKey key3{2, 1, 0};
   
   table.UpdateSequence(key1, 0, 100);
   table.UpdateSequence(key2, 0, 200);
@@ -53,7 +120,7 @@ TEST(IdempotencyTableTest, RemoveProducer) {
   
   EXPECT_EQ(table.Size(), 3);
   
-  table.RemoveProducer("producer1");
+  table.RemoveProducer(1);
   
   EXPECT_EQ(table.Size(), 1);
   EXPECT_EQ(table.GetLastSequence(key3), 0);
@@ -63,7 +130,7 @@ TEST(IdempotencyTableTest, RemoveProducer) {
 TEST(IdempotencyTableTest, Clear) {
   IdempotencyTable table;
   
-  ProducerKey key{"producer1", "topic1", 0};
+  ProducerKey key{1, 1, 0};
   table.UpdateSequence(key, 0, 100);
   
   EXPECT_EQ(table.Size(), 1);
@@ -76,12 +143,785 @@ TEST(IdempotencyTableTest, Clear) {
 TEST(IdempotencyTableTest, EmptyTable) {
   IdempotencyTable table;
   
-  ProducerKey key{"producer1", "topic1", 0};
+  ProducerKey key{1, 1, 0};
   
   EXPECT_EQ(table.GetLastSequence(key), -1);
   EXPECT_EQ(table.GetLastOffset(key), -1);
 }
 
-} 
-} 
+TEST(FetchWaitersTest, NotifyWakesWaiter) {
+  common::TimerService timers;
+  FetchWaiters waiters(timers);
+
+  std::thread producer([&waiters] {
+    while (waiters.Size() == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    waiters.Notify({1, 0}, 1);
+  });
+
+  auto wait = [&]() -> common::Task<bool> {
+    co_return co_await waiters.WaitForData({1, 0}, 0, std::chrono::milliseconds(5000));
+  };
+  EXPECT_TRUE(common::SyncWait(wait()));
+  producer.join();
+  EXPECT_EQ(waiters.Size(), 0);
+}
+
+TEST(FetchWaitersTest, TimesOutWithoutData) {
+  common::TimerService timers;
+  FetchWaiters waiters(timers);
+
+  auto wait = [&]() -> common::Task<bool> {
+    co_return co_await waiters.WaitForData({1, 0}, 0, std::chrono::milliseconds(10));
+  };
+  EXPECT_FALSE(common::SyncWait(wait()));
+
+  // Data that arrived before the wait is not missed
+  waiters.Notify({1, 0}, 5);
+  EXPECT_TRUE(common::SyncWait(wait()));
+}
+
+TEST(FetchWaitersTest, DoesNotParkOnceTimersStopped) {
+  common::TimerService timers;
+  FetchWaiters waiters(timers);
+  timers.Shutdown();
+
+  auto wait = [&]() -> common::Task<bool> {
+    co_return co_await waiters.WaitForData({1, 0}, 0, std::chrono::milliseconds(60000));
+  };
+  EXPECT_FALSE(common::SyncWait(wait()));
+  EXPECT_EQ(waiters.Size(), 0);
+}
+
+TEST(FetchWaitersTest, ShutdownWakesParkedFetches) {
+  common::TimerService timers;
+  FetchWaiters waiters(timers);
+
+  std::thread stopper([&waiters] {
+    while (waiters.Size() == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    waiters.Shutdown();
+  });
+
+  auto wait = [&]() -> common::Task<bool> {
+    co_return co_await waiters.WaitForData({1, 0}, 0, std::chrono::milliseconds(60000));
+  };
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(common::SyncWait(wait()));
+  stopper.join();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(10));
+
+  // Later fetches answer at once instead of parking
+  EXPECT_FALSE(common::SyncWait(wait()));
+  EXPECT_EQ(waiters.Size(), 0);
+}
+
+TEST(FetchWaitersTest, TopicWaiterWokenWhenTopicIsInterned) {
+  common::TimerService timers;
+  common::TopicRegistry topics;
+  FetchWaiters waiters(timers);
+
+  std::thread producer([&] {
+    while (waiters.Size() == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    (void)topics.Intern("orders");
+    waiters.NotifyTopic("orders");
+  });
+
+  auto wait = [&](std::chrono::milliseconds timeout) -> common::Task<bool> {
+    co_return co_await waiters.WaitForTopic(topics, "orders", timeout);
+  };
+  EXPECT_TRUE(common::SyncWait(wait(std::chrono::milliseconds(5000))));
+  producer.join();
+  EXPECT_EQ(waiters.Size(), 0);
+
+  // A topic that already exists does not park, and waiting never interns the name
+  EXPECT_TRUE(common::SyncWait(wait(std::chrono::milliseconds(60000))));
+  auto wait_unknown = [&]() -> common::Task<bool> {
+    co_return co_await waiters.WaitForTopic(topics, "made-up", std::chrono::milliseconds(10));
+  };
+  EXPECT_FALSE(common::SyncWait(wait_unknown()));
+  EXPECT_FALSE(topics.Find("made-up").has_value());
+  EXPECT_EQ(waiters.Size(), 0);
+}
+
+TEST(SequenceWaitersTest, WakesEachBatchWhenItsPredecessorLands) {
+  common::TimerService timers;
+  IdempotencyTable table;
+  SequenceWaiters waiters(table, timers);
+  ProducerKey key{1, 1, 0};
+  table.UpdateSequence(key, 0, 0);
+
+  // Batches 2 and 3 are parked behind batch 1
+  std::vector<std::thread> batches;
+  std::atomic<int> woken{0};
+  for (int64_t sequence = 3; sequence >= 2; --sequence) {
+    batches.emplace_back([&, sequence] {
+      auto wait = [&]() -> common::Task<bool> {
+        co_return co_await waiters.WaitForTurn(key, sequence, std::chrono::milliseconds(5000));
+      };
+      EXPECT_TRUE(common::SyncWait(wait()));
+      EXPECT_EQ(table.CheckSequence(key, sequence).status, SequenceStatus::kAccept);
+      woken.fetch_add(1);
+      table.UpdateSequence(key, sequence, sequence * 100);
+      waiters.Notify(key, sequence);
+    });
+  }
+  while (waiters.Size() < 2) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(woken.load(), 0);
+
+  // Landing batch 1 releases 2, which in turn releases 3
+  table.UpdateSequence(key, 1, 100);
+  waiters.Notify(key, 1);
+  for (auto& batch : batches) {
+    batch.join();
+  }
+  EXPECT_EQ(woken.load(), 2);
+  EXPECT_EQ(waiters.Size(), 0);
+  EXPECT_EQ(table.GetLastSequence(key), 3);
+}
+
+TEST(SequenceWaitersTest, TimesOutWhenPredecessorNeverLands) {
+  common::TimerService timers;
+  IdempotencyTable table;
+  SequenceWaiters waiters(table, timers);
+  ProducerKey key{1, 1, 0};
+  table.UpdateSequence(key, 0, 0);
+
+  auto wait = [&]() -> common::Task<bool> {
+    co_return co_await waiters.WaitForTurn(key, 2, std::chrono::milliseconds(10));
+  };
+  EXPECT_FALSE(common::SyncWait(wait()));
+  EXPECT_EQ(waiters.Size(), 0);
+
+  // No wait once the batch ahead is already in
+  table.UpdateSequence(key, 1, 100);
+  EXPECT_TRUE(common::SyncWait(wait()));
+}
+
+TEST(TokenBucketTest, ThrottlesUntilDebtIsRepaid) {
+  auto now = TokenBucket::Clock::now();
+  TokenBucket bucket(100, 100, now);
+
+  // An oversized request is admitted but leaves the bucket in debt
+  EXPECT_EQ(bucket.Delay(now).count(), 0);
+  bucket.Consume(150, now);
+  EXPECT_EQ(bucket.Delay(now).count(), 500);
+
+  // Refill at 100/s repays the debt
+  EXPECT_EQ(bucket.Delay(now + std::chrono::milliseconds(250)).count(), 250);
+  EXPECT_EQ(bucket.Delay(now + std::chrono::milliseconds(500)).count(), 0);
+}
+
+TEST(QuotaManagerTest, ThrottlesPerEntity) {
+  QuotaConfig config;
+  config.client.requests_per_sec = 2;
+  QuotaManager quotas(config);
+  auto now = QuotaManager::Clock::now();
+
+  QuotaSubject noisy{"", "10.0.0.1", "topic1"};
+  QuotaSubject quiet{"", "10.0.0.2", "topic1"};
+
+  EXPECT_FALSE(quotas.Acquire(noisy, 0, now).Throttled());
+  EXPECT_FALSE(quotas.Acquire(noisy, 0, now).Throttled());
+  EXPECT_FALSE(quotas.Acquire(noisy, 0, now).Throttled());
+
+  auto decision = quotas.Acquire(noisy, 0, now);
+  EXPECT_TRUE(decision.Throttled());
+  EXPECT_EQ(decision.entity, "client");
+  EXPECT_EQ(decision.throttle.count(), 500);
+
+  // Other clients are unaffected
+  EXPECT_FALSE(quotas.Acquire(quiet, 0, now).Throttled());
+}
+
+TEST(QuotaManagerTest, ByteQuotaAndDisabled) {
+  QuotaConfig config;
+  config.topic.bytes_per_sec = 1000;
+  QuotaManager quotas(config);
+  auto now = QuotaManager::Clock::now();
+
+  QuotaSubject subject{"producer1", "10.0.0.1", "topic1"};
+  EXPECT_FALSE(quotas.Acquire(subject, 0, now).Throttled());
+  quotas.RecordBytes(subject, 3000, now);
+
+  auto decision = quotas.Acquire(subject, 0, now);
+  EXPECT_EQ(decision.entity, "topic");
+  EXPECT_EQ(decision.throttle.count(), 2000);
+
+  // Only the topic quota is configured, so only topic buckets are tracked
+  EXPECT_EQ(quotas.Size(), 1);
+
+  QuotaManager unlimited(QuotaConfig{});
+  EXPECT_FALSE(unlimited.Enabled());
+  EXPECT_FALSE(unlimited.Acquire(subject, 1 << 30, now).Throttled());
+}
+
+TEST(QuotaManagerTest, ClientAddress) {
+  EXPECT_EQ(QuotaManager::ClientAddress("ipv4:10.0.0.1:5000"), "10.0.0.1");
+  EXPECT_EQ(QuotaManager::ClientAddress("ipv6:[::1]:5000"), "::1");
+  EXPECT_EQ(QuotaManager::ClientAddress(""), "");
+}
+
+TEST(MemoryBudgetTest, ReserveAndRelease) {
+  common::TimerService timers;
+  MemoryBudget budget(100, timers);
+
+  auto first = budget.TryReserve(60);
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(budget.Used(), 60);
+  EXPECT_FALSE(budget.TryReserve(50).has_value());
+
+  // Shrinking returns the unused part
+  first->Shrink(40);
+  EXPECT_EQ(budget.Used(), 40);
+  EXPECT_TRUE(budget.TryReserve(50).has_value());
+
+  // Requests larger than the budget are charged as the whole budget
+  first.reset();
+  auto oversized = budget.TryReserve(1000);
+  ASSERT_TRUE(oversized.has_value());
+  EXPECT_EQ(oversized->Bytes(), 100);
+}
+
+TEST(MemoryBudgetTest, WaiterGrantedOnRelease) {
+  common::TimerService timers;
+  MemoryBudget budget(100, timers);
+  auto held = budget.TryReserve(100);
+
+  std::thread releaser([&budget, &held] {
+    while (budget.Waiting() == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    held.reset();
+  });
+
+  auto reserve = [&]() -> common::Task<size_t> {
+    auto reservation = co_await budget.Reserve(80, std::chrono::milliseconds(5000));
+    co_return reservation ? reservation->Bytes() : 0;
+  };
+  EXPECT_EQ(common::SyncWait(reserve()), 80);
+  releaser.join();
+  EXPECT_EQ(budget.Used(), 0);
+}
+
+TEST(MemoryBudgetTest, WaiterTimesOut) {
+  common::TimerService timers;
+  MemoryBudget budget(100, timers);
+  auto held = budget.TryReserve(100);
+
+  auto reserve = [&]() -> common::Task<bool> {
+    auto reservation = co_await budget.Reserve(10, std::chrono::milliseconds(10));
+    co_return reservation.has_value();
+  };
+  EXPECT_FALSE(common::SyncWait(reserve()));
+  EXPECT_EQ(budget.Waiting(), 0);
+  EXPECT_EQ(budget.Used(), 100);
+}
+
+TEST(RequestLanesTest, ClassifiesFetchByLag) {
+  RequestLaneConfig config;
+  config.tail_fetch_max_lag = 100;
+  RequestLanes lanes(config);
+
+  EXPECT_EQ(lanes.ClassifyFetch(1000, 1000), RequestClass::kTailFetch);
+  EXPECT_EQ(lanes.ClassifyFetch(900, 1000), RequestClass::kTailFetch);
+  EXPECT_EQ(lanes.ClassifyFetch(899, 1000), RequestClass::kCatchUpFetch);
+  EXPECT_EQ(RequestLanes::Name(RequestClass::kCatchUpFetch), "catch_up_fetch");
+}
+
+TEST(RequestLanesTest, SaturatedLaneDoesNotBlockOthers) {
+  RequestLaneConfig config;
+  config.catch_up_fetch_threads = 1;
+  RequestLanes lanes(config);
+
+  // Park the only catch-up thread and queue more work behind it
+  std::atomic<bool> release{false};
+  for (int i = 0; i < 4; ++i) {
+    lanes.For(RequestClass::kCatchUpFetch).Post([&release] {
+      while (!release.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    });
+  }
+
+  auto produce = [&]() -> common::Task<bool> {
+    co_await lanes.For(RequestClass::kProduce).Schedule();
+    co_return common::Executor::Current() == &lanes.For(RequestClass::kProduce);
+  };
+  EXPECT_TRUE(common::SyncWait(produce()));
+  EXPECT_GT(lanes.For(RequestClass::kCatchUpFetch).QueueDepth(), 0);
+
+  release.store(true);
+  lanes.Shutdown();
+}
+
+TEST(RequestLanesTest, SlowFlushDoesNotBlockProduce) {
+  RequestLaneConfig config;
+  config.flush_threads = 1;
+  RequestLanes lanes(config);
+
+  // A stuck fsync and the ones queued behind it
+  std::atomic<bool> release{false};
+  for (int i = 0; i < 4; ++i) {
+    lanes.Flush().Post([&release] {
+      while (!release.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    });
+  }
+
+  auto produce = [&]() -> common::Task<bool> {
+    co_await lanes.For(RequestClass::kProduce).Schedule();
+    co_return common::Executor::Current() == &lanes.For(RequestClass::kProduce);
+  };
+  EXPECT_TRUE(common::SyncWait(produce()));
+  EXPECT_GT(lanes.Flush().QueueDepth(), 0);
+
+  release.store(true);
+  lanes.Shutdown();
+}
+
+// Broker service behind an in-process gRPC server
+class BrokerServiceTest : public ::testing::Test {
+protected:
+  void TearDown() override {
+    if (server_) {
+      server_->Shutdown();
+    }
+    server_.reset();
+    service_.reset();
+    std::filesystem::remove_all(root_);
+  }
+
+  void Start(BrokerServiceOptions options = {}) {
+    root_ = std::filesystem::temp_directory_path() / "streamit_broker_service_test";
+    std::filesystem::remove_all(root_);
+    std::filesystem::create_directories(root_);
+    log_dir_ = std::make_shared<storage::LogDir>(root_, 1024 * 1024);
+
+    options.producer_snapshot_interval = std::chrono::milliseconds(0);
+    options.checkpoint_interval = std::chrono::milliseconds(0);
+    service_ = std::make_unique<BrokerServiceImpl>(log_dir_, std::make_shared<IdempotencyTable>(), options);
+
+    grpc::ServerBuilder builder;
+    builder.RegisterService(service_.get());
+    server_ = builder.BuildAndStart();
+    ASSERT_NE(server_, nullptr);
+    stub_ = streamit::v1::Broker::NewStub(server_->InProcessChannel(grpc::ChannelArguments()));
+  }
+
+  std::filesystem::path root_;
+  std::shared_ptr<storage::LogDir> log_dir_;
+  std::unique_ptr<BrokerServiceImpl> service_;
+  std::unique_ptr<grpc::Server> server_;
+  std::unique_ptr<streamit::v1::Broker::Stub> stub_;
+};
+
+TEST_F(BrokerServiceTest, ShedsRequestsWhoseDeadlineExpiredInTheQueue) {
+  BrokerServiceOptions options;
+  options.lanes.produce_threads = 1;
+  options.lanes.tail_fetch_threads = 1;
+  Start(options);
 
+  auto shed = common::MetricsRegistry::Instance().CounterFamily("streamit_requests_shed_total", "");
+  auto produce_shed = shed->WithLabels({{"type", "produce"}, {"stage", "queue"}});
+  auto fetch_shed = shed->WithLabels({{"type", "tail_fetch"}, {"stage", "queue"}});
+  int64_t produce_shed_before = produce_shed->Value();
+  int64_t fetch_shed_before = fetch_shed->Value();
+
+  // Park both lanes so each request's deadline has passed by the time it is dequeued
+  std::atomic<bool> release{false};
+  auto park = [&release] {
+    while (!release.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  };
+  service_->LaneExecutor(RequestClass::kProduce).Post(park);
+  service_->LaneExecutor(RequestClass::kTailFetch).Post(park);
+
+  streamit::v1::ProduceRequest produce;
+  produce.set_topic("shed-topic");
+  produce.set_partition(0);
+  auto* record = produce.add_records();
+  record->set_key("key");
+  record->set_value("value");
+  grpc::ClientContext produce_context;
+  produce_context.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(100));
+  streamit::v1::ProduceResponse produce_response;
+  EXPECT_EQ(stub_->Produce(&produce_context, produce, &produce_response).error_code(),
+            grpc::StatusCode::DEADLINE_EXCEEDED);
+
+  streamit::v1::FetchRequest fetch;
+  fetch.set_topic("shed-topic");
+  fetch.set_partition(0);
+  fetch.set_offset(0);
+  fetch.set_max_bytes(1024);
+  grpc::ClientContext fetch_context;
+  fetch_context.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(100));
+  streamit::v1::FetchResponse fetch_response;
+  EXPECT_EQ(stub_->Fetch(&fetch_context, fetch, &fetch_response).error_code(), grpc::StatusCode::DEADLINE_EXCEEDED);
+
+  release.store(true);
+  auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while ((produce_shed->Value() == produce_shed_before || fetch_shed->Value() == fetch_shed_before) &&
+         std::chrono::steady_clock::now() < give_up) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(produce_shed->Value(), produce_shed_before + 1);
+  EXPECT_EQ(fetch_shed->Value(), fetch_shed_before + 1);
+
+  // Neither handler got as far as storage: the partition was never created, appended to or read
+  EXPECT_FALSE(log_dir_->Topics()->Find("shed-topic").has_value());
+}
+
+TEST_F(BrokerServiceTest, FetchesDoNotInternUnknownTopics) {
+  Start();
+  auto topics = log_dir_->Topics();
+  size_t topics_before = topics->Size();
+
+  auto fetch = [this](const std::string& topic, int64_t offset, int max_wait_ms) {
+    streamit::v1::FetchRequest request;
+    request.set_topic(topic);
+    request.set_partition(0);
+    request.set_offset(offset);
+    request.set_max_bytes(1024);
+    grpc::ClientContext context;
+    if (max_wait_ms > 0) {
+      context.AddMetadata("x-max-wait-ms", std::to_string(max_wait_ms));
+    }
+    streamit::v1::FetchResponse response;
+    EXPECT_TRUE(stub_->Fetch(&context, request, &response).ok());
+    return response;
+  };
+
+  // Fetches for names nobody has produced to answer as an empty log without assigning ids
+  EXPECT_EQ(fetch("made-up-1", 0, 0).error_code(), streamit::v1::OK);
+  EXPECT_EQ(fetch("made-up-2", 5, 0).error_code(), streamit::v1::OFFSET_OUT_OF_RANGE);
+  EXPECT_EQ(fetch("made-up-3", 0, 20).error_code(), streamit::v1::OK);
+  EXPECT_EQ(topics->Size(), topics_before);
+
+  // A long poll on a topic that does not exist yet is still answered by the first produce
+  streamit::v1::FetchResponse polled;
+  std::thread poller([&] { polled = fetch("late-topic", 0, 5000); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  streamit::v1::ProduceRequest produce;
+  produce.set_topic("late-topic");
+  produce.set_partition(0);
+  auto* record = produce.add_records();
+  record->set_key("key");
+  record->set_value("value");
+  grpc::ClientContext produce_context;
+  streamit::v1::ProduceResponse produce_response;
+  ASSERT_TRUE(stub_->Produce(&produce_context, produce, &produce_response).ok());
+  ASSERT_EQ(produce_response.error_code(), streamit::v1::OK);
+
+  poller.join();
+  EXPECT_EQ(polled.error_code(), streamit::v1::OK);
+  EXPECT_EQ(polled.batches_size(), 1);
+  EXPECT_EQ(topics->Size(), topics_before + 1);
+}
+
+TEST_F(BrokerServiceTest, FetchReservesOnlyWhatThePartitionHolds) {
+  BrokerServiceOptions options;
+  options.max_inflight_bytes = 64 * 1024 * 1024;
+  Start(options);
+
+  streamit::v1::ProduceRequest produce;
+  produce.set_topic("reserve-topic");
+  produce.set_partition(0);
+  auto* record = produce.add_records();
+  record->set_key("key");
+  record->set_value("value");
+  grpc::ClientContext produce_context;
+  streamit::v1::ProduceResponse produce_response;
+  ASSERT_TRUE(stub_->Produce(&produce_context, produce, &produce_response).ok());
+  ASSERT_EQ(produce_response.error_code(), streamit::v1::OK);
+
+  // A catch-up fetch asking for the whole budget
+  streamit::v1::FetchRequest fetch;
+  fetch.set_topic("reserve-topic");
+  fetch.set_partition(0);
+  fetch.set_offset(0);
+  fetch.set_max_bytes(static_cast<int32_t>(options.max_inflight_bytes));
+  grpc::ClientContext fetch_context;
+  streamit::v1::FetchResponse fetch_response;
+  ASSERT_TRUE(stub_->Fetch(&fetch_context, fetch, &fetch_response).ok());
+  ASSERT_EQ(fetch_response.error_code(), streamit::v1::OK);
+  EXPECT_EQ(fetch_response.batches_size(), 1);
+
+  // The gauge was last set right after the fetch reserved, and that reservation covered one small segment
+  auto inflight = common::MetricsRegistry::Instance().GaugeFamily("streamit_inflight_bytes", "")->WithLabels({});
+  EXPECT_LT(inflight->Value(), 64 * 1024);
+}
+
+TEST_F(BrokerServiceTest, PipelinedBatchesArrivingInReverseOrderAllSucceed) {
+  Start();
+
+  auto produce = [this](int64_t sequence) {
+    streamit::v1::ProduceRequest request;
+    request.set_topic("pipeline-topic");
+    request.set_partition(0);
+    request.set_producer_id(7);
+    request.set_sequence(sequence);
+    auto* record = request.add_records();
+    record->set_key("key");
+    record->set_value(std::to_string(sequence));
+
+    grpc::ClientContext context;
+    streamit::v1::ProduceResponse response;
+    EXPECT_TRUE(stub_->Produce(&context, request, &response).ok());
+    return response;
+  };
+
+  // The first batch fixes where the producer's sequence starts
+  ASSERT_EQ(produce(0).error_code(), streamit::v1::OK);
+
+  // A full window sent newest first, so every batch but the last arrives ahead of the one the broker expects
+  constexpr int64_t kWindow = static_cast<int64_t>(SequenceWindow::kSize);
+  std::vector<streamit::v1::ProduceResponse> responses(kWindow + 1);
+  std::vector<std::thread> clients;
+  for (int64_t sequence = kWindow; sequence >= 1; --sequence) {
+    clients.emplace_back([&, sequence] { responses[sequence] = produce(sequence); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  for (auto& client : clients) {
+    client.join();
+  }
+
+  // Every batch succeeds, at offsets in sequence order rather than arrival order
+  for (int64_t sequence = 1; sequence <= kWindow; ++sequence) {
+    EXPECT_EQ(responses[sequence].error_code(), streamit::v1::OK) << responses[sequence].error_message();
+    EXPECT_EQ(responses[sequence].base_offset(), sequence);
+  }
+}
+
+TEST_F(BrokerServiceTest, LegacyTraceIdIsContinuedAndEchoed) {
+  Start();
+
+  constexpr std::string_view kTraceId = "0af7651916cd43dd8448eb211c80319c";
+  streamit::v1::ProduceRequest request;
+  request.set_topic("trace-topic");
+  request.set_partition(0);
+  auto* record = request.add_records();
+  record->set_key("key");
+  record->set_value("value");
+
+  // An older client sends only x-trace-id, without a traceparent
+  grpc::ClientContext context;
+  context.AddMetadata("x-trace-id", std::string(kTraceId));
+  streamit::v1::ProduceResponse response;
+  ASSERT_TRUE(stub_->Produce(&context, request, &response).ok());
+
+  // The server span joined the caller's trace and returns it in both forms
+  const auto& metadata = context.GetServerInitialMetadata();
+  auto legacy = metadata.find("x-trace-id");
+  ASSERT_NE(legacy, metadata.end());
+  EXPECT_EQ(std::string_view(legacy->second.data(), legacy->second.length()), kTraceId);
+
+  auto traceparent = metadata.find("traceparent");
+  ASSERT_NE(traceparent, metadata.end());
+  auto span = common::ParseTraceparent(std::string_view(traceparent->second.data(), traceparent->second.length()));
+  ASSERT_TRUE(span.has_value());
+  EXPECT_EQ(span->trace_id.ToString(), kTraceId);
+}
+
+TEST(BoundedIdempotencyTableTest, EvictsLeastRecentlyUsed) {
+  BoundedIdempotencyTable table(2, std::chrono::milliseconds(60000));
+
+  ProducerKey key1{1, 1, 0};
+  ProducerKey key2{2, 1, 0};
+  ProducerKey key3{3, 1, 0};
+
+  table.UpdateSequence(key1, 0, 100);
+  table.UpdateSequence(key2, 0, 200);
+
+  // Touching key1 makes key2 the eviction candidate
+  EXPECT_TRUE(table.IsValidSequence(key1, 1));
+  table.UpdateSequence(key3, 0, 300);
+
+  EXPECT_EQ(table.Size(), 2);
+  EXPECT_EQ(table.GetLastOffset(key1), 100);
+  EXPECT_EQ(table.GetLastOffset(key2), -1);
+  EXPECT_EQ(table.GetLastOffset(key3), 300);
+
+  // Updating an existing key at capacity does not evict anything
+  table.UpdateSequence(key3, 1, 400);
+  EXPECT_EQ(table.Size(), 2);
+
+  // Retained batches survive LRU touches
+  auto check = table.CheckSequence(key3, 0);
+  EXPECT_EQ(check.status, SequenceStatus::kDuplicate);
+  EXPECT_EQ(check.offset, 300);
+}
+
+TEST(BoundedIdempotencyTableTest, ExpiresAfterTtl) {
+  BoundedIdempotencyTable table(100, std::chrono::milliseconds(20));
+
+  ProducerKey key{1, 1, 0};
+  table.UpdateSequence(key, 5, 100);
+  EXPECT_FALSE(table.IsValidSequence(key, 5));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  // An expired producer starts over
+  EXPECT_EQ(table.GetLastSequence(key), -1);
+  EXPECT_TRUE(table.IsValidSequence(key, 0));
+  table.CleanupExpired();
+  EXPECT_EQ(table.Size(), 0);
+}
+
+TEST(BoundedIdempotencyTableTest, RemoveProducerAndClear) {
+  BoundedIdempotencyTable table(100, std::chrono::milliseconds(60000));
+
+  table.UpdateSequence({1, 1, 0}, 0, 100);
+  table.UpdateSequence({1, 2, 0}, 0, 200);
+  table.UpdateSequence({2, 1, 0}, 0, 300);
+
+  table.RemoveProducer(1);
+  EXPECT_EQ(table.Size(), 1);
+  EXPECT_EQ(table.GetLastOffset({2, 1, 0}), 300);
+
+  table.Clear();
+  EXPECT_EQ(table.Size(), 0);
+  table.UpdateSequence({3, 1, 0}, 0, 400);
+  EXPECT_EQ(table.Size(), 1);
+}
+
+TEST(IdempotencyTableTest, ShardedConcurrentUpdates) {
+  IdempotencyTable table(8);
+  EXPECT_EQ(table.NumShards(), 8);
+
+  std::vector<std::thread> writers;
+  for (int32_t partition = 0; partition < 8; ++partition) {
+    writers.emplace_back([&table, partition] {
+      ProducerKey key{1, 1, partition};
+      for (int64_t sequence = 0; sequence < 1000; ++sequence) {
+        if (table.IsValidSequence(key, sequence)) {
+          table.UpdateSequence(key, sequence, sequence * 10);
+        }
+      }
+    });
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+
+  EXPECT_EQ(table.Size(), 8);
+  EXPECT_EQ(table.GetLastSequence({1, 1, 3}), 999);
+
+  // Removing a producer reaches every shard
+  table.RemoveProducer(1);
+  EXPECT_EQ(table.Size(), 0);
+}
+
+TEST(BoundedIdempotencyTableTest, ShardsSplitCapacity) {
+  BoundedIdempotencyTable table(64, std::chrono::milliseconds(60000), 4);
+  EXPECT_EQ(table.NumShards(), 4);
+
+  for (int32_t partition = 0; partition < 1000; ++partition) {
+    table.UpdateSequence({1, 1, partition}, 0, partition);
+  }
+
+  // Each shard holds at most its share of the capacity
+  EXPECT_LE(table.Size(), 64);
+  EXPECT_EQ(table.GetLastOffset({1, 1, 999}), 999);
+}
+
+
+TEST(ProducerSnapshotTest, RecoversFromSnapshotAndLogTail) {
+  auto root = std::filesystem::temp_directory_path() / "streamit_producer_snapshot_test";
+  std::filesystem::remove_all(root);
+
+  auto log_dir = std::make_shared<storage::LogDir>(root, 1024 * 1024);
+  auto table = std::make_shared<IdempotencyTable>();
+  auto segment = log_dir->GetSegment("topic1", 0).value();
+  std::vector<storage::Record> records{storage::Record("key", "value", 0)};
+  ProducerKey key{1, log_dir->Topics()->Intern("topic1"), 0};
+
+  auto append = [&](int64_t sequence) {
+    int64_t offset = segment->Append(records, key.producer_id, sequence).value();
+    table->UpdateSequence(key, sequence, offset);
+  };
+
+  for (int64_t sequence = 0; sequence < 3; ++sequence) {
+    append(sequence);
+  }
+  ProducerSnapshotter snapshotter(log_dir, table);
+  ASSERT_TRUE(snapshotter.Write(snapshotter.Capture()).ok());
+
+  // Written after the snapshot, so only recoverable from the log
+  append(3);
+  ASSERT_TRUE(segment->Append(records).ok());
+  append(4);
+
+  auto restored = std::make_shared<IdempotencyTable>();
+  ProducerSnapshotter recovering(log_dir, restored);
+  auto replayed = recovering.Recover();
+  ASSERT_TRUE(replayed.ok());
+  EXPECT_EQ(replayed.value(), 3);
+  EXPECT_EQ(recovering.MaxProducerId(), 1);
+
+  // Batches from both the snapshot and the tail are still deduplicated
+  EXPECT_EQ(restored->CheckSequence(key, 1).status, SequenceStatus::kDuplicate);
+  EXPECT_EQ(restored->CheckSequence(key, 1).offset, 1);
+  EXPECT_EQ(restored->CheckSequence(key, 4).offset, 5);
+  EXPECT_EQ(restored->CheckSequence(key, 5).status, SequenceStatus::kAccept);
+
+  std::filesystem::remove_all(root);
+}
+
+TEST(ProducerSnapshotTest, RejectsCorruptFile) {
+  auto path = std::filesystem::temp_directory_path() / "streamit_producer_snapshot_corrupt";
+  ProducerSnapshot snapshot;
+  snapshot.end_offset = 42;
+  snapshot.producers.emplace_back(1, std::vector<SequenceWindow::Batch>{{7, 40}, {8, 41}});
+  ASSERT_TRUE(ProducerSnapshotter::WriteFile(path, snapshot).ok());
+
+  auto loaded = ProducerSnapshotter::ReadFile(path);
+  ASSERT_TRUE(loaded.ok());
+  EXPECT_EQ(loaded.value().end_offset, 42);
+  ASSERT_EQ(loaded.value().producers.size(), 1);
+  EXPECT_EQ(loaded.value().producers[0].second[1].offset, 41);
+
+  // Flip a byte inside the end offset
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(8);
+    file.put('\x7f');
+  }
+  EXPECT_EQ(ProducerSnapshotter::ReadFile(path).status().code(), absl::StatusCode::kDataLoss);
+  EXPECT_EQ(ProducerSnapshotter::ReadFile(path.string() + ".missing").status().code(), absl::StatusCode::kNotFound);
+
+  std::filesystem::remove(path);
+}
+
+TEST(ProducerIdManagerTest, NeverReissuesAfterRestart) {
+  auto path = std::filesystem::temp_directory_path() / "streamit_producer_id_block";
+  std::filesystem::remove(path);
+
+  ProducerIdManager ids(path);
+  EXPECT_FALSE(ids.Allocate().ok());
+  ASSERT_TRUE(ids.Load().ok());
+  EXPECT_EQ(ids.Allocate().value(), 1);
+  EXPECT_EQ(ids.Allocate().value(), 2);
+
+  // A restart skips the rest of the reserved block
+  ProducerIdManager restarted(path);
+  ASSERT_TRUE(restarted.Load().ok());
+  EXPECT_EQ(restarted.Allocate().value(), ProducerIdManager::kBlockSize + 1);
+
+  // Ids recovered from the log are skipped too
+  restarted.Observe(5000);
+  EXPECT_EQ(restarted.Allocate().value(), 5001);
+
+  std::filesystem::remove(path);
+}
+} 
+}
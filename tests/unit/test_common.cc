@@ -1,7 +1,28 @@
 #include <gtest/gtest.h>
 #include "streamit/common/status.h"
 #include "streamit/common/result.h"
+#include "streamit/common/stage_timer.h"
+#include "streamit/common/async_logger.h"
+#include "streamit/common/cpu_profiler.h"
 #include "streamit/common/crc32.h"
+#include "streamit/common/executor.h"
+#include "streamit/common/http_health_server.h"
+#include "streamit/common/instrumented_mutex.h"
+#include "streamit/common/metrics.h"
+#include "streamit/common/mpmc_queue.h"
+#include "streamit/common/slow_request_log.h"
+#include "streamit/common/span.h"
+#include "streamit/common/task.h"
+#include "streamit/common/timer_service.h"
+#include "streamit/common/topic_registry.h"
+#include <chrono>
+#include <future>
+#include <netinet/in.h>
+#include <spdlog/sinks/ostream_sink.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
 
 namespace streamit::common {
 namespace {
@@ -78,6 +99,542 @@ TEST(Crc32Test, EmptyData) {
   EXPECT_TRUE(Crc32::Verify(empty_data, crc));
 }
 
-} 
+TEST(TaskTest, SyncWaitReturnsValue) {
+  auto inner = []() -> Task<int> { co_return 41; };
+  auto outer = [&]() -> Task<int> { co_return co_await inner() + 1; };
+  EXPECT_EQ(SyncWait(outer()), 42);
+}
+
+TEST(TaskTest, PropagatesException) {
+  auto failing = []() -> Task<void> {
+    throw std::runtime_error("boom");
+    co_return;
+  };
+  EXPECT_THROW(SyncWait(failing()), std::runtime_error);
+}
+
+TEST(ExecutorTest, RunOnResumesOnOriginExecutor) {
+  Executor requests("test-request", 1);
+  Executor io("test-io", 1);
+
+  auto task = [&]() -> Task<bool> {
+    co_await requests.Schedule();
+    auto io_thread = co_await RunOn(io, [] { return std::this_thread::get_id(); });
+    co_return Executor::Current() == &requests && io_thread != std::this_thread::get_id();
+  };
+  EXPECT_TRUE(SyncWait(task()));
+}
+
+TEST(TimerServiceTest, SleepForAndCancel) {
+  TimerService timers;
+
+  auto start = std::chrono::steady_clock::now();
+  SyncWait([&]() -> Task<void> { co_await timers.SleepFor(std::chrono::milliseconds(20)); }());
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+  bool fired = false;
+  auto id = timers.ScheduleAfter(std::chrono::milliseconds(1000), [&fired] { fired = true; });
+  EXPECT_TRUE(timers.Cancel(id));
+  EXPECT_FALSE(timers.Cancel(id));
+  EXPECT_EQ(timers.Size(), 0);
+}
+
+TEST(TopicRegistryTest, InternsDenseIds) {
+  TopicRegistry topics;
+
+  EXPECT_FALSE(topics.Find("orders").has_value());
+  EXPECT_EQ(topics.Intern("orders"), 0);
+  EXPECT_EQ(topics.Intern("payments"), 1);
+  EXPECT_EQ(topics.Intern("orders"), 0);
+  EXPECT_EQ(topics.Find("payments"), 1);
+  EXPECT_EQ(topics.Name(1), "payments");
+  EXPECT_EQ(topics.Size(), 2);
+}
+
+TEST(MetricsTest, CounterSumsShards) {
+  Counter counter;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&counter] {
+      for (int i = 0; i < 1000; ++i) {
+        counter.Increment(2);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(counter.Value(), 8000);
+}
+
+TEST(MetricsTest, HistogramBuckets) {
+  // Every value lands in a bucket whose bounds contain it
+  for (int64_t value : {int64_t{0}, int64_t{31}, int64_t{32}, int64_t{33}, int64_t{1000}, int64_t{123456789},
+                        Histogram::kMaxValue}) {
+    auto index = Histogram::BucketIndex(value);
+    ASSERT_LT(index, Histogram::kBucketCount);
+    EXPECT_LE(Histogram::BucketLowerBound(index), value);
+    EXPECT_GE(Histogram::BucketUpperBound(index), value);
+  }
+}
+
+TEST(MetricsTest, HistogramQuantilesAndMerge) {
+  Histogram first;
+  Histogram second;
+  for (int64_t value = 1; value <= 1000; ++value) {
+    (value % 2 ? first : second).Record(value * 1000);
+  }
+
+  auto snapshot = first.Snapshot();
+  snapshot.Merge(second.Snapshot());
+  EXPECT_EQ(snapshot.Count(), 1000);
+  EXPECT_EQ(snapshot.Min(), 1000);
+  EXPECT_EQ(snapshot.Max(), 1000000);
+  EXPECT_DOUBLE_EQ(snapshot.Mean(), 500500.0);
+
+  // Quantiles are exact to within a bucket
+  EXPECT_NEAR(snapshot.Quantile(0.5), 500000, 500000 * 0.04);
+  EXPECT_NEAR(snapshot.Quantile(0.99), 990000, 990000 * 0.04);
+  EXPECT_EQ(snapshot.Quantile(1.0), 1000000);
+  EXPECT_EQ(HistogramSnapshot().Quantile(0.5), 0);
+}
+
+TEST(MetricsTest, HistogramShardsAllocatedByConcurrentWriters) {
+  // More threads than shards, so several threads race to allocate each shard
+  Histogram histogram;
+  EXPECT_EQ(histogram.Snapshot().Count(), 0);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 32; ++t) {
+    threads.emplace_back([&histogram] {
+      for (int i = 0; i < 1000; ++i) {
+        histogram.Record(2);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto snapshot = histogram.Snapshot();
+  EXPECT_EQ(snapshot.Count(), 32000);
+  EXPECT_EQ(snapshot.Sum(), 64000);
+}
+
+TEST(MetricsTest, PrometheusExposition) {
+  auto& registry = MetricsRegistry::Instance();
+
+  // Series of one family share a name and differ by labels
+  auto family = registry.CounterFamily("test_exposition_total", "Test counter");
+  family->WithLabels({{"topic", "orders"}, {"partition", "0"}})->Increment(3);
+  family->WithLabels({{"topic", "say \"hi\""}, {"partition", "1"}})->Increment();
+  EXPECT_EQ(family->WithLabels({{"topic", "orders"}, {"partition", "0"}})->Value(), 3);
+
+  registry.CreateLatencyHistogram("test_exposition_latency", "Test histogram", {{"type", "produce"}})->Record(7);
+
+  auto text = registry.RenderPrometheus();
+  EXPECT_NE(text.find("# TYPE test_exposition_total counter\n"), std::string::npos);
+  EXPECT_NE(text.find("test_exposition_total{partition=\"0\",topic=\"orders\"} 3\n"), std::string::npos);
+  EXPECT_NE(text.find("test_exposition_total{partition=\"1\",topic=\"say \\\"hi\\\"\"} 1\n"), std::string::npos);
+  EXPECT_NE(text.find("# TYPE test_exposition_latency summary\n"), std::string::npos);
+  EXPECT_NE(text.find("test_exposition_latency{type=\"produce\",quantile=\"0.99\"} 7\n"), std::string::npos);
+  EXPECT_NE(text.find("test_exposition_latency_count{type=\"produce\"} 1\n"), std::string::npos);
+}
+
+enum class TestStage { kFirst, kSecond, kUnused, kCount };
+
+TEST(MetricsTest, StageTimerRecordsMarkedStages) {
+  auto family = MetricsRegistry::Instance().HistogramFamily("test_stage_ns", "Test stages");
+  StageHistograms<TestStage> histograms(*family, {"first", "second", "unused"});
+
+  {
+    StageTimer<TestStage> timer(histograms);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    timer.Mark(TestStage::kFirst);
+    timer.Mark(TestStage::kSecond);
+    timer.Mark(TestStage::kFirst); // Time adds up across marks of the same stage
+    EXPECT_GE(timer.Elapsed(TestStage::kFirst), std::chrono::milliseconds(2));
+    EXPECT_GE(timer.Total(), timer.Elapsed(TestStage::kFirst) + timer.Elapsed(TestStage::kSecond));
+  }
+
+  EXPECT_EQ(histograms.stages[0]->Snapshot().Count(), 1);
+  EXPECT_GE(histograms.stages[0]->Snapshot().Min(), 2000000);
+  EXPECT_EQ(histograms.stages[1]->Snapshot().Count(), 1);
+  EXPECT_EQ(histograms.stages[2]->Snapshot().Count(), 0);
+}
+
+TEST(SlowRequestLogTest, KeepsLatestSampledRequests) {
+  SlowRequestLog log(std::chrono::milliseconds(10), 2, 2);
+  EXPECT_FALSE(log.ShouldRecord(std::chrono::milliseconds(9)));
+  EXPECT_EQ(log.SlowCount(), 0);
+
+  // Every other slow request is kept, and only the latest two of those
+  int recorded = 0;
+  for (int i = 0; i < 6; ++i) {
+    if (log.ShouldRecord(std::chrono::milliseconds(20))) {
+      SlowRequest request;
+      request.type = "produce";
+      request.topic = "orders";
+      request.partition = recorded++;
+      request.stages = {{"write", std::chrono::nanoseconds(5)}, {"append_lock", std::chrono::nanoseconds(7)}};
+      log.Record(std::move(request));
+    }
+  }
+  EXPECT_EQ(recorded, 3);
+  EXPECT_EQ(log.SlowCount(), 6);
+
+  auto entries = log.Entries();
+  ASSERT_EQ(entries.size(), 2u);
+  EXPECT_EQ(entries[0].partition, 1);
+  EXPECT_EQ(entries[1].partition, 2);
+
+  auto json = log.RenderJson();
+  EXPECT_NE(json.find("\"topic\":\"orders\",\"partition\":2"), std::string::npos);
+  EXPECT_NE(json.find("\"stages_ns\":{\"write\":5,\"append_lock\":7}"), std::string::npos);
+  EXPECT_EQ(json.find("\"partition\":0"), std::string::npos);
+}
+
+TEST(MpmcQueueTest, FifoUntilFull) {
+  MpmcQueue<int> queue(3); // Rounded up to 4
+  EXPECT_EQ(queue.Capacity(), 4u);
+  EXPECT_TRUE(queue.Empty());
+
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.TryPush(int{i}));
+  }
+  EXPECT_FALSE(queue.TryPush(4));
+
+  int value = -1;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.TryPop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(queue.TryPop(value));
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(MpmcQueueTest, ConcurrentProducersAndConsumers) {
+  constexpr int kThreads = 4;
+  constexpr int kPerThread = 20000;
+  MpmcQueue<int64_t> queue(64);
+  std::atomic<int64_t> sum{0};
+  std::atomic<int> popped{0};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kPerThread; ++i) {
+        int64_t value = int64_t{t} * kPerThread + i;
+        while (!queue.TryPush(std::move(value))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+    threads.emplace_back([&] {
+      int64_t value;
+      while (popped.load() < kThreads * kPerThread) {
+        if (queue.TryPop(value)) {
+          sum += value;
+          ++popped;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  int64_t n = int64_t{kThreads} * kPerThread;
+  EXPECT_EQ(popped.load(), n);
+  EXPECT_EQ(sum.load(), n * (n - 1) / 2);
+}
+
+TEST(LogRateLimiterTest, LimitsEachWindow) {
+  LogRateLimiter limiter(2);
+  auto now = std::chrono::steady_clock::now();
+  int64_t suppressed = -1;
+
+  EXPECT_TRUE(limiter.Allow(suppressed, now));
+  EXPECT_EQ(suppressed, 0);
+  EXPECT_TRUE(limiter.Allow(suppressed, now));
+  EXPECT_FALSE(limiter.Allow(suppressed, now));
+  EXPECT_FALSE(limiter.Allow(suppressed, now));
+
+  // A new window lets messages through again and reports what was held back
+  EXPECT_TRUE(limiter.Allow(suppressed, now + std::chrono::seconds(1)));
+  EXPECT_EQ(suppressed, 2);
+}
+
+TEST(AsyncLoggerTest, WritesQueuedMessagesInOrder) {
+  std::ostringstream out;
+  auto sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(out);
+  sink->set_pattern("%l %v");
+  auto logger = std::make_shared<spdlog::logger>("async_logger_test", sink);
+
+  AsyncLogger async_logger(logger, 16);
+  for (int i = 0; i < 10; ++i) {
+    async_logger.Log(spdlog::level::info, "message " + std::to_string(i));
+  }
+  async_logger.Flush();
+
+  std::string expected;
+  for (int i = 0; i < 10; ++i) {
+    expected += "info message " + std::to_string(i) + "\n";
+  }
+  EXPECT_EQ(out.str(), expected);
+  EXPECT_EQ(async_logger.Dropped(), 0);
+
+  // After Stop messages are written synchronously
+  async_logger.Stop();
+  async_logger.Log(spdlog::level::warn, "late");
+  EXPECT_EQ(out.str(), expected + "warning late\n");
+}
+
+TEST(TraceTest, TraceIdHex) {
+  TraceId id{0x0af7651916cd43ddULL, 0x8448eb211c80319cULL};
+  EXPECT_EQ(id.ToString(), "0af7651916cd43dd8448eb211c80319c");
+  EXPECT_EQ(fmt::format("[{}]", id), "[0af7651916cd43dd8448eb211c80319c]");
+  EXPECT_EQ(fmt::format("[{}]", TraceId{}), "[]");
+  EXPECT_EQ(TraceId::FromHex(id.ToString()), id);
+  EXPECT_EQ(TraceId::FromHex("ff"), (TraceId{0, 0xff}));
+  EXPECT_FALSE(TraceId::FromHex("xyz"));
+  EXPECT_FALSE(TraceId::FromHex("0000"));
+
+  auto generated = TraceId::Generate();
+  EXPECT_TRUE(generated.IsValid());
+  EXPECT_NE(generated, TraceId::Generate());
+}
+
+TEST(TraceTest, Traceparent) {
+  auto context = ParseTraceparent("00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01");
+  ASSERT_TRUE(context);
+  EXPECT_EQ(context->trace_id, (TraceId{0x0af7651916cd43ddULL, 0x8448eb211c80319cULL}));
+  EXPECT_EQ(context->span_id, 0xb7ad6b7169203331ULL);
+  EXPECT_TRUE(context->sampled);
+  EXPECT_EQ(FormatTraceparent(*context), "00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01");
+
+  EXPECT_FALSE(ParseTraceparent("00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-00")->sampled);
+  EXPECT_TRUE(ParseTraceparent("01-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01-future"));
+
+  EXPECT_FALSE(ParseTraceparent("00-00000000000000000000000000000000-b7ad6b7169203331-01"));
+  EXPECT_FALSE(ParseTraceparent("00-0af7651916cd43dd8448eb211c80319c-0000000000000000-01"));
+  EXPECT_FALSE(ParseTraceparent("00-0AF7651916CD43DD8448EB211C80319C-b7ad6b7169203331-01"));
+  EXPECT_FALSE(ParseTraceparent("ff-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01"));
+  EXPECT_FALSE(ParseTraceparent("00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01-extra"));
+  EXPECT_FALSE(ParseTraceparent("00-0af7651916cd43dd8448eb211c80319c"));
+}
+
+// Keeps every exported batch
+class CollectingSpanSink final : public SpanSink {
+public:
+  explicit CollectingSpanSink(std::vector<std::vector<SpanRecord>>& batches) : batches_(batches) {
+  }
+
+  absl::Status Export(const std::vector<SpanRecord>& spans) override {
+    batches_.push_back(spans);
+    return absl::OkStatus();
+  }
+
+private:
+  std::vector<std::vector<SpanRecord>>& batches_;
+};
+
+TEST(TraceTest, BareTraceIdIsContinuedWithoutParentSpan) {
+  std::vector<std::vector<SpanRecord>> batches;
+  SpanExporter exporter(std::make_unique<CollectingSpanSink>(batches), SpanExporterOptions{});
+
+  // What TraceContext::Extract returns for a legacy x-trace-id
+  SpanContext legacy;
+  legacy.trace_id = *TraceId::FromHex("0af7651916cd43dd8448eb211c80319c");
+  ASSERT_FALSE(legacy.IsValid());
+  {
+    Span span("produce", legacy, &exporter);
+    EXPECT_EQ(span.Context().trace_id, legacy.trace_id);
+    EXPECT_NE(span.Context().span_id, 0u);
+  }
+  exporter.Stop();
+
+  ASSERT_EQ(batches.size(), 1u);
+  ASSERT_EQ(batches[0].size(), 1u);
+  EXPECT_EQ(batches[0][0].trace_id, legacy.trace_id);
+  EXPECT_EQ(batches[0][0].parent_span_id, 0u);
+}
+
+TEST(TraceTest, SpansAreExportedInBatches) {
+  std::vector<std::vector<SpanRecord>> batches;
+  SpanExporterOptions options;
+  options.max_batch = 2;
+  SpanExporter exporter(std::make_unique<CollectingSpanSink>(batches), options);
+
+  auto parent = *ParseTraceparent("00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01");
+  {
+    Span child("produce", parent, &exporter);
+    child.SetAttribute("topic", std::string("orders"));
+    child.SetAttribute("partition", 3);
+    EXPECT_EQ(child.Context().trace_id, parent.trace_id);
+    EXPECT_NE(child.Context().span_id, parent.span_id);
+
+    Span root("fetch", SpanContext{}, &exporter);
+    root.SetError("boom");
+    EXPECT_NE(root.Context().trace_id, parent.trace_id);
+
+    // An unsampled caller's trace is propagated but not exported
+    auto unsampled = parent;
+    unsampled.sampled = false;
+    Span skipped("fetch", unsampled, &exporter);
+  }
+  exporter.Stop();
+
+  ASSERT_EQ(batches.size(), 1u);
+  ASSERT_EQ(batches[0].size(), 2u);
+  EXPECT_EQ(exporter.Exported(), 2);
+  EXPECT_EQ(exporter.Dropped(), 0);
+
+  // Spans end in reverse order of construction
+  const auto& root = batches[0][0];
+  const auto& child = batches[0][1];
+  EXPECT_EQ(child.parent_span_id, parent.span_id);
+  EXPECT_EQ(root.parent_span_id, 0u);
+  EXPECT_LE(child.start_unix_nanos, child.end_unix_nanos);
+
+  auto json = RenderOtlpJson(batches[0], "streamit-broker");
+  EXPECT_NE(json.find("\"stringValue\":\"streamit-broker\""), std::string::npos);
+  EXPECT_NE(json.find("\"traceId\":\"0af7651916cd43dd8448eb211c80319c\",\"spanId\""), std::string::npos);
+  EXPECT_NE(json.find("\"parentSpanId\":\"b7ad6b7169203331\""), std::string::npos);
+  EXPECT_NE(json.find("{\"key\":\"topic\",\"value\":{\"stringValue\":\"orders\"}}"), std::string::npos);
+  EXPECT_NE(json.find("{\"key\":\"partition\",\"value\":{\"intValue\":\"3\"}}"), std::string::npos);
+  EXPECT_NE(json.find("\"status\":{\"code\":2,\"message\":\"boom\"}"), std::string::npos);
+}
+
+TEST(InstrumentedMutexTest, RecordsContentionPerSite) {
+  SetLockProfilingMode(LockProfiling::kFull);
+  InstrumentedMutex mutex("test_contended");
+  int64_t counter = 0;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 2000; ++i) {
+        std::lock_guard<InstrumentedMutex> lock(mutex);
+        ++counter;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  SetLockProfilingMode(LockProfiling::kSampled);
+  EXPECT_EQ(counter, 8000);
+
+  // Series are shared through the registry by lock name
+  auto& registry = MetricsRegistry::Instance();
+  MetricLabels labels{{"lock", "test_contended"}};
+  EXPECT_EQ(registry.CounterFamily("streamit_lock_acquisitions_total", "")->WithLabels(labels)->Value(), 8000);
+  EXPECT_EQ(registry.HistogramFamily("streamit_lock_hold_ns", "")->WithLabels(labels)->Snapshot().Count(), 8000);
+  auto contended = registry.CounterFamily("streamit_lock_contended_total", "")->WithLabels(labels)->Value();
+  EXPECT_EQ(registry.HistogramFamily("streamit_lock_wait_ns", "")->WithLabels(labels)->Snapshot().Count(), contended);
+
+  // try_lock counts as an uncontended acquisition
+  ASSERT_TRUE(mutex.try_lock());
+  mutex.unlock();
+  EXPECT_EQ(registry.CounterFamily("streamit_lock_acquisitions_total", "")->WithLabels(labels)->Value(), 8001);
+
+  EXPECT_NE(LockProfiler::RenderJson().find("\"lock\":\"test_contended\",\"acquisitions\":8001,"),
+            std::string::npos);
+}
+
+TEST(CpuProfilerTest, FoldsSampledStacks) {
+  std::atomic<bool> stop{false};
+  std::thread burner([&stop] {
+    pthread_setname_np(pthread_self(), "cpu-burner");
+    volatile uint64_t x = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+      x = x * 6364136223846793005ull + 1;
+    }
+  });
+
+  auto profile = CpuProfiler::Collect({std::chrono::seconds(1), 200});
+  stop.store(true);
+  burner.join();
+  ASSERT_TRUE(profile.ok()) << profile.status();
+
+  // One `thread;frames... count` line per stack, and the spinning thread accounts for most samples
+  int64_t burner_samples = 0;
+  std::istringstream lines(*profile);
+  for (std::string line; std::getline(lines, line);) {
+    auto space = line.rfind(' ');
+    ASSERT_NE(space, std::string::npos) << line;
+    if (line.starts_with("cpu-burner;")) {
+      burner_samples += std::stoll(line.substr(space + 1));
+    }
+  }
+  EXPECT_GT(burner_samples, 50);
+
+  EXPECT_EQ(CpuProfiler::Collect({std::chrono::seconds(0), 99}).status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(ServeCpuProfile({"GET", "/debug/pprof/profile", {{"hz", "fast"}}}).status_code, 400);
 }
 
+TEST(HttpHealthServerTest, ParseRequestLine) {
+  auto request = HttpHealthServer::ParseRequestLine("GET /debug/pprof/profile?seconds=5&hz=99 HTTP/1.1\r\nHost: x\r\n");
+  EXPECT_EQ(request.method, "GET");
+  EXPECT_EQ(request.path, "/debug/pprof/profile");
+  EXPECT_EQ(request.query.at("seconds"), "5");
+  EXPECT_EQ(request.query.at("hz"), "99");
+
+  EXPECT_EQ(HttpHealthServer::ParseRequestLine("GET /metrics HTTP/1.1\r\n").path, "/metrics");
+  EXPECT_TRUE(HttpHealthServer::ParseRequestLine("garbage").method.empty());
+}
+
+// Connect to a local port, retrying while the server is still starting; -1 if it never comes up
+int ConnectToLocalPort(uint16_t port) {
+  for (int attempt = 0; attempt < 100; ++attempt) {
+    int socket_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (connect(socket_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0) {
+      return socket_fd;
+    }
+    close(socket_fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return -1;
+}
+
+TEST(HttpHealthServerTest, SilentClientDoesNotHoldTheExecutor) {
+  constexpr uint16_t kPort = 18473;
+  Executor executor("test-admin", 1);
+  HttpHealthServer server("127.0.0.1", kPort, nullptr, &executor);
+  ASSERT_TRUE(server.Start());
+
+  // Connects but never sends a request line
+  int silent = ConnectToLocalPort(kPort);
+  ASSERT_GE(silent, 0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  // The only executor thread is still free for other work
+  std::promise<void> ran;
+  ASSERT_TRUE(executor.Post([&ran] { ran.set_value(); }));
+  EXPECT_EQ(ran.get_future().wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+  // Once the silent client goes away, requests are answered again
+  close(silent);
+  int client = ConnectToLocalPort(kPort);
+  ASSERT_GE(client, 0);
+  std::string request = "GET /live HTTP/1.1\r\n\r\n";
+  ASSERT_EQ(send(client, request.data(), request.size(), MSG_NOSIGNAL), static_cast<ssize_t>(request.size()));
+  char buffer[256] = {};
+  ASSERT_GT(read(client, buffer, sizeof(buffer) - 1), 0);
+  EXPECT_TRUE(std::string(buffer).starts_with("HTTP/1.1 200"));
+  close(client);
+
+  EXPECT_TRUE(server.Stop());
+  executor.Shutdown();
+}
+
+} 
+}
@@ -1,8 +1,13 @@
 #include <gtest/gtest.h>
+#include "streamit/storage/log_dir.h"
+#include "streamit/storage/offset_checkpoint.h"
+#include "streamit/storage/partition.h"
 #include "streamit/storage/record.h"
 #include "streamit/storage/serializer.h"
-#include <filesystem>
+#include <cstddef>
 #include <cstdio>
+#include <filesystem>
+#include <fstream>
 
 namespace streamit::storage {
 namespace {
@@ -47,6 +52,20 @@ TEST(RecordBatchTest, SerializeDeserialize) {
   EXPECT_TRUE(deserialized.VerifyCrc32());
 }
 
+TEST(RecordBatchTest, ProducerFieldsRoundTrip) {
+  std::vector<Record> records = {Record("key1", "value1", 1234567890)};
+
+  RecordBatch batch(100, records, 1234567890, 7, 42);
+  auto deserialized = RecordBatch::Deserialize(batch.Serialize());
+  EXPECT_EQ(deserialized.producer_id, 7);
+  EXPECT_EQ(deserialized.sequence, 42);
+  EXPECT_EQ(batch.Serialize().size(), batch.SerializedSize());
+
+  // The producer fields are covered by the CRC
+  deserialized.sequence = 43;
+  EXPECT_FALSE(deserialized.VerifyCrc32());
+}
+
 TEST(RecordBatchTest, Crc32Verification) {
   std::vector<Record> records = {
     Record("key1", "value1", 1234567890)
@@ -100,6 +119,150 @@ TEST(SerializerTest, GetSizes) {
   EXPECT_GT(Serializer::GetBatchSize(batch), 0);
 }
 
+TEST(LogDirTest, PartitionSnapshotSurvivesRoll) {
+  auto root = std::filesystem::temp_directory_path() / "streamit_logdir_snapshot_test";
+  std::filesystem::remove_all(root);
+  LogDir log_dir(root, 1024 * 1024);
+
+  common::TopicPartition tp{log_dir.Topics()->Intern("topic1"), 0};
+  EXPECT_EQ(log_dir.GetPartition(tp), nullptr);
+
+  auto partition = log_dir.GetOrCreatePartition(tp);
+  EXPECT_EQ(log_dir.GetPartition(tp), partition);
+
+  auto first = partition->ActiveSegment();
+  ASSERT_TRUE(first.ok());
+  std::vector<Record> records = {Record("key", "value", 1234567890)};
+  ASSERT_TRUE(first.value()->Append(records).ok());
+
+  // A reader's snapshot is unchanged by a roll; the next load sees the new segment
+  auto before = partition->Segments();
+  auto rolled = partition->Roll();
+  ASSERT_TRUE(rolled.ok());
+  EXPECT_EQ(before->size(), 1u);
+  EXPECT_EQ(partition->Segments()->size(), 2u);
+  EXPECT_EQ(rolled.value()->BaseOffset(), 1);
+  EXPECT_EQ(partition->EndOffset(), 1);
+
+  std::filesystem::remove_all(root);
+}
+
+TEST(LogDirTest, OpenRejectsUnsupportedSegmentVersion) {
+  auto root = std::filesystem::temp_directory_path() / "streamit_logdir_version_test";
+  std::filesystem::remove_all(root);
+  {
+    LogDir log_dir(root, 1024 * 1024);
+    auto partition = log_dir.GetOrCreatePartition({log_dir.Topics()->Intern("topic1"), 0});
+    auto segment = partition->ActiveSegment();
+    ASSERT_TRUE(segment.ok());
+    std::vector<Record> records = {Record("key", "value", 1234567890)};
+    ASSERT_TRUE(segment.value()->Append(records).ok());
+  }
+
+  // Rewrite every segment header as if an older broker had written it
+  for (const auto& entry : std::filesystem::directory_iterator(root / "topic1" / "0")) {
+    if (entry.path().extension() == ".log") {
+      std::fstream file(entry.path(), std::ios::in | std::ios::out | std::ios::binary);
+      uint32_t old_version = 1;
+      file.seekp(offsetof(SegmentHeader, version));
+      file.write(reinterpret_cast<const char*>(&old_version), sizeof(old_version));
+    }
+  }
+
+  auto reopened = LogDir::Open(root, 1024 * 1024);
+  ASSERT_FALSE(reopened.ok());
+  EXPECT_EQ(reopened.status().code(), absl::StatusCode::kFailedPrecondition);
+
+  std::filesystem::remove_all(root);
+}
+
+TEST(PartitionTest, FindSegmentBinarySearch) {
+  auto root = std::filesystem::temp_directory_path() / "streamit_partition_find_test";
+  std::filesystem::remove_all(root);
+  Partition partition({1, 0}, root, 1024 * 1024);
+
+  // Three segments holding offsets [0, 2), [2, 3) and an empty active one at 3
+  std::vector<Record> two = {Record("k1", "v1", 1), Record("k2", "v2", 2)};
+  std::vector<Record> one = {Record("k3", "v3", 3)};
+  ASSERT_TRUE(partition.Roll().value()->Append(two).ok());
+  ASSERT_TRUE(partition.Roll().value()->Append(one).ok());
+  ASSERT_TRUE(partition.Roll().ok());
+
+  auto segments = partition.Segments();
+  EXPECT_EQ(Partition::FindSegment(*segments, 0), segments->begin());
+  EXPECT_EQ(Partition::FindSegment(*segments, 1), segments->begin());
+  EXPECT_EQ(Partition::FindSegment(*segments, 2), segments->begin() + 1);
+  EXPECT_EQ(Partition::FindSegment(*segments, 3), segments->end()); // Log end
+  EXPECT_EQ(Partition::FindSegment(*segments, -1), segments->end());
+
+  std::filesystem::remove_all(root);
+}
+
+TEST(PartitionTest, HighWaterMarkNeverMovesBack) {
+  auto root = std::filesystem::temp_directory_path() / "streamit_partition_hwm_test";
+  std::filesystem::remove_all(root);
+  Partition partition({1, 0}, root, 1024 * 1024);
+
+  // Produces finishing out of order must not publish an older end offset
+  partition.SetHighWaterMark(20);
+  partition.SetHighWaterMark(10);
+  EXPECT_EQ(partition.HighWaterMark(), 20);
+
+  std::filesystem::remove_all(root);
+}
+
+TEST(PartitionTest, AppendRollsOnOverflow) {
+  auto root = std::filesystem::temp_directory_path() / "streamit_partition_roll_test";
+  std::filesystem::remove_all(root);
+  common::Executor background("roll-test", 1);
+  auto partition = std::make_shared<Partition>(common::TopicPartition{1, 0}, root, 16 * 1024,
+                                               Partition::SegmentList{}, 0, &background);
+
+  // Batches that straddle a segment boundary land in the next segment instead of failing
+  std::vector<Record> records = {Record("key", std::string(1000, 'v'), 1234567890)};
+  for (int64_t i = 0; i < 100; ++i) {
+    auto result = partition->Append(records);
+    ASSERT_TRUE(result.ok()) << result.status();
+    EXPECT_EQ(result.value().base_offset, i);
+  }
+  EXPECT_GT(partition->Segments()->size(), 1u);
+  EXPECT_EQ(partition->EndOffset(), 100);
+
+  // A batch bigger than a whole segment still fails
+  std::vector<Record> oversized = {Record("key", std::string(32 * 1024, 'v'), 1234567890)};
+  EXPECT_EQ(partition->Append(oversized).status().code(), absl::StatusCode::kResourceExhausted);
+
+  background.Shutdown();
+  std::filesystem::remove_all(root);
+}
+
+TEST(OffsetCheckpointTest, RoundTripAndCorruption) {
+  auto root = std::filesystem::temp_directory_path() / "streamit_offset_checkpoint_test";
+  std::filesystem::remove_all(root);
+  LogDir log_dir(root, 1024 * 1024);
+
+  log_dir.SetHighWaterMark("topic1", 0, 5);
+  log_dir.SetHighWaterMark("topic 2", 3, 7);
+  ASSERT_TRUE(log_dir.Checkpoint().ok());
+
+  OffsetCheckpoint checkpoint(root / OffsetCheckpoint::kFileName);
+  auto offsets = checkpoint.Read();
+  ASSERT_TRUE(offsets.ok());
+  ASSERT_EQ(offsets.value().size(), 2u);
+  EXPECT_EQ(offsets.value()[0], (PartitionOffsets{"topic1", 0, 0, 5}));
+  EXPECT_EQ(offsets.value()[1], (PartitionOffsets{"topic 2", 3, 0, 7}));
+
+  // A flipped byte is caught by the CRC
+  {
+    std::fstream file(root / OffsetCheckpoint::kFileName, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(12);
+    file.put('\x7f');
+  }
+  EXPECT_EQ(checkpoint.Read().status().code(), absl::StatusCode::kDataLoss);
+
+  std::filesystem::remove_all(root);
+}
+
 } 
 } 
 
@@ -2,9 +2,79 @@
 #include "streamit/proto/streamit.grpc.pb.h"
 #include <grpcpp/grpcpp.h>
 #include <iostream>
+#include <netdb.h>
+#include <optional>
+#include <sys/socket.h>
+#include <unistd.h>
 
 namespace streamit::cli {
 
+namespace {
+
+// GET `path` from a broker's HTTP admin port; returns the response body, or nullopt on any failure
+std::optional<std::string> HttpGet(const std::string& host, int port, const std::string& path) {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* addresses = nullptr;
+  if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0) {
+    std::cerr << "Failed to resolve " << host << std::endl;
+    return std::nullopt;
+  }
+
+  int fd = -1;
+  for (auto* address = addresses; address != nullptr; address = address->ai_next) {
+    fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (fd >= 0 && connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+      break;
+    }
+    if (fd >= 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  freeaddrinfo(addresses);
+  if (fd < 0) {
+    std::cerr << "Failed to connect to " << host << ":" << port << std::endl;
+    return std::nullopt;
+  }
+
+  std::string request = "GET " + path + " HTTP/1.0\r\nHost: " + host + "\r\nConnection: close\r\n\r\n";
+  size_t sent = 0;
+  while (sent < request.size()) {
+    auto n = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0) {
+      close(fd);
+      std::cerr << "Failed to send request" << std::endl;
+      return std::nullopt;
+    }
+    sent += static_cast<size_t>(n);
+  }
+
+  // The server closes the connection after one response
+  std::string response;
+  char buffer[4096];
+  ssize_t n;
+  while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, static_cast<size_t>(n));
+  }
+  close(fd);
+
+  auto header_end = response.find("\r\n\r\n");
+  if (header_end == std::string::npos) {
+    std::cerr << "Malformed response from " << host << ":" << port << std::endl;
+    return std::nullopt;
+  }
+  auto status_line = response.substr(0, response.find("\r\n"));
+  if (status_line.find(" 200 ") == std::string::npos) {
+    std::cerr << "Request failed: " << status_line << std::endl;
+    return std::nullopt;
+  }
+  return response.substr(header_end + 4);
+}
+
+} // namespace
+
 int RunAdmin(int argc, char* argv[]) {
   if (argc < 2) {
     PrintAdminHelp();
@@ -19,6 +89,10 @@ int RunAdmin(int argc, char* argv[]) {
     return RunDescribeTopic(argc - 1, argv + 1);
   } else if (command == "list-topics") {
     return RunListTopics(argc - 1, argv + 1);
+  } else if (command == "slow-requests") {
+    return RunSlowRequests(argc - 1, argv + 1);
+  } else if (command == "locks") {
+    return RunLocks(argc - 1, argv + 1);
   } else {
     std::cerr << "Unknown admin command: " << command << std::endl;
     PrintAdminHelp();
@@ -179,6 +253,56 @@ int RunListTopics(int argc, char* argv[]) {
   return 0;
 }
 
+int RunSlowRequests(int argc, char* argv[]) {
+  // Parse command line arguments
+  std::string broker_host = "localhost";
+  int admin_port = 8080;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      PrintSlowRequestsHelp();
+      return 0;
+    } else if (arg == "--broker" && i + 1 < argc) {
+      broker_host = argv[++i];
+    } else if (arg == "--port" && i + 1 < argc) {
+      admin_port = std::stoi(argv[++i]);
+    }
+  }
+
+  auto body = HttpGet(broker_host, admin_port, "/admin/slow_requests");
+  if (!body) {
+    return 1;
+  }
+  std::cout << *body;
+  return 0;
+}
+
+int RunLocks(int argc, char* argv[]) {
+  // Parse command line arguments
+  std::string broker_host = "localhost";
+  int admin_port = 8080;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      PrintLocksHelp();
+      return 0;
+    } else if (arg == "--broker" && i + 1 < argc) {
+      broker_host = argv[++i];
+    } else if (arg == "--port" && i + 1 < argc) {
+      admin_port = std::stoi(argv[++i]);
+    }
+  }
+
+  auto body = HttpGet(broker_host, admin_port, "/admin/locks");
+  if (!body) {
+    return 1;
+  }
+  std::cout << *body;
+  return 0;
+}
+
 void PrintAdminHelp() {
   std::cout << "Usage: streamit_cli admin <command> [options]\n"
             << "\n"
@@ -186,6 +310,8 @@ void PrintAdminHelp() {
             << "  create-topic     Create a new topic\n"
             << "  describe-topic   Describe a topic\n"
             << "  list-topics      List all topics\n"
+            << "  slow-requests    Show a broker's recent slow requests\n"
+            << "  locks            Show a broker's lock wait and hold times\n"
             << "\n"
             << "Use 'streamit_cli admin <command> --help' for command-specific help.\n";
 }
@@ -221,4 +347,22 @@ void PrintListTopicsHelp() {
             << "  --help, -h            Show this help message\n";
 }
 
+void PrintSlowRequestsHelp() {
+  std::cout << "Usage: streamit_cli admin slow-requests [options]\n"
+            << "\n"
+            << "Options:\n"
+            << "  --broker HOST         Broker hostname (default: localhost)\n"
+            << "  --port PORT           Broker HTTP admin port (default: 8080)\n"
+            << "  --help, -h            Show this help message\n";
+}
+
+void PrintLocksHelp() {
+  std::cout << "Usage: streamit_cli admin locks [options]\n"
+            << "\n"
+            << "Options:\n"
+            << "  --broker HOST         Broker hostname (default: localhost)\n"
+            << "  --port PORT           Broker HTTP admin port (default: 8080)\n"
+            << "  --help, -h            Show this help message\n";
+}
+
 } // namespace streamit::cli
@@ -9,11 +9,15 @@ int RunAdmin(int argc, char* argv[]);
 int RunCreateTopic(int argc, char* argv[]);
 int RunDescribeTopic(int argc, char* argv[]);
 int RunListTopics(int argc, char* argv[]);
+int RunSlowRequests(int argc, char* argv[]);
+int RunLocks(int argc, char* argv[]);
 
 // Help functions
 void PrintAdminHelp();
 void PrintCreateTopicHelp();
 void PrintDescribeTopicHelp();
 void PrintListTopicsHelp();
+void PrintSlowRequestsHelp();
+void PrintLocksHelp();
 
 } // namespace streamit::cli
@@ -19,6 +19,7 @@ int RunConsumer(int argc, char* argv[]) {
   int64_t from_offset = 0;
   int max_bytes = 1024 * 1024; // 1MB
   bool follow = false;
+  int max_wait_ms = 0;
 
   for (int i = 1; i < argc; ++i) {
     std::string arg = argv[i];
@@ -41,6 +42,8 @@ int RunConsumer(int argc, char* argv[]) {
       from_offset = std::stoll(argv[++i]);
     } else if (arg == "--max-bytes" && i + 1 < argc) {
       max_bytes = std::stoi(argv[++i]);
+    } else if (arg == "--max-wait-ms" && i + 1 < argc) {
+      max_wait_ms = std::stoi(argv[++i]);
     } else if (arg == "--follow" || arg == "-f") {
       follow = true;
     }
@@ -106,6 +109,10 @@ int RunConsumer(int argc, char* argv[]) {
 
     streamit::v1::FetchResponse fetch_response;
     grpc::ClientContext fetch_context;
+    if (max_wait_ms > 0) {
+      // Long poll: the broker holds the fetch until new data arrives or the wait expires
+      fetch_context.AddMetadata("x-max-wait-ms", std::to_string(max_wait_ms));
+    }
     grpc::Status fetch_status = broker_stub->Fetch(&fetch_context, fetch_request, &fetch_response);
 
     if (!fetch_status.ok()) {
@@ -148,8 +155,10 @@ int RunConsumer(int argc, char* argv[]) {
       break;
     }
 
-    // Sleep before next fetch
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // Sleep before next fetch unless the broker already waited for data
+    if (max_wait_ms <= 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
 
   } while (follow);
 
@@ -173,6 +182,7 @@ void PrintConsumerHelp() {
             << "  --group GROUP           Consumer group (default: default-group)\n"
             << "  --from OFFSET           Starting offset (default: 0)\n"
             << "  --max-bytes BYTES       Maximum bytes per fetch (default: 1MB)\n"
+            << "  --max-wait-ms MS        Long-poll wait for new data per fetch (default: 0)\n"
             << "  --follow, -f            Follow new messages\n"
             << "  --help, -h              Show this help message\n";
 }
@@ -1,7 +1,6 @@
 #include "producer.h"
 #include "streamit/proto/streamit.grpc.pb.h"
 #include <chrono>
-#include <ctime>
 #include <grpcpp/grpcpp.h>
 #include <iostream>
 #include <random>
@@ -19,7 +18,7 @@ int RunProducer(int argc, char* argv[]) {
   int size = 1024;
   std::string acks = "leader";
   int duration_seconds = 10;
-  std::string producer_id;
+  int64_t producer_id = 0;
 
   for (int i = 1; i < argc; ++i) {
     std::string arg = argv[i];
@@ -43,7 +42,7 @@ int RunProducer(int argc, char* argv[]) {
     } else if (arg == "--duration" && i + 1 < argc) {
       duration_seconds = std::stoi(argv[++i]);
     } else if (arg == "--producer-id" && i + 1 < argc) {
-      producer_id = argv[++i];
+      producer_id = std::stoll(argv[++i]);
     }
   }
 
@@ -53,16 +52,25 @@ int RunProducer(int argc, char* argv[]) {
     return 1;
   }
 
-  // Generate producer ID if not provided
-  if (producer_id.empty()) {
-    producer_id = "producer-" + std::to_string(std::time(nullptr));
-  }
-
   // Create gRPC channel
   std::string server_address = broker_host + ":" + std::to_string(broker_port);
   auto channel = grpc::CreateChannel(server_address, grpc::InsecureChannelCredentials());
   auto stub = streamit::v1::Broker::NewStub(channel);
 
+  // Ask the broker for a producer ID if one was not given
+  if (producer_id == 0) {
+    streamit::v1::InitProducerIdRequest init_request;
+    streamit::v1::InitProducerIdResponse init_response;
+    grpc::ClientContext init_context;
+    grpc::Status init_status = stub->InitProducerId(&init_context, init_request, &init_response);
+    if (!init_status.ok() || init_response.error_code() != streamit::v1::OK) {
+      std::cerr << "InitProducerId failed: "
+                << (init_status.ok() ? init_response.error_message() : init_status.error_message()) << std::endl;
+      return 1;
+    }
+    producer_id = init_response.producer_id();
+  }
+
   // Convert acks string to enum
   streamit::v1::Ack ack_level = streamit::v1::ACK_LEADER;
   if (acks == "quorum") {
@@ -159,7 +167,7 @@ void PrintProducerHelp() {
             << "  --size SIZE          Message size in bytes (default: 1024)\n"
             << "  --acks ACKS          Acknowledgment level: leader|quorum (default: leader)\n"
             << "  --duration SECONDS   Duration in seconds (default: 10)\n"
-            << "  --producer-id ID     Producer ID (default: auto-generated)\n"
+            << "  --producer-id ID     Numeric producer ID to resume (default: assigned by the broker)\n"
             << "  --help, -h           Show this help message\n";
 }
 